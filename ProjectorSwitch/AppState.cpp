@@ -0,0 +1,121 @@
+#include <thread>
+#include <utility>
+#include "AppState.h"
+
+void AppState::ApplyToggleResult(const DisplayWindowResult& result)
+{
+	++ToggleCount;
+	LastToggleOk = result.AllOk;
+	LastError = result.Error;
+	LastToggleUs = result.Timings.TotalUs;
+
+	if (result.Presence != ZoomPresence::Unknown)
+	{
+		Presence = result.Presence;
+	}
+
+	if (result.Placement != MediaWindowPlacement::Unknown)
+	{
+		Placement = result.Placement;
+	}
+	else if (result.Presence == ZoomPresence::NotRunning)
+	{
+		// Zoom exited, taking the window with it.
+		Placement = MediaWindowPlacement::Unknown;
+	}
+}
+
+AppStateStore::AppStateStore()
+	: current_(nullptr)
+	, readers_{ 0, 0 }
+	, readerSlot_(0)
+	, published_(std::make_unique<const Snapshot>(std::make_shared<const AppState>()))
+{
+	current_.store(published_.get());
+}
+
+AppStateStore::~AppStateStore() = default;
+
+AppStateStore::Snapshot AppStateStore::Current() const
+{
+	// Announce the read before loading the pointer (all sequentially consistent), so a
+	// writer that then sees no reader in the slot knows no one there can still reach
+	// what it retired.
+	const std::uint32_t slot = readerSlot_.load();
+	readers_[slot].fetch_add(1);
+	Snapshot snapshot = *current_.load();
+	readers_[slot].fetch_sub(1);
+	return snapshot;
+}
+
+std::uint64_t AppStateStore::Update(const Mutation& mutation)
+{
+	std::uint64_t version = 0;
+	{
+		const std::lock_guard<std::mutex> lock(writeMutex_);
+
+		auto next = std::make_shared<AppState>(**published_);
+		mutation(*next);
+		version = ++next->Version;
+
+		auto holder = std::make_unique<const Snapshot>(std::move(next));
+		current_.store(holder.get());
+		retired_.push_back(std::move(published_));
+		published_ = std::move(holder);
+
+		if (!ReadersActive())
+		{
+			retired_.clear();
+		}
+		else if (retired_.size() >= MaxRetired)
+		{
+			WaitForReaders();
+			retired_.clear();
+		}
+	}
+
+	if (listener_)
+	{
+		listener_(version);
+	}
+
+	return version;
+}
+
+/// <summary>
+/// True if a reader may be part-way through Current(). Each slot is read after the
+/// retired snapshots were replaced, so a reader counted in neither loads the new one.
+/// </summary>
+bool AppStateStore::ReadersActive() const
+{
+	return readers_[0].load() != 0 || readers_[1].load() != 0;
+}
+
+/// <summary>
+/// Waits until every reader that started before the call has finished. New readers
+/// are sent to the other slot, so the one waited on only drains; it is done for both
+/// slots, as a reader may have read the slot number just before a switch.
+/// </summary>
+void AppStateStore::WaitForReaders()
+{
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		const std::uint32_t drained = readerSlot_.load();
+		readerSlot_.store(drained ^ 1);
+		while (readers_[drained].load() != 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+std::size_t AppStateStore::RetiredCount()
+{
+	const std::lock_guard<std::mutex> lock(writeMutex_);
+	return retired_.size();
+}
+
+void AppStateStore::SetChangeListener(ChangeListener listener)
+{
+	listener_ = std::move(listener);
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DisplayWindowResult.h"
+#include "WindowGeometry.h"
+
+/// <summary>
+/// A monitor as listed in the monitor selection, in list order.
+/// </summary>
+struct MonitorEntry
+{
+	std::wstring Key;
+	ScreenRect Rect;
+};
+
+/// <summary>
+/// Application state shared between the UI and worker threads. Published as an
+/// immutable snapshot: a snapshot never changes once readers can see it.
+/// </summary>
+struct AppState
+{
+	std::uint64_t Version = 0;
+
+	std::uintptr_t MainWindow = 0;          // the main window's native handle (an HWND on Windows); 0 if there is none
+	std::uint32_t WindowDpi = 96;           // the DPI the main window is laid out for
+
+	std::vector<MonitorEntry> Monitors;     // the monitor selection list; empty while released when idle
+	std::wstring SelectedMonitorKey;        // empty if no monitor is selected
+	std::uint64_t TopologyGeneration = 0;   // incremented each time monitors are enumerated
+	std::uint32_t MonitorCount = 0;         // as last enumerated (kept while Monitors is released)
+
+	ZoomPresence Presence = ZoomPresence::Unknown;
+	MediaWindowPlacement Placement = MediaWindowPlacement::Unknown;
+
+	std::uint64_t ToggleCount = 0;
+	bool LastToggleOk = false;
+	DisplayWindowError LastError = DisplayWindowError::None;
+	std::int64_t LastToggleUs = 0;
+
+	// Copies the outcome of a toggle (presence and placement only where the toggle determined them).
+	void ApplyToggleResult(const DisplayWindowResult& result);
+};
+
+/// <summary>
+/// Holds the current AppState snapshot, RCU-style. Readers load the published
+/// snapshot pointer and take a reference to it in a fixed number of atomic steps
+/// (wait-free), counted in one of two reader slots; writers are serialized, copy the
+/// state, modify the copy and publish it with an atomic pointer swap. A replaced
+/// snapshot is retired, and freed by a later write once no reader is part-way through
+/// taking it; readers' own references keep it alive for as long as they hold them.
+/// If readers are always about when writes happen, at most MaxRetired snapshots
+/// pile up: the writer then switches readers to the other slot and waits for the
+/// few already in the old one to finish (a grace period, as in sleepable RCU).
+/// Portable (no Windows dependencies).
+/// </summary>
+class AppStateStore  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+	using Snapshot = std::shared_ptr<const AppState>;
+	using Mutation = std::function<void(AppState&)>;
+	using ChangeListener = std::function<void(std::uint64_t version)>;
+
+	static constexpr std::size_t MaxRetired = 16;
+
+private:
+	std::atomic<const Snapshot*> current_;
+	mutable std::atomic<std::uint32_t> readers_[2]; // readers part-way through Current(), by slot
+	std::atomic<std::uint32_t> readerSlot_;         // the slot new readers count themselves in
+	std::mutex writeMutex_;
+	std::vector<std::unique_ptr<const Snapshot>> retired_; // guarded by writeMutex_
+	std::unique_ptr<const Snapshot> published_;            // guarded by writeMutex_
+	ChangeListener listener_;
+
+	bool ReadersActive() const;
+	void WaitForReaders();
+
+public:
+	AppStateStore();
+	~AppStateStore();
+
+	AppStateStore(const AppStateStore&) = delete;
+	AppStateStore& operator=(const AppStateStore&) = delete;
+
+	// The current snapshot; never null. Wait-free.
+	Snapshot Current() const;
+
+	// Applies mutation to a copy of the current state and publishes it, then notifies
+	// the listener (on the calling thread). Returns the published version.
+	std::uint64_t Update(const Mutation& mutation);
+
+	// Called after each publish with the new version. Set before other threads use the
+	// store; the listener must be safe to call from any thread (e.g. PostMessage).
+	void SetChangeListener(ChangeListener listener);
+
+	// Replaced snapshots not yet freed (diagnostics; never more than MaxRetired).
+	std::size_t RetiredCount();
+};
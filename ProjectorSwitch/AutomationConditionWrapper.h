@@ -1,29 +1,6 @@
 #pragma once
 #include <uiautomation.h>
+#include "UniqueRef.h"
 
-class AutomationConditionWrapper  // NOLINT(cppcoreguidelines-special-member-functions)
-{
-private:
-	IUIAutomationCondition* condition_;
-
-public:
-	AutomationConditionWrapper(IUIAutomationCondition* condition)
-		: condition_(condition)
-	{		
-	}
-
-	~AutomationConditionWrapper()
-	{
-		if (condition_ != nullptr)
-		{
-			condition_->Release();
-			condition_ = nullptr;
-		}
-	}
-
-	IUIAutomationCondition* GetCondition() const
-	{
-		return condition_;
-	}
-};
-
+// Owning, move-only reference to a UI Automation condition.
+using AutomationConditionWrapper = UniqueRef<IUIAutomationCondition>;
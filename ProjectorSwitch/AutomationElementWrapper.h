@@ -1,29 +1,7 @@
 #pragma once
 #include <uiautomation.h>
+#include "UniqueRef.h"
 
-class AutomationElementWrapper
-{
-private:
-	IUIAutomationElement* element;
-
-public:
-	AutomationElementWrapper(IUIAutomationElement* element)
-	{
-		this->element = element;
-	}
-
-	~AutomationElementWrapper()
-	{
-		if (element)
-		{
-			element->Release();
-			element = nullptr;
-		}
-	}
-
-	IUIAutomationElement* GetElement()
-	{
-		return element;
-	}
-};
-
+// Owning, move-only references to UI Automation elements and element arrays.
+using AutomationElementWrapper = UniqueRef<IUIAutomationElement>;
+using AutomationElementArrayWrapper = UniqueRef<IUIAutomationElementArray>;
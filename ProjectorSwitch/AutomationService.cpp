@@ -1,66 +1,104 @@
 #include "AutomationService.h"
+#include "FlightRecorder.h"
 
 /// <summary>
 /// Initializes an instance of the AutomationService class, setting up the
-/// COM library and UI Automation interfaces.
+/// COM library and (unless deferred) the UI Automation interfaces.
 /// </summary>
-AutomationService::AutomationService()
-	: automation_(nullptr)
-	, desktopElement_(nullptr)
+/// <param name="creation">Whether UI Automation is created now or by a later Create call.</param>
+AutomationService::AutomationService(const Creation creation)
+	: apartment_(CoInitializeEx(nullptr, COINIT_MULTITHREADED)) // Initialize COM library
 {
-	// Initialize COM library
-	HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	FlightRecorder::Instance().Record(FlightEventKind::AutomationInit, apartment_, 0);
 
-	if (SUCCEEDED(hr))
+	if (creation == Creation::Now)
 	{
-		// Initialize COM library for UI Automation
-		hr = CoInitializeSecurity(
-			nullptr,
-			-1,
-			nullptr,
-			nullptr,
-			RPC_C_AUTHN_LEVEL_DEFAULT,
-			RPC_C_IMP_LEVEL_IMPERSONATE,
-			nullptr,
-			EOAC_NONE,
-			nullptr
-		);
+		Create();
 	}
+}
 
-	if (SUCCEEDED(hr))
+/// <summary>
+/// Destructor for the AutomationService class. Cleans up UI Automation resources.
+/// </summary>
+AutomationService::~AutomationService()
+{
+	// Released before COM is uninitialized.
+	desktopElement_.Reset();
+	automation_.Reset();
+
+	CoUninitialize();
+}
+
+/// <summary>
+/// Creates the UI Automation interface and locates the desktop element. On another
+/// thread, that thread must be in the multithreaded apartment for the call; the
+/// constructing thread keeps the apartment, and so the objects, alive afterwards.
+/// </summary>
+void AutomationService::Create()
+{
+	if (FAILED(apartment_) || automation_)
 	{
-		hr = CoCreateInstance(
-			CLSID_CUIAutomation,
-			nullptr,
-			CLSCTX_INPROC_SERVER,
-			IID_IUIAutomation,
-			reinterpret_cast<void**>(&automation_));
+		return;
+	}
 
-		if (SUCCEEDED(hr))
-		{
-			LocateDesktop();
-		}
+	// Process-wide COM security. CoInitializeSecurity can only succeed once per process
+	// (later calls fail with RPC_E_TOO_LATE), and the service is created again after each
+	// idle release, so it is called once, by the first service. UI Automation is created
+	// whatever its result: it works with the default security too.
+	static const HRESULT security = CoInitializeSecurity(
+		nullptr,
+		-1,
+		nullptr,
+		nullptr,
+		RPC_C_AUTHN_LEVEL_DEFAULT,
+		RPC_C_IMP_LEVEL_IMPERSONATE,
+		nullptr,
+		EOAC_NONE,
+		nullptr
+	);
+	FlightRecorder::Instance().Record(FlightEventKind::AutomationInit, security, 1);
+
+	const HRESULT hr = CoCreateInstance(
+		CLSID_CUIAutomation,
+		nullptr,
+		CLSCTX_INPROC_SERVER,
+		IID_IUIAutomation,
+		reinterpret_cast<void**>(automation_.Out()));
+	FlightRecorder::Instance().Record(FlightEventKind::AutomationInit, hr, 2);
+
+	if (SUCCEEDED(hr))
+	{
+		LocateDesktop();
 	}
 }
 
 /// <summary>
-/// Destructor for the AutomationService class. Cleans up UI Automation resources.
+/// Sets how long UI Automation waits to connect to a provider and for a provider to
+/// answer a request, so a hung application cannot block a call indefinitely.
 /// </summary>
-AutomationService::~AutomationService()
+/// <param name="connectionTimeoutMs">Connection timeout (the UIA default is 2 seconds).</param>
+/// <param name="transactionTimeoutMs">Per-request timeout (the UIA default is 20 seconds).</param>
+/// <returns>True if both were set; false before Windows 8.</returns>
+bool AutomationService::SetTimeouts(const DWORD connectionTimeoutMs, const DWORD transactionTimeoutMs) const
 {
-	if (desktopElement_)
+	if (!automation_)
 	{
-		desktopElement_->Release();
-		desktopElement_ = nullptr;
+		return false;
 	}
 
-	if (automation_)
+	UniqueRef<IUIAutomation2> automation2;
+	HRESULT hr = automation_->QueryInterface(IID_PPV_ARGS(automation2.Out()));
+	if (SUCCEEDED(hr))
 	{
-		automation_->Release();
-		automation_ = nullptr;
+		hr = automation2->put_ConnectionTimeout(connectionTimeoutMs);
+		if (SUCCEEDED(hr))
+		{
+			hr = automation2->put_TransactionTimeout(transactionTimeoutMs);
+		}
 	}
 
-	CoUninitialize();
+	FlightRecorder::Instance().Record(FlightEventKind::AutomationInit, hr, 4, connectionTimeoutMs, transactionTimeoutMs);
+	return SUCCEEDED(hr);
 }
 
 /// <summary>
@@ -68,10 +106,11 @@ AutomationService::~AutomationService()
 /// </summary>
 void AutomationService::LocateDesktop()
 {
-	HRESULT hr = automation_->GetRootElement(&desktopElement_);
+	HRESULT hr = automation_->GetRootElement(desktopElement_.Out());
+	FlightRecorder::Instance().Record(FlightEventKind::AutomationInit, hr, 3);
 	if (!SUCCEEDED(hr))
 	{
 		OutputDebugString(L"Could not get desktop element!");
-		desktopElement_ = nullptr;
+		desktopElement_.Reset();
 	}
 }
\ No newline at end of file
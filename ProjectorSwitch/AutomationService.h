@@ -1,25 +1,44 @@
 #pragma once
 #include <uiautomation.h>
+#include "AutomationElementWrapper.h"
 
 class AutomationService
 {
+public:
+	enum class Creation
+	{
+		Now,
+		Deferred // by a later Create call, e.g. on a worker thread
+	};
+
 private:
-	IUIAutomation* automation_;
-	IUIAutomationElement* desktopElement_;
+	HRESULT apartment_; // joining the multithreaded apartment on the constructing thread
+	UniqueRef<IUIAutomation> automation_;
+	AutomationElementWrapper desktopElement_;
 
 	void LocateDesktop();
 
 public:
-	AutomationService();
+	// Joins the multithreaded COM apartment on this thread; the destructor, which
+	// leaves it, must run on the same thread.
+	explicit AutomationService(Creation creation = Creation::Now);
 	~AutomationService();
 
+	// Creates UI Automation and locates the desktop element: the costly part (loading
+	// UIAutomationCore, a round trip to the desktop). Any thread in the multithreaded
+	// apartment may call it, as long as nothing else uses the service meanwhile.
+	void Create();
+
+	// Bounds cross-process calls (IUIAutomation2, Windows 8+); they then fail with UIA_E_TIMEOUT.
+	bool SetTimeouts(DWORD connectionTimeoutMs, DWORD transactionTimeoutMs) const;
+
 	IUIAutomation* GetAutomationInterface() const
 	{
-		return automation_;
+		return automation_.Get();
 	}
 
 	IUIAutomationElement* DesktopElement() const
 	{
-		return desktopElement_;
+		return desktopElement_.Get();
 	}
 };
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+// Little-endian fixed-width helpers shared by the binary file formats.
+namespace BinaryIo
+{
+	inline void WriteU64(std::ostream& out, const std::uint64_t value)
+	{
+		char bytes[8];
+		for (int i = 0; i < 8; ++i)
+		{
+			bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+		}
+		out.write(bytes, sizeof(bytes));
+	}
+
+	inline void WriteU32(std::ostream& out, const std::uint32_t value)
+	{
+		char bytes[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+		}
+		out.write(bytes, sizeof(bytes));
+	}
+
+	inline void WriteU16(std::ostream& out, const std::uint16_t value)
+	{
+		const char bytes[2] = { static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF) };
+		out.write(bytes, sizeof(bytes));
+	}
+
+	inline bool ReadU64(std::istream& in, std::uint64_t& value)
+	{
+		unsigned char bytes[8];
+		if (!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+		{
+			return false;
+		}
+
+		value = 0;
+		for (int i = 7; i >= 0; --i)
+		{
+			value = (value << 8) | bytes[i];
+		}
+		return true;
+	}
+
+	inline bool ReadU32(std::istream& in, std::uint32_t& value)
+	{
+		unsigned char bytes[4];
+		if (!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+		{
+			return false;
+		}
+
+		value = 0;
+		for (int i = 3; i >= 0; --i)
+		{
+			value = (value << 8) | bytes[i];
+		}
+		return true;
+	}
+
+	inline bool ReadU16(std::istream& in, std::uint16_t& value)
+	{
+		unsigned char bytes[2];
+		if (!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes)))
+		{
+			return false;
+		}
+
+		value = static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+		return true;
+	}
+}
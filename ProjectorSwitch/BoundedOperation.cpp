@@ -0,0 +1,162 @@
+#include <thread>
+#include "BoundedOperation.h"
+
+BoundedOperation::~BoundedOperation()
+{
+	// Let an abandoned run stop early; it still owns its state.
+	if (last_ != nullptr)
+	{
+		last_->Abandon.Cancel();
+	}
+
+	const bool busy = IsBusy();
+	RetireWorker();
+	if (thread_.joinable())
+	{
+		// An idle worker exits at once; one stuck in an abandoned run is left to finish it.
+		if (busy)
+		{
+			thread_.detach();
+		}
+		else
+		{
+			thread_.join();
+		}
+	}
+}
+
+/// <summary>
+/// Runs queued work until the worker is retired and its queue is empty.
+/// </summary>
+void BoundedOperation::Serve(const std::shared_ptr<Worker>& worker)
+{
+	for (;;)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(worker->Mutex);
+			worker->Wake.wait_until(lock, std::chrono::steady_clock::time_point::max(),
+				[&worker] { return !worker->Queue.empty() || worker->Retired; });
+			if (worker->Queue.empty())
+			{
+				return;
+			}
+
+			job = std::move(worker->Queue.front());
+			worker->Queue.pop_front();
+		}
+
+		job();
+	}
+}
+
+// Lets the worker exit once it is done; the next bounded run starts a new one.
+void BoundedOperation::RetireWorker()
+{
+	if (worker_ == nullptr)
+	{
+		return;
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock(worker_->Mutex);
+		worker_->Retired = true;
+	}
+	worker_->Wake.notify_all();
+	worker_.reset();
+}
+
+bool BoundedOperation::IsBusy() const
+{
+	if (last_ == nullptr)
+	{
+		return false;
+	}
+
+	const std::lock_guard<std::mutex> lock(last_->Mutex);
+	return !last_->Finished;
+}
+
+/// <summary>
+/// Runs the work and waits for it within the deadline.
+/// </summary>
+/// <param name="work">The work; it receives a token that is cancelled if the run is abandoned.</param>
+/// <param name="deadline">When to stop waiting.</param>
+/// <param name="cancel">Stops waiting when cancelled (checked every few milliseconds).</param>
+/// <returns>How the wait ended. Only for Completed may the work's results be used.</returns>
+OperationStatus BoundedOperation::Run(const Work& work, const Deadline& deadline, const CancellationToken& cancel)
+{
+	if (IsBusy())
+	{
+		return OperationStatus::Busy;
+	}
+
+	if (cancel.IsCancelled())
+	{
+		return OperationStatus::Cancelled;
+	}
+
+	if (deadline.IsNever() && !cancel.CanBeCancelled())
+	{
+		// Nothing to bound it by.
+		work(CancellationToken());
+		return OperationStatus::Completed;
+	}
+
+	if (worker_ == nullptr)
+	{
+		if (thread_.joinable())
+		{
+			thread_.detach(); // retired with an abandoned run, which has since returned
+		}
+
+		worker_ = std::make_shared<Worker>();
+		thread_ = std::thread(Serve, worker_);
+	}
+
+	auto state = std::make_shared<State>();
+	last_ = state;
+
+	{
+		const std::lock_guard<std::mutex> lock(worker_->Mutex);
+		worker_->Queue.emplace_back([state, work]
+		{
+			work(state->Abandon.Token());
+
+			const std::lock_guard<std::mutex> stateLock(state->Mutex);
+			state->Finished = true;
+			state->Done.notify_all();
+		});
+	}
+	worker_->Wake.notify_one();
+
+	std::unique_lock<std::mutex> lock(state->Mutex);
+	for (;;)
+	{
+		if (state->Finished)
+		{
+			return OperationStatus::Completed;
+		}
+
+		if (deadline.Expired())
+		{
+			state->Abandon.Cancel();
+			RetireWorker();
+			return OperationStatus::TimedOut;
+		}
+
+		if (cancel.IsCancelled())
+		{
+			state->Abandon.Cancel();
+			RetireWorker();
+			return OperationStatus::Cancelled;
+		}
+
+		auto wakeAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(CancelPollMs);
+		if (deadline.Expiry() < wakeAt)
+		{
+			wakeAt = deadline.Expiry();
+		}
+		state->Done.wait_until(lock, wakeAt);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "Deadline.h"
+
+enum class OperationStatus
+{
+	Completed,
+	TimedOut,  // the deadline passed first
+	Cancelled, // the caller's token was cancelled first
+	Busy       // an earlier, abandoned run has not finished yet
+};
+
+/// <summary>
+/// Runs work that may block for a long time (e.g. cross-process UI Automation
+/// calls into a hung application) on a worker thread, and waits only until it
+/// completes, the deadline passes or the caller cancels. The worker is started
+/// with the first bounded run and serves later runs from its queue. An abandoned
+/// run keeps going in the background on its worker, which is retired (it exits
+/// once the run returns) and replaced by a new one for the next run; the run's
+/// token is cancelled so it can stop at the next check. The work must therefore
+/// own (or share) everything it touches and report its results through shared
+/// state. A new run is refused while an abandoned one is still going, so hung
+/// calls do not pile up.
+/// Portable (no Windows dependencies).
+/// </summary>
+class BoundedOperation  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+	using Work = std::function<void(const CancellationToken&)>;
+
+	BoundedOperation() = default;
+	~BoundedOperation();
+
+	// Runs inline, without a worker, if the deadline is Never and the token cannot be cancelled.
+	OperationStatus Run(const Work& work, const Deadline& deadline, const CancellationToken& cancel = CancellationToken());
+
+	// True while an abandoned run is still going.
+	bool IsBusy() const;
+
+private:
+	struct Worker
+	{
+		std::mutex Mutex;
+		std::condition_variable Wake;
+		std::deque<std::function<void()>> Queue;
+		bool Retired = false;
+	};
+
+	struct State
+	{
+		std::mutex Mutex;
+		std::condition_variable Done;
+		bool Finished = false;
+		CancellationSource Abandon;
+	};
+
+	static constexpr int CancelPollMs = 10;
+
+	std::shared_ptr<Worker> worker_;
+	std::thread thread_;
+	std::shared_ptr<State> last_;
+
+	static void Serve(const std::shared_ptr<Worker>& worker);
+	void RetireWorker();
+};
@@ -0,0 +1,98 @@
+#include "CallCounters.h"
+
+namespace
+{
+	const wchar_t* const CategoryNames[CallCounts::CategoryCount] =
+	{
+		L"UiaFind",
+		L"UiaPropertyRead",
+		L"SetWindowPos",
+		L"SetLayeredWindowAttributes",
+		L"DwmSetWindowAttribute",
+		L"GetWindowPlacement",
+		L"ProcessSnapshot",
+		L"IniFileAccess",
+		L"SetWindowPlacement",
+		L"ShowWindow",
+		L"SetWindowLong",
+		L"SetForegroundWindow",
+		L"RedrawWindow",
+	};
+}
+
+const wchar_t* CallCounts::CategoryName(const CallCategory category)
+{
+	const auto index = static_cast<size_t>(category);
+	return index < static_cast<size_t>(CategoryCount) ? CategoryNames[index] : L"Unknown";
+}
+
+std::uint32_t CallCounts::Total() const
+{
+	std::uint32_t total = 0;
+	for (const auto v : Values)
+	{
+		total += v;
+	}
+	return total;
+}
+
+bool CallCounts::Exceeds(const CallCounts& budget) const
+{
+	for (size_t i = 0; i < Values.size(); ++i)
+	{
+		if (Values[i] > budget.Values[i])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/// <summary>
+/// Formats the non-zero counts as "Name=count" pairs.
+/// </summary>
+std::wstring CallCounts::Format() const
+{
+	std::wstring result;
+	for (int i = 0; i < CategoryCount; ++i)
+	{
+		if (Values[static_cast<size_t>(i)] == 0)
+		{
+			continue;
+		}
+
+		if (!result.empty())
+		{
+			result += L' ';
+		}
+
+		result += CategoryNames[i];
+		result += L'=';
+		result += std::to_wstring(Values[static_cast<size_t>(i)]);
+	}
+
+	return result.empty() ? L"(none)" : result;
+}
+
+/// <summary>
+/// Per-toggle budget. The fade issues one SetLayeredWindowAttributes per ~10 ms
+/// frame over 300 ms, plus the initial and final alpha.
+/// </summary>
+CallCounts CallCounts::DefaultToggleBudget()
+{
+	CallCounts budget;
+	budget[CallCategory::UiaFind] = 11;                    // FindAll + one FindFirst per candidate
+	budget[CallCategory::UiaPropertyRead] = 2;             // native handle + bounding rect
+	budget[CallCategory::SetWindowPos] = 4;                // move, corrective resize, raise to the top (twice)
+	budget[CallCategory::SetLayeredWindowAttributes] = 40;
+	budget[CallCategory::DwmSetWindowAttribute] = 4;       // transitions off/on, cloak/uncloak
+	budget[CallCategory::GetWindowPlacement] = 1;
+	budget[CallCategory::ProcessSnapshot] = 1;
+	budget[CallCategory::IniFileAccess] = 5;               // selected monitor rect + toggle mode
+	budget[CallCategory::SetWindowPlacement] = 1;
+	budget[CallCategory::ShowWindow] = 3;                  // restore, hide (if not cloaked), show
+	budget[CallCategory::SetWindowLong] = 2;               // layered style on and off
+	budget[CallCategory::SetForegroundWindow] = 1;
+	budget[CallCategory::RedrawWindow] = 1;
+	return budget;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Categories of cross-process / window-manager calls made during a toggle.
+enum class CallCategory : std::uint8_t
+{
+	UiaFind,
+	UiaPropertyRead,
+	SetWindowPos,
+	SetLayeredWindowAttributes,
+	DwmSetWindowAttribute,
+	GetWindowPlacement,
+	ProcessSnapshot,
+	IniFileAccess,
+	SetWindowPlacement,
+	ShowWindow,                 // ShowWindow and ShowWindowAsync
+	SetWindowLong,              // window style changes
+	SetForegroundWindow,
+	RedrawWindow,
+	Count
+};
+
+struct CallCounts
+{
+	static constexpr int CategoryCount = static_cast<int>(CallCategory::Count);
+
+	std::array<std::uint32_t, CategoryCount> Values{};
+
+	std::uint32_t& operator[](const CallCategory category) { return Values[static_cast<size_t>(category)]; }
+	std::uint32_t operator[](const CallCategory category) const { return Values[static_cast<size_t>(category)]; }
+
+	std::uint32_t Total() const;
+
+	// True if any category exceeds the corresponding budget entry.
+	bool Exceeds(const CallCounts& budget) const;
+
+	std::wstring Format() const;
+
+	static const wchar_t* CategoryName(CallCategory category);
+
+	// Upper bounds for a single toggle (display or send back), with up to 10 Zoom candidates.
+	static CallCounts DefaultToggleBudget();
+};
+
+/// <summary>
+/// Installs a CallCounts sink for the current thread for the lifetime of the
+/// scope (scopes nest). Count() is a no-op when no scope is active.
+/// Portable (no Windows dependencies).
+/// </summary>
+class CallCountScope  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	static inline thread_local CallCounts* current_ = nullptr;
+	CallCounts* previous_;
+
+public:
+	explicit CallCountScope(CallCounts& counts)
+		: previous_(current_)
+	{
+		current_ = &counts;
+	}
+
+	~CallCountScope()
+	{
+		current_ = previous_;
+	}
+
+	static void Count(const CallCategory category, const std::uint32_t times = 1)
+	{
+		if (current_ != nullptr)
+		{
+			(*current_)[category] += times;
+		}
+	}
+
+	// Attributes calls counted elsewhere (e.g. on a worker thread) to the current scope.
+	static void Add(const CallCounts& counts)
+	{
+		if (current_ != nullptr)
+		{
+			for (size_t i = 0; i < counts.Values.size(); ++i)
+			{
+				current_->Values[i] += counts.Values[i];
+			}
+		}
+	}
+};
@@ -0,0 +1,45 @@
+#include <windows.h>
+#include <dwmapi.h>
+#include "CompositionClock.h"
+
+std::int64_t CompositionClock::Now()
+{
+	LARGE_INTEGER now{};
+	QueryPerformanceCounter(&now);
+	return now.QuadPart;
+}
+
+std::int64_t CompositionClock::Frequency()
+{
+	static const std::int64_t frequency = []
+	{
+		LARGE_INTEGER value{};
+		QueryPerformanceFrequency(&value);
+		return value.QuadPart;
+	}();
+
+	return frequency;
+}
+
+std::int64_t CompositionClock::MessageTime()
+{
+	const auto messageTime = static_cast<std::uint32_t>(GetMessageTime());
+	return PresentTiming::MessageTimeToQpc(messageTime, GetTickCount(), Now(), Frequency());
+}
+
+bool CompositionClock::Sample(CompositionSample& sample)
+{
+	DWM_TIMING_INFO info{};
+	info.cbSize = sizeof(info);
+
+	// The window must be null (composition timing is global) on Windows 8.1 and later.
+	if (FAILED(DwmGetCompositionTimingInfo(nullptr, &info)))
+	{
+		return false;
+	}
+
+	sample.VBlankQpc = static_cast<std::int64_t>(info.qpcVBlank);
+	sample.RefreshPeriodQpc = static_cast<std::int64_t>(info.qpcRefreshPeriod);
+	sample.ComposeQpc = static_cast<std::int64_t>(info.qpcCompose);
+	return sample.RefreshPeriodQpc > 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include "PresentTiming.h"
+
+/// <summary>
+/// The QueryPerformanceCounter clock that DWM reports its frame timing in, for
+/// stamping toggle events so they can be correlated with presentation.
+/// </summary>
+class CompositionClock
+{
+public:
+	static std::int64_t Now();
+	static std::int64_t Frequency();
+
+	// When the message being handled was generated (e.g. the click behind a BN_CLICKED),
+	// to GetMessageTime's resolution (the system timer tick).
+	static std::int64_t MessageTime();
+
+	// The desktop compositor's current frame timing; false if it is unavailable.
+	static bool Sample(CompositionSample& sample);
+};
@@ -0,0 +1,119 @@
+#include "CountedAutomation.h"
+
+CountedObject::CountedObject(std::int64_t& live)
+	: live_(live)
+	, refs_(1)
+{
+	++live_;
+}
+
+CountedObject::~CountedObject()
+{
+	--live_;
+}
+
+std::uint32_t CountedObject::AddRef()
+{
+	return ++refs_;
+}
+
+std::uint32_t CountedObject::Release()
+{
+	const std::uint32_t refs = --refs_;
+	if (refs == 0)
+	{
+		delete this;
+	}
+	return refs;
+}
+
+CountedElementArray::CountedElementArray(std::int64_t& live, const std::vector<int>& indices)
+	: CountedObject(live)
+{
+	elements_.reserve(indices.size());
+	for (const int index : indices)
+	{
+		elements_.push_back(new CountedElement(live, index));
+	}
+}
+
+CountedElementArray::~CountedElementArray()
+{
+	for (CountedElement* element : elements_)
+	{
+		element->Release();
+	}
+}
+
+CountedDiscoveryBackend::CountedDiscoveryBackend(DesktopModel& model, std::int64_t& live, CountedElement* root)
+	: model_(model)
+	, live_(live)
+	, root_(root)
+{
+}
+
+int CountedDiscoveryBackend::FindCandidates(const MediaWindowSelectors& selectors)
+{
+	candidates_.Reset();
+
+	if (root_ == nullptr)
+	{
+		return -1;
+	}
+
+	// Temporary conditions, as built for each search.
+	const UniqueRef<CountedObject> nameCondition(new CountedObject(live_));
+	const UniqueRef<CountedObject> classCondition(new CountedObject(live_));
+	const UniqueRef<CountedObject> andCondition(new CountedObject(live_));
+
+	const int count = model_.FindCandidates(selectors);
+	if (count >= 0)
+	{
+		std::vector<int> indices;
+		indices.reserve(static_cast<size_t>(count));
+		for (int i = 0; i < count; ++i)
+		{
+			indices.push_back(model_.CandidateElement(i));
+		}
+		candidates_.Reset(new CountedElementArray(live_, indices));
+	}
+
+	return count;
+}
+
+int CountedDiscoveryBackend::CandidateHasMainWindowMarker(const int candidateIndex, const MediaWindowSelectors& selectors)
+{
+	if (!candidates_)
+	{
+		return -1;
+	}
+
+	if (candidateIndex < 0 || candidateIndex >= candidates_->Length())
+	{
+		return CandidateUnavailable;
+	}
+
+	if (!markerCondition_)
+	{
+		markerCondition_.Reset(new CountedObject(live_));
+	}
+
+	const int found = model_.CandidateHasMainWindowMarker(candidateIndex, selectors);
+	if (found == 1)
+	{
+		// FindFirst returns the marker element, which is only checked for null.
+		const UniqueRef<CountedElement> marker(new CountedElement(live_, -1));
+	}
+
+	return found;
+}
+
+UniqueRef<CountedElement> CountedDiscoveryBackend::DetachCandidate(const int candidateIndex) const
+{
+	if (!candidates_ || candidateIndex < 0 || candidateIndex >= candidates_->Length())
+	{
+		return UniqueRef<CountedElement>();
+	}
+
+	return UniqueRef<CountedElement>::Share(candidates_->GetElement(candidateIndex));
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "DesktopModel.h"
+#include "DiscoveryBackend.h"
+#include "UniqueRef.h"
+
+/// <summary>
+/// Stand-in for a COM object: reference counted (AddRef/Release), deleted on the
+/// last Release, and counted while alive so leaks and over-releases show up.
+/// Portable (no Windows dependencies).
+/// </summary>
+class CountedObject  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	std::int64_t& live_;
+	std::uint32_t refs_;
+
+protected:
+	virtual ~CountedObject();
+
+public:
+	explicit CountedObject(std::int64_t& live);
+
+	std::uint32_t AddRef();
+	std::uint32_t Release();
+};
+
+struct CountedElement : CountedObject
+{
+	int Index;
+
+	CountedElement(std::int64_t& live, const int index)
+		: CountedObject(live)
+		, Index(index)
+	{
+	}
+};
+
+// Holds one reference to each element, like IUIAutomationElementArray.
+class CountedElementArray : public CountedObject  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	std::vector<CountedElement*> elements_;
+
+protected:
+	~CountedElementArray() override;
+
+public:
+	CountedElementArray(std::int64_t& live, const std::vector<int>& indices);
+
+	int Length() const { return static_cast<int>(elements_.size()); }
+	CountedElement* GetElement(int index) const { return elements_[static_cast<size_t>(index)]; } // not AddRef'd
+};
+
+/// <summary>
+/// DiscoveryBackend over a DesktopModel that hands out counted objects with the
+/// same ownership as UiaDiscoveryBackend: the root is borrowed, the candidate array
+/// is held until the next search, the marker condition is cached, elements found
+/// while probing are released at once and DetachCandidate returns an AddRef'd
+/// element. Used by the soak benchmark to account for object lifetimes.
+/// </summary>
+class CountedDiscoveryBackend : public DiscoveryBackend
+{
+private:
+	DesktopModel& model_;
+	std::int64_t& live_;
+	CountedElement* root_;
+	UniqueRef<CountedElementArray> candidates_;
+	UniqueRef<CountedObject> markerCondition_;
+
+public:
+	CountedDiscoveryBackend(DesktopModel& model, std::int64_t& live, CountedElement* root);
+
+	int FindCandidates(const MediaWindowSelectors& selectors) override;
+	int CandidateHasMainWindowMarker(int candidateIndex, const MediaWindowSelectors& selectors) override;
+
+	// Returns a new reference to the candidate element (empty if unavailable).
+	UniqueRef<CountedElement> DetachCandidate(int candidateIndex) const;
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/// <summary>
+/// A point in time after which an operation should give up (no platform dependencies).
+/// </summary>
+class Deadline
+{
+private:
+	std::chrono::steady_clock::time_point expiry_;
+	bool never_;
+
+	Deadline(const std::chrono::steady_clock::time_point expiry, const bool never)
+		: expiry_(expiry)
+		, never_(never)
+	{
+	}
+
+public:
+	static Deadline Never()
+	{
+		return Deadline(std::chrono::steady_clock::time_point::max(), true);
+	}
+
+	// A deadline timeoutMs from now; 0 or less means no deadline.
+	static Deadline FromNow(const std::int64_t timeoutMs)
+	{
+		if (timeoutMs <= 0)
+		{
+			return Never();
+		}
+		return Deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs), false);
+	}
+
+	bool IsNever() const { return never_; }
+	bool Expired() const { return !never_ && std::chrono::steady_clock::now() >= expiry_; }
+	std::chrono::steady_clock::time_point Expiry() const { return expiry_; }
+
+	// Milliseconds left (0 once expired; INT64_MAX for no deadline).
+	std::int64_t RemainingMilliseconds() const
+	{
+		if (never_)
+		{
+			return INT64_MAX;
+		}
+
+		const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(expiry_ - std::chrono::steady_clock::now()).count();
+		return remaining > 0 ? remaining : 0;
+	}
+};
+
+/// <summary>
+/// Read side of a cancellation flag. A default-constructed token is never cancelled.
+/// Copies share the flag, so a token can be handed to another thread.
+/// </summary>
+class CancellationToken
+{
+private:
+	std::shared_ptr<const std::atomic<bool>> flag_;
+
+	friend class CancellationSource;
+
+	explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> flag)
+		: flag_(std::move(flag))
+	{
+	}
+
+public:
+	CancellationToken() = default;
+
+	bool IsCancelled() const { return flag_ != nullptr && flag_->load(std::memory_order_acquire); }
+	bool CanBeCancelled() const { return flag_ != nullptr; }
+};
+
+/// <summary>
+/// Write side of a cancellation flag. Cancel() may be called from any thread.
+/// </summary>
+class CancellationSource
+{
+private:
+	std::shared_ptr<std::atomic<bool>> flag_;
+
+public:
+	CancellationSource()
+		: flag_(std::make_shared<std::atomic<bool>>(false))
+	{
+	}
+
+	void Cancel() { flag_->store(true, std::memory_order_release); }
+	bool IsCancelled() const { return flag_->load(std::memory_order_acquire); }
+	CancellationToken Token() const { return CancellationToken(flag_); }
+};
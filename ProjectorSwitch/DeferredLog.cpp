@@ -0,0 +1,425 @@
+#include <chrono>
+#include <cwchar>
+#include <utility>
+#include "DeferredLog.h"
+
+namespace
+{
+	// Once woken, the background thread lets the rest of the burst arrive before it
+	// drains, rather than competing with the writer for the CPU message by message
+	// (and having each message wake it again).
+	constexpr std::chrono::milliseconds GatherDelay{ 1 };
+
+	bool IsOneOf(const wchar_t c, const wchar_t* set)
+	{
+		return c != L'\0' && std::wcschr(set, c) != nullptr;
+	}
+
+	void AppendText(std::wstring& out, const wchar_t* text, size_t length, const bool leftAlign, const int width, const int precision)
+	{
+		if (precision >= 0 && static_cast<size_t>(precision) < length)
+		{
+			length = static_cast<size_t>(precision);
+		}
+
+		const size_t padding = width > 0 && static_cast<size_t>(width) > length ? static_cast<size_t>(width) - length : 0;
+		if (!leftAlign)
+		{
+			out.append(padding, L' ');
+		}
+		out.append(text, length);
+		if (leftAlign)
+		{
+			out.append(padding, L' ');
+		}
+	}
+
+	// The argument as an unsigned value of its original width (so %x of -1 as an int is ffffffff).
+	unsigned long long AsUnsigned(const DeferredLogArg& arg)
+	{
+		const std::uint64_t value = arg.Type == DeferredLogArg::Kind::Double ? static_cast<std::uint64_t>(arg.Double) : arg.Unsigned;
+		return arg.Size >= 8 ? value : value & ((std::uint64_t{ 1 } << (8 * arg.Size)) - 1);
+	}
+
+	long long AsSigned(const DeferredLogArg& arg)
+	{
+		if (arg.Type == DeferredLogArg::Kind::Double)
+		{
+			return static_cast<long long>(arg.Double);
+		}
+		return arg.Type == DeferredLogArg::Kind::Unsigned ? static_cast<long long>(arg.Unsigned) : arg.Signed;
+	}
+
+	double AsDouble(const DeferredLogArg& arg)
+	{
+		switch (arg.Type)
+		{
+		case DeferredLogArg::Kind::Double: return arg.Double;
+		case DeferredLogArg::Kind::Signed: return static_cast<double>(arg.Signed);
+		case DeferredLogArg::Kind::Unsigned: return static_cast<double>(arg.Unsigned);
+		default: return 0.0;
+		}
+	}
+}
+
+DeferredLog::DeferredLog()
+{
+	for (std::uint64_t i = 0; i < Capacity; ++i)
+	{
+		slots_[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+DeferredLog::~DeferredLog()
+{
+	Stop();
+}
+
+DeferredLog& DeferredLog::Instance()
+{
+	static DeferredLog log;
+	return log;
+}
+
+void DeferredLog::Start(Sink sink)
+{
+	if (thread_.joinable())
+	{
+		return;
+	}
+
+	sink_ = std::move(sink);
+	woken_ = false;
+	stopping_ = false;
+	thread_ = std::thread([this] { Run(); });
+}
+
+void DeferredLog::Stop()
+{
+	if (!thread_.joinable())
+	{
+		return;
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock(wakeMutex_);
+		stopping_ = true;
+	}
+	wakeCondition_.notify_one();
+	thread_.join();
+}
+
+/// <summary>
+/// Claims the next free slot (a bounded multi-producer queue: one compare-exchange on
+/// the enqueue position). Returns null, counting a dropped message, if the queue is full.
+/// </summary>
+DeferredLog::Slot* DeferredLog::Claim()
+{
+	std::uint64_t position = enqueuePos_.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Slot& slot = slots_[position & (Capacity - 1)];
+		const std::uint64_t sequence = slot.Sequence.load(std::memory_order_acquire);
+		if (sequence == position)
+		{
+			if (enqueuePos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				return &slot;
+			}
+		}
+		else if (sequence < position)
+		{
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		else
+		{
+			position = enqueuePos_.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+/// <summary>
+/// Makes the message visible to the background thread, waking it if it is asleep.
+/// The fence pairs with the one in Run: either this writer sees parked_ set, or the
+/// background thread sees the message before it waits.
+/// </summary>
+void DeferredLog::Publish(Slot* slot)
+{
+	const std::uint64_t position = slot->Sequence.load(std::memory_order_relaxed);
+	slot->Sequence.store(position + 1, std::memory_order_release);
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (parked_.load(std::memory_order_relaxed))
+	{
+		Wake();
+	}
+}
+
+/// <summary>
+/// Wakes the background thread. Of the writers that find it parked, only the first
+/// (which clears the flag) signals it.
+/// </summary>
+void DeferredLog::Wake()
+{
+	if (!parked_.exchange(false, std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock(wakeMutex_);
+		woken_ = true;
+	}
+	wakeCondition_.notify_one();
+}
+
+bool DeferredLog::HasPublished() const
+{
+	return slots_[dequeuePos_ & (Capacity - 1)].Sequence.load(std::memory_order_acquire) == dequeuePos_ + 1;
+}
+
+/// <summary>
+/// Formats and writes out every published message; false if there were none.
+/// </summary>
+bool DeferredLog::Drain()
+{
+	bool any = false;
+	for (;;)
+	{
+		Slot& slot = slots_[dequeuePos_ & (Capacity - 1)];
+		if (slot.Sequence.load(std::memory_order_acquire) != dequeuePos_ + 1)
+		{
+			return any;
+		}
+
+		const std::wstring message = Format(slot.Record);
+		const DeferredLogLevel level = slot.Record.Level;
+		slot.Sequence.store(dequeuePos_ + Capacity, std::memory_order_release);
+		++dequeuePos_;
+		any = true;
+
+		if (sink_)
+		{
+			sink_(level, message);
+		}
+	}
+}
+
+void DeferredLog::Run()
+{
+	std::uint64_t reportedDrops = 0;
+	for (;;)
+	{
+		Drain();
+
+		const std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+		if (dropped != reportedDrops && sink_)
+		{
+			sink_(DeferredLogLevel::Warn, L"Log queue full: " + std::to_wstring(dropped - reportedDrops) + L" message(s) dropped");
+			reportedDrops = dropped;
+		}
+
+		// Park, then look again: a message published before the writer could see the
+		// flag is picked up here rather than waiting for the next one.
+		parked_.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (HasPublished())
+		{
+			parked_.store(false, std::memory_order_relaxed);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wakeMutex_);
+		wakeCondition_.wait_until(lock, std::chrono::steady_clock::time_point::max(), [this] { return woken_ || stopping_; });
+		woken_ = false;
+		wakeups_.fetch_add(1, std::memory_order_relaxed);
+		if (stopping_)
+		{
+			lock.unlock();
+			parked_.store(false, std::memory_order_relaxed);
+			Drain();
+			return;
+		}
+
+		lock.unlock();
+		std::this_thread::sleep_for(GatherDelay);
+	}
+}
+
+void DeferredLog::CaptureText(DeferredLogRecord& record, const wchar_t* text)
+{
+	DeferredLogArg& arg = record.Args[record.ArgCount++];
+	arg.Type = DeferredLogArg::Kind::Text;
+	arg.Size = 0;
+	arg.Unsigned = 0;
+	arg.TextOffset = record.TextUsed;
+
+	std::uint16_t length = 0;
+	if (text == nullptr)
+	{
+		text = L"(null)";
+	}
+	while (text[length] != L'\0' && record.TextUsed < DeferredLogRecord::TextCapacity)
+	{
+		record.Text[record.TextUsed++] = text[length++];
+	}
+	arg.TextLength = length;
+}
+
+void DeferredLog::CaptureText(DeferredLogRecord& record, const char* text)
+{
+	DeferredLogArg& arg = record.Args[record.ArgCount++];
+	arg.Type = DeferredLogArg::Kind::Text;
+	arg.Size = 0;
+	arg.Unsigned = 0;
+	arg.TextOffset = record.TextUsed;
+
+	// Narrow arguments are ASCII in this code base (reasons, exception texts).
+	std::uint16_t length = 0;
+	if (text == nullptr)
+	{
+		text = "(null)";
+	}
+	while (text[length] != '\0' && record.TextUsed < DeferredLogRecord::TextCapacity)
+	{
+		record.Text[record.TextUsed++] = static_cast<wchar_t>(static_cast<unsigned char>(text[length++]));
+	}
+	arg.TextLength = length;
+}
+
+/// <summary>
+/// Interprets the format like printf: flags, width, precision and length modifiers
+/// (including MSVC's I64) are accepted, and each conversion is formatted with
+/// swprintf using the argument's captured type. %s, %ls and %hs all take a string
+/// argument; a conversion without an argument is left as written.
+/// </summary>
+std::wstring DeferredLog::Format(const DeferredLogRecord& record)
+{
+	std::wstring out;
+	if (record.Format == nullptr)
+	{
+		return out;
+	}
+
+	int nextArg = 0;
+	const wchar_t* p = record.Format;
+	while (*p != L'\0')
+	{
+		if (*p != L'%')
+		{
+			out.push_back(*p++);
+			continue;
+		}
+
+		const wchar_t* start = p++;
+		if (*p == L'%')
+		{
+			out.push_back(L'%');
+			++p;
+			continue;
+		}
+
+		std::wstring flags;
+		while (IsOneOf(*p, L"-+ #0"))
+		{
+			flags.push_back(*p++);
+		}
+
+		int width = 0;
+		while (*p >= L'0' && *p <= L'9')
+		{
+			width = width * 10 + (*p++ - L'0');
+		}
+
+		int precision = -1;
+		if (*p == L'.')
+		{
+			++p;
+			precision = 0;
+			while (*p >= L'0' && *p <= L'9')
+			{
+				precision = precision * 10 + (*p++ - L'0');
+			}
+		}
+
+		// Length modifiers are dropped: the captured type decides.
+		while (IsOneOf(*p, L"hljztLI") || ((*p == L'6' || *p == L'3') && (p[1] == L'4' || p[1] == L'2')))
+		{
+			p += (*p == L'6' || *p == L'3') ? 2 : 1;
+		}
+
+		const wchar_t conversion = *p;
+		if (conversion == L'\0' || nextArg >= record.ArgCount)
+		{
+			// Malformed, or more conversions than arguments.
+			out.append(start, conversion == L'\0' ? p : p + 1);
+			p = conversion == L'\0' ? p : p + 1;
+			continue;
+		}
+		++p;
+
+		const DeferredLogArg& arg = record.Args[nextArg++];
+		std::wstring spec = L"%" + flags;
+		if (width > 0)
+		{
+			spec += std::to_wstring(width);
+		}
+		if (precision >= 0)
+		{
+			spec += L"." + std::to_wstring(precision);
+		}
+
+		wchar_t buffer[128];
+		int written = -1;
+		if (conversion == L's' || conversion == L'S')
+		{
+			if (arg.Type == DeferredLogArg::Kind::Text)
+			{
+				AppendText(out, record.Text + arg.TextOffset, arg.TextLength, flags.find(L'-') != std::wstring::npos, width, precision);
+			}
+			else
+			{
+				out.append(start, p);
+			}
+			continue;
+		}
+		else if (conversion == L'c' || conversion == L'C')
+		{
+			const wchar_t c = static_cast<wchar_t>(AsUnsigned(arg));
+			AppendText(out, &c, 1, flags.find(L'-') != std::wstring::npos, width, -1);
+			continue;
+		}
+		else if (IsOneOf(conversion, L"di"))
+		{
+			spec += L"lld";
+			written = std::swprintf(buffer, 128, spec.c_str(), AsSigned(arg));
+		}
+		else if (IsOneOf(conversion, L"uxXo"))
+		{
+			spec += L"ll";
+			spec.push_back(conversion);
+			written = std::swprintf(buffer, 128, spec.c_str(), AsUnsigned(arg));
+		}
+		else if (IsOneOf(conversion, L"fFeEgGaA"))
+		{
+			spec.push_back(conversion);
+			written = std::swprintf(buffer, 128, spec.c_str(), AsDouble(arg));
+		}
+		else if (conversion == L'p')
+		{
+			written = std::swprintf(buffer, 128, L"%p", arg.Type == DeferredLogArg::Kind::Pointer ? arg.Pointer : nullptr);
+		}
+
+		if (written >= 0)
+		{
+			out.append(buffer, static_cast<size_t>(written));
+		}
+		else
+		{
+			out.append(start, p);
+		}
+	}
+
+	return out;
+}
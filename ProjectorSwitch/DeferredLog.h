@@ -0,0 +1,208 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+enum class DeferredLogLevel : std::uint8_t
+{
+	Debug,
+	Info,
+	Warn,
+	Error
+};
+
+// One captured argument: its value as given, not yet formatted.
+struct DeferredLogArg
+{
+	enum class Kind : std::uint8_t
+	{
+		Signed,
+		Unsigned,
+		Double,
+		Pointer,
+		Text // copied into the record's text buffer
+	};
+
+	Kind Type;
+	std::uint8_t Size; // bytes in the original integer (for %u/%x of negative values)
+	std::uint16_t TextOffset;
+	std::uint16_t TextLength;
+	union
+	{
+		std::int64_t Signed;
+		std::uint64_t Unsigned;
+		double Double;
+		const void* Pointer;
+	};
+};
+
+struct DeferredLogRecord
+{
+	static constexpr int MaxArgs = 8;
+	static constexpr int TextCapacity = 192; // shared by all string arguments; longer ones are cut
+
+	DeferredLogLevel Level;
+	std::uint8_t ArgCount;
+	std::uint16_t TextUsed;
+	const wchar_t* Format; // must be a string literal
+	DeferredLogArg Args[MaxArgs];
+	wchar_t Text[TextCapacity];
+};
+
+/// <summary>
+/// Logging front end for hot paths. A call captures the format pointer and the raw
+/// argument values (strings are copied) into a slot of a bounded lock-free queue;
+/// formatting and the hand-off to the sink (the application log) happen on a
+/// background thread. That thread sleeps while the queue is empty, without timeouts,
+/// and only the message that finds it asleep wakes it (one system call per burst).
+/// Messages are dropped, and counted, if the queue is full.
+/// Portable (no Windows dependencies).
+/// </summary>
+class DeferredLog  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+	using Sink = std::function<void(DeferredLogLevel level, const std::wstring& message)>;
+
+	static constexpr std::uint64_t Capacity = 256; // power of two
+
+	DeferredLog();
+	~DeferredLog();
+
+	static DeferredLog& Instance();
+
+	// Starts the background thread; messages written before this wait in the queue.
+	void Start(Sink sink);
+
+	// Writes out everything queued, then stops the background thread.
+	void Stop();
+
+	template <typename... Args>
+	void Write(const DeferredLogLevel level, const wchar_t* format, const Args&... args)
+	{
+		static_assert(sizeof...(Args) <= DeferredLogRecord::MaxArgs, "too many log arguments");
+
+		Slot* slot = Claim();
+		if (slot == nullptr)
+		{
+			return;
+		}
+
+		DeferredLogRecord& record = slot->Record;
+		record.Level = level;
+		record.Format = format;
+		record.ArgCount = 0;
+		record.TextUsed = 0;
+		(Capture(record, args), ...);
+		Publish(slot);
+	}
+
+	std::uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+	// How many times the background thread has been woken (by a writer or Stop).
+	std::uint64_t Wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+
+	// Expands the record's printf-style format with its captured arguments.
+	static std::wstring Format(const DeferredLogRecord& record);
+
+private:
+	struct Slot
+	{
+		std::atomic<std::uint64_t> Sequence{ 0 }; // position when free, position + 1 once published
+		DeferredLogRecord Record;
+	};
+
+	Slot slots_[Capacity];
+	std::atomic<std::uint64_t> enqueuePos_{ 0 };
+	std::uint64_t dequeuePos_ = 0; // background thread only
+	std::atomic<std::uint64_t> dropped_{ 0 };
+	std::atomic<bool> parked_{ false }; // the background thread found the queue empty and is (about to be) waiting
+	std::atomic<std::uint64_t> wakeups_{ 0 };
+	std::mutex wakeMutex_;
+	std::condition_variable wakeCondition_;
+	bool woken_ = false;
+	bool stopping_ = false;
+	std::thread thread_;
+	Sink sink_;
+
+	Slot* Claim();
+	void Publish(Slot* slot);
+	bool Drain();
+	bool HasPublished() const;
+	void Wake();
+	void Run();
+
+	static void CaptureText(DeferredLogRecord& record, const wchar_t* text);
+	static void CaptureText(DeferredLogRecord& record, const char* text);
+
+	template <typename T>
+	static void Capture(DeferredLogRecord& record, const T& value)
+	{
+		using V = std::decay_t<T>;
+		if constexpr (std::is_same_v<V, wchar_t*> || std::is_same_v<V, const wchar_t*> ||
+			std::is_same_v<V, char*> || std::is_same_v<V, const char*>)
+		{
+			CaptureText(record, value);
+		}
+		else
+		{
+			DeferredLogArg& arg = record.Args[record.ArgCount++];
+			arg.Size = static_cast<std::uint8_t>(sizeof(V));
+			if constexpr (std::is_floating_point_v<V>)
+			{
+				arg.Type = DeferredLogArg::Kind::Double;
+				arg.Double = static_cast<double>(value);
+			}
+			else if constexpr (std::is_pointer_v<V>)
+			{
+				arg.Type = DeferredLogArg::Kind::Pointer;
+				arg.Pointer = value;
+			}
+			else if constexpr (std::is_signed_v<V>)
+			{
+				arg.Type = DeferredLogArg::Kind::Signed;
+				arg.Signed = static_cast<std::int64_t>(value);
+			}
+			else
+			{
+				static_assert(std::is_integral_v<V>, "unsupported log argument type");
+				arg.Type = DeferredLogArg::Kind::Unsigned;
+				arg.Unsigned = static_cast<std::uint64_t>(value);
+			}
+		}
+	}
+};
+
+// Levels below PROJECTORSWITCH_LOG_LEVEL (0 = debug ... 3 = error) compile to nothing,
+// arguments included. Debug builds keep everything; release builds drop debug.
+#if !defined(PROJECTORSWITCH_LOG_LEVEL)
+#if defined(_DEBUG)
+#define PROJECTORSWITCH_LOG_LEVEL 0
+#else
+#define PROJECTORSWITCH_LOG_LEVEL 1
+#endif
+#endif
+
+#if PROJECTORSWITCH_LOG_LEVEL <= 0
+#define DLOG_DEBUG(...) DeferredLog::Instance().Write(DeferredLogLevel::Debug, __VA_ARGS__)
+#else
+#define DLOG_DEBUG(...) ((void)0)
+#endif
+
+#if PROJECTORSWITCH_LOG_LEVEL <= 1
+#define DLOG_INFO(...) DeferredLog::Instance().Write(DeferredLogLevel::Info, __VA_ARGS__)
+#else
+#define DLOG_INFO(...) ((void)0)
+#endif
+
+#if PROJECTORSWITCH_LOG_LEVEL <= 2
+#define DLOG_WARN(...) DeferredLog::Instance().Write(DeferredLogLevel::Warn, __VA_ARGS__)
+#else
+#define DLOG_WARN(...) ((void)0)
+#endif
+
+#define DLOG_ERROR(...) DeferredLog::Instance().Write(DeferredLogLevel::Error, __VA_ARGS__)
@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include "DesktopModel.h"
+#include "CallCounters.h"
+#include "TreeSnapshot.h"
+
+namespace
+{
+	constexpr std::uint32_t ZoomProcessId = 4242;
+
+	/// <summary>
+	/// Adds a tree of the given depth and fanout beneath parent.
+	/// </summary>
+	void AddSubtree(DesktopModel& model, const int parent, const int depth, const int fanout,
+		const std::uint32_t processId, int& counter)
+	{
+		if (depth <= 0)
+		{
+			return;
+		}
+
+		for (int i = 0; i < fanout; ++i)
+		{
+			++counter;
+			const std::wstring helpText = L"{\"controlID\":\"ctl_" + std::to_wstring(counter) + L"\",\"isEnabled\":true}";
+			const int child = model.AddElement(parent, L"Element " + std::to_wstring(counter), L"ZoomElementClass", helpText, processId);
+			AddSubtree(model, child, depth - 1, fanout, processId, counter);
+		}
+	}
+
+	/// <summary>
+	/// Returns the deepest, last-added descendant of element (the worst case for a
+	/// depth-first FindFirst).
+	/// </summary>
+	int LastLeaf(const DesktopModel& model, int element)
+	{
+		while (!model.Element(element).Children.empty())
+		{
+			element = model.Element(element).Children.back();
+		}
+		return element;
+	}
+}
+
+DesktopModel::DesktopModel()
+	: callLatencyUs_(0)
+	, elementLatencyNs_(0)
+	, findCalls_(0)
+	, elementsVisited_(0)
+	, expectedMediaWindow_(-1)
+{
+	elements_.push_back(DesktopElement{ L"Desktop", L"#32769", L"", 0, -1, {} });
+}
+
+int DesktopModel::AddElement(const int parent, const std::wstring& name, const std::wstring& className,
+	const std::wstring& helpText, const std::uint32_t processId)
+{
+	const int index = static_cast<int>(elements_.size());
+	elements_.push_back(DesktopElement{ name, className, helpText, processId, parent, {} });
+	elements_[static_cast<size_t>(parent)].Children.push_back(index);
+	return index;
+}
+
+void DesktopModel::SetLatency(const std::int64_t callLatencyUs, const std::int64_t elementLatencyNs)
+{
+	callLatencyUs_ = callLatencyUs;
+	elementLatencyNs_ = elementLatencyNs;
+}
+
+void DesktopModel::ResetCounters()
+{
+	findCalls_ = 0;
+	elementsVisited_ = 0;
+}
+
+int DesktopModel::CandidateElement(const int candidateIndex) const
+{
+	if (candidateIndex < 0 || static_cast<size_t>(candidateIndex) >= candidates_.size())
+	{
+		return -1;
+	}
+	return candidates_[static_cast<size_t>(candidateIndex)];
+}
+
+/// <summary>
+/// Spins for the simulated cost of a call (sleeping is far too coarse for
+/// microsecond latencies).
+/// </summary>
+void DesktopModel::SimulateCost(const std::uint64_t elementsVisited) const
+{
+	const std::int64_t totalNs = (callLatencyUs_ * 1000) + (elementLatencyNs_ * static_cast<std::int64_t>(elementsVisited));
+	if (totalNs <= 0)
+	{
+		return;
+	}
+
+	const auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(totalNs);
+	while (std::chrono::steady_clock::now() < until)
+	{
+	}
+}
+
+/// <summary>
+/// Generates a desktop with Zoom candidates (all but one being "main" windows
+/// that contain a marker control deep in their tree), unrelated windows and a
+/// few decoys that match the Zoom name but not its class.
+/// </summary>
+DesktopModel DesktopModel::Generate(const DesktopScenario& scenario)
+{
+	DesktopModel model;
+	model.SetLatency(scenario.CallLatencyUs, scenario.ElementLatencyNs);
+
+	const MediaWindowSelectors zoom = MediaWindowSelectors::Zoom();
+	std::mt19937 rng(scenario.Seed);
+
+	const int candidates = std::max(0, scenario.ZoomCandidates);
+	const int mediaPosition = scenario.MediaWindowPosition < 0 ? candidates - 1 : std::min(scenario.MediaWindowPosition, candidates - 1);
+
+	// Decide where each Zoom candidate sits among the top-level windows.
+	const int topLevelCount = candidates + std::max(0, scenario.UnrelatedWindows);
+	std::vector<int> zoomSlots(static_cast<size_t>(topLevelCount));
+	for (int i = 0; i < topLevelCount; ++i)
+	{
+		zoomSlots[static_cast<size_t>(i)] = i;
+	}
+	std::shuffle(zoomSlots.begin(), zoomSlots.end(), rng);
+	zoomSlots.resize(static_cast<size_t>(candidates));
+	std::sort(zoomSlots.begin(), zoomSlots.end());
+
+	int counter = 0;
+	int zoomIndex = 0;
+	int unrelatedIndex = 0;
+	for (int slot = 0; slot < topLevelCount; ++slot)
+	{
+		if (zoomIndex < candidates && zoomSlots[static_cast<size_t>(zoomIndex)] == slot)
+		{
+			const int window = model.AddElement(0, zoom.WindowName, zoom.WindowClassName, L"", ZoomProcessId);
+			AddSubtree(model, window, scenario.TreeDepth, scenario.TreeFanout, ZoomProcessId, counter);
+
+			if (zoomIndex == mediaPosition)
+			{
+				model.expectedMediaWindow_ = zoomIndex;
+			}
+			else if (!zoom.MainWindowHelpTexts.empty())
+			{
+				const int leaf = LastLeaf(model, window);
+				model.AddElement(leaf, L"Meeting information", L"ZoomButtonClass",
+					zoom.MainWindowHelpTexts[static_cast<size_t>(zoomIndex) % zoom.MainWindowHelpTexts.size()], ZoomProcessId);
+			}
+
+			++zoomIndex;
+			continue;
+		}
+
+		// Every tenth unrelated window is a decoy titled like the Zoom window (e.g. a browser tab).
+		const bool decoy = (unrelatedIndex % 10) == 9;
+		const std::uint32_t processId = 1000 + static_cast<std::uint32_t>(unrelatedIndex);
+		const int window = model.AddElement(0,
+			decoy ? zoom.WindowName : L"Window " + std::to_wstring(unrelatedIndex),
+			L"UnrelatedWndClass" + std::to_wstring(unrelatedIndex % 7), L"", processId);
+
+		int parent = window;
+		for (int e = 0; e < scenario.UnrelatedTreeSize; ++e)
+		{
+			const int child = model.AddElement(parent, L"Item " + std::to_wstring(e), L"UnrelatedItemClass", L"", processId);
+			if ((rng() % 4) == 0)
+			{
+				parent = child; // occasionally go deeper
+			}
+		}
+
+		++unrelatedIndex;
+	}
+
+	return model;
+}
+
+int DesktopModel::FindCandidates(const MediaWindowSelectors& selectors)
+{
+	CallCountScope::Count(CallCategory::UiaFind);
+	++findCalls_;
+	candidates_.clear();
+
+	const auto& topLevel = elements_[0].Children;
+	for (const int child : topLevel)
+	{
+		const DesktopElement& e = elements_[static_cast<size_t>(child)];
+		if (e.Name == selectors.WindowName && e.ClassName == selectors.WindowClassName)
+		{
+			candidates_.push_back(child);
+		}
+	}
+
+	elementsVisited_ += topLevel.size();
+	SimulateCost(topLevel.size());
+	return static_cast<int>(candidates_.size());
+}
+
+/// <summary>
+/// Depth-first search of the candidate's descendants, stopping at the first
+/// marker (like IUIAutomationElement::FindFirst).
+/// </summary>
+int DesktopModel::CandidateHasMainWindowMarker(const int candidateIndex, const MediaWindowSelectors& selectors)
+{
+	CallCountScope::Count(CallCategory::UiaFind);
+	++findCalls_;
+
+	const int root = CandidateElement(candidateIndex);
+	if (root < 0)
+	{
+		return CandidateUnavailable;
+	}
+
+	std::uint64_t visited = 0;
+	bool found = false;
+	std::vector<int> stack(elements_[static_cast<size_t>(root)].Children.rbegin(), elements_[static_cast<size_t>(root)].Children.rend());
+	while (!stack.empty() && !found)
+	{
+		const int current = stack.back();
+		stack.pop_back();
+		++visited;
+
+		const DesktopElement& e = elements_[static_cast<size_t>(current)];
+		for (const auto& marker : selectors.MainWindowHelpTexts)
+		{
+			if (e.HelpText == marker)
+			{
+				found = true;
+				break;
+			}
+		}
+
+		stack.insert(stack.end(), e.Children.rbegin(), e.Children.rend());
+	}
+
+	elementsVisited_ += visited;
+	SimulateCost(visited);
+	return found ? 1 : 0;
+}
+
+/// <summary>
+/// Writes the elements in pre-order (as a capture would), with the expected
+/// media window recorded as the selected candidate.
+/// </summary>
+void DesktopModel::WriteSnapshot(TreeSnapshotWriter& writer) const
+{
+	// (element, parent index in the snapshot)
+	std::vector<std::pair<int, int>> stack{ { 0, -1 } };
+	while (!stack.empty())
+	{
+		const auto [element, parent] = stack.back();
+		stack.pop_back();
+
+		const DesktopElement& e = elements_[static_cast<size_t>(element)];
+		const int index = writer.AddElement(parent, e.Name, e.ClassName, e.HelpText, e.ProcessId);
+		for (auto it = e.Children.rbegin(); it != e.Children.rend(); ++it)
+		{
+			stack.emplace_back(*it, index);
+		}
+	}
+
+	writer.Finish(expectedMediaWindow_);
+}
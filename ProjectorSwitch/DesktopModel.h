@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DiscoveryBackend.h"
+
+class TreeSnapshotWriter;
+
+struct DesktopElement
+{
+	std::wstring Name;
+	std::wstring ClassName;
+	std::wstring HelpText;
+	std::uint32_t ProcessId;
+	int Parent;
+	std::vector<int> Children;
+};
+
+// Parameters for a generated desktop.
+struct DesktopScenario
+{
+	int ZoomCandidates = 2;          // windows matching the Zoom name/class
+	int MediaWindowPosition = -1;    // which candidate is the media window (-1 = last)
+	int TreeDepth = 4;               // depth of each Zoom window's element tree
+	int TreeFanout = 3;              // children per element in Zoom trees
+	int UnrelatedWindows = 50;       // other top-level windows
+	int UnrelatedTreeSize = 20;      // elements beneath each unrelated window
+	std::int64_t CallLatencyUs = 0;  // fixed cost of each Find call (cross-process round trip)
+	std::int64_t ElementLatencyNs = 0; // cost per element visited by a Find call
+	std::uint32_t Seed = 1;
+};
+
+/// <summary>
+/// Synthetic desktop: top-level windows with process IDs and UIA-like element
+/// trees (Name, ClassName, HelpText), with configurable per-call latency to mimic
+/// cross-process cost. Serves the real discovery logic through DiscoveryBackend.
+/// Portable (no Windows dependencies).
+/// </summary>
+class DesktopModel : public DiscoveryBackend
+{
+private:
+	std::vector<DesktopElement> elements_; // element 0 is the desktop root
+	std::vector<int> candidates_;
+	std::int64_t callLatencyUs_;
+	std::int64_t elementLatencyNs_;
+	std::uint64_t findCalls_;
+	std::uint64_t elementsVisited_;
+	int expectedMediaWindow_;
+
+	void SimulateCost(std::uint64_t elementsVisited) const;
+
+public:
+	DesktopModel();
+
+	static DesktopModel Generate(const DesktopScenario& scenario);
+
+	int AddElement(int parent, const std::wstring& name, const std::wstring& className,
+		const std::wstring& helpText, std::uint32_t processId);
+
+	void SetLatency(std::int64_t callLatencyUs, std::int64_t elementLatencyNs);
+
+	const std::vector<DesktopElement>& Elements() const { return elements_; }
+	const DesktopElement& Element(int index) const { return elements_[static_cast<size_t>(index)]; }
+	int CandidateElement(int candidateIndex) const;
+
+	// For generated scenarios: the candidate index of the media window (or -1).
+	int ExpectedMediaWindow() const { return expectedMediaWindow_; }
+
+	std::uint64_t FindCalls() const { return findCalls_; }
+	std::uint64_t ElementsVisited() const { return elementsVisited_; }
+	void ResetCounters();
+
+	// Writes the whole desktop in the --capture-tree snapshot format.
+	void WriteSnapshot(TreeSnapshotWriter& writer) const;
+
+	int FindCandidates(const MediaWindowSelectors& selectors) override;
+	int CandidateHasMainWindowMarker(int candidateIndex, const MediaWindowSelectors& selectors) override;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include "MediaWindowSelectors.h"
+
+/// <summary>
+/// Source of top-level windows and their element trees for media window discovery.
+/// Implemented over UI Automation (UiaDiscoveryBackend) and by the synthetic
+/// DesktopModel. Portable (no Windows dependencies).
+/// </summary>
+class DiscoveryBackend
+{
+public:
+	// CandidateHasMainWindowMarker's result when the candidate itself could not be
+	// obtained (e.g. the window closed since FindCandidates); the candidate is skipped.
+	static constexpr int CandidateUnavailable = -2;
+
+	virtual ~DiscoveryBackend() = default;
+
+	// Finds top-level windows (children of the desktop) matching the selector's
+	// name and class name. Returns the number of candidates, or -1 on failure.
+	// Candidates are held by the backend until the next call.
+	virtual int FindCandidates(const MediaWindowSelectors& selectors) = 0;
+
+	// Returns 1 if the candidate has a descendant whose HelpText matches one of
+	// the selector's main-window markers, 0 if not, -1 if the search failed, or
+	// CandidateUnavailable.
+	virtual int CandidateHasMainWindowMarker(int candidateIndex, const MediaWindowSelectors& selectors) = 0;
+};
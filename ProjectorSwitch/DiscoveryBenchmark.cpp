@@ -0,0 +1,212 @@
+#include "DiscoveryBenchmark.h"
+#include "CallCounters.h"
+#include "LatencyHistogram.h"
+#include "MediaWindowDiscovery.h"
+#include "ReplayDiscoveryBackend.h"
+
+namespace
+{
+	// Rough cost of a cross-process UIA call and of each element the provider walks.
+	constexpr std::int64_t TypicalCallLatencyUs = 150;
+	constexpr std::int64_t TypicalElementLatencyNs = 400;
+	constexpr int MaxCandidates = 10;
+
+	// Every strategy is run on each scenario; InOrder is the one ZoomService uses.
+	constexpr DiscoveryStrategy Strategies[] = { DiscoveryStrategy::InOrder, DiscoveryStrategy::Reverse, DiscoveryStrategy::ProbeAll };
+
+	struct CaseResult
+	{
+		LatencyHistogram Total;
+		LatencyHistogram Find;
+		LatencyHistogram Identify;
+		CallCounts Calls;
+		std::int64_t Probes = 0;
+		int Correct = 0;
+		int Candidates = 0;
+	};
+
+	/// <summary>
+	/// Writes a name as a JSON string, escaping quotes and backslashes.
+	/// </summary>
+	void WriteJsonString(std::ostream& out, const std::string& value)
+	{
+		out << '"';
+		for (const char ch : value)
+		{
+			if (ch == '"' || ch == '\\')
+			{
+				out << '\\';
+			}
+			out << ch;
+		}
+		out << '"';
+	}
+
+	/// <summary>
+	/// Runs discovery against the backend repeatedly, counting runs whose selected
+	/// candidate index (-1 for none) isExpected accepts.
+	/// </summary>
+	template <typename Expected>
+	void Measure(DiscoveryBackend& backend, const DiscoveryStrategy strategy, const Expected& isExpected, const int iterations, CaseResult& result)
+	{
+		const MediaWindowSelectors selectors = MediaWindowSelectors::Zoom();
+
+		for (int i = 0; i < iterations; ++i)
+		{
+			DiscoveryOutcome outcome;
+			{
+				CallCountScope scope(result.Calls);
+				outcome = MediaWindowDiscovery::Locate(backend, selectors, CancellationToken(), strategy);
+			}
+
+			result.Total.Record(outcome.FindUs + outcome.IdentifyUs);
+			result.Find.Record(outcome.FindUs);
+			result.Identify.Record(outcome.IdentifyUs);
+			result.Probes += outcome.Probes;
+			result.Candidates = outcome.CandidateCount;
+
+			if (isExpected(outcome.SelectedIndex))
+			{
+				++result.Correct;
+			}
+		}
+	}
+
+	void WriteResult(std::ostream& out, const std::string& name, const DiscoveryStrategy strategy, const int iterations,
+		const std::uint64_t elements, const std::uint64_t elementsVisited, const CaseResult& result)
+	{
+		const double runs = iterations > 0 ? static_cast<double>(iterations) : 1.0;
+		out << "{\"scenario\":";
+		WriteJsonString(out, name);
+		out << ",\"strategy\":\"" << MediaWindowDiscovery::StrategyName(strategy) << '"'
+			<< ",\"iterations\":" << iterations
+			<< ",\"correct\":" << result.Correct
+			<< ",\"elements\":" << elements
+			<< ",\"candidates\":" << result.Candidates
+			<< ",\"find_calls_per_run\":" << static_cast<double>(result.Calls[CallCategory::UiaFind]) / runs
+			<< ",\"probes_per_run\":" << static_cast<double>(result.Probes) / runs
+			<< ",\"elements_visited_per_run\":" << static_cast<double>(elementsVisited) / runs
+			<< ",\"find_p50_us\":" << result.Find.ValueAtPercentile(50)
+			<< ",\"identify_p50_us\":" << result.Identify.ValueAtPercentile(50)
+			<< ",\"p50_us\":" << result.Total.ValueAtPercentile(50)
+			<< ",\"p95_us\":" << result.Total.ValueAtPercentile(95)
+			<< ",\"max_us\":" << result.Total.Max()
+			<< ",\"mean_us\":" << result.Total.Mean()
+			<< "}\n";
+	}
+
+	DesktopScenario TypicalScenario()
+	{
+		DesktopScenario scenario;
+		scenario.CallLatencyUs = TypicalCallLatencyUs;
+		scenario.ElementLatencyNs = TypicalElementLatencyNs;
+		return scenario;
+	}
+}
+
+std::vector<DiscoveryBenchmarkCase> DiscoveryBenchmark::DefaultCases()
+{
+	std::vector<DiscoveryBenchmarkCase> cases;
+
+	for (int candidates = 1; candidates <= MaxCandidates; ++candidates)
+	{
+		DesktopScenario scenario = TypicalScenario();
+		scenario.ZoomCandidates = candidates;
+		cases.push_back({ "candidates-" + std::to_string(candidates), scenario });
+	}
+
+	DesktopScenario mediaFirst = TypicalScenario();
+	mediaFirst.ZoomCandidates = 5;
+	mediaFirst.MediaWindowPosition = 0;
+	cases.push_back({ "media-window-first", mediaFirst });
+
+	DesktopScenario deepTree = TypicalScenario();
+	deepTree.ZoomCandidates = 3;
+	deepTree.TreeDepth = 7;
+	cases.push_back({ "deep-tree", deepTree });
+
+	DesktopScenario crowded = TypicalScenario();
+	crowded.ZoomCandidates = 3;
+	crowded.UnrelatedWindows = 500;
+	cases.push_back({ "crowded-desktop", crowded });
+
+	DesktopScenario noZoom = TypicalScenario();
+	noZoom.ZoomCandidates = 0;
+	cases.push_back({ "zoom-not-running", noZoom });
+
+	DesktopScenario noLatency = TypicalScenario();
+	noLatency.ZoomCandidates = 5;
+	noLatency.CallLatencyUs = 0;
+	noLatency.ElementLatencyNs = 0;
+	cases.push_back({ "candidates-5-no-latency", noLatency });
+
+	return cases;
+}
+
+/// <summary>
+/// Runs each case with each strategy for the given number of iterations and writes
+/// one JSON line per case and strategy.
+/// </summary>
+/// <param name="out">Report destination.</param>
+/// <param name="cases">Scenarios to run.</param>
+/// <param name="iterations">Discovery runs per scenario and strategy.</param>
+/// <returns>True if every run of the InOrder strategy selected the expected window.</returns>
+bool DiscoveryBenchmark::Run(std::ostream& out, const std::vector<DiscoveryBenchmarkCase>& cases, const int iterations)
+{
+	bool allCorrect = true;
+
+	for (const auto& benchCase : cases)
+	{
+		DesktopModel model = DesktopModel::Generate(benchCase.Scenario);
+		const int expected = model.ExpectedMediaWindow();
+
+		for (const DiscoveryStrategy strategy : Strategies)
+		{
+			model.ResetCounters();
+
+			CaseResult result;
+			Measure(model, strategy, [expected](const int selected) { return selected == expected; }, iterations, result);
+			WriteResult(out, benchCase.Name, strategy, iterations, model.Elements().size(), model.ElementsVisited(), result);
+
+			if (strategy == DiscoveryStrategy::InOrder && result.Correct != iterations)
+			{
+				allCorrect = false;
+			}
+		}
+	}
+
+	return allCorrect;
+}
+
+/// <summary>
+/// Runs discovery against a captured snapshot with each strategy and writes one JSON
+/// line per strategy.
+/// </summary>
+/// <param name="out">Report destination.</param>
+/// <param name="name">Scenario name for the report (normally the file name).</param>
+/// <param name="reader">An open snapshot.</param>
+/// <param name="iterations">Discovery runs per strategy.</param>
+/// <returns>True if every run of the InOrder strategy selected the window that was selected at capture time.</returns>
+bool DiscoveryBenchmark::RunSnapshot(std::ostream& out, const std::string& name, TreeSnapshotReader& reader, const int iterations)
+{
+	ReplayDiscoveryBackend backend(reader);
+	bool allCorrect = true;
+
+	// Candidates are compared by element, as the capture includes windows that are not.
+	const int expected = reader.SelectedElement();
+	for (const DiscoveryStrategy strategy : Strategies)
+	{
+		backend.ResetCounters();
+
+		CaseResult result;
+		Measure(backend, strategy, [&backend, expected](const int selected) { return backend.CandidateElement(selected) == expected; }, iterations, result);
+		WriteResult(out, name, strategy, iterations, reader.ElementCount(), backend.ElementsVisited(), result);
+
+		if (strategy == DiscoveryStrategy::InOrder && result.Correct != iterations)
+		{
+			allCorrect = false;
+		}
+	}
+
+	return allCorrect;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+#include "DesktopModel.h"
+#include "TreeSnapshot.h"
+
+struct DiscoveryBenchmarkCase
+{
+	std::string Name;
+	DesktopScenario Scenario;
+};
+
+/// <summary>
+/// Runs the real discovery logic (MediaWindowDiscovery) against generated
+/// DesktopModel scenarios and reports wall time, call counts and correctness
+/// per scenario and discovery strategy as JSON lines. Captured snapshots (--capture-tree) can be run
+/// the same way, checking the selection against the one made at capture time.
+/// Portable (no Windows dependencies).
+/// </summary>
+class DiscoveryBenchmark
+{
+public:
+	static constexpr int DefaultIterations = 100;
+
+	// 1-10 Zoom candidates, deep trees, hundreds of unrelated windows, etc.
+	static std::vector<DiscoveryBenchmarkCase> DefaultCases();
+
+	// Returns false if the InOrder strategy selected the wrong window in any scenario
+	// (the others are reported for comparison).
+	static bool Run(std::ostream& out, const std::vector<DiscoveryBenchmarkCase>& cases, int iterations = DefaultIterations);
+
+	// Returns false if InOrder selects a different window than when the snapshot was captured.
+	static bool RunSnapshot(std::ostream& out, const std::string& name, TreeSnapshotReader& reader, int iterations = DefaultIterations);
+};
@@ -0,0 +1,155 @@
+#include <istream>
+#include <ostream>
+#include <utility>
+#include "DiscoveryCache.h"
+#include "BinaryIo.h"
+
+namespace
+{
+	constexpr std::uint32_t CacheFileMagic = 0x43445350; // "PSDC"
+	constexpr std::uint32_t CacheFileVersion = 2; // 1 also held the original position (now in SessionJournal)
+
+	// Class names are at most 256 characters (GetClassName); anything longer is corrupt.
+	constexpr std::uint32_t MaxClassNameLength = 256;
+
+	constexpr std::uint64_t FnvOffsetBasis = 14695981039346656037ull;
+	constexpr std::uint64_t FnvPrime = 1099511628211ull;
+
+	void HashU32(std::uint64_t& hash, const std::uint32_t value)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			hash ^= (value >> (8 * i)) & 0xFF;
+			hash *= FnvPrime;
+		}
+	}
+}
+
+/// <summary>
+/// Writes the entry (little-endian, fixed layout apart from the class name).
+/// </summary>
+void DiscoveryCache::Write(std::ostream& out, const DiscoveryCacheEntry& entry)
+{
+	BinaryIo::WriteU32(out, CacheFileMagic);
+	BinaryIo::WriteU32(out, CacheFileVersion);
+	BinaryIo::WriteU64(out, entry.Window.WindowHandle);
+	BinaryIo::WriteU32(out, entry.Window.ProcessId);
+	BinaryIo::WriteU64(out, entry.Window.ProcessStartTime);
+	BinaryIo::WriteU32(out, static_cast<std::uint32_t>(entry.Path));
+	BinaryIo::WriteU64(out, entry.TopologyHash);
+
+	BinaryIo::WriteU32(out, static_cast<std::uint32_t>(entry.Window.ClassName.size()));
+	for (const wchar_t c : entry.Window.ClassName)
+	{
+		BinaryIo::WriteU32(out, static_cast<std::uint32_t>(c));
+	}
+}
+
+bool DiscoveryCache::Read(std::istream& in, DiscoveryCacheEntry& entry)
+{
+	entry = DiscoveryCacheEntry();
+
+	DiscoveryCacheEntry read;
+	std::uint32_t magic = 0;
+	std::uint32_t version = 0;
+	std::uint32_t path = 0;
+	std::uint32_t classLength = 0;
+	if (!BinaryIo::ReadU32(in, magic) || magic != CacheFileMagic ||
+		!BinaryIo::ReadU32(in, version) || version != CacheFileVersion ||
+		!BinaryIo::ReadU64(in, read.Window.WindowHandle) ||
+		!BinaryIo::ReadU32(in, read.Window.ProcessId) ||
+		!BinaryIo::ReadU64(in, read.Window.ProcessStartTime) ||
+		!BinaryIo::ReadU32(in, path) || path > static_cast<std::uint32_t>(DiscoveryPath::IdentifiedByMarkers) ||
+		!BinaryIo::ReadU64(in, read.TopologyHash) ||
+		!BinaryIo::ReadU32(in, classLength) || classLength > MaxClassNameLength)
+	{
+		return false;
+	}
+
+	read.Path = static_cast<DiscoveryPath>(path);
+	read.Window.ClassName.reserve(classLength);
+	for (std::uint32_t i = 0; i < classLength; ++i)
+	{
+		std::uint32_t c = 0;
+		if (!BinaryIo::ReadU32(in, c))
+		{
+			return false;
+		}
+		read.Window.ClassName.push_back(static_cast<wchar_t>(c));
+	}
+
+	entry = std::move(read);
+	return true;
+}
+
+/// <summary>
+/// The rules, in order: something must be cached; the handle must still name a
+/// window; that window must belong to the same process instance (id and start
+/// time) and have the same class; and the monitors must not have changed, since
+/// Windows moves windows between monitors when they do.
+/// </summary>
+CacheValidity DiscoveryCache::Validate(const DiscoveryCacheEntry& cached, const WindowIdentity& observed, const std::uint64_t topologyHash)
+{
+	if (cached.Window.WindowHandle == 0 || cached.Window.ProcessId == 0 || cached.Path == DiscoveryPath::Unknown)
+	{
+		return CacheValidity::Empty;
+	}
+
+	if (observed.WindowHandle != cached.Window.WindowHandle || observed.ProcessId == 0)
+	{
+		return CacheValidity::WindowGone;
+	}
+
+	if (observed.ProcessId != cached.Window.ProcessId || observed.ProcessStartTime != cached.Window.ProcessStartTime)
+	{
+		return CacheValidity::ProcessChanged;
+	}
+
+	if (observed.ClassName != cached.Window.ClassName)
+	{
+		return CacheValidity::ClassChanged;
+	}
+
+	if (topologyHash != cached.TopologyHash)
+	{
+		return CacheValidity::TopologyChanged;
+	}
+
+	return CacheValidity::Valid;
+}
+
+std::uint64_t DiscoveryCache::HashTopology(const std::vector<MonitorFacts>& monitors)
+{
+	if (monitors.empty())
+	{
+		return 0;
+	}
+
+	std::uint64_t hash = FnvOffsetBasis;
+	HashU32(hash, static_cast<std::uint32_t>(monitors.size()));
+	for (const auto& m : monitors)
+	{
+		HashU32(hash, static_cast<std::uint32_t>(m.Rect.Left));
+		HashU32(hash, static_cast<std::uint32_t>(m.Rect.Top));
+		HashU32(hash, static_cast<std::uint32_t>(m.Rect.Right));
+		HashU32(hash, static_cast<std::uint32_t>(m.Rect.Bottom));
+		HashU32(hash, m.Dpi);
+	}
+
+	return hash;
+}
+
+const wchar_t* DiscoveryCache::ValidityName(const CacheValidity validity)
+{
+	switch (validity)
+	{
+	case CacheValidity::Valid: return L"valid";
+	case CacheValidity::Empty: return L"empty";
+	case CacheValidity::WindowGone: return L"window gone";
+	case CacheValidity::ProcessChanged: return L"process changed";
+	case CacheValidity::ClassChanged: return L"class changed";
+	case CacheValidity::TopologyChanged: return L"topology changed";
+	}
+
+	return L"?";
+}
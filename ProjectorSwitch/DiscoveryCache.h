@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "WindowGeometry.h"
+#include "WindowIdentity.h"
+
+// How discovery chose the cached window.
+enum class DiscoveryPath : std::uint8_t
+{
+	Unknown,
+	SingleCandidate,     // the only window matching name and class
+	IdentifiedByMarkers  // one of several, told apart by the main-window markers
+};
+
+// A monitor as seen by the topology hash.
+struct MonitorFacts
+{
+	ScreenRect Rect;
+	unsigned Dpi = 0;
+};
+
+struct DiscoveryCacheEntry
+{
+	WindowIdentity Window;
+	DiscoveryPath Path = DiscoveryPath::Unknown;
+	std::uint64_t TopologyHash = 0;
+};
+
+enum class CacheValidity : std::uint8_t
+{
+	Valid,
+	Empty,           // nothing cached (or the file was unreadable)
+	WindowGone,      // the handle no longer names a window
+	ProcessChanged,  // the handle now belongs to another process (or Zoom restarted)
+	ClassChanged,
+	TopologyChanged  // monitors were added, removed, moved or rescaled
+};
+
+/// <summary>
+/// Media window discovery result persisted between one-shot runs, so a new
+/// process can check the last window with a few calls instead of searching the
+/// UI Automation tree again. The file format and validation rules live here;
+/// observing the current window and monitors is left to the caller.
+/// Portable (no Windows dependencies).
+/// </summary>
+class DiscoveryCache
+{
+public:
+	static void Write(std::ostream& out, const DiscoveryCacheEntry& entry);
+
+	// False (and an empty entry) if the data is missing, truncated or of another version.
+	static bool Read(std::istream& in, DiscoveryCacheEntry& entry);
+
+	// Checks a cached entry against the window its handle names now (observed) and
+	// the current topology hash. A window is only reused if all of them still match.
+	static CacheValidity Validate(const DiscoveryCacheEntry& cached, const WindowIdentity& observed, std::uint64_t topologyHash);
+
+	// Order-sensitive hash of the monitors' rectangles and DPIs (0 for none).
+	static std::uint64_t HashTopology(const std::vector<MonitorFacts>& monitors);
+
+	static const wchar_t* ValidityName(CacheValidity validity);
+};
@@ -1,13 +1,97 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include "CallCounters.h"
+
+enum class DisplayWindowError : std::uint8_t
+{
+    None,
+    AutomationUnavailable,
+    DesktopUnavailable,
+    ZoomNotRunning,
+    MediaWindowNotFound,
+    TargetMonitorNotFound,
+    NoNativeWindowHandle,
+    InvalidWindowHandle,
+    NoWindowPosition,
+    MirrorUnavailable,
+    DeadlineExceeded,
+    Count
+};
+
+// Bit flags recording which alternative code paths a toggle took.
+enum ToggleFallback : std::uint32_t
+{
+    ToggleFallbackNone = 0,
+    ToggleFallbackSingleCandidate = 1u << 0,
+    ToggleFallbackMultipleCandidates = 1u << 1,
+    ToggleFallbackRestoredFromMinimized = 1u << 2,
+    ToggleFallbackHiddenInsteadOfCloaked = 1u << 3,
+    ToggleFallbackNoFade = 1u << 4,
+    ToggleFallbackFabricatedRestoreRect = 1u << 5,
+    ToggleFallbackMinimizedSendBack = 1u << 6,
+    ToggleFallbackDpiPrecompensated = 1u << 7,
+    ToggleFallbackCorrectiveResize = 1u << 8,
+    ToggleFallbackWarmStart = 1u << 9, // window taken from the discovery cache, no search
+};
+
+constexpr int ToggleFallbackCount = 10;
+
+// Where a toggle left the media window (Unknown if it was not reached).
+enum class MediaWindowPlacement : std::uint8_t
+{
+    Unknown,
+    Restored,
+    OnProjector,
+    Mirrored
+};
+
+enum class ZoomPresence : std::uint8_t
+{
+    Unknown,
+    NotRunning,
+    Running
+};
+
+// Per-stage durations of a single toggle, in microseconds (0 if the stage did not run).
+struct ToggleStageTimings
+{
+    std::int64_t TotalUs = 0;
+    std::int64_t ProcessSnapshotUs = 0;
+    std::int64_t DiscoveryUs = 0;
+    std::int64_t IdentifyUs = 0;
+    std::int64_t MoveUs = 0;
+    std::int64_t ClickToVisibleUs = 0; // input event to the first fully opaque frame on the projector
+};
 
 struct DisplayWindowResult
 {
     bool AllOk;
+    DisplayWindowError Error;
     std::wstring ErrorMessage;
+    std::uint32_t Fallbacks;
+    ToggleStageTimings Timings;
+    CallCounts Calls;
+    std::uint32_t ResizeEvents; // size changes of the media window observed while moving it
+    ZoomPresence Presence;
+    MediaWindowPlacement Placement;
+    std::int64_t OpaqueQpc; // when the media window (or mirror) became fully opaque on the projector; 0 if it did not
 
     DisplayWindowResult()
-        : AllOk(false)        
+        : AllOk(false)
+        , Error(DisplayWindowError::None)
+        , Fallbacks(ToggleFallbackNone)
+        , ResizeEvents(0)
+        , Presence(ZoomPresence::Unknown)
+        , Placement(MediaWindowPlacement::Unknown)
+        , OpaqueQpc(0)
+    {
+    }
+
+    void Fail(const DisplayWindowError error, const std::wstring& message)
     {
+        AllOk = false;
+        Error = error;
+        ErrorMessage = message;
     }
 };
@@ -0,0 +1,169 @@
+#include <utility>
+#include "DwmThumbnailCompositor.h"
+#include "TraceRecorder.h"
+
+namespace
+{
+	const wchar_t* const HostClassName = L"ProjectorSwitchMirrorHost";
+
+	RECT ToRect(const ScreenRect& rect)
+	{
+		return RECT{ rect.Left, rect.Top, rect.Right, rect.Bottom };
+	}
+}
+
+DwmThumbnailCompositor::DwmThumbnailCompositor(std::function<void()> onTick)
+	: host_(nullptr)
+	, source_(nullptr)
+	, thumbnail_(nullptr)
+	, onTick_(std::move(onTick))
+{
+}
+
+DwmThumbnailCompositor::~DwmThumbnailCompositor()
+{
+	Unregister();
+	DestroyHost();
+}
+
+/// <summary>
+/// Registers the host window class once per process.
+/// </summary>
+const wchar_t* DwmThumbnailCompositor::HostWindowClass()
+{
+	static const ATOM atom = []
+	{
+		WNDCLASSEXW windowClass{};
+		windowClass.cbSize = sizeof(windowClass);
+		windowClass.lpfnWndProc = HostWindowProc;
+		windowClass.hInstance = GetModuleHandleW(nullptr);
+		windowClass.hCursor = LoadCursor(nullptr, IDC_ARROW);
+		windowClass.hbrBackground = static_cast<HBRUSH>(GetStockObject(BLACK_BRUSH)); // letterbox bars
+		windowClass.lpszClassName = HostClassName;
+		return RegisterClassExW(&windowClass);
+	}();
+
+	return atom != 0 ? HostClassName : nullptr;
+}
+
+LRESULT CALLBACK DwmThumbnailCompositor::HostWindowProc(const HWND hwnd, const UINT message, const WPARAM wParam, const LPARAM lParam)
+{
+	switch (message)
+	{
+	case WM_NCCREATE:
+	{
+		const auto* create = reinterpret_cast<const CREATESTRUCTW*>(lParam);
+		SetWindowLongPtrW(hwnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(create->lpCreateParams));
+		break;
+	}
+
+	case WM_MOUSEACTIVATE:
+		return MA_NOACTIVATE;
+
+	case WM_TIMER:
+		if (wParam == RefreshTimerId)
+		{
+			// The handler may stop the mirror, destroying this window.
+			const auto* compositor = reinterpret_cast<const DwmThumbnailCompositor*>(GetWindowLongPtrW(hwnd, GWLP_USERDATA));
+			if (compositor != nullptr && compositor->onTick_)
+			{
+				compositor->onTick_();
+			}
+			return 0;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	return DefWindowProcW(hwnd, message, wParam, lParam);
+}
+
+bool DwmThumbnailCompositor::CreateHost(const ScreenRect& monitorRect)
+{
+	TRACE_ZONE("DwmThumbnailCompositor::CreateHost");
+	const wchar_t* windowClass = HostWindowClass();
+	if (windowClass == nullptr)
+	{
+		return false;
+	}
+
+	host_ = CreateWindowExW(
+		WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE,
+		windowClass,
+		L"ProjectorSwitch Mirror",
+		WS_POPUP,
+		monitorRect.Left,
+		monitorRect.Top,
+		monitorRect.Width(),
+		monitorRect.Height(),
+		nullptr,
+		nullptr,
+		GetModuleHandleW(nullptr),
+		this);
+
+	return host_ != nullptr;
+}
+
+void DwmThumbnailCompositor::DestroyHost()
+{
+	if (host_ == nullptr)
+	{
+		return;
+	}
+
+	KillTimer(host_, RefreshTimerId);
+	SetWindowLongPtrW(host_, GWLP_USERDATA, 0);
+	DestroyWindow(host_);
+	host_ = nullptr;
+}
+
+void DwmThumbnailCompositor::ShowHost()
+{
+	ShowWindow(host_, SW_SHOWNOACTIVATE);
+	SetTimer(host_, RefreshTimerId, RefreshIntervalMs, nullptr);
+}
+
+bool DwmThumbnailCompositor::Register(const std::uint64_t sourceWindow)
+{
+	TRACE_ZONE("DwmThumbnailCompositor::Register");
+	source_ = reinterpret_cast<HWND>(static_cast<std::uintptr_t>(sourceWindow));
+	return SUCCEEDED(DwmRegisterThumbnail(host_, source_, &thumbnail_));
+}
+
+void DwmThumbnailCompositor::Unregister()
+{
+	if (thumbnail_ != nullptr)
+	{
+		DwmUnregisterThumbnail(thumbnail_);
+		thumbnail_ = nullptr;
+		source_ = nullptr;
+	}
+}
+
+bool DwmThumbnailCompositor::QuerySourceSize(int& width, int& height)
+{
+	SIZE size{};
+	if (thumbnail_ == nullptr || !IsWindow(source_) || FAILED(DwmQueryThumbnailSourceSize(thumbnail_, &size)))
+	{
+		return false;
+	}
+
+	width = size.cx;
+	height = size.cy;
+	return true;
+}
+
+bool DwmThumbnailCompositor::Update(const ScreenRect& source, const ScreenRect& destination)
+{
+	DWM_THUMBNAIL_PROPERTIES properties{};
+	properties.dwFlags = DWM_TNP_RECTSOURCE | DWM_TNP_RECTDESTINATION | DWM_TNP_VISIBLE | DWM_TNP_OPACITY | DWM_TNP_SOURCECLIENTAREAONLY;
+	properties.rcSource = ToRect(source);
+	properties.rcDestination = ToRect(destination);
+	properties.fVisible = TRUE;
+	properties.opacity = 255;
+	properties.fSourceClientAreaOnly = FALSE; // rcSource already excludes the frame
+
+	return SUCCEEDED(DwmUpdateThumbnailProperties(thumbnail_, &properties));
+}
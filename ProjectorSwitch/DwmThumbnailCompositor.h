@@ -0,0 +1,38 @@
+#pragma once
+#include <windows.h>
+#include <dwmapi.h>
+#include <functional>
+#include "ThumbnailCompositor.h"
+
+/// <summary>
+/// ThumbnailCompositor backed by DWM thumbnails (DwmRegisterThumbnail) in a
+/// borderless, topmost, non-activating host window. While the host is shown, a
+/// timer calls onTick so the owner can re-fit the thumbnail to the source.
+/// </summary>
+class DwmThumbnailCompositor final : public ThumbnailCompositor  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	static constexpr UINT_PTR RefreshTimerId = 1;
+
+	HWND host_;
+	HWND source_;
+	HTHUMBNAIL thumbnail_;
+	std::function<void()> onTick_;
+
+	static LRESULT CALLBACK HostWindowProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
+	static const wchar_t* HostWindowClass();
+
+public:
+	static constexpr UINT RefreshIntervalMs = 250;
+
+	explicit DwmThumbnailCompositor(std::function<void()> onTick);
+	~DwmThumbnailCompositor() override;
+
+	bool CreateHost(const ScreenRect& monitorRect) override;
+	void DestroyHost() override;
+	void ShowHost() override;
+	bool Register(std::uint64_t sourceWindow) override;
+	void Unregister() override;
+	bool QuerySourceSize(int& width, int& height) override;
+	bool Update(const ScreenRect& source, const ScreenRect& destination) override;
+};
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <utility>
+#include "EventReactor.h"
+
+EventReactor::RegistrationId ReactorHandlers::Add(const NativeWaitHandle handle, EventReactor::Callback callback)
+{
+	const EventReactor::RegistrationId id = nextId_++;
+	entries_.push_back(Entry{ id, handle, std::move(callback), true });
+	return id;
+}
+
+void ReactorHandlers::Remove(const EventReactor::RegistrationId id)
+{
+	for (Entry& entry : entries_)
+	{
+		if (entry.Id == id)
+		{
+			entry.Active = false;
+		}
+	}
+}
+
+void ReactorHandlers::Compact()
+{
+	entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const Entry& entry) { return !entry.Active; }),
+		entries_.end());
+}
+
+void ReactorHandlers::Snapshot(std::vector<NativeWaitHandle>& handles, std::vector<EventReactor::RegistrationId>& ids) const
+{
+	handles.clear();
+	ids.clear();
+	for (const Entry& entry : entries_)
+	{
+		if (entry.Active)
+		{
+			handles.push_back(entry.Handle);
+			ids.push_back(entry.Id);
+		}
+	}
+}
+
+bool ReactorHandlers::Invoke(const EventReactor::RegistrationId id)
+{
+	for (const Entry& entry : entries_)
+	{
+		if (entry.Id == id && entry.Active)
+		{
+			// A copy, as the callback may register handlers (reallocating entries_).
+			const EventReactor::Callback callback = entry.Callback;
+			callback();
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ReactorTaskQueue::Push(EventReactor::Callback callback)
+{
+	const std::lock_guard<std::mutex> lock(mutex_);
+	const bool wasEmpty = tasks_.empty();
+	tasks_.push_back(std::move(callback));
+	return wasEmpty;
+}
+
+std::uint64_t ReactorTaskQueue::RunAll()
+{
+	std::vector<EventReactor::Callback> tasks;
+	{
+		const std::lock_guard<std::mutex> lock(mutex_);
+		tasks.swap(tasks_);
+	}
+
+	for (const EventReactor::Callback& task : tasks)
+	{
+		task();
+	}
+	return tasks.size();
+}
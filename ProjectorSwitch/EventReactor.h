@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// What a reactor waits on: a kernel object HANDLE on Windows, a file descriptor elsewhere.
+#if defined(_WIN32)
+using NativeWaitHandle = void*;
+#else
+using NativeWaitHandle = int;
+#endif
+
+struct ReactorStats
+{
+	std::uint64_t Wakeups = 0;       // returns from the blocking wait
+	std::uint64_t HandleEvents = 0;  // registered handles found signaled
+	std::uint64_t Messages = 0;      // window messages dispatched (Windows)
+	std::uint64_t Tasks = 0;         // posted callbacks run
+	std::uint64_t IdleWakeups = 0;   // wakeups that found nothing to do
+};
+
+/// <summary>
+/// Single-threaded event loop: waits (without polling) for registered handles,
+/// posted callbacks and, on Windows, window messages, and dispatches them all on
+/// the thread that calls Run. Components register what they wait on instead of
+/// running a thread of their own.
+/// Portable interface (Win32EventReactor, PollEventReactor).
+/// </summary>
+class EventReactor
+{
+public:
+	using Callback = std::function<void()>;
+	using RegistrationId = std::uint32_t;
+
+	static constexpr RegistrationId InvalidRegistration = 0;
+
+	virtual ~EventReactor() = default;
+
+	// Calls callback on the reactor thread whenever handle is signaled (readable, for a
+	// file descriptor). Waits are level-triggered, so the callback must reset or consume
+	// what signaled it. Reactor thread only; callbacks may register and unregister.
+	virtual RegistrationId Register(NativeWaitHandle handle, Callback callback) = 0;
+	virtual void Unregister(RegistrationId id) = 0;
+
+	// Queues callback to run on the reactor thread. Safe to call from any thread.
+	virtual void Post(Callback callback) = 0;
+
+	// Called on the reactor thread after each wakeup that dispatched something, once
+	// there is nothing more to dispatch (e.g. the message queue has drained).
+	virtual void SetIdleCallback(Callback callback) = 0;
+
+	// Dispatches until Quit (or, on Windows, WM_QUIT). Returns the exit code.
+	virtual int Run() = 0;
+
+	// Makes Run return exitCode once the current dispatch finishes. Reactor thread only
+	// (Post it from other threads).
+	virtual void Quit(int exitCode) = 0;
+
+	virtual ReactorStats Stats() const = 0;
+};
+
+/// <summary>
+/// Handle registrations shared by the reactor implementations. Entries removed
+/// while dispatching are only marked, and erased by Compact between waits, so a
+/// callback may unregister itself or others safely.
+/// Portable (no Windows dependencies).
+/// </summary>
+class ReactorHandlers
+{
+private:
+	struct Entry
+	{
+		EventReactor::RegistrationId Id;
+		NativeWaitHandle Handle;
+		EventReactor::Callback Callback;
+		bool Active;
+	};
+
+	std::vector<Entry> entries_;
+	EventReactor::RegistrationId nextId_ = 1;
+
+public:
+	EventReactor::RegistrationId Add(NativeWaitHandle handle, EventReactor::Callback callback);
+	void Remove(EventReactor::RegistrationId id);
+	void Compact();
+
+	// The active registrations' handles and ids, in registration order.
+	void Snapshot(std::vector<NativeWaitHandle>& handles, std::vector<EventReactor::RegistrationId>& ids) const;
+
+	// Runs the registration's callback; false if it has been removed meanwhile.
+	bool Invoke(EventReactor::RegistrationId id);
+};
+
+/// <summary>
+/// Callbacks posted to a reactor from any thread.
+/// Portable (no Windows dependencies).
+/// </summary>
+class ReactorTaskQueue
+{
+private:
+	std::mutex mutex_;
+	std::vector<EventReactor::Callback> tasks_;
+
+public:
+	// Returns true if the queue was empty (the reactor needs waking).
+	bool Push(EventReactor::Callback callback);
+
+	// Runs the tasks queued so far (not those they post); returns how many ran.
+	std::uint64_t RunAll();
+};
@@ -0,0 +1,128 @@
+#include <memory>
+#include <ostream>
+#include "FlightRecorder.h"
+
+namespace
+{
+	const char* const KindNames[static_cast<size_t>(FlightEventKind::Count)] =
+	{
+		"None",
+		"ToggleBegin",
+		"ToggleEnd",
+		"AutomationInit",
+		"ProcessSnapshot",
+		"OpenProcessFailed",
+		"ProcessLookup",
+		"FindAll",
+		"CandidateProbe",
+		"NativeWindowHandle",
+		"BoundingRect",
+		"TargetRect",
+		"RestoreWait",
+		"Cloak",
+		"SetWindowPos",
+		"Fade",
+		"SendBack",
+		"DpiTransition",
+		"Mirror",
+		"Deadline",
+		"JournalRead",
+		"PinCorrection",
+		"ShareFollow",
+	};
+}
+
+FlightRecorder& FlightRecorder::Instance()
+{
+	static FlightRecorder instance;
+	return instance;
+}
+
+const char* FlightRecorder::KindName(const FlightEventKind kind)
+{
+	const auto index = static_cast<size_t>(kind);
+	return index < static_cast<size_t>(FlightEventKind::Count) ? KindNames[index] : "Unknown";
+}
+
+/// <summary>
+/// Records one event. Safe to call from any thread.
+/// </summary>
+void FlightRecorder::Record(
+	const FlightEventKind kind, const std::int32_t code,
+	const std::int64_t a, const std::int64_t b, const std::int64_t c, const std::int64_t d)
+{
+	const std::uint64_t index = next_.fetch_add(1, std::memory_order_relaxed);
+	Slot& slot = slots_[index & (Capacity - 1)];
+
+	slot.Sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.TimeUs.store(NowUs(), std::memory_order_relaxed);
+	slot.Kind.store(static_cast<std::uint16_t>(kind), std::memory_order_relaxed);
+	slot.Code.store(code, std::memory_order_relaxed);
+	slot.Args[0].store(a, std::memory_order_relaxed);
+	slot.Args[1].store(b, std::memory_order_relaxed);
+	slot.Args[2].store(c, std::memory_order_relaxed);
+	slot.Args[3].store(d, std::memory_order_relaxed);
+
+	slot.Sequence.store(index + 1, std::memory_order_release);
+}
+
+/// <summary>
+/// Copies the events currently held, oldest first. Slots that are being
+/// overwritten while we read are skipped.
+/// </summary>
+size_t FlightRecorder::Snapshot(FlightEventRecord* out, const size_t maxEvents) const
+{
+	const std::uint64_t end = next_.load(std::memory_order_acquire);
+	const std::uint64_t begin = end > Capacity ? end - Capacity : 0;
+
+	size_t copied = 0;
+	for (std::uint64_t i = begin; i < end && copied < maxEvents; ++i)
+	{
+		const Slot& slot = slots_[i & (Capacity - 1)];
+		if (slot.Sequence.load(std::memory_order_acquire) != i + 1)
+		{
+			continue;
+		}
+
+		FlightEventRecord e{};
+		e.Sequence = i;
+		e.TimeUs = slot.TimeUs.load(std::memory_order_relaxed);
+		e.Kind = static_cast<FlightEventKind>(slot.Kind.load(std::memory_order_relaxed));
+		e.Code = slot.Code.load(std::memory_order_relaxed);
+		for (int n = 0; n < 4; ++n)
+		{
+			e.Args[n] = slot.Args[n].load(std::memory_order_relaxed);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.Sequence.load(std::memory_order_relaxed) != i + 1)
+		{
+			continue; // overwritten during the copy
+		}
+
+		out[copied++] = e;
+	}
+
+	return copied;
+}
+
+/// <summary>
+/// Writes the buffered events as text, one per line (code in hex so HRESULTs
+/// are readable).
+/// </summary>
+void FlightRecorder::Dump(std::ostream& out) const
+{
+	const auto events = std::make_unique<FlightEventRecord[]>(Capacity);
+	const size_t count = Snapshot(events.get(), Capacity);
+
+	out << "# seq time_us event code a b c d\n";
+	for (size_t i = 0; i < count; ++i)
+	{
+		const FlightEventRecord& e = events[i];
+		out << e.Sequence << ' ' << e.TimeUs << ' ' << KindName(e.Kind)
+			<< " 0x" << std::hex << static_cast<std::uint32_t>(e.Code) << std::dec
+			<< ' ' << e.Args[0] << ' ' << e.Args[1] << ' ' << e.Args[2] << ' ' << e.Args[3] << '\n';
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include "Stopwatch.h"
+
+enum class FlightEventKind : std::uint16_t
+{
+	None,
+	ToggleBegin,
+	ToggleEnd,             // code=error, a=allOk, b=totalUs, c=fallbacks
+	AutomationInit,        // code=hr, a=stage (0=CoInitializeEx, 1=CoInitializeSecurity, 2=CoCreateInstance, 3=GetRootElement, 4=timeouts)
+	ProcessSnapshot,       // code=lastError, a=processesScanned, b=matches
+	OpenProcessFailed,     // code=lastError, a=pid
+	ProcessLookup,         // a=handles, b=us
+	FindAll,               // code=hr, a=candidates, b=us
+	CandidateProbe,        // code=hr, a=index, b=hasConferenceControls, c=us
+	NativeWindowHandle,    // code=hr, a=hwnd
+	BoundingRect,          // code=hr, a..d=rect
+	TargetRect,            // a..d=rect
+	RestoreWait,           // a=hwnd, b=waitedMs, c=stillIconic
+	Cloak,                 // code=hr, a=hwnd
+	SetWindowPos,          // code=ok, a..d=left,top,width,height
+	Fade,                  // a=hwnd, b=steps, c=us
+	SendBack,              // a=hwnd, b=wasMinimized, c=fabricatedRect
+	DpiTransition,         // code=fromDpi, a=toDpi, b=resizeEvents, c=correctiveResize
+	Mirror,                // code=ok, a=hwnd, b=started, c=thumbnailUpdates
+	Deadline,              // code=status (0=completed, 1=timed out, 2=cancelled, 3=busy), a=deadlineMs, b=us
+	JournalRead,           // code=JournalMatch, a=hwnd, b=sequence, c=adopted
+	PinCorrection,         // code=ok, a=hwnd, b=latencyUs, c=backoffs
+	ShareFollow,           // code=shown (0=sent home), a=hwnd, b=eventToVisibleUs, c=fallbacks
+	Count
+};
+
+struct FlightEventRecord
+{
+	std::uint64_t Sequence;
+	std::int64_t TimeUs;
+	FlightEventKind Kind;
+	std::int32_t Code;
+	std::int64_t Args[4];
+};
+
+/// <summary>
+/// Always-on, fixed-size ring buffer of fine-grained toggle events. Writers
+/// claim a slot with one atomic increment and publish it with a sequence number,
+/// so recording is lock-free and allocation-free; the oldest events are
+/// overwritten. Portable (no Windows dependencies).
+/// </summary>
+class FlightRecorder
+{
+public:
+	static constexpr std::uint64_t Capacity = 1024; // power of two
+
+	static FlightRecorder& Instance();
+
+	void Record(FlightEventKind kind, std::int32_t code = 0,
+		std::int64_t a = 0, std::int64_t b = 0, std::int64_t c = 0, std::int64_t d = 0);
+
+	std::uint64_t EventCount() const { return next_.load(std::memory_order_acquire); }
+	std::int64_t NowUs() const { return clock_.ElapsedMicroseconds(); }
+
+	// Copies out the events still in the buffer (oldest first); returns the number copied.
+	size_t Snapshot(FlightEventRecord* out, size_t maxEvents) const;
+	void Dump(std::ostream& out) const;
+
+	static const char* KindName(FlightEventKind kind);
+
+private:
+	struct Slot
+	{
+		std::atomic<std::uint64_t> Sequence{ 0 }; // index + 1 once published, 0 while being written
+		std::atomic<std::int64_t> TimeUs{ 0 };
+		std::atomic<std::uint16_t> Kind{ 0 };
+		std::atomic<std::int32_t> Code{ 0 };
+		std::atomic<std::int64_t> Args[4]{};
+	};
+
+	Stopwatch clock_;
+	std::atomic<std::uint64_t> next_{ 0 };
+	std::array<Slot, Capacity> slots_;
+
+	FlightRecorder() = default;
+};
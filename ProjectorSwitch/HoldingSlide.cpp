@@ -0,0 +1,277 @@
+#include <cmath>
+#include <utility>
+#include "HoldingSlide.h"
+#include "WindowGeometry.h"
+
+namespace
+{
+	constexpr std::uint32_t Opaque = 0xFF000000u;
+
+	// Contributions of source pixels to one destination pixel along an axis.
+	struct Taps
+	{
+		int First = 0;
+		std::vector<float> Weights;
+	};
+
+	/// <summary>
+	/// Tent filter weights for resampling sourceSize pixels to destinationSize. The
+	/// filter widens with the reduction factor, so downscaling averages every source
+	/// pixel (no aliasing) and upscaling interpolates bilinearly.
+	/// </summary>
+	std::vector<Taps> ComputeTaps(const int sourceSize, const int destinationSize)
+	{
+		const double scale = static_cast<double>(sourceSize) / destinationSize;
+		const double radius = scale > 1.0 ? scale : 1.0;
+
+		std::vector<Taps> taps(static_cast<size_t>(destinationSize));
+		for (int d = 0; d < destinationSize; ++d)
+		{
+			const double center = (d + 0.5) * scale - 0.5;
+			int first = static_cast<int>(std::floor(center - radius)) + 1;
+			int last = static_cast<int>(std::ceil(center + radius)) - 1;
+			first = first < 0 ? 0 : first;
+			last = last >= sourceSize ? sourceSize - 1 : last;
+
+			Taps& t = taps[static_cast<size_t>(d)];
+			t.First = first;
+			double total = 0.0;
+			for (int s = first; s <= last; ++s)
+			{
+				const double w = 1.0 - std::fabs(s - center) / radius;
+				t.Weights.push_back(static_cast<float>(w > 0.0 ? w : 0.0));
+				total += t.Weights.back();
+			}
+
+			if (total <= 0.0)
+			{
+				// Only at the very edge: take the nearest pixel.
+				t.First = static_cast<int>(center + 0.5) < sourceSize ? static_cast<int>(center + 0.5) : sourceSize - 1;
+				t.First = t.First < 0 ? 0 : t.First;
+				t.Weights.assign(1, 1.0f);
+				continue;
+			}
+
+			for (auto& w : t.Weights)
+			{
+				w = static_cast<float>(w / total);
+			}
+		}
+
+		return taps;
+	}
+
+	float Channel(const std::uint32_t pixel, const int shift)
+	{
+		return static_cast<float>((pixel >> shift) & 0xFF);
+	}
+
+	std::uint32_t ToByte(const float value)
+	{
+		const float rounded = value + 0.5f;
+		return rounded <= 0.0f ? 0u : rounded >= 255.0f ? 255u : static_cast<std::uint32_t>(rounded);
+	}
+
+	/// <summary>
+	/// Resamples a premultiplied image (separably: rows, then columns).
+	/// </summary>
+	std::vector<std::uint32_t> Resample(const SlideImage& source, const int width, const int height)
+	{
+		const std::vector<Taps> xTaps = ComputeTaps(source.Width, width);
+		const std::vector<Taps> yTaps = ComputeTaps(source.Height, height);
+
+		// Horizontal pass: source.Height rows of width pixels, 4 channels each.
+		std::vector<float> rows(static_cast<size_t>(source.Height) * width * 4);
+		for (int y = 0; y < source.Height; ++y)
+		{
+			const std::uint32_t* in = &source.Pixels[static_cast<size_t>(y) * source.Width];
+			float* out = &rows[static_cast<size_t>(y) * width * 4];
+			for (int x = 0; x < width; ++x)
+			{
+				const Taps& t = xTaps[static_cast<size_t>(x)];
+				float acc[4] = {};
+				for (size_t i = 0; i < t.Weights.size(); ++i)
+				{
+					const std::uint32_t p = in[t.First + static_cast<int>(i)];
+					for (int c = 0; c < 4; ++c)
+					{
+						acc[c] += t.Weights[i] * Channel(p, 8 * c);
+					}
+				}
+
+				for (int c = 0; c < 4; ++c)
+				{
+					out[x * 4 + c] = acc[c];
+				}
+			}
+		}
+
+		// Vertical pass.
+		std::vector<std::uint32_t> pixels(static_cast<size_t>(width) * height);
+		for (int y = 0; y < height; ++y)
+		{
+			const Taps& t = yTaps[static_cast<size_t>(y)];
+			for (int x = 0; x < width; ++x)
+			{
+				float acc[4] = {};
+				for (size_t i = 0; i < t.Weights.size(); ++i)
+				{
+					const float* p = &rows[(static_cast<size_t>(t.First + static_cast<int>(i)) * width + x) * 4];
+					for (int c = 0; c < 4; ++c)
+					{
+						acc[c] += t.Weights[i] * p[c];
+					}
+				}
+
+				std::uint32_t pixel = 0;
+				for (int c = 0; c < 4; ++c)
+				{
+					pixel |= ToByte(acc[c]) << (8 * c);
+				}
+				pixels[static_cast<size_t>(y) * width + x] = pixel;
+			}
+		}
+
+		return pixels;
+	}
+
+	// Premultiplied source over an opaque background.
+	std::uint32_t Over(const std::uint32_t source, const std::uint32_t background)
+	{
+		const std::uint32_t inverseAlpha = 255 - (source >> 24);
+		std::uint32_t pixel = Opaque;
+		for (int c = 0; c < 3; ++c)
+		{
+			const std::uint32_t s = (source >> (8 * c)) & 0xFF;
+			const std::uint32_t b = (background >> (8 * c)) & 0xFF;
+			const std::uint32_t v = s + (b * inverseAlpha + 127) / 255;
+			pixel |= (v > 255 ? 255 : v) << (8 * c);
+		}
+		return pixel;
+	}
+}
+
+HoldingSlide::HoldingSlide(SlideImage source, const std::uint32_t background, const std::size_t capacity)
+	: source_(std::move(source))
+	, background_(background | Opaque)
+	, capacity_(capacity > 0 ? capacity : 1)
+	, renders_(0)
+{
+}
+
+const SlideImage& HoldingSlide::ForSize(const int width, const int height)
+{
+	for (auto it = entries_.begin(); it != entries_.end(); ++it)
+	{
+		if (it->Width == width && it->Height == height)
+		{
+			entries_.splice(entries_.begin(), entries_, it);
+			return entries_.front().Image;
+		}
+	}
+
+	if (entries_.size() >= capacity_)
+	{
+		entries_.pop_back();
+	}
+
+	++renders_;
+	entries_.push_front(Entry{ width, height, Render(source_, width, height, background_) });
+	return entries_.front().Image;
+}
+
+void HoldingSlide::Preload(SlideImage rendered)
+{
+	if (rendered.IsEmpty())
+	{
+		return;
+	}
+
+	for (auto it = entries_.begin(); it != entries_.end(); ++it)
+	{
+		if (it->Width == rendered.Width && it->Height == rendered.Height)
+		{
+			entries_.erase(it);
+			break;
+		}
+	}
+
+	if (entries_.size() >= capacity_)
+	{
+		entries_.pop_back();
+	}
+
+	const int width = rendered.Width;
+	const int height = rendered.Height;
+	entries_.push_front(Entry{ width, height, std::move(rendered) });
+}
+
+SlideImage HoldingSlide::Render(const SlideImage& source, const int width, const int height, const std::uint32_t background)
+{
+	SlideImage slide;
+	if (width <= 0 || height <= 0)
+	{
+		return slide;
+	}
+
+	slide.Width = width;
+	slide.Height = height;
+	slide.Pixels.assign(static_cast<size_t>(width) * height, background | Opaque);
+	if (source.IsEmpty() || source.Pixels.size() < static_cast<size_t>(source.Width) * source.Height)
+	{
+		return slide;
+	}
+
+	const ScreenRect fit = WindowGeometry::AspectFit(source.Width, source.Height, ScreenRect{ 0, 0, width, height });
+	if (fit.IsEmpty())
+	{
+		return slide;
+	}
+
+	const std::vector<std::uint32_t> scaled = Resample(source, fit.Width(), fit.Height());
+	for (int y = 0; y < fit.Height(); ++y)
+	{
+		for (int x = 0; x < fit.Width(); ++x)
+		{
+			slide.Pixels[static_cast<size_t>(fit.Top + y) * width + fit.Left + x] =
+				Over(scaled[static_cast<size_t>(y) * fit.Width() + x], background);
+		}
+	}
+
+	return slide;
+}
+
+bool HoldingSlide::ParseColor(const std::wstring& text, std::uint32_t& color)
+{
+	if (text.size() != 7 || text[0] != L'#')
+	{
+		return false;
+	}
+
+	std::uint32_t value = 0;
+	for (size_t i = 1; i < text.size(); ++i)
+	{
+		const wchar_t c = text[i];
+		std::uint32_t digit = 0;
+		if (c >= L'0' && c <= L'9')
+		{
+			digit = static_cast<std::uint32_t>(c - L'0');
+		}
+		else if (c >= L'a' && c <= L'f')
+		{
+			digit = static_cast<std::uint32_t>(c - L'a' + 10);
+		}
+		else if (c >= L'A' && c <= L'F')
+		{
+			digit = static_cast<std::uint32_t>(c - L'A' + 10);
+		}
+		else
+		{
+			return false;
+		}
+		value = (value << 4) | digit;
+	}
+
+	color = value;
+	return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+// Top-down 32-bit pixels, premultiplied 0xAARRGGBB (a 32bpp BGRA DIB on little-endian).
+struct SlideImage
+{
+	int Width = 0;
+	int Height = 0;
+	std::vector<std::uint32_t> Pixels;
+
+	bool IsEmpty() const { return Width <= 0 || Height <= 0; }
+};
+
+/// <summary>
+/// The holding slide shown on the projector while the media window is away: an
+/// image scaled to fit the monitor (letterboxed with the background colour), or
+/// just the colour. Rendering is done once per monitor resolution and cached, so
+/// showing the slide during a meeting never decodes or scales anything.
+/// Portable (no Windows dependencies).
+/// </summary>
+class HoldingSlide
+{
+private:
+	struct Entry
+	{
+		int Width;
+		int Height;
+		SlideImage Image;
+	};
+
+	SlideImage source_;
+	std::uint32_t background_;
+	std::size_t capacity_;
+	std::list<Entry> entries_; // most recently used first
+	std::uint64_t renders_;
+
+public:
+	static constexpr std::size_t DefaultCapacity = 4;
+
+	// source may be empty (a plain colour slide); background is opaque 0xRRGGBB.
+	HoldingSlide(SlideImage source, std::uint32_t background, std::size_t capacity = DefaultCapacity);
+
+	// The slide for a monitor of this size, rendered on first use (and again only if evicted).
+	const SlideImage& ForSize(int width, int height);
+
+	// Adds a slide rendered elsewhere (e.g. ahead of time on a worker thread).
+	void Preload(SlideImage rendered);
+
+	std::uint64_t Renders() const { return renders_; }
+
+	// Scales source (filtered, preserving its aspect ratio) centred onto an opaque
+	// width x height image of the background colour.
+	static SlideImage Render(const SlideImage& source, int width, int height, std::uint32_t background);
+
+	// Parses "#RRGGBB".
+	static bool ParseColor(const std::wstring& text, std::uint32_t& color);
+};
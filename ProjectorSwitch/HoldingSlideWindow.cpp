@@ -0,0 +1,211 @@
+#include <wincodec.h>
+#include <cstring>
+#include "HoldingSlideWindow.h"
+#include "TraceRecorder.h"
+
+#pragma comment(lib, "windowscodecs.lib")
+
+namespace
+{
+	const wchar_t* const SlideClassName = L"ProjectorSwitchHoldingSlide";
+}
+
+HoldingSlideWindow::HoldingSlideWindow(const std::wstring& imagePath, const std::uint32_t background, const ScreenRect& monitorRect)
+	: window_(nullptr)
+	, background_(background)
+	, uploaded_(nullptr)
+{
+	const int width = monitorRect.Width();
+	const int height = monitorRect.Height();
+	pending_ = std::async(std::launch::async, [imagePath, background, width, height]
+	{
+		Prepared prepared;
+		if (!imagePath.empty())
+		{
+			Decode(imagePath, prepared.Source);
+		}
+		prepared.Rendered = HoldingSlide::Render(prepared.Source, width, height, background);
+		return prepared;
+	});
+}
+
+HoldingSlideWindow::~HoldingSlideWindow()
+{
+	if (window_ != nullptr)
+	{
+		DestroyWindow(window_);
+		window_ = nullptr;
+	}
+}
+
+const wchar_t* HoldingSlideWindow::WindowClass()
+{
+	static const ATOM atom = []
+	{
+		WNDCLASSEXW windowClass{};
+		windowClass.cbSize = sizeof(windowClass);
+		windowClass.lpfnWndProc = DefWindowProcW;
+		windowClass.hInstance = GetModuleHandleW(nullptr);
+		windowClass.hCursor = LoadCursor(nullptr, IDC_ARROW);
+		windowClass.lpszClassName = SlideClassName;
+		return RegisterClassExW(&windowClass);
+	}();
+
+	return atom != 0 ? SlideClassName : nullptr;
+}
+
+/// <summary>
+/// Decodes an image file (any format WIC supports) to premultiplied BGRA.
+/// Runs on the worker thread, in its own apartment.
+/// </summary>
+bool HoldingSlideWindow::Decode(const std::wstring& imagePath, SlideImage& image)
+{
+	const HRESULT hrInit = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	IWICImagingFactory* factory = nullptr;
+	IWICBitmapDecoder* decoder = nullptr;
+	IWICBitmapFrameDecode* frame = nullptr;
+	IWICBitmapSource* converted = nullptr;
+	UINT width = 0;
+	UINT height = 0;
+	bool ok = false;
+	if (SUCCEEDED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory))) &&
+		SUCCEEDED(factory->CreateDecoderFromFilename(imagePath.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder)) &&
+		SUCCEEDED(decoder->GetFrame(0, &frame)) &&
+		SUCCEEDED(WICConvertBitmapSource(GUID_WICPixelFormat32bppPBGRA, frame, &converted)) &&
+		SUCCEEDED(converted->GetSize(&width, &height)) && width > 0 && height > 0)
+	{
+		image.Width = static_cast<int>(width);
+		image.Height = static_cast<int>(height);
+		image.Pixels.resize(static_cast<size_t>(width) * height);
+		ok = SUCCEEDED(converted->CopyPixels(nullptr, width * 4, static_cast<UINT>(image.Pixels.size() * 4),
+			reinterpret_cast<BYTE*>(image.Pixels.data())));
+		if (!ok)
+		{
+			image = SlideImage();
+		}
+	}
+
+	if (converted != nullptr)
+	{
+		converted->Release();
+	}
+	if (frame != nullptr)
+	{
+		frame->Release();
+	}
+	if (decoder != nullptr)
+	{
+		decoder->Release();
+	}
+	if (factory != nullptr)
+	{
+		factory->Release();
+	}
+
+	if (SUCCEEDED(hrInit))
+	{
+		CoUninitialize();
+	}
+
+	return ok;
+}
+
+/// <summary>
+/// Gives the layered window its pixels and position. The bitmap is only needed for
+/// the call: DWM keeps its own copy.
+/// </summary>
+bool HoldingSlideWindow::Upload(const SlideImage& image, const ScreenRect& monitorRect)
+{
+	TRACE_ZONE("HoldingSlideWindow::Upload");
+	BITMAPINFO info{};
+	info.bmiHeader.biSize = sizeof(info.bmiHeader);
+	info.bmiHeader.biWidth = image.Width;
+	info.bmiHeader.biHeight = -image.Height; // top-down
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	const HDC screen = GetDC(nullptr);
+	const HDC memory = CreateCompatibleDC(screen);
+	void* bits = nullptr;
+	const HBITMAP bitmap = CreateDIBSection(memory, &info, DIB_RGB_COLORS, &bits, nullptr, 0);
+	bool ok = false;
+	if (bitmap != nullptr && bits != nullptr)
+	{
+		std::memcpy(bits, image.Pixels.data(), image.Pixels.size() * sizeof(std::uint32_t));
+		const HGDIOBJ previous = SelectObject(memory, bitmap);
+
+		POINT position{ monitorRect.Left, monitorRect.Top };
+		SIZE size{ image.Width, image.Height };
+		POINT origin{ 0, 0 };
+		BLENDFUNCTION blend{ AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+		ok = UpdateLayeredWindow(window_, screen, &position, &size, memory, &origin, 0, &blend, ULW_ALPHA) != FALSE;
+
+		SelectObject(memory, previous);
+	}
+
+	if (bitmap != nullptr)
+	{
+		DeleteObject(bitmap);
+	}
+	DeleteDC(memory);
+	ReleaseDC(nullptr, screen);
+	return ok;
+}
+
+void HoldingSlideWindow::ShowBelow(const HWND window, const ScreenRect& monitorRect)
+{
+	TRACE_ZONE("HoldingSlideWindow::ShowBelow");
+	if (monitorRect.IsEmpty())
+	{
+		return;
+	}
+
+	if (pending_.valid())
+	{
+		// Normally finished long ago; otherwise this waits for the worker.
+		Prepared prepared = pending_.get();
+		slide_ = std::make_unique<HoldingSlide>(std::move(prepared.Source), background_);
+		slide_->Preload(std::move(prepared.Rendered));
+	}
+
+	if (window_ == nullptr)
+	{
+		const wchar_t* windowClass = WindowClass();
+		if (windowClass == nullptr)
+		{
+			return;
+		}
+
+		window_ = CreateWindowExW(
+			WS_EX_LAYERED | WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE,
+			windowClass,
+			L"ProjectorSwitch Holding Slide",
+			WS_POPUP,
+			monitorRect.Left, monitorRect.Top, monitorRect.Width(), monitorRect.Height(),
+			nullptr, nullptr, GetModuleHandleW(nullptr), nullptr);
+		if (window_ == nullptr)
+		{
+			return;
+		}
+	}
+
+	// The cache returns the same image for the same size, so unchanged monitors are not re-uploaded.
+	const SlideImage& image = slide_->ForSize(monitorRect.Width(), monitorRect.Height());
+	if (uploaded_ != &image && !Upload(image, monitorRect))
+	{
+		return;
+	}
+	uploaded_ = &image;
+
+	SetWindowPos(window_, window != nullptr ? window : HWND_TOPMOST, monitorRect.Left, monitorRect.Top, 0, 0,
+		SWP_NOSIZE | SWP_NOACTIVATE | SWP_SHOWWINDOW);
+}
+
+void HoldingSlideWindow::Hide()
+{
+	if (window_ != nullptr)
+	{
+		ShowWindow(window_, SW_HIDE);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <windows.h>
+#include <future>
+#include <memory>
+#include <string>
+#include "HoldingSlide.h"
+#include "WindowGeometry.h"
+
+/// <summary>
+/// Shows the holding slide full-screen on the projector while the media window is
+/// away. The window is layered and given its bitmap once per size with
+/// UpdateLayeredWindow, so DWM keeps the pixels and showing or repainting it costs
+/// nothing. The image is decoded and scaled for the first monitor on a worker
+/// thread as soon as the window is constructed.
+/// </summary>
+class HoldingSlideWindow  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	struct Prepared
+	{
+		SlideImage Source;
+		SlideImage Rendered;
+	};
+
+	HWND window_;
+	std::uint32_t background_;
+	std::future<Prepared> pending_;
+	std::unique_ptr<HoldingSlide> slide_;
+	const SlideImage* uploaded_;
+
+	static const wchar_t* WindowClass();
+	static bool Decode(const std::wstring& imagePath, SlideImage& image);
+	bool Upload(const SlideImage& image, const ScreenRect& monitorRect);
+
+public:
+	// imagePath may be empty for a plain background colour (0xRRGGBB) slide.
+	HoldingSlideWindow(const std::wstring& imagePath, std::uint32_t background, const ScreenRect& monitorRect);
+	~HoldingSlideWindow();
+
+	// Shows the slide covering the monitor, immediately below window in the topmost band,
+	// so that it is revealed (rather than the desktop) as window leaves.
+	void ShowBelow(HWND window, const ScreenRect& monitorRect);
+
+	void Hide();
+};
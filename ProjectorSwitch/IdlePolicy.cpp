@@ -0,0 +1,62 @@
+#include "IdlePolicy.h"
+
+IdlePolicy::IdlePolicy(const Clock::duration releaseAfter, const Clock::time_point now)
+	: releaseAfter_(releaseAfter)
+	, quietSince_(now)
+	, zoomPresent_(false)
+	, released_(false)
+{
+}
+
+IdleAction IdlePolicy::OnZoomPresence(const bool present, const Clock::time_point now)
+{
+	if (present)
+	{
+		zoomPresent_ = true;
+		if (released_)
+		{
+			released_ = false;
+			return IdleAction::Acquire;
+		}
+		return IdleAction::None;
+	}
+
+	if (zoomPresent_)
+	{
+		// Zoom has just gone; the release period starts now.
+		zoomPresent_ = false;
+		quietSince_ = now;
+	}
+
+	return OnTick(now);
+}
+
+IdleAction IdlePolicy::OnUserIntent(const Clock::time_point now)
+{
+	quietSince_ = now;
+	if (released_)
+	{
+		released_ = false;
+		return IdleAction::Acquire;
+	}
+	return IdleAction::None;
+}
+
+IdleAction IdlePolicy::OnTick(const Clock::time_point now)
+{
+	if (now >= NextRelease())
+	{
+		released_ = true;
+		return IdleAction::Release;
+	}
+	return IdleAction::None;
+}
+
+IdlePolicy::Clock::time_point IdlePolicy::NextRelease() const
+{
+	if (released_ || zoomPresent_ || releaseAfter_ <= Clock::duration::zero())
+	{
+		return Clock::time_point::max();
+	}
+	return quietSince_ + releaseAfter_;
+}
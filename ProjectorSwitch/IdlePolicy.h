@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+
+enum class IdleAction
+{
+	None,
+	Release, // tear down what is only needed while Zoom is running
+	Acquire  // build it again
+};
+
+/// <summary>
+/// Decides when to release resources that are only needed while a meeting may be
+/// toggled (UI Automation, caches) and when to acquire them again: released once
+/// Zoom has been absent for the release period with no user interest in toggling,
+/// acquired when Zoom appears or the user shows intent (e.g. hovers Toggle).
+/// Time is passed in, so the policy runs against a fake clock in tests.
+/// Portable (no Windows dependencies).
+/// </summary>
+class IdlePolicy
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+private:
+	Clock::duration releaseAfter_;
+	Clock::time_point quietSince_; // since when Zoom has been absent and the user inactive
+	bool zoomPresent_;
+	bool released_;
+
+public:
+	// A zero releaseAfter never releases. Zoom is assumed absent until observed.
+	IdlePolicy(Clock::duration releaseAfter, Clock::time_point now);
+
+	// The result of a presence check (e.g. a process snapshot).
+	IdleAction OnZoomPresence(bool present, Clock::time_point now);
+
+	// The user is about to toggle, or may be.
+	IdleAction OnUserIntent(Clock::time_point now);
+
+	// Periodic check; returns Release once the release period has passed.
+	IdleAction OnTick(Clock::time_point now);
+
+	// When OnTick would next release (time_point::max() if it will not without new input).
+	Clock::time_point NextRelease() const;
+
+	bool IsReleased() const { return released_; }
+};
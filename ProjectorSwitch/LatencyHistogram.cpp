@@ -0,0 +1,218 @@
+#include <bit>
+#include <cmath>
+#include "LatencyHistogram.h"
+#include "BinaryIo.h"
+
+LatencyHistogram::LatencyHistogram()
+{
+	Reset();
+}
+
+void LatencyHistogram::Reset()
+{
+	counts_.fill(0);
+	totalCount_ = 0;
+	sum_ = 0;
+	min_ = MaxTrackableValue;
+	max_ = 0;
+}
+
+/// <summary>
+/// Maps a value to its bucket. Values below 2 * SubBucketCount map one-to-one;
+/// above that each power of two is divided into SubBucketCount linear buckets.
+/// </summary>
+int LatencyHistogram::BucketIndex(std::uint64_t value)
+{
+	if (value > MaxTrackableValue)
+	{
+		value = MaxTrackableValue;
+	}
+
+	const int msb = static_cast<int>(std::bit_width(value)) - 1;
+	if (msb <= SubBucketBits)
+	{
+		return static_cast<int>(value);
+	}
+
+	const int shift = msb - SubBucketBits;
+	return (shift * SubBucketCount) + static_cast<int>(value >> shift);
+}
+
+/// <summary>
+/// Returns the highest value that maps to the given bucket.
+/// </summary>
+std::uint64_t LatencyHistogram::BucketUpperBound(const int index)
+{
+	if (index < 2 * SubBucketCount)
+	{
+		return static_cast<std::uint64_t>(index);
+	}
+
+	const int shift = (index / SubBucketCount) - 1;
+	const std::uint64_t subBucket = static_cast<std::uint64_t>(index - (shift * SubBucketCount));
+	return ((subBucket + 1) << shift) - 1;
+}
+
+/// <summary>
+/// Records one value (negative values are treated as zero, values beyond the
+/// trackable range are clamped).
+/// </summary>
+void LatencyHistogram::Record(const std::int64_t valueUs)
+{
+	std::uint64_t value = valueUs < 0 ? 0 : static_cast<std::uint64_t>(valueUs);
+	if (value > MaxTrackableValue)
+	{
+		value = MaxTrackableValue;
+	}
+
+	++counts_[static_cast<size_t>(BucketIndex(value))];
+	++totalCount_;
+	sum_ += value;
+
+	if (value < min_)
+	{
+		min_ = value;
+	}
+
+	if (value > max_)
+	{
+		max_ = value;
+	}
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+	for (size_t i = 0; i < counts_.size(); ++i)
+	{
+		counts_[i] += other.counts_[i];
+	}
+
+	totalCount_ += other.totalCount_;
+	sum_ += other.sum_;
+
+	if (other.totalCount_ > 0 && other.min_ < min_)
+	{
+		min_ = other.min_;
+	}
+
+	if (other.max_ > max_)
+	{
+		max_ = other.max_;
+	}
+}
+
+double LatencyHistogram::Mean() const
+{
+	return totalCount_ == 0 ? 0.0 : static_cast<double>(sum_) / static_cast<double>(totalCount_);
+}
+
+std::uint64_t LatencyHistogram::ValueAtPercentile(double percentile) const
+{
+	if (totalCount_ == 0)
+	{
+		return 0;
+	}
+
+	if (percentile < 0.0)
+	{
+		percentile = 0.0;
+	}
+	else if (percentile > 100.0)
+	{
+		percentile = 100.0;
+	}
+
+	auto target = static_cast<std::uint64_t>(std::ceil((percentile / 100.0) * static_cast<double>(totalCount_)));
+	if (target == 0)
+	{
+		target = 1;
+	}
+
+	std::uint64_t cumulative = 0;
+	for (int i = 0; i < BucketCount; ++i)
+	{
+		cumulative += counts_[static_cast<size_t>(i)];
+		if (cumulative >= target)
+		{
+			const std::uint64_t upper = BucketUpperBound(i);
+			return upper < max_ ? upper : max_;
+		}
+	}
+
+	return max_;
+}
+
+/// <summary>
+/// Writes the histogram in sparse form: summary fields, the number of non-empty
+/// buckets, then (index, count) pairs.
+/// </summary>
+void LatencyHistogram::Write(std::ostream& out) const
+{
+	BinaryIo::WriteU64(out, totalCount_);
+	BinaryIo::WriteU64(out, sum_);
+	BinaryIo::WriteU64(out, min_);
+	BinaryIo::WriteU64(out, max_);
+
+	std::uint32_t nonEmpty = 0;
+	for (const auto c : counts_)
+	{
+		if (c != 0)
+		{
+			++nonEmpty;
+		}
+	}
+
+	BinaryIo::WriteU32(out, nonEmpty);
+	for (size_t i = 0; i < counts_.size(); ++i)
+	{
+		if (counts_[i] != 0)
+		{
+			BinaryIo::WriteU32(out, static_cast<std::uint32_t>(i));
+			BinaryIo::WriteU64(out, counts_[i]);
+		}
+	}
+}
+
+/// <summary>
+/// Reads a histogram written by Write, replacing the current contents.
+/// Returns false (leaving the histogram empty) if the data is truncated or invalid.
+/// </summary>
+bool LatencyHistogram::Read(std::istream& in)
+{
+	Reset();
+
+	std::uint32_t nonEmpty = 0;
+	if (!BinaryIo::ReadU64(in, totalCount_) ||
+		!BinaryIo::ReadU64(in, sum_) ||
+		!BinaryIo::ReadU64(in, min_) ||
+		!BinaryIo::ReadU64(in, max_) ||
+		!BinaryIo::ReadU32(in, nonEmpty) ||
+		nonEmpty > static_cast<std::uint32_t>(BucketCount))
+	{
+		Reset();
+		return false;
+	}
+
+	std::uint64_t countedTotal = 0;
+	for (std::uint32_t n = 0; n < nonEmpty; ++n)
+	{
+		std::uint32_t index = 0;
+		std::uint64_t count = 0;
+		if (!BinaryIo::ReadU32(in, index) || !BinaryIo::ReadU64(in, count) || index >= static_cast<std::uint32_t>(BucketCount))
+		{
+			Reset();
+			return false;
+		}
+
+		counts_[index] = count;
+		countedTotal += count;
+	}
+
+	if (countedTotal != totalCount_)
+	{
+		Reset();
+		return false;
+	}
+
+	return true;
+}
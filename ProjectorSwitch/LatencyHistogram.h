@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+
+/// <summary>
+/// HDR-style log-linear histogram of microsecond latencies. Each power of two is
+/// split into 32 linear sub-buckets (about 3% relative precision) up to ~19 hours.
+/// Recording never allocates. Portable (no Windows dependencies).
+/// </summary>
+class LatencyHistogram
+{
+public:
+	static constexpr int SubBucketBits = 5;
+	static constexpr int SubBucketCount = 1 << SubBucketBits;
+	static constexpr int MaxValueBits = 36;
+	static constexpr int BucketCount = (MaxValueBits - SubBucketBits + 1) * SubBucketCount;
+	static constexpr std::uint64_t MaxTrackableValue = (std::uint64_t{ 1 } << MaxValueBits) - 1;
+
+	LatencyHistogram();
+
+	void Record(std::int64_t valueUs);
+	void Merge(const LatencyHistogram& other);
+	void Reset();
+
+	std::uint64_t TotalCount() const { return totalCount_; }
+	std::uint64_t Min() const { return totalCount_ == 0 ? 0 : min_; }
+	std::uint64_t Max() const { return max_; }
+	double Mean() const;
+
+	// Returns the value at the given percentile (0..100), reported as the upper
+	// bound of the containing bucket and clamped to the recorded maximum.
+	std::uint64_t ValueAtPercentile(double percentile) const;
+
+	void Write(std::ostream& out) const;
+	bool Read(std::istream& in);
+
+	static int BucketIndex(std::uint64_t value);
+	static std::uint64_t BucketUpperBound(int index);
+
+private:
+	std::array<std::uint64_t, BucketCount> counts_;
+	std::uint64_t totalCount_;
+	std::uint64_t sum_;
+	std::uint64_t min_;
+	std::uint64_t max_;
+};
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cwchar>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LogBenchmark.h"
+#include "DeferredLog.h"
+
+namespace
+{
+	// Calls per timed batch; well under DeferredLog::Capacity, so nothing is dropped.
+	constexpr int BatchSize = 64;
+
+	const wchar_t* const Detail = L"warm start";
+
+	/// <summary>
+	/// Times batches of calls (prepare runs untimed before each one) and writes the
+	/// per-call cost percentiles.
+	/// </summary>
+	template <typename Call, typename Prepare>
+	void Measure(std::ostream& out, const char* name, const int batches, Call call, Prepare prepare)
+	{
+		std::vector<double> nsPerCall;
+		nsPerCall.reserve(static_cast<size_t>(batches));
+		for (int b = 0; b < batches; ++b)
+		{
+			prepare();
+			const auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < BatchSize; ++i)
+			{
+				call(static_cast<long long>(b) * BatchSize + i);
+			}
+			const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+			nsPerCall.push_back(elapsed / BatchSize);
+		}
+
+		std::sort(nsPerCall.begin(), nsPerCall.end());
+		const auto at = [&nsPerCall](const double percentile)
+		{
+			return nsPerCall.empty() ? 0.0 : nsPerCall[static_cast<size_t>(percentile / 100.0 * static_cast<double>(nsPerCall.size() - 1))];
+		};
+
+		out << "{\"strategy\":\"" << name << "\""
+			<< ",\"calls\":" << static_cast<long long>(batches) * BatchSize
+			<< ",\"p50_ns_per_call\":" << at(50)
+			<< ",\"p99_ns_per_call\":" << at(99)
+			<< ",\"max_ns_per_call\":" << at(100)
+			<< "}\n";
+	}
+}
+
+bool LogBenchmark::Run(std::ostream& out, const DirectFunction& direct, const int batches)
+{
+	bool delivered = false;
+	{
+		// Its own instance, so the application log is not involved.
+		DeferredLog log;
+		std::atomic<long long> received{ 0 };
+		long long written = 0;
+		log.Start([&received](DeferredLogLevel, const std::wstring&) { received.fetch_add(1, std::memory_order_relaxed); });
+
+		Measure(out, "deferred", batches,
+			[&log, &written](const long long value)
+			{
+				log.Write(DeferredLogLevel::Info, L"Toggle completed in %lld us (%ls)", value, Detail);
+				++written;
+			},
+			[&log, &received, &written]
+			{
+				// The background thread catches up between batches (a dropped message never arrives).
+				while (received.load(std::memory_order_relaxed) + static_cast<long long>(log.Dropped()) < written)
+				{
+					std::this_thread::yield();
+				}
+			});
+		log.Stop();
+
+		// Each batch is a burst: ideally one wakeup per batch, plus the one to stop.
+		out << "{\"strategy\":\"deferred\",\"wakeups\":" << log.Wakeups()
+			<< ",\"dropped\":" << log.Dropped() << "}\n";
+		delivered = log.Dropped() == 0 && received.load(std::memory_order_relaxed) == written;
+	}
+
+	wchar_t buffer[256];
+	Measure(out, "format-only", batches,
+		[&buffer](const long long value) { std::swprintf(buffer, 256, L"Toggle completed in %lld us (%ls)", value, Detail); },
+		[] {});
+
+	if (direct)
+	{
+		Measure(out, "direct", batches, [&direct](const long long value) { direct(value, Detail); }, [] {});
+	}
+
+	return delivered;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <functional>
+#include <ostream>
+
+/// <summary>
+/// Compares the caller's cost of logging a typical toggle message through
+/// DeferredLog with formatting it in place and with a direct, synchronous logging
+/// call (supplied by the caller: the application log on Windows, a flushed file
+/// elsewhere). Reports nanoseconds per call, and the deferred log's wakeups, as JSON
+/// lines.
+/// Portable (no Windows dependencies).
+/// </summary>
+class LogBenchmark
+{
+public:
+	// Logs L"Toggle completed in %lld us (%ls)" with the given values.
+	using DirectFunction = std::function<void(long long totalUs, const wchar_t* detail)>;
+
+	static constexpr int DefaultBatches = 2000;
+
+	// False if the deferred log dropped or lost a message.
+	static bool Run(std::ostream& out, const DirectFunction& direct, int batches = DefaultBatches);
+};
@@ -0,0 +1,62 @@
+#include "MappedFile.h"
+
+MappedFile::MappedFile(const std::wstring& path, const std::size_t size)
+	: file_(INVALID_HANDLE_VALUE)
+	, mapping_(nullptr)
+	, view_(nullptr)
+	, size_(size)
+{
+	file_ = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	// A mapping larger than the file extends it (with zeros); a smaller one leaves it as is.
+	ULARGE_INTEGER mappingSize{};
+	mappingSize.QuadPart = size;
+	mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READWRITE, mappingSize.HighPart, mappingSize.LowPart, nullptr);
+	if (mapping_ == nullptr)
+	{
+		return;
+	}
+
+	view_ = static_cast<std::uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size));
+}
+
+MappedFile::~MappedFile()
+{
+	if (view_ != nullptr)
+	{
+		UnmapViewOfFile(view_);
+	}
+
+	if (mapping_ != nullptr)
+	{
+		CloseHandle(mapping_);
+	}
+
+	if (file_ != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file_);
+	}
+}
+
+/// <summary>
+/// Queues the range's dirty pages for writing. FlushFileBuffers is not called: it
+/// waits for the device, which would put a disk write on the caller's path, and
+/// only adds durability against losing the whole system. The view's pages are the
+/// file's cache pages, so a crash or forced logoff of this process loses nothing,
+/// and records kept here (the session journal) are worthless after a power loss or
+/// system crash anyway, as the windows they describe are gone.
+/// </summary>
+bool MappedFile::Flush(const std::size_t offset, const std::size_t length) const
+{
+	if (view_ == nullptr || offset + length > size_)
+	{
+		return false;
+	}
+
+	return FlushViewOfFile(view_ + offset, length) != FALSE;
+}
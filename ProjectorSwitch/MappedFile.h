@@ -0,0 +1,33 @@
+#pragma once
+#include <windows.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// A fixed-size file mapped read/write into memory (created zero-filled if missing).
+/// Used for small records that must survive a crash of the process writing them.
+/// </summary>
+class MappedFile  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+	MappedFile(const std::wstring& path, std::size_t size);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Null if the file could not be opened or mapped.
+	std::uint8_t* Data() const { return view_; }
+	std::size_t Size() const { return size_; }
+
+	// Starts writing the range to the file. Once written to the view, data already
+	// survives a crash of this process; this only hastens it reaching the disk.
+	bool Flush(std::size_t offset, std::size_t length) const;
+
+private:
+	HANDLE file_;
+	HANDLE mapping_;
+	std::uint8_t* view_;
+	std::size_t size_;
+};
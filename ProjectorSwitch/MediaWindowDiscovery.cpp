@@ -0,0 +1,98 @@
+#include "MediaWindowDiscovery.h"
+#include "Stopwatch.h"
+#include "TraceRecorder.h"
+
+/// <summary>
+/// Finds all top-level windows matching the selector name/class. A single match
+/// is assumed to be the media window; with several, the candidates are probed for
+/// main-window marker controls as the strategy directs. A candidate that can no
+/// longer be obtained is skipped.
+/// </summary>
+/// <param name="backend">Desktop access.</param>
+/// <param name="selectors">What to look for.</param>
+/// <param name="cancel">Stops the search between backend calls.</param>
+/// <param name="strategy">The order in which candidates are probed.</param>
+/// <returns>The candidate count and the selected candidate index (or -1).</returns>
+DiscoveryOutcome MediaWindowDiscovery::Locate(DiscoveryBackend& backend, const MediaWindowSelectors& selectors,
+	const CancellationToken& cancel, const DiscoveryStrategy strategy)
+{
+	TRACE_ZONE("MediaWindowDiscovery::Locate");
+	DiscoveryOutcome outcome;
+
+	const Stopwatch findClock;
+	outcome.CandidateCount = backend.FindCandidates(selectors);
+	outcome.FindUs = findClock.ElapsedMicroseconds();
+
+	if (cancel.IsCancelled())
+	{
+		outcome.Cancelled = true;
+		return outcome;
+	}
+
+	if (outcome.CandidateCount <= 0)
+	{
+		return outcome;
+	}
+
+	// If only one window found, assume it's the media window
+	if (outcome.CandidateCount == 1)
+	{
+		outcome.SelectedIndex = 0;
+		return outcome;
+	}
+
+	// Multiple windows found - need to identify which is the main window
+	TRACE_ZONE("MediaWindowDiscovery::Identify");
+	const Stopwatch identifyClock;
+	int unmarked = 0;
+	int firstUnmarked = -1;
+	for (int n = 0; n < outcome.CandidateCount; ++n)
+	{
+		if (cancel.IsCancelled())
+		{
+			outcome.Cancelled = true;
+			break;
+		}
+
+		const int i = strategy == DiscoveryStrategy::Reverse ? outcome.CandidateCount - 1 - n : n;
+		++outcome.Probes;
+
+		// A failed search is treated like "no marker", as the main window always exposes them.
+		const int marker = backend.CandidateHasMainWindowMarker(i, selectors);
+		if (marker == 1 || marker == DiscoveryBackend::CandidateUnavailable)
+		{
+			continue;
+		}
+
+		if (strategy != DiscoveryStrategy::ProbeAll)
+		{
+			outcome.SelectedIndex = i;
+			break;
+		}
+
+		if (unmarked++ == 0)
+		{
+			firstUnmarked = i;
+		}
+	}
+
+	if (strategy == DiscoveryStrategy::ProbeAll && !outcome.Cancelled && unmarked == 1)
+	{
+		outcome.SelectedIndex = firstUnmarked;
+	}
+	outcome.IdentifyUs = identifyClock.ElapsedMicroseconds();
+
+	return outcome;
+}
+
+const char* MediaWindowDiscovery::StrategyName(const DiscoveryStrategy strategy)
+{
+	switch (strategy)
+	{
+	case DiscoveryStrategy::InOrder: return "in-order";
+	case DiscoveryStrategy::Reverse: return "reverse";
+	case DiscoveryStrategy::ProbeAll: return "probe-all";
+	}
+
+	return "?";
+}
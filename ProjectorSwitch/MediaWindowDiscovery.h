@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include "Deadline.h"
+#include "DiscoveryBackend.h"
+#include "MediaWindowSelectors.h"
+
+struct DiscoveryOutcome
+{
+	int CandidateCount = 0;      // -1 if the top-level search failed
+	int SelectedIndex = -1;      // index of the media window among the candidates
+	int Probes = 0;              // candidates searched for main-window markers
+	bool Cancelled = false;      // stopped before a window was selected
+	std::int64_t FindUs = 0;
+	std::int64_t IdentifyUs = 0;
+};
+
+// How candidates are probed for main-window markers when there are several.
+enum class DiscoveryStrategy : std::uint8_t
+{
+	InOrder,  // in the order found, selecting the first without a marker (used by ZoomService)
+	Reverse,  // likewise from the last found (the media window is usually opened last)
+	ProbeAll  // every candidate, selecting one only if it is the only one without a marker
+};
+
+/// <summary>
+/// Media window discovery logic, independent of how the desktop is accessed.
+/// Portable (no Windows dependencies).
+/// </summary>
+class MediaWindowDiscovery
+{
+public:
+	// The token is checked between backend calls (a call in progress is not interrupted).
+	static DiscoveryOutcome Locate(DiscoveryBackend& backend, const MediaWindowSelectors& selectors,
+		const CancellationToken& cancel = CancellationToken(), DiscoveryStrategy strategy = DiscoveryStrategy::InOrder);
+
+	static const char* StrategyName(DiscoveryStrategy strategy);
+};
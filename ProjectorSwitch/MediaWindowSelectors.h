@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Describes how to recognise a conferencing app's media (second) window.
+struct MediaWindowSelectors
+{
+	std::wstring WindowName;
+	std::wstring WindowClassName;
+
+	// HelpText values of controls that exist only in the main conference window,
+	// used to tell it apart when several windows match name and class.
+	std::vector<std::wstring> MainWindowHelpTexts;
+
+	static MediaWindowSelectors Zoom()
+	{
+		// The class name and name may vary based on the Zoom version and configuration!
+		return MediaWindowSelectors
+		{
+			L"Zoom Meeting",
+			L"ConfMultiTabContentWndClass",
+			{
+				L"{\"controlID\":\"btn_conf_info\",\"isEnabled\":true}",
+				L"{\"controlID\":\"conf_title\",\"isEnabled\":true}",
+			}
+		};
+	}
+
+	static MediaWindowSelectors ZoomShare()
+	{
+		// The window another participant's shared screen is viewed in (a separate window,
+		// e.g. with dual monitors). The class name may vary based on the Zoom version!
+		return MediaWindowSelectors
+		{
+			L"",
+			L"ZPContentViewWndClass",
+			{}
+		};
+	}
+};
@@ -0,0 +1,391 @@
+#include <memory>
+#include <vector>
+#include "MediaWindowToggle.h"
+#include "FlightRecorder.h"
+#include "Stopwatch.h"
+#include "TraceRecorder.h"
+
+namespace
+{
+	// Used when the toggle is constructed without an observer.
+	MediaWindowToggle::Observer NoObserver;
+
+	std::int64_t HandleValue(const PlatformWindow window)
+	{
+		return static_cast<std::int64_t>(window);
+	}
+}
+
+void MediaWindowToggle::Observer::Mirror(PlatformWindow, const ScreenRect&, DisplayWindowResult& result)
+{
+	result.Fail(DisplayWindowError::MirrorUnavailable, L"Could not mirror the Zoom media window.");
+}
+
+MediaWindowToggle::MediaWindowToggle(PlatformBackend& platform, ProviderRegistry& providers, Observer* observer)
+	: platform_(platform)
+	, providers_(providers)
+	, observer_(observer != nullptr ? observer : &NoObserver)
+{
+}
+
+/// <summary>
+/// Performs the toggle: finds the media window, then sends it back if it is already
+/// on the projector, or moves it there.
+/// </summary>
+/// <param name="result">Receives the outcome, stage timings and fallback paths taken.</param>
+void MediaWindowToggle::Run(DisplayWindowResult& result)
+{
+	if (!FindMediaWindow(result))
+	{
+		return;
+	}
+
+	const ScreenRect monitorRect = platform_.LoadTargetMonitorRect();
+	if (monitorRect.IsEmpty())
+	{
+		result.Fail(DisplayWindowError::TargetMonitorNotFound, L"Could not find target monitor!");
+		return;
+	}
+
+	PlatformWindow window = 0;
+	const PlatformResult windowRead = platform_.ReadElementWindow(window);
+	if (windowRead == PlatformResult::TimedOut)
+	{
+		result.Fail(DisplayWindowError::DeadlineExceeded, L"Zoom did not respond in time (UiaDeadlineMs).");
+		return;
+	}
+
+	if (windowRead != PlatformResult::Ok || window == 0)
+	{
+		result.Fail(DisplayWindowError::NoNativeWindowHandle, L"Could not get native window handle for Zoom media window.");
+		return;
+	}
+
+	if (!platform_.IsWindow(window))
+	{
+		result.Fail(DisplayWindowError::InvalidWindowHandle, L"Native window handle is not a valid window.");
+		return;
+	}
+
+	if (platform_.LoadMirrorMode())
+	{
+		observer_->Mirror(window, monitorRect, result);
+		return;
+	}
+
+	ScreenRect windowRect;
+	const PlatformResult rectRead = platform_.ReadElementRect(windowRect);
+	if (rectRead == PlatformResult::TimedOut)
+	{
+		result.Fail(DisplayWindowError::DeadlineExceeded, L"Zoom did not respond in time (UiaDeadlineMs).");
+		return;
+	}
+
+	if (rectRead != PlatformResult::Ok)
+	{
+		result.Fail(DisplayWindowError::NoWindowPosition, L"Could not get position of Zoom media window.");
+		return;
+	}
+
+	const unsigned targetDpi = platform_.MonitorDpi(monitorRect);
+	const ScreenRect targetRect = TargetRect(monitorRect, window, targetDpi);
+	FlightRecorder::Instance().Record(FlightEventKind::TargetRect, 0,
+		targetRect.Left, targetRect.Top, targetRect.Right, targetRect.Bottom);
+
+	const Stopwatch moveClock;
+	if (targetRect == windowRect)
+	{
+		// already displayed
+		observer_->OnSendingBack(window, monitorRect, placement_);
+		SendBack(window, result);
+		observer_->OnSentBack(window, placement_);
+		result.Placement = MediaWindowPlacement::Restored;
+	}
+	else
+	{
+		placement_.WasMinimized = platform_.IsMinimized(window);
+		placement_.Rect = windowRect;
+		WindowPlacementInfo current;
+		placement_.ShowState = platform_.GetWindowPlacement(window, current) ? current.ShowState : WindowShowState::Normal;
+		observer_->OnDisplaying(window, placement_);
+		Display(window, targetRect, targetDpi, result);
+		observer_->OnDisplayed(window, targetRect);
+		result.Placement = MediaWindowPlacement::OnProjector;
+	}
+	result.Timings.MoveUs = moveClock.ElapsedMicroseconds();
+
+	observer_->OnToggled(window, result.Fallbacks);
+	result.AllOk = true;
+}
+
+/// <summary>
+/// Finds the media window (the observer's warm start window, or the first running
+/// provider's by searching) and makes it the backend's current element.
+/// </summary>
+/// <returns>True if found; otherwise result has failed.</returns>
+bool MediaWindowToggle::FindMediaWindow(DisplayWindowResult& result)
+{
+	TRACE_ZONE("MediaWindowToggle::FindMediaWindow");
+	if (!platform_.HasAutomation())
+	{
+		result.Fail(DisplayWindowError::AutomationUnavailable, L"AutomationService is not initialized.");
+		return false;
+	}
+
+	if (!platform_.ConnectDesktop())
+	{
+		result.Fail(DisplayWindowError::DesktopUnavailable, L"Failed to get Desktop Element.");
+		return false;
+	}
+
+	const PlatformWindow cachedWindow = observer_->WarmStartWindow();
+	if (cachedWindow != 0)
+	{
+		if (platform_.AdoptWindowElement(cachedWindow) == PlatformResult::Ok)
+		{
+			// The cached window's process is checked by validation, so there is no snapshot either.
+			result.Fallbacks |= ToggleFallbackWarmStart;
+			result.Presence = ZoomPresence::Running;
+			return true;
+		}
+
+		observer_->WarmStartUnavailable();
+	}
+
+	// Providers that are not running are never searched (or their selectors loaded).
+	const Stopwatch snapshotClock;
+	const std::vector<int> runningProviders = providers_.Resolve(platform_.ProcessNames());
+	result.Timings.ProcessSnapshotUs = snapshotClock.ElapsedMicroseconds();
+	FlightRecorder::Instance().Record(FlightEventKind::ProcessLookup, 0,
+		static_cast<std::int64_t>(runningProviders.size()), result.Timings.ProcessSnapshotUs);
+
+	if (runningProviders.empty())
+	{
+		result.Presence = ZoomPresence::NotRunning;
+		result.Fail(DisplayWindowError::ZoomNotRunning, L"Zoom is not running!");
+		return false;
+	}
+
+	std::vector<std::shared_ptr<const MediaWindowSelectors>> selectors;
+	for (const int provider : runningProviders)
+	{
+		selectors.push_back(providers_.Selectors(provider));
+	}
+
+	const Stopwatch discoveryClock;
+	DiscoveryOutcome outcome;
+	const OperationStatus status = platform_.LocateMediaWindow(selectors, outcome);
+	result.Timings.DiscoveryUs = discoveryClock.ElapsedMicroseconds();
+
+	if (status == OperationStatus::Busy)
+	{
+		result.Fail(DisplayWindowError::DeadlineExceeded, L"Zoom is still not responding to the previous search.");
+		return false;
+	}
+
+	if (status != OperationStatus::Completed)
+	{
+		result.Fail(DisplayWindowError::DeadlineExceeded, L"Zoom did not respond in time (UiaDeadlineMs).");
+		return false;
+	}
+
+	result.Presence = ZoomPresence::Running;
+	if (outcome.CandidateCount == 1)
+	{
+		result.Fallbacks |= ToggleFallbackSingleCandidate;
+	}
+	else if (outcome.CandidateCount > 1)
+	{
+		result.Fallbacks |= ToggleFallbackMultipleCandidates;
+		result.Timings.IdentifyUs = outcome.IdentifyUs;
+	}
+
+	if (outcome.SelectedIndex < 0 || outcome.Cancelled)
+	{
+		result.Fail(DisplayWindowError::MediaWindowNotFound, L"Could not find Zoom media window!");
+		return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Calculates the target rectangle for a window so that its client area exactly
+/// covers the given monitor rectangle, with the window's non-client borders outside it.
+/// </summary>
+/// <param name="monitorRect">The target monitor's rectangle.</param>
+/// <param name="window">The window whose borders are to be considered.</param>
+/// <param name="targetDpi">The DPI of the target monitor (frame sizes scale with DPI).</param>
+ScreenRect MediaWindowToggle::TargetRect(const ScreenRect& monitorRect, const PlatformWindow window, const unsigned targetDpi)
+{
+	TRACE_ZONE("MediaWindowToggle::TargetRect");
+	return WindowGeometry::TargetRect(monitorRect, platform_.WindowFrameMetrics(window, targetDpi));
+}
+
+/// <summary>
+/// Calculates a suitable position on the primary monitor for a window whose original
+/// position is unknown.
+/// </summary>
+ScreenRect MediaWindowToggle::FallbackRestoreRect(const PlatformWindow window)
+{
+	return WindowGeometry::FallbackRestoreRect(platform_.PrimaryWorkArea(), platform_.WindowFrameMetrics(window, platform_.SystemDpi()));
+}
+
+/// <summary>
+/// Returns the window to its placement before it was moved, making one up on the
+/// primary monitor if that is unknown.
+/// </summary>
+/// <param name="window">The window on the projector.</param>
+/// <param name="result">Receives the fallback paths taken.</param>
+void MediaWindowToggle::SendBack(const PlatformWindow window, DisplayWindowResult& result)
+{
+	TRACE_ZONE("MediaWindowToggle::SendBack");
+	// If it was originally minimized, minimize again, but make sure its normal position is on the primary monitor.
+	if (placement_.WasMinimized)
+	{
+		result.Fallbacks |= ToggleFallbackMinimizedSendBack;
+
+		// Place the window's normal (restore) position on the primary monitor so future restores happen there.
+		const ScreenRect restoreRect = FallbackRestoreRect(window);
+
+		platform_.SetWindowPlacement(window, WindowPlacementInfo{ WindowShowState::Normal, restoreRect });
+
+		// Drop out of topmost band before minimizing.
+		platform_.LowerFromTopmost(window);
+		platform_.Minimize(window);
+		placement_.WasMinimized = false;
+		FlightRecorder::Instance().Record(FlightEventKind::SendBack, 0, HandleValue(window), 1, 0);
+		return;
+	}
+
+	platform_.Activate(window);
+
+	const bool fabricated = placement_.Rect.IsEmpty();
+	if (fabricated)
+	{
+		// fabricate a suitable location on the primary monitor
+		result.Fallbacks |= ToggleFallbackFabricatedRestoreRect;
+		placement_.Rect = FallbackRestoreRect(window);
+	}
+
+	platform_.RestoreWindow(window, placement_.Rect);
+
+	if (placement_.ShowState == WindowShowState::Maximized)
+	{
+		platform_.Maximize(window);
+	}
+
+	FlightRecorder::Instance().Record(FlightEventKind::SendBack, 0, HandleValue(window), 0, fabricated ? 1 : 0);
+}
+
+/// <summary>
+/// Displays a window at a specified position and size with a smooth fade-in animation, handling DWM
+/// transitions and window cloaking for a seamless visual effect.
+/// </summary>
+/// <param name="window">The window to be displayed and animated.</param>
+/// <param name="targetRect">The target window rectangle, in screen coordinates.</param>
+/// <param name="targetDpi">The DPI of the monitor containing targetRect.</param>
+/// <param name="result">Receives the fallback paths taken and when the window became opaque.</param>
+void MediaWindowToggle::Display(const PlatformWindow window, const ScreenRect& targetRect, const unsigned targetDpi, DisplayWindowResult& result)
+{
+	TRACE_ZONE("MediaWindowToggle::Display");
+	if (!platform_.IsWindow(window))
+	{
+		return;
+	}
+
+	WindowTransition::Begin(platform_, window);
+
+	// If minimized, restore first so the move will take effect correctly.
+	if (platform_.IsMinimized(window))
+	{
+		TRACE_ZONE("Display.RestoreWait");
+		result.Fallbacks |= ToggleFallbackRestoredFromMinimized;
+		const unsigned waited = WindowTransition::RestoreFromMinimized(platform_, window);
+		FlightRecorder::Instance().Record(FlightEventKind::RestoreWait, 0,
+			HandleValue(window), waited, platform_.IsMinimized(window) ? 1 : 0);
+	}
+
+	// Cloak to avoid intermediate frames while moving/sizing (Win8+). Fallback to hide.
+	WindowTransitionState transition = WindowTransition::Conceal(platform_, window);
+	if (!transition.Cloaked)
+	{
+		result.Fallbacks |= ToggleFallbackHiddenInsteadOfCloaked;
+	}
+
+	// Reposition/resize while hidden/cloaked.
+	MoveAcrossDpi(window, targetRect, targetDpi, result);
+
+	// Uncloak or show transparent and allow activation so we can become topmost of the topmost band.
+	WindowTransition::PrepareFadeIn(platform_, transition);
+	WindowTransition::Reveal(platform_, transition);
+	platform_.ForceToForeground(window);
+
+	// If alpha was set successfully, animate to full opacity.
+	if (transition.AlphaOk)
+	{
+		TRACE_ZONE("Display.Fade");
+		const Stopwatch fadeClock;
+		const int fadeSteps = WindowTransition::FadeIn(platform_, { transition });
+		FlightRecorder::Instance().Record(FlightEventKind::Fade, 0, HandleValue(window), fadeSteps, fadeClock.ElapsedMicroseconds());
+	}
+	else
+	{
+		result.Fallbacks |= ToggleFallbackNoFade;
+	}
+	result.OpaqueQpc = platform_.CompositionNow();
+
+	WindowTransition::End(platform_, window);
+}
+
+/// <summary>
+/// Moves and sizes the window to the target rectangle in a single pass. If the target
+/// monitor's DPI differs from the window's, a per-monitor aware window resizes itself to
+/// the rectangle suggested by WM_DPICHANGED, so the rectangle passed is precompensated to
+/// make that suggestion the target. A corrective resize is made only if the window does not
+/// settle at the target. Size changes of the window are counted throughout.
+/// </summary>
+/// <param name="window">The window (cloaked or hidden).</param>
+/// <param name="targetRect">The final window rectangle, in screen coordinates.</param>
+/// <param name="targetDpi">The DPI of the monitor containing targetRect.</param>
+/// <param name="result">Receives the fallback paths taken and the resize count.</param>
+void MediaWindowToggle::MoveAcrossDpi(const PlatformWindow window, const ScreenRect& targetRect, const unsigned targetDpi, DisplayWindowResult& result)
+{
+	TRACE_ZONE("Display.SetWindowPos");
+	const unsigned windowDpi = platform_.WindowDpi(window);
+	const bool crossesDpi = targetDpi != 0 && windowDpi != 0 && windowDpi != targetDpi;
+
+	ScreenRect moveRect = targetRect;
+	if (crossesDpi)
+	{
+		result.Fallbacks |= ToggleFallbackDpiPrecompensated;
+		moveRect = WindowGeometry::PrecompensateForDpiChange(targetRect, windowDpi, targetDpi);
+	}
+
+	platform_.BeginResizeCount(window);
+
+	const bool moved = platform_.MoveTopmost(window, moveRect);
+	FlightRecorder::Instance().Record(FlightEventKind::SetWindowPos, moved ? 1 : 0, moveRect.Left, moveRect.Top, moveRect.Width(), moveRect.Height());
+
+	bool corrective = false;
+	if (crossesDpi)
+	{
+		// Let the window respond to WM_DPICHANGED before checking where it ended up.
+		platform_.SettleResizes(DpiSettleQuietMs, DpiSettleMaxMs);
+
+		ScreenRect actual;
+		if (platform_.GetWindowRect(window, actual) && !(actual == targetRect))
+		{
+			corrective = true;
+			result.Fallbacks |= ToggleFallbackCorrectiveResize;
+			const bool resized = platform_.MoveTopmost(window, targetRect);
+			FlightRecorder::Instance().Record(FlightEventKind::SetWindowPos, resized ? 1 : 0, targetRect.Left, targetRect.Top,
+				targetRect.Width(), targetRect.Height());
+		}
+	}
+
+	platform_.SettleResizes(0, 0);
+	result.ResizeEvents = platform_.EndResizeCount();
+	FlightRecorder::Instance().Record(FlightEventKind::DpiTransition, static_cast<std::int32_t>(windowDpi),
+		targetDpi, result.ResizeEvents, corrective ? 1 : 0);
+}
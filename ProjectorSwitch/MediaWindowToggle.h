@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include "DisplayWindowResult.h"
+#include "PlatformBackend.h"
+#include "ProviderRegistry.h"
+#include "WindowTransition.h"
+
+// Where the media window was before it was moved onto the projector.
+struct SendBackPlacement
+{
+	ScreenRect Rect;           // empty if unknown (a position on the primary monitor is made up)
+	bool WasMinimized = false;
+	WindowShowState ShowState = WindowShowState::Normal;
+};
+
+/// <summary>
+/// Toggles the media window between its place and the projector: finds it, then
+/// moves it onto the target monitor with the cloak-move-fade transition, or sends
+/// it back where it was. Every platform call goes through the PlatformBackend, so
+/// a toggle's calls are counted, and it can be driven against a fake. ZoomService
+/// adds what lives beyond one toggle (journal, pin, holding slide, warm start,
+/// mirror) through the Observer.
+/// Portable (no Windows dependencies).
+/// </summary>
+class MediaWindowToggle
+{
+public:
+	// How long to wait for a window's own WM_DPICHANGED resize after a cross-DPI move.
+	static constexpr unsigned DpiSettleQuietMs = 30;
+	static constexpr unsigned DpiSettleMaxMs = 250;
+
+	class Observer
+	{
+	public:
+		virtual ~Observer() = default;
+
+		// A window to toggle without searching for it (e.g. from the discovery cache), or 0.
+		virtual PlatformWindow WarmStartWindow() { return 0; }
+
+		// The window WarmStartWindow returned has gone; the toggle searches instead.
+		virtual void WarmStartUnavailable() {}
+
+		// In mirror mode (ToggleMode=mirror): mirrors the window instead of moving it.
+		virtual void Mirror(PlatformWindow window, const ScreenRect& monitorRect, DisplayWindowResult& result);
+
+		// Before the window is sent back; placement can be filled in if still empty.
+		virtual void OnSendingBack(PlatformWindow /*window*/, const ScreenRect& /*monitorRect*/, SendBackPlacement& /*placement*/) {}
+		virtual void OnSentBack(PlatformWindow /*window*/, const SendBackPlacement& /*placement*/) {}
+
+		// Before the window is moved onto the projector, with where it is now.
+		virtual void OnDisplaying(PlatformWindow /*window*/, const SendBackPlacement& /*placement*/) {}
+		virtual void OnDisplayed(PlatformWindow /*window*/, const ScreenRect& /*targetRect*/) {}
+
+		// After either, with the toggle's fallback flags (which record how the window was found).
+		virtual void OnToggled(PlatformWindow /*window*/, std::uint32_t /*fallbacks*/) {}
+	};
+
+private:
+	PlatformBackend& platform_;
+	ProviderRegistry& providers_;
+	Observer* observer_;
+	SendBackPlacement placement_;
+
+	bool FindMediaWindow(DisplayWindowResult& result);
+	void SendBack(PlatformWindow window, DisplayWindowResult& result);
+	void MoveAcrossDpi(PlatformWindow window, const ScreenRect& targetRect, unsigned targetDpi, DisplayWindowResult& result);
+	ScreenRect FallbackRestoreRect(PlatformWindow window);
+
+public:
+	// The observer, if any, must outlive the toggle.
+	MediaWindowToggle(PlatformBackend& platform, ProviderRegistry& providers, Observer* observer = nullptr);
+
+	// Performs the toggle, recording the outcome, timings and fallbacks in result.
+	void Run(DisplayWindowResult& result);
+
+	// Moves a window onto the projector at targetRect (on a monitor at targetDpi),
+	// concealed while it moves, then fades it in.
+	void Display(PlatformWindow window, const ScreenRect& targetRect, unsigned targetDpi, DisplayWindowResult& result);
+
+	// The window rect that makes the window's client area exactly cover the monitor.
+	ScreenRect TargetRect(const ScreenRect& monitorRect, PlatformWindow window, unsigned targetDpi);
+
+	const SendBackPlacement& Placement() const { return placement_; }
+};
@@ -0,0 +1,111 @@
+#include "MirrorSession.h"
+
+MirrorSession::MirrorSession(ThumbnailCompositor* compositor)
+	: compositor_(compositor)
+	, active_(false)
+	, hostCreated_(false)
+	, registered_(false)
+	, source_(0)
+	, updates_(0)
+{
+}
+
+MirrorSession::~MirrorSession()
+{
+	Stop();
+}
+
+/// <summary>
+/// Creates the host on the monitor, registers the thumbnail and shows it. On any
+/// failure everything created so far is released again.
+/// </summary>
+/// <returns>True if the mirror is showing.</returns>
+bool MirrorSession::Start(const std::uint64_t sourceWindow, const ScreenRect& monitorRect, const FrameMetrics& metrics,
+	const FrameInsets& chromeCrop)
+{
+	Stop();
+
+	source_ = sourceWindow;
+	hostRect_ = monitorRect;
+	chromeCrop_ = chromeCrop;
+	lastSource_ = ScreenRect{};
+	lastDestination_ = ScreenRect{};
+	updates_ = 0;
+
+	hostCreated_ = compositor_->CreateHost(monitorRect);
+	registered_ = hostCreated_ && compositor_->Register(sourceWindow);
+	if (!registered_ || !Fit(metrics))
+	{
+		TearDown();
+		return false;
+	}
+
+	compositor_->ShowHost();
+	active_ = true;
+	return true;
+}
+
+bool MirrorSession::Refresh(const FrameMetrics& metrics)
+{
+	if (active_ && !Fit(metrics))
+	{
+		Stop();
+	}
+
+	return active_;
+}
+
+void MirrorSession::Stop()
+{
+	TearDown();
+	active_ = false;
+}
+
+/// <summary>
+/// Computes the source and destination rects for the source's current size and
+/// updates the thumbnail if they changed.
+/// </summary>
+/// <returns>False if the source has gone or the update failed.</returns>
+bool MirrorSession::Fit(const FrameMetrics& metrics)
+{
+	int width = 0;
+	int height = 0;
+	if (!compositor_->QuerySourceSize(width, height) || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	const ScreenRect source = WindowGeometry::MirrorSourceRect(width, height, metrics, chromeCrop_);
+	const ScreenRect destination = WindowGeometry::AspectFit(source.Width(), source.Height(),
+		ScreenRect{ 0, 0, hostRect_.Width(), hostRect_.Height() });
+
+	if (source == lastSource_ && destination == lastDestination_)
+	{
+		return true;
+	}
+
+	if (!compositor_->Update(source, destination))
+	{
+		return false;
+	}
+
+	lastSource_ = source;
+	lastDestination_ = destination;
+	++updates_;
+	return true;
+}
+
+void MirrorSession::TearDown()
+{
+	if (registered_)
+	{
+		compositor_->Unregister();
+		registered_ = false;
+	}
+
+	if (hostCreated_)
+	{
+		compositor_->DestroyHost();
+		hostCreated_ = false;
+	}
+}
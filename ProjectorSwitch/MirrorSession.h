@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include "ThumbnailCompositor.h"
+#include "WindowGeometry.h"
+
+/// <summary>
+/// Mirrors a window onto a monitor instead of moving it: a host window covers the
+/// monitor and shows the window's thumbnail, cropped to its content and
+/// aspect-fitted. Start and Stop always leave the compositor fully set up or fully
+/// torn down. Portable (no Windows dependencies).
+/// </summary>
+class MirrorSession  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	ThumbnailCompositor* compositor_;
+	bool active_;
+	bool hostCreated_;
+	bool registered_;
+	std::uint64_t source_;
+	ScreenRect hostRect_;
+	FrameInsets chromeCrop_;
+	ScreenRect lastSource_;
+	ScreenRect lastDestination_;
+	std::uint32_t updates_;
+
+	bool Fit(const FrameMetrics& metrics);
+	void TearDown();
+
+public:
+	explicit MirrorSession(ThumbnailCompositor* compositor);
+	~MirrorSession();
+
+	// metrics: the source window's frame metrics at its current DPI.
+	// chromeCrop: extra content to crop from the client area (at 96 DPI).
+	bool Start(std::uint64_t sourceWindow, const ScreenRect& monitorRect, const FrameMetrics& metrics, const FrameInsets& chromeCrop);
+
+	// Re-fits after the source is resized (no compositor call if nothing changed);
+	// stops the session if the source has gone. Returns IsActive().
+	bool Refresh(const FrameMetrics& metrics);
+
+	void Stop();
+
+	bool IsActive() const { return active_; }
+	std::uint64_t Source() const { return source_; }
+	std::uint32_t Updates() const { return updates_; }
+};
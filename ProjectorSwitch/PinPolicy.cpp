@@ -0,0 +1,86 @@
+#include <cstdlib>
+#include "PinPolicy.h"
+
+namespace
+{
+	bool Within(const ScreenRect& a, const ScreenRect& b, const int tolerance)
+	{
+		return std::abs(a.Left - b.Left) < tolerance && std::abs(a.Top - b.Top) < tolerance &&
+			std::abs(a.Right - b.Right) < tolerance && std::abs(a.Bottom - b.Bottom) < tolerance;
+	}
+}
+
+PinPolicy::PinPolicy(const ScreenRect& target, const PinOptions& options)
+	: target_(target)
+	, options_(options)
+	, pinned_(true)
+	, userMoving_(false)
+{
+}
+
+/// <summary>
+/// Returns Correct for drift beyond the tolerance unless the pin has ended, the
+/// user is moving the window, it is minimized, or the policy is backing off. The
+/// burst limit counts corrections made within BurstWindow; reaching it starts a
+/// backoff, after which corrections resume with an empty burst.
+/// </summary>
+PinAction PinPolicy::OnLocationChange(const ScreenRect& observed, const bool minimized, const Clock::time_point now)
+{
+	if (!pinned_ || userMoving_ || minimized || Within(observed, target_, options_.TolerancePx))
+	{
+		return PinAction::None;
+	}
+
+	++stats_.DriftEvents;
+	if (now < backoffUntil_)
+	{
+		++stats_.RateLimited;
+		return PinAction::None;
+	}
+
+	while (!recentCorrections_.empty() && now - recentCorrections_.front() >= options_.BurstWindow)
+	{
+		recentCorrections_.pop_front();
+	}
+
+	if (static_cast<int>(recentCorrections_.size()) >= options_.BurstCorrections)
+	{
+		// Something keeps moving the window; let it, for a while.
+		++stats_.Backoffs;
+		++stats_.RateLimited;
+		backoffUntil_ = now + options_.Backoff;
+		recentCorrections_.clear();
+		return PinAction::None;
+	}
+
+	recentCorrections_.push_back(now);
+	return PinAction::Correct;
+}
+
+PinAction PinPolicy::OnUserMoveSize(const bool started)
+{
+	if (!pinned_)
+	{
+		return PinAction::None;
+	}
+
+	userMoving_ = started;
+	if (started)
+	{
+		return PinAction::None;
+	}
+
+	// Wherever the user put it is where it should stay.
+	pinned_ = false;
+	return PinAction::Unpin;
+}
+
+void PinPolicy::OnCorrected(const std::chrono::microseconds latency)
+{
+	++stats_.Corrections;
+	stats_.TotalLatencyUs += latency.count();
+	if (latency.count() > stats_.MaxLatencyUs)
+	{
+		stats_.MaxLatencyUs = latency.count();
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include "WindowGeometry.h"
+
+struct PinOptions
+{
+	int TolerancePx = 2;                       // drift smaller than this on every edge is ignored
+	int BurstCorrections = 3;                  // at most this many corrections...
+	std::chrono::milliseconds BurstWindow{ 2000 }; // ...within this period, then
+	std::chrono::milliseconds Backoff{ 10000 };    // stop correcting for this long
+};
+
+enum class PinAction
+{
+	None,
+	Correct, // move the window back to the target
+	Unpin    // stop enforcing (the user moved or sized the window)
+};
+
+struct PinStats
+{
+	std::uint64_t DriftEvents = 0;  // location changes that left the window off target
+	std::uint64_t Corrections = 0;
+	std::uint64_t RateLimited = 0;  // drift ignored while backing off
+	std::uint64_t Backoffs = 0;     // times the burst limit was reached
+	std::int64_t TotalLatencyUs = 0; // drift observed to correction applied
+	std::int64_t MaxLatencyUs = 0;
+};
+
+/// <summary>
+/// Decides when to move a pinned window back to its target rectangle after
+/// location changes made by its own application. Corrections are rate limited:
+/// after a burst, the policy backs off so it does not fight the application (or
+/// the user), and a move or size by the user ends the pin. Time is passed in,
+/// so the policy is driven by scripted event streams in tests.
+/// Portable (no Windows dependencies).
+/// </summary>
+class PinPolicy
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+private:
+	ScreenRect target_;
+	PinOptions options_;
+	std::deque<Clock::time_point> recentCorrections_;
+	Clock::time_point backoffUntil_;
+	bool pinned_;
+	bool userMoving_;
+	PinStats stats_;
+
+public:
+	PinPolicy(const ScreenRect& target, const PinOptions& options = PinOptions());
+
+	// The window's rectangle after a location change (minimized windows are left alone).
+	PinAction OnLocationChange(const ScreenRect& observed, bool minimized, Clock::time_point now);
+
+	// The user started (true) or finished (false) moving or sizing the window.
+	PinAction OnUserMoveSize(bool started);
+
+	// A correction was applied; latency is from the drift being observed.
+	void OnCorrected(std::chrono::microseconds latency);
+
+	bool IsPinned() const { return pinned_; }
+	const ScreenRect& Target() const { return target_; }
+	const PinStats& Stats() const { return stats_; }
+};
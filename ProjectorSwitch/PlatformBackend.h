@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BoundedOperation.h"
+#include "MediaWindowDiscovery.h"
+#include "WindowGeometry.h"
+
+// A top-level window (an HWND on Windows); 0 for none.
+using PlatformWindow = std::uint64_t;
+
+enum class PlatformResult : std::uint8_t
+{
+	Ok,
+	Failed,
+	TimedOut // the app did not respond within the UI Automation timeouts
+};
+
+enum class WindowShowState : std::uint8_t
+{
+	Normal,
+	Minimized,
+	Maximized
+};
+
+struct WindowPlacementInfo
+{
+	WindowShowState ShowState = WindowShowState::Normal;
+	ScreenRect NormalRect; // where the window restores to
+};
+
+/// <summary>
+/// The process, settings, UI Automation and window manager calls a toggle makes.
+/// Implementations count each call they make to another process, the settings file
+/// or the window manager in the current CallCountScope, at the call itself (so an
+/// operation costing several calls counts each). Reads of window state answered
+/// without messaging the window (IsWindow, GetWindowRect, DPI, styles) are not counted.
+/// Implemented by Win32PlatformBackend, and by fakes in the tests.
+/// Portable interface (no Windows dependencies).
+/// </summary>
+class PlatformBackend
+{
+public:
+	virtual ~PlatformBackend() = default;
+
+	// Executable names of the running processes (a process snapshot).
+	virtual std::vector<std::wstring> ProcessNames() = 0;
+
+	// The selected monitor's rectangle from settings (empty if none), and the toggle mode.
+	virtual ScreenRect LoadTargetMonitorRect() = 0;
+	virtual bool LoadMirrorMode() = 0;
+	virtual FrameInsets LoadMirrorCrop() = 0;
+
+	virtual bool HasAutomation() const = 0;
+	virtual bool ConnectDesktop() = 0;
+
+	// Searches for the first of the selectors (in order) to match a window, within the
+	// UiaDeadlineMs setting. The window selected becomes the current element.
+	virtual OperationStatus LocateMediaWindow(const std::vector<std::shared_ptr<const MediaWindowSelectors>>& selectors,
+		DiscoveryOutcome& outcome) = 0;
+
+	// Makes the window's element the current one (no search; fails if it has gone).
+	virtual PlatformResult AdoptWindowElement(PlatformWindow window) = 0;
+
+	// Properties of the current element (the one adopted or last located).
+	virtual PlatformResult ReadElementWindow(PlatformWindow& window) = 0;
+	virtual PlatformResult ReadElementRect(ScreenRect& rect) = 0;
+
+	virtual bool IsWindow(PlatformWindow window) = 0;
+	virtual bool IsMinimized(PlatformWindow window) = 0;
+	virtual bool GetWindowRect(PlatformWindow window, ScreenRect& rect) = 0;
+	virtual unsigned WindowDpi(PlatformWindow window) = 0;
+	virtual unsigned MonitorDpi(const ScreenRect& monitorRect) = 0;
+	virtual unsigned SystemDpi() = 0;
+	virtual ScreenRect PrimaryWorkArea() = 0;
+
+	// The frame the window has (or will have) at the given DPI.
+	virtual FrameMetrics WindowFrameMetrics(PlatformWindow window, unsigned dpi) = 0;
+
+	virtual bool GetWindowPlacement(PlatformWindow window, WindowPlacementInfo& placement) = 0;
+	virtual void SetWindowPlacement(PlatformWindow window, const WindowPlacementInfo& placement) = 0;
+
+	// Moves and sizes the window into the topmost band, without activating it.
+	virtual bool MoveTopmost(PlatformWindow window, const ScreenRect& rect) = 0;
+
+	// Brings the window to the foreground and the top of the topmost band, even if
+	// this process is not in the foreground.
+	virtual bool ForceToForeground(PlatformWindow window) = 0;
+
+	// Takes the window out of the topmost band without moving or activating it.
+	virtual bool LowerFromTopmost(PlatformWindow window) = 0;
+
+	// Moves and sizes the window out of the topmost band, showing it.
+	virtual bool RestoreWindow(PlatformWindow window, const ScreenRect& rect) = 0;
+
+	virtual void Minimize(PlatformWindow window) = 0;
+	virtual void Maximize(PlatformWindow window) = 0;
+	virtual void Restore(PlatformWindow window) = 0;
+	virtual void Show(PlatformWindow window) = 0;
+	virtual void Hide(PlatformWindow window) = 0;
+	virtual void Activate(PlatformWindow window) = 0;
+	virtual bool HasLayeredStyle(PlatformWindow window) = 0;
+	virtual void SetLayeredStyle(PlatformWindow window, bool layered) = 0;
+	virtual void Redraw(PlatformWindow window) = 0;
+
+	// Sets the opacity of a layered window.
+	virtual bool SetWindowAlpha(PlatformWindow window, std::uint8_t alpha) = 0;
+
+	// Cloaks or uncloaks the window; fails where cloaking is unavailable.
+	virtual bool SetCloaked(PlatformWindow window, bool cloaked) = 0;
+
+	// Disables (or re-enables) the system's minimize/restore/maximize animations.
+	virtual bool SetTransitionsDisabled(PlatformWindow window, bool disabled) = 0;
+
+	// Counts the window's size changes from Begin to End. Settle waits until none has
+	// arrived for quietMs, or maxMs has passed.
+	virtual void BeginResizeCount(PlatformWindow window) = 0;
+	virtual void SettleResizes(unsigned quietMs, unsigned maxMs) = 0;
+	virtual std::uint32_t EndResizeCount() = 0;
+
+	virtual std::uint64_t TickMs() = 0;
+	virtual void SleepMs(unsigned ms) = 0;
+
+	// Now on the compositor's clock (CompositionClock), for DisplayWindowResult::OpaqueQpc.
+	virtual std::int64_t CompositionNow() = 0;
+};
@@ -0,0 +1,126 @@
+#if !defined(_WIN32)
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <utility>
+#include "PollEventReactor.h"
+
+PollEventReactor::PollEventReactor()
+	: wakeFd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+	, quit_(false)
+	, exitCode_(0)
+{
+}
+
+PollEventReactor::~PollEventReactor()
+{
+	if (wakeFd_ >= 0)
+	{
+		close(wakeFd_);
+	}
+}
+
+EventReactor::RegistrationId PollEventReactor::Register(const NativeWaitHandle handle, Callback callback)
+{
+	return handlers_.Add(handle, std::move(callback));
+}
+
+void PollEventReactor::Unregister(const RegistrationId id)
+{
+	handlers_.Remove(id);
+}
+
+void PollEventReactor::Post(Callback callback)
+{
+	if (tasks_.Push(std::move(callback)))
+	{
+		const std::uint64_t one = 1;
+		[[maybe_unused]] const ssize_t written = write(wakeFd_, &one, sizeof(one));
+	}
+}
+
+void PollEventReactor::SetIdleCallback(Callback callback)
+{
+	idle_ = std::move(callback);
+}
+
+void PollEventReactor::Quit(const int exitCode)
+{
+	quit_ = true;
+	exitCode_ = exitCode;
+}
+
+int PollEventReactor::Run()
+{
+	if (wakeFd_ < 0)
+	{
+		return -1;
+	}
+
+	std::vector<NativeWaitHandle> handles;
+	std::vector<RegistrationId> ids;
+	std::vector<pollfd> fds;
+	quit_ = false;
+
+	while (!quit_)
+	{
+		handlers_.Compact();
+		handlers_.Snapshot(handles, ids);
+
+		// The wake descriptor comes first; registered handles follow in order.
+		fds.assign(1, pollfd{ wakeFd_, POLLIN, 0 });
+		for (const NativeWaitHandle handle : handles)
+		{
+			fds.push_back(pollfd{ handle, POLLIN, 0 });
+		}
+
+		const int ready = poll(fds.data(), static_cast<nfds_t>(fds.size()), -1);
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return -1;
+		}
+
+		++stats_.Wakeups;
+		std::uint64_t dispatched = 0;
+
+		for (size_t i = 1; i < fds.size() && !quit_; ++i)
+		{
+			if ((fds[i].revents & (POLLIN | POLLERR | POLLHUP)) != 0 && handlers_.Invoke(ids[i - 1]))
+			{
+				++stats_.HandleEvents;
+				++dispatched;
+			}
+		}
+
+		// Posted tasks are run on every wakeup, so the wake counter is cleared first
+		// (non-blocking): a task posted after this read writes it again. When quitting,
+		// it is left set, so tasks still queued run on the next Run (Post only writes
+		// it when the queue was empty).
+		if (!quit_)
+		{
+			std::uint64_t count = 0;
+			[[maybe_unused]] const ssize_t bytesRead = read(wakeFd_, &count, sizeof(count));
+
+			const std::uint64_t tasks = tasks_.RunAll();
+			stats_.Tasks += tasks;
+			dispatched += tasks;
+		}
+
+		if (dispatched == 0)
+		{
+			++stats_.IdleWakeups;
+		}
+		else if (idle_ && !quit_)
+		{
+			idle_();
+		}
+	}
+
+	return exitCode_;
+}
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+#if !defined(_WIN32)
+#include "EventReactor.h"
+
+/// <summary>
+/// EventReactor over poll(2), woken for posted callbacks through an eventfd.
+/// Lets components built on the reactor, and their tests, run on Linux.
+/// </summary>
+class PollEventReactor : public EventReactor  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	ReactorHandlers handlers_;
+	ReactorTaskQueue tasks_;
+	Callback idle_;
+	ReactorStats stats_;
+	int wakeFd_;
+	bool quit_;
+	int exitCode_;
+
+public:
+	PollEventReactor();
+	~PollEventReactor() override;
+
+	RegistrationId Register(NativeWaitHandle handle, Callback callback) override;
+	void Unregister(RegistrationId id) override;
+	void Post(Callback callback) override;
+	void SetIdleCallback(Callback callback) override;
+	int Run() override;
+	void Quit(int exitCode) override;
+	ReactorStats Stats() const override { return stats_; }
+};
+#endif
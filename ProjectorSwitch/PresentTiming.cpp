@@ -0,0 +1,53 @@
+#include "PresentTiming.h"
+
+namespace
+{
+	// Largest message age accepted; anything older is a clock mismatch, not a real delay.
+	constexpr std::uint32_t MaxMessageAgeMs = 60000;
+
+	// Floor division (rounding towards negative infinity), for a positive divisor.
+	std::int64_t FloorDiv(const std::int64_t value, const std::int64_t divisor)
+	{
+		const std::int64_t quotient = value / divisor;
+		return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+	}
+}
+
+std::int64_t PresentTiming::FirstPresentAfter(const CompositionSample& sample, const std::int64_t changeQpc)
+{
+	const std::int64_t period = sample.RefreshPeriodQpc;
+	if (period <= 0 || sample.VBlankQpc <= 0 || changeQpc <= 0)
+	{
+		return 0;
+	}
+
+	// Phase of composition within the refresh period.
+	const std::int64_t sinceVBlank = sample.ComposeQpc > 0 ? sample.ComposeQpc - sample.VBlankQpc : 0;
+	const std::int64_t phase = sinceVBlank - FloorDiv(sinceVBlank, period) * period;
+
+	// First composition at or after the change (ceiling), then the vertical blank after it.
+	const std::int64_t frame = -FloorDiv(sample.VBlankQpc + phase - changeQpc, period);
+	return sample.VBlankQpc + (frame + 1) * period;
+}
+
+std::int64_t PresentTiming::MessageTimeToQpc(const std::uint32_t messageTimeMs, const std::uint32_t nowMs, const std::int64_t nowQpc, const std::int64_t frequency)
+{
+	const std::uint32_t ageMs = nowMs - messageTimeMs; // modulo 2^32, so correct across the wrap
+	if (frequency <= 0 || ageMs > MaxMessageAgeMs)
+	{
+		return nowQpc;
+	}
+
+	return nowQpc - static_cast<std::int64_t>(ageMs) * frequency / 1000;
+}
+
+std::int64_t PresentTiming::ToMicroseconds(const std::int64_t ticks, const std::int64_t frequency)
+{
+	if (frequency <= 0)
+	{
+		return 0;
+	}
+
+	// Split to avoid overflowing ticks * 1000000 for long intervals.
+	return (ticks / frequency) * 1000000 + (ticks % frequency) * 1000000 / frequency;
+}
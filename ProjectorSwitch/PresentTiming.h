@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+// One reading of the compositor's clock (DWM_TIMING_INFO), in QueryPerformanceCounter ticks.
+struct CompositionSample
+{
+	std::int64_t VBlankQpc = 0;        // the most recent vertical blank
+	std::int64_t RefreshPeriodQpc = 0; // time between vertical blanks
+	std::int64_t ComposeQpc = 0;       // the most recent composition (0 if unknown)
+};
+
+/// <summary>
+/// Correlates toggle timestamps with the compositor's frame timing to find when a
+/// change first reaches the screen. The compositor runs once per refresh, at a fixed
+/// phase after each vertical blank; a change is picked up by the first composition
+/// that starts after it and presented at the vertical blank following that
+/// composition. A single sample is enough, as the grid extends either way in time.
+/// Portable (no Windows dependencies).
+/// </summary>
+class PresentTiming
+{
+public:
+	// The vertical blank at which a change made at changeQpc is first on screen;
+	// 0 if the sample is unusable.
+	static std::int64_t FirstPresentAfter(const CompositionSample& sample, std::int64_t changeQpc);
+
+	// Converts an input message's time (GetMessageTime: milliseconds, wrapping every
+	// 49.7 days) to the QPC time base, given both clocks read now.
+	static std::int64_t MessageTimeToQpc(std::uint32_t messageTimeMs, std::uint32_t nowMs, std::int64_t nowQpc, std::int64_t frequency);
+
+	static std::int64_t ToMicroseconds(std::int64_t ticks, std::int64_t frequency);
+};
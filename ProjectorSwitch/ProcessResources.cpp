@@ -0,0 +1,27 @@
+#include <Windows.h>
+#include <Psapi.h>
+#include "ProcessResources.h"
+
+ResourceSample ProcessResources::Sample()
+{
+	ResourceSample sample;
+	const HANDLE process = GetCurrentProcess();
+
+	DWORD handles = 0;
+	if (GetProcessHandleCount(process, &handles))
+	{
+		sample.Handles = handles;
+	}
+
+	sample.GdiObjects = GetGuiResources(process, GR_GDIOBJECTS);
+	sample.UserObjects = GetGuiResources(process, GR_USEROBJECTS);
+
+	PROCESS_MEMORY_COUNTERS_EX counters{};
+	counters.cb = sizeof(counters);
+	if (GetProcessMemoryInfo(process, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)))
+	{
+		sample.PrivateBytes = static_cast<std::int64_t>(counters.PrivateUsage);
+	}
+
+	return sample;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "SoakBenchmark.h"
+
+/// <summary>
+/// Samples this process's handle, GDI and USER object counts and private bytes.
+/// </summary>
+class ProcessResources
+{
+public:
+	static ResourceSample Sample();
+};
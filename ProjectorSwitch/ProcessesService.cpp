@@ -3,18 +3,24 @@
 #include <memory>
 #include "ProcessesService.h"  
 #include "HandleDeleter.h"
+#include "TraceRecorder.h"
+#include "FlightRecorder.h"
+#include "CallCounters.h"
 
 
 /// Retrieves a list of process handles for all processes matching the specified name.
 // ReSharper disable once CppMemberFunctionMayBeStatic
 std::vector<std::unique_ptr<void, HandleDeleter>> ProcessesService::GetProcessesByName(const std::wstring& name)
 {
+	TRACE_ZONE("ProcessesService::GetProcessesByName");
 	std::vector<std::unique_ptr<void, HandleDeleter>> result;
 
 	// Create toolhelp snapshot.  
+	CallCountScope::Count(CallCategory::ProcessSnapshot);
 	const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
 	if (snapshot == INVALID_HANDLE_VALUE)
 	{
+		FlightRecorder::Instance().Record(FlightEventKind::ProcessSnapshot, static_cast<std::int32_t>(GetLastError()));
 		OutputDebugString(L"Could not get process snapshot!");
 		return result;
 	}
@@ -26,10 +32,12 @@ std::vector<std::unique_ptr<void, HandleDeleter>> ProcessesService::GetProcesses
 	process.dwSize = sizeof(process);
 
 	// enumerate all processes.  
+	std::int64_t scanned = 0;
 	if (Process32First(snapshotHandle, &process))
 	{
 		do
 		{
+			++scanned;
 			if (std::wstring(process.szExeFile) == name)
 			{
 				// Process found, add to result.  
@@ -38,9 +46,96 @@ std::vector<std::unique_ptr<void, HandleDeleter>> ProcessesService::GetProcesses
 				{					
 					result.push_back(std::unique_ptr<void, HandleDeleter>(processHandle));
 				}
+				else
+				{
+					FlightRecorder::Instance().Record(FlightEventKind::OpenProcessFailed,
+						static_cast<std::int32_t>(GetLastError()), process.th32ProcessID);
+				}
 			}
 		} while (Process32Next(snapshotHandle, &process));
 	}
 
+	FlightRecorder::Instance().Record(FlightEventKind::ProcessSnapshot, 0, scanned, static_cast<std::int64_t>(result.size()));
+
 	return result;
 }
+
+/// Lists the executable names of all running processes, for matching against several
+/// apps at once.
+// ReSharper disable once CppMemberFunctionMayBeStatic
+std::vector<std::wstring> ProcessesService::GetProcessNames()
+{
+	TRACE_ZONE("ProcessesService::GetProcessNames");
+	std::vector<std::wstring> names;
+
+	CallCountScope::Count(CallCategory::ProcessSnapshot);
+	const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+	if (snapshot == INVALID_HANDLE_VALUE)
+	{
+		FlightRecorder::Instance().Record(FlightEventKind::ProcessSnapshot, static_cast<std::int32_t>(GetLastError()));
+		OutputDebugString(L"Could not get process snapshot!");
+		return names;
+	}
+
+	const CHandle snapshotHandle(snapshot);
+
+	PROCESSENTRY32 process;
+	ZeroMemory(&process, sizeof(process));
+	process.dwSize = sizeof(process);
+
+	if (Process32First(snapshotHandle, &process))
+	{
+		do
+		{
+			names.emplace_back(process.szExeFile);
+		} while (Process32Next(snapshotHandle, &process));
+	}
+
+	FlightRecorder::Instance().Record(FlightEventKind::ProcessSnapshot, 0, static_cast<std::int64_t>(names.size()), 0);
+
+	return names;
+}
+
+/// Lists the ids of the processes running any of the named executables.
+// ReSharper disable once CppMemberFunctionMayBeStatic
+std::vector<std::uint32_t> ProcessesService::GetProcessIds(const std::vector<std::wstring>& names)
+{
+	TRACE_ZONE("ProcessesService::GetProcessIds");
+	std::vector<std::uint32_t> ids;
+
+	CallCountScope::Count(CallCategory::ProcessSnapshot);
+	const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+	if (snapshot == INVALID_HANDLE_VALUE)
+	{
+		FlightRecorder::Instance().Record(FlightEventKind::ProcessSnapshot, static_cast<std::int32_t>(GetLastError()));
+		OutputDebugString(L"Could not get process snapshot!");
+		return ids;
+	}
+
+	const CHandle snapshotHandle(snapshot);
+
+	PROCESSENTRY32 process;
+	ZeroMemory(&process, sizeof(process));
+	process.dwSize = sizeof(process);
+
+	std::int64_t scanned = 0;
+	if (Process32First(snapshotHandle, &process))
+	{
+		do
+		{
+			++scanned;
+			for (const auto& name : names)
+			{
+				if (_wcsicmp(process.szExeFile, name.c_str()) == 0)
+				{
+					ids.push_back(process.th32ProcessID);
+					break;
+				}
+			}
+		} while (Process32Next(snapshotHandle, &process));
+	}
+
+	FlightRecorder::Instance().Record(FlightEventKind::ProcessSnapshot, 0, scanned, static_cast<std::int64_t>(ids.size()));
+
+	return ids;
+}
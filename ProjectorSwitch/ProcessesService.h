@@ -1,6 +1,7 @@
 #pragma once
 #include <Windows.h>
 #include <TlHelp32.h>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -10,5 +11,11 @@ class ProcessesService
 {
 	public:
 		std::vector<std::unique_ptr<void, HandleDeleter>> GetProcessesByName(const std::wstring& name);
+
+		// Executable names of all running processes, from one snapshot (no handles are opened).
+		std::vector<std::wstring> GetProcessNames();
+
+		// Ids of the running processes with any of the executable names (compared case-insensitively).
+		std::vector<std::uint32_t> GetProcessIds(const std::vector<std::wstring>& names);
 };
 
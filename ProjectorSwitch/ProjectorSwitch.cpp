@@ -9,12 +9,33 @@
 #include "ProjectorSwitch.h"
 
 #include <filesystem>
+#include <fstream>
+#include <thread>
 #include <shellapi.h> // CommandLineToArgvW
 
 #include "MonitorService.h"
 #include "SettingsService.h"
 #include "ZoomService.h"
+#include "Win32PlatformBackend.h"
 #include "WindowPlacementService.h"
+#include "StartupProfiler.h"
+#include "TraceRecorder.h"
+#include "ToggleStats.h"
+#include "FlightRecorder.h"
+#include "DiscoveryBenchmark.h"
+#include "DeferredLog.h"
+#include "LogBenchmark.h"
+#include "UiaTreeCapture.h"
+#include "ProcessesService.h"
+#include "ProviderRegistry.h"
+#include "SceneService.h"
+#include "SoakBenchmark.h"
+#include "ProcessResources.h"
+#include "UniqueRef.h"
+#include "AppState.h"
+#include "Win32EventReactor.h"
+#include "IdlePolicy.h"
+#include "CompositionClock.h"
 #include "Logger.h"
 
 constexpr int MaxLoadStringLength = 100;
@@ -25,6 +46,12 @@ constexpr int ComboBoxWidth = 200;
 constexpr int ComboBoxHeight = 20;
 constexpr int ButtonId = 10001;
 constexpr int ComboBoxId = 10002;
+constexpr UINT WM_APP_STATE_CHANGED = WM_APP + 1; // wParam: the published AppState version
+constexpr LONG PresenceCheckMs = 5000;      // how often to look for the Zoom process
+constexpr ULONG PresenceCheckToleranceMs = 1000; // lets the system coalesce the check with other wakeups
+constexpr int RealSoakToggles = 1000;
+constexpr int RealSoakWarmup = 50;
+constexpr int RealSoakReportEvery = 100;
 
 #pragma comment(linker,"\"/manifestdependency:type='win32' \
 name='Microsoft.Windows.Common-Controls' version='6.0.0.0' \
@@ -35,28 +62,63 @@ processorArchitecture='*' publicKeyToken='6595b64144ccf1df' language='*'\"")
 namespace
 {
 	// Global Variables (internal linkage):
-	HINSTANCE CurrentInstance;
+	StartupProfiler TheStartupProfiler; // constructed before wWinMain so timings are relative to process entry
+	bool FirstPaintRecorded = false;
 	WCHAR TitleBarCaption[MaxLoadStringLength];
 	WCHAR MainWindowClass[MaxLoadStringLength];
-	HWND BtnHandle;
-	HWND ComboBoxHandle;
-	HFONT ModernFont;
-	HWND MainWindowHandle;
-	std::vector<MonitorData> TheMonitorData;
-	std::unique_ptr<ZoomService> TheZoomService;
+	Win32EventReactor TheReactor; // the UI thread's event loop; components register their waitable handles with it
+	std::unique_ptr<IdlePolicy> TheIdlePolicy; // null until the UI starts
+	CHandle PresenceTimer;
+	std::thread AcquisitionWorker;                        // creating PendingAutomation; joinable until adopted
+	std::unique_ptr<AutomationService> PendingAutomation; // owned here, used only by the worker until it is joined
+	std::uint64_t AcquisitionGeneration = 0;              // so a stale posted adoption is ignored
+	const wchar_t* AcquisitionReason = L"";
+	ResourceSample AcquisitionBefore;
+	AppStateStore TheAppState; // shared with worker threads; the main window, its DPI and the monitor list live here
 	const std::wstring AppName = L"ApcProjSw";
-	UINT CurrentDpi = BaseDpi;
+	const std::wstring StatsFileName = L"stats.bin";
+	const std::wstring DiscoveryCacheFileName = L"discovery.bin";
+	ToggleStats SessionStats; // toggles not yet merged into the stats file (merged when the loop goes idle)
 
 	struct CommandLineOptions
 	{
 		bool ShowHelp = false;
 		bool NoGui = false;
 		bool Toggle = false;
+		bool ShowStats = false;
 		std::wstring MonitorArg; // Key or 1-based index as string
+		std::wstring ProfileStartupPath; // JSON lines startup report destination
+		std::wstring ProfileBaselinePath; // previous startup report to compare against
+		std::wstring TracePath; // Chrome trace JSON destination (trace-enabled builds only)
+		std::wstring BenchDiscoveryPath; // discovery benchmark report destination (JSON lines)
+		std::vector<std::wstring> ReplayTreePaths; // snapshots to benchmark instead of simulated desktops
+		std::wstring CaptureTreePath; // UIA tree snapshot destination
+		std::wstring SceneName; // scene to apply or revert
+		std::wstring SoakReportPath; // soak self-test report destination (JSON lines)
+		std::wstring BenchLoggingPath; // logging benchmark report destination (JSON lines)
 		std::vector<std::wstring> Unknown;
 	};
 
-	CommandLineOptions CmdOptions; // parsed options for this process
+	/// <summary>
+	/// The main window, or null before it is created and once it is destroyed.
+	/// </summary>
+	HWND MainWindow()
+	{
+		return reinterpret_cast<HWND>(TheAppState.Current()->MainWindow);  // NOLINT(performance-no-int-to-ptr)
+	}
+
+	/// <summary>
+	/// The DPI the main window is laid out for.
+	/// </summary>
+	UINT WindowDpi()
+	{
+		return TheAppState.Current()->WindowDpi;
+	}
+
+	void PublishWindowDpi(const UINT dpi)
+	{
+		TheAppState.Update([dpi](AppState& state) { state.WindowDpi = dpi; });
+	}
 
 	/// <summary>
 	/// Scales an integer value based on the current DPI.
@@ -65,7 +127,32 @@ namespace
 	/// <returns>The scaled value.</returns>
 	int Scale(const int value)
 	{
-		return MulDiv(value, static_cast<int>(CurrentDpi), BaseDpi);
+		return MulDiv(value, static_cast<int>(WindowDpi()), BaseDpi);
+	}
+
+	/// <summary>
+	/// The ZoomService, owned by the main window (its GWLP_USERDATA) so that it lives
+	/// and dies with it; null while released when idle.
+	/// </summary>
+	ZoomService* WindowZoomService()
+	{
+		const HWND hWnd = MainWindow();
+		return hWnd ? reinterpret_cast<ZoomService*>(GetWindowLongPtr(hWnd, GWLP_USERDATA)) : nullptr;  // NOLINT(performance-no-int-to-ptr)
+	}
+
+	/// <summary>
+	/// Hands the main window a new ZoomService (or none), destroying the one it had.
+	/// Without a window the service is destroyed here.
+	/// </summary>
+	void SetWindowZoomService(const HWND hWnd, std::unique_ptr<ZoomService> service)
+	{
+		if (!hWnd)
+		{
+			return;
+		}
+
+		const std::unique_ptr<ZoomService> previous(reinterpret_cast<ZoomService*>(  // NOLINT(performance-no-int-to-ptr)
+			SetWindowLongPtr(hWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(service.release()))));
 	}
 
 	std::wstring& GetCurrentFolder()
@@ -125,11 +212,22 @@ namespace
 			L"  --toggle                 Toggle the Zoom window once.\n"
 			L"  --no-gui                 Run headless (no window).\n"
 			L"  --monitor <key|index>    Preselect monitor (Key or 1-based index).\n"
+			L"  --profile-startup <file> Write startup phase timings (JSON lines).\n"
+			L"  --profile-baseline <file> Compare startup timings against a previous report.\n"
+			L"  --trace <file>           Write toggle trace zones as Chrome trace JSON on exit.\n"
+			L"  --stats                  Show accumulated toggle latency statistics and exit.\n"
+			L"  --bench-discovery <file> Benchmark window discovery on simulated desktops and exit.\n"
+			L"  --replay-tree <file>     With --bench-discovery, benchmark a captured snapshot instead (repeatable).\n"
+			L"  --capture-tree <file>    Capture the Zoom windows' UI Automation trees to a snapshot and exit.\n"
+			L"  --scene <name>           Apply the named scene from settings.ini (or revert it if applied) and exit.\n"
+			L"  --selftest-soak <file>   Toggle repeatedly, checking for object, handle and memory leaks, and exit.\n"
+			L"  --bench-logging <file>   Benchmark deferred against direct logging calls and exit.\n"
 			L"\n"
 			L"Examples:\n"
 			L"  ProjectorSwitch.exe --toggle --no-gui\n"
 			L"  ProjectorSwitch.exe --monitor 2\n"
-			L"  ProjectorSwitch.exe --monitor \"MONITOR_KEY_STRING\"\n";
+			L"  ProjectorSwitch.exe --monitor \"MONITOR_KEY_STRING\"\n"
+			L"  ProjectorSwitch.exe --profile-startup startup.jsonl --profile-baseline baseline.jsonl\n";
 
 		MessageBoxW(nullptr, help, L"ProjectorSwitch Help", MB_OK | MB_ICONINFORMATION | MB_SETFOREGROUND | MB_TOPMOST);
 	}
@@ -152,6 +250,10 @@ namespace
 			{
 				out.Toggle = true;
 			}
+			else if (a == L"--stats")
+			{
+				out.ShowStats = true;
+			}
 			else if (a == L"--monitor")
 			{
 				if (i + 1 < args.size())
@@ -163,6 +265,105 @@ namespace
 					out.Unknown.push_back(a); // missing value; track as unknown for now
 				}
 			}
+			else if (a == L"--profile-startup")
+			{
+				if (i + 1 < args.size())
+				{
+					out.ProfileStartupPath = args[++i];
+				}
+				else
+				{
+					out.Unknown.push_back(a);
+				}
+			}
+			else if (a == L"--profile-baseline")
+			{
+				if (i + 1 < args.size())
+				{
+					out.ProfileBaselinePath = args[++i];
+				}
+				else
+				{
+					out.Unknown.push_back(a);
+				}
+			}
+			else if (a == L"--trace")
+			{
+				if (i + 1 < args.size())
+				{
+					out.TracePath = args[++i];
+				}
+				else
+				{
+					out.Unknown.push_back(a);
+				}
+			}
+			else if (a == L"--bench-discovery")
+			{
+				if (i + 1 < args.size())
+				{
+					out.BenchDiscoveryPath = args[++i];
+				}
+				else
+				{
+					out.Unknown.push_back(a);
+				}
+			}
+			else if (a == L"--replay-tree")
+			{
+				if (i + 1 < args.size())
+				{
+					out.ReplayTreePaths.push_back(args[++i]);
+				}
+				else
+				{
+					out.Unknown.push_back(a);
+				}
+			}
+			else if (a == L"--capture-tree")
+			{
+				if (i + 1 < args.size())
+				{
+					out.CaptureTreePath = args[++i];
+				}
+				else
+				{
+					out.Unknown.push_back(a);
+				}
+			}
+			else if (a == L"--scene")
+			{
+				if (i + 1 < args.size())
+				{
+					out.SceneName = args[++i];
+				}
+				else
+				{
+					out.Unknown.push_back(a);
+				}
+			}
+			else if (a == L"--selftest-soak")
+			{
+				if (i + 1 < args.size())
+				{
+					out.SoakReportPath = args[++i];
+				}
+				else
+				{
+					out.Unknown.push_back(a);
+				}
+			}
+			else if (a == L"--bench-logging")
+			{
+				if (i + 1 < args.size())
+				{
+					out.BenchLoggingPath = args[++i];
+				}
+				else
+				{
+					out.Unknown.push_back(a);
+				}
+			}
 			else
 			{
 				out.Unknown.push_back(a);
@@ -170,6 +371,44 @@ namespace
 		}
 	}
 
+	/// <summary>
+	/// The options on this process's command line, parsed on first use and never
+	/// changed afterwards, so any thread may read them.
+	/// </summary>
+	const CommandLineOptions& Options()
+	{
+		static const CommandLineOptions options = []
+		{
+			CommandLineOptions parsed;
+			ParseCommandLine(GetArgs(), parsed);
+			return parsed;
+		}();
+		return options;
+	}
+
+	/// <summary>
+	/// Hands messages written with the DLOG_* macros to the application log.
+	/// </summary>
+	void WriteDeferredLog(const DeferredLogLevel level, const std::wstring& message)
+	{
+		switch (level)
+		{
+		case DeferredLogLevel::Debug: LOG_DEBUG(L"%ls", message.c_str()); break;
+		case DeferredLogLevel::Info: LOG_INFO(L"%ls", message.c_str()); break;
+		case DeferredLogLevel::Warn: LOG_WARN(L"%ls", message.c_str()); break;
+		case DeferredLogLevel::Error: LOG_ERROR(L"%ls", message.c_str()); break;
+		}
+	}
+
+	/// <summary>
+	/// Writes out any deferred messages, then closes the application log.
+	/// </summary>
+	void ShutdownLogging()
+	{
+		DeferredLog::Instance().Stop();
+		Logger::Shutdown();
+	}
+
 	/// <summary>
 	/// Attempts to apply a monitor selection argument.
 	/// If numeric, treats as 1-based index into current monitors.
@@ -184,7 +423,7 @@ namespace
 		const auto monitors = ms.GetMonitorsData();
 		if (monitors.empty())
 		{
-			LOG_WARN(L"No monitors enumerated when applying --monitor");
+			DLOG_WARN(L"No monitors enumerated when applying --monitor");
 			return false;
 		}
 
@@ -196,245 +435,932 @@ namespace
 			const unsigned long oneBased = std::wcstoul(arg.c_str(), nullptr, 10);
 			if (oneBased >= 1 && oneBased <= monitors.size())
 			{
-				index = static_cast<int>(oneBased - 1);
+				index = static_cast<int>(oneBased - 1);
+			}
+			else
+			{
+				DLOG_WARN(L"--monitor index %lu out of range (1..%zu)", oneBased, monitors.size());
+				return false;
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < monitors.size(); ++i)
+			{
+				const auto& m = monitors[i];
+				if (_wcsicmp(m.Key.c_str(), arg.c_str()) == 0 ||
+					_wcsicmp(m.FriendlyName.c_str(), arg.c_str()) == 0 ||
+					_wcsicmp(m.DeviceName.c_str(), arg.c_str()) == 0)
+				{
+					index = static_cast<int>(i);
+					break;
+				}
+			}
+			if (index < 0)
+			{
+				DLOG_WARN(L"--monitor value '%ls' did not match any Key/FriendlyName/DeviceName", arg.c_str());
+				return false;
+			}
+		}
+
+		const MonitorData& md = monitors[static_cast<size_t>(index)];
+		const SettingsService ss;
+		ss.SaveSelectedMonitorKey(md.Key);
+		ss.SaveSelectedMonitorRect(md.MonitorRect);
+		DLOG_INFO(L"Applied monitor selection via CLI: index=%d key=%ls rect=[%ld,%ld,%ld,%ld]",
+			index + 1, md.Key.c_str(), md.MonitorRect.left, md.MonitorRect.top, md.MonitorRect.right, md.MonitorRect.bottom);
+		return true;
+	}
+
+	/// <summary>
+	/// Saves main window position to settings
+	/// </summary>
+	/// <param name="hWnd">Main window handle</param>
+	void SaveWindowPosition(const HWND hWnd)
+	{
+		SettingsService ss;
+		const WindowPlacementService wps(&ss);
+		wps.SaveWindowPlace(hWnd);
+		LOG_DEBUG(L"Saved window position");
+	}
+
+	/// <summary>
+	/// Restores main window position from settings
+	/// </summary>
+	/// <param name="hwnd">Main window handle</param>
+	void RestoreWindowPosition(const HWND hwnd)
+	{
+		StartupProfiler::Scope phase(TheStartupProfiler, "RestoreWindowPosition");
+		SettingsService ss;
+		const WindowPlacementService wps(&ss);
+		wps.RestoreWindowPlace(hwnd);
+		LOG_DEBUG(L"Restored window position");
+	}
+
+	/// <summary>
+	/// Handles resizing of the main window, rearranging controls as needed
+	/// </summary>
+	/// <param name="hwnd">Main window handle (unused)</param>
+	/// <param name="lParam">lParam value (new width and height)</param>
+	/// <summary>
+	/// Handles resizing of the main window, rearranging controls as needed
+	/// </summary>
+	/// <param name="hwnd">Main window handle</param>
+	/// <param name="lParam">lParam value (new width and height)</param>
+	void HandleResize(HWND hwnd, const LPARAM lParam)
+	{
+		const HWND button = GetDlgItem(hwnd, ButtonId);
+		const HWND comboBox = GetDlgItem(hwnd, ComboBoxId);
+		if (!button || !comboBox) return;
+
+		const UINT width = LOWORD(lParam);
+		const UINT height = HIWORD(lParam);
+		UNREFERENCED_PARAMETER(height);
+
+		// Always compute sizes from logical DIPs so they rescale with DPI
+		const int btnW = Scale(ButtonWidth);
+		const int btnH = Scale(ButtonHeight);
+		const int comboW = Scale(ComboBoxWidth);
+		const int comboH = Scale(ComboBoxHeight);
+
+		// Center and position with scaled margins
+		int x = static_cast<int>(width - btnW) / 2;
+		int y = Scale(10);
+		MoveWindow(button, x, y, btnW, btnH, TRUE);
+
+		x = static_cast<int>(width - comboW) / 2;
+		y = y + btnH + Scale(20);
+		MoveWindow(comboBox, x, y, comboW, comboH, TRUE);
+	}
+
+	void PublishSelectedMonitor(const std::wstring& key)
+	{
+		TheAppState.Update([&key](AppState& state) { state.SelectedMonitorKey = key; });
+	}
+
+	/// <summary>
+	/// Logs the published application state. A notification older than the current
+	/// snapshot is skipped, as the notification for the current snapshot is still queued.
+	/// </summary>
+	/// <param name="version">The version whose publication posted the notification.</param>
+	void OnAppStateChanged(const std::uint64_t version)
+	{
+		const AppStateStore::Snapshot state = TheAppState.Current();
+		if (state->Version > version)
+		{
+			return; // a later notification is on its way
+		}
+
+		LOG_DEBUG(L"App state v%llu: monitors=%u (generation %llu), zoom=%d, placement=%d, toggles=%llu",
+			static_cast<unsigned long long>(state->Version), state->MonitorCount,
+			static_cast<unsigned long long>(state->TopologyGeneration), static_cast<int>(state->Presence),
+			static_cast<int>(state->Placement), static_cast<unsigned long long>(state->ToggleCount));
+	}
+
+	/// <summary>
+	/// Adds monitor entries to the combo box and publishes them as the monitor list
+	/// </summary>
+	/// <param name="comboHandle">ComboBox handle</param>
+	/// <returns>The monitors, in combo box order</returns>
+	std::vector<MonitorData> AddMonitorsToCombo(const HWND comboHandle)
+	{
+		std::vector<MonitorData> monitors;
+		{
+			StartupProfiler::Scope phase(TheStartupProfiler, "EnumerateMonitors");
+			constexpr MonitorService ms;
+			monitors = ms.GetMonitorsData();
+		}
+
+		std::vector<MonitorEntry> entries;
+		entries.reserve(monitors.size());
+		for (const auto& i : monitors)
+		{
+			const std::wstring displayText = i.GetDisplayName();
+			SendMessage(comboHandle, CB_ADDSTRING, 0, reinterpret_cast<LPARAM>(displayText.c_str()));
+			entries.push_back(MonitorEntry{ i.Key, ScreenRect{ i.MonitorRect.left, i.MonitorRect.top, i.MonitorRect.right, i.MonitorRect.bottom } });
+		}
+
+		const auto monitorCount = static_cast<std::uint32_t>(entries.size());
+		TheAppState.Update([&entries, monitorCount](AppState& state)
+		{
+			++state.TopologyGeneration;
+			state.MonitorCount = monitorCount;
+			state.Monitors = std::move(entries);
+		});
+
+		// Show ~8 items when dropped (no need to inflate the control's selection height)
+		SendMessage(comboHandle, CB_SETMINVISIBLE, 8, 0);
+		LOG_INFO(L"Enumerated %zu monitor(s) into combo box", monitors.size());
+		return monitors;
+	}
+
+	/// <summary>
+	/// Creates the toggle button
+	/// </summary>
+	/// <param name="parent">Parent handle</param>
+	/// <returns>Button handle</returns>
+	HWND CreateButton(const HWND parent)
+	{
+		return CreateWindowW(
+			L"BUTTON",
+			L"Toggle Zoom Window",
+			WS_TABSTOP | WS_VISIBLE | WS_CHILD,
+			Scale(10), // x position 
+			Scale(10), // y position 
+			Scale(ButtonWidth),
+			Scale(ButtonHeight),
+			parent,
+			reinterpret_cast<HMENU>(static_cast<UINT_PTR>(ButtonId)), // NOLINT(performance-no-int-to-ptr)
+			reinterpret_cast<HINSTANCE>(GetWindowLongPtr(parent, GWLP_HINSTANCE)), // NOLINT(performance-no-int-to-ptr)
+			nullptr); // Pointer not needed.
+	}
+
+	/// <summary>
+	/// Responds to selection of a monitor in the combo box
+	/// </summary>
+	/// <param name="comboHandle">ComboBox handle</param>
+	/// <param name="monitors">The monitors in the combo box, in order</param>
+	void SelectMonitor(const HWND comboHandle, const std::vector<MonitorData>& monitors)
+	{
+		const SettingsService ss;
+		const std::wstring savedKey = ss.LoadSelectedMonitorKey();
+		const RECT savedRect = ss.LoadSelectedMonitorRect();
+
+		const int index = MonitorService::FindMonitorIndex(monitors, savedKey, savedRect);
+
+		if (index >= 0)
+		{
+			SendMessage(comboHandle, CB_SETCURSEL, index, 0);
+			PublishSelectedMonitor(monitors[static_cast<size_t>(index)].Key);
+			DLOG_INFO(L"Preselected monitor index %d", index);
+		}
+		else
+		{
+			// clear
+			SendMessage(comboHandle, CB_SETCURSEL, static_cast<WPARAM>(-1), 0);
+			DLOG_WARN(L"No persisted monitor selection matched");
+		}
+	}
+
+	/// <summary>
+	/// Creates a screen font similar to modern Windows UI
+	/// </summary>
+	/// <returns>Font handle</returns>
+	HFONT CreateModernFont()
+	{
+		// ~10pt Segoe UI; negative => character height
+		constexpr int pointSize = 10;
+		const int lfHeight = -MulDiv(pointSize, static_cast<int>(WindowDpi()), 72);
+		return CreateFont(
+			lfHeight, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+			DEFAULT_CHARSET, OUT_OUTLINE_PRECIS,
+			CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH,
+			L"Segoe UI");
+	}
+
+	/// <summary>
+	/// Deletes the font set on the controls, if any. The button holds the font both
+	/// controls share.
+	/// </summary>
+	/// <param name="parent">Main window handle</param>
+	void DeleteModernFont(const HWND parent)
+	{
+		const HWND button = GetDlgItem(parent, ButtonId);
+		const auto font = button ? reinterpret_cast<HFONT>(SendMessage(button, WM_GETFONT, 0, 0)) : nullptr;  // NOLINT(performance-no-int-to-ptr)
+		if (font)
+		{
+			DeleteObject(font);
+		}
+	}
+
+	/// <summary>
+	/// Sets a modern font for the controls
+	/// </summary>
+	/// <param name="parent">Main window handle</param>
+	void SetModernFont(const HWND parent)
+	{
+		DeleteModernFont(parent);
+		const HFONT font = CreateModernFont();
+
+		if (font)
+		{
+			// WM_SETFONT is meaningful for child controls
+			for (const int id : { ButtonId, ComboBoxId })
+			{
+				if (const HWND control = GetDlgItem(parent, id))
+				{
+					SendMessage(control, WM_SETFONT, reinterpret_cast<WPARAM>(font), TRUE);
+				}
+			}
+		}
+		LOG_DEBUG(L"Applied modern font (DPI=%u)", WindowDpi());
+	}
+
+	/// <summary>
+	/// Creates the combo box for monitor selection
+	/// </summary>
+	/// <param name="parent">Parent handle</param>
+	/// <returns>ComboBox handle</returns>
+	HWND CreateComboBox(const HWND parent)
+	{
+		const auto result = CreateWindowW(
+			L"COMBOBOX",
+			nullptr,
+			WS_TABSTOP | WS_VISIBLE | WS_CHILD | CBS_DROPDOWNLIST | WS_VSCROLL,
+			Scale(10),   // x
+			Scale(100),  // y
+			Scale(ComboBoxWidth),
+			Scale(ComboBoxHeight), // single-line selection; dropdown height handled by CB_SETMINVISIBLE
+			parent,
+			reinterpret_cast<HMENU>(static_cast<UINT_PTR>(ComboBoxId)),  // NOLINT(performance-no-int-to-ptr)
+			reinterpret_cast<HINSTANCE>(GetWindowLongPtr(parent, GWLP_HINSTANCE)), // NOLINT(performance-no-int-to-ptr)
+			nullptr);
+
+		SelectMonitor(result, AddMonitorsToCombo(result));
+		return result;
+	}
+
+	/// <summary>
+	/// Marks startup as complete and, if requested via --profile-startup, writes
+	/// the phase report (optionally compared against --profile-baseline).
+	/// </summary>
+	void WriteStartupReport()
+	{
+		TheStartupProfiler.Finish();
+		LOG_INFO(L"Startup completed in %lld us", static_cast<long long>(TheStartupProfiler.TotalUs()));
+
+		if (Options().ProfileStartupPath.empty())
+		{
+			return;
+		}
+
+		std::vector<StartupPhase> baseline;
+		const bool hasBaseline = !Options().ProfileBaselinePath.empty();
+		if (hasBaseline)
+		{
+			std::ifstream in(std::filesystem::path(Options().ProfileBaselinePath));
+			if (in)
+			{
+				baseline = StartupProfiler::ReadReport(in);
+			}
+			else
+			{
+				LOG_WARN(L"Could not read startup baseline '%ls'", Options().ProfileBaselinePath.c_str());
+			}
+		}
+
+		std::ofstream out(std::filesystem::path(Options().ProfileStartupPath), std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			LOG_WARN(L"Could not write startup profile '%ls'", Options().ProfileStartupPath.c_str());
+			return;
+		}
+
+		TheStartupProfiler.WriteReport(out, hasBaseline ? &baseline : nullptr);
+		LOG_INFO(L"Wrote startup profile to %ls", Options().ProfileStartupPath.c_str());
+	}
+
+	/// <summary>
+	/// Writes recorded trace zones to the --trace file, if requested.
+	/// </summary>
+	void WriteTraceFile()
+	{
+		if (Options().TracePath.empty())
+		{
+			return;
+		}
+
+#if defined(PROJECTORSWITCH_TRACE)
+		std::ofstream out(std::filesystem::path(Options().TracePath), std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			LOG_WARN(L"Could not write trace file '%ls'", Options().TracePath.c_str());
+			return;
+		}
+
+		TraceRecorder::Instance().ExportChromeTrace(out);
+		LOG_INFO(L"Wrote trace to %ls", Options().TracePath.c_str());
+#else
+		LOG_WARN(L"--trace ignored: this build was compiled without PROJECTORSWITCH_TRACE");
+#endif
+	}
+
+	std::filesystem::path GetStatsFilePath()
+	{
+		const SettingsService ss;
+		return std::filesystem::path(ss.GetSiblingFilePath(StatsFileName));
+	}
+
+	/// <summary>
+	/// Loads the persisted toggle statistics (empty if the file is missing or invalid).
+	/// </summary>
+	ToggleStats LoadStatsFile()
+	{
+		ToggleStats stats;
+		std::ifstream in(GetStatsFilePath(), std::ios::in | std::ios::binary);
+		if (in)
+		{
+			stats.Read(in);
+		}
+		return stats;
+	}
+
+	/// <summary>
+	/// Merges the toggles recorded since the last merge into the stats file beside
+	/// settings.ini, so a crash or forced logoff loses at most the toggle in flight.
+	/// The file is replaced by renaming a complete copy over it.
+	/// </summary>
+	void MergeStatsFile()
+	{
+		if (SessionStats.ToggleCount() == 0)
+		{
+			return;
+		}
+
+		// Static, to keep the histograms (tens of KB) off the stack.
+		static ToggleStats stats;
+		const std::filesystem::path path = GetStatsFilePath();
+		{
+			std::ifstream in(path, std::ios::in | std::ios::binary);
+			if (!in || !stats.Read(in))
+			{
+				stats.Reset();
+			}
+		}
+		stats.Merge(SessionStats);
+
+		std::filesystem::path tempPath = path;
+		tempPath += L".tmp";
+		{
+			std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (out)
+			{
+				stats.Write(out);
+			}
+			if (!out)
+			{
+				LOG_WARN(L"Could not write toggle statistics file");
+				return;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, path, ec);
+		if (ec)
+		{
+			LOG_WARN(L"Could not replace toggle statistics file: %hs", ec.message().c_str());
+			return;
+		}
+
+		DLOG_INFO(L"Merged %llu toggle(s) into statistics file (total %llu)",
+			static_cast<unsigned long long>(SessionStats.ToggleCount()), static_cast<unsigned long long>(stats.ToggleCount()));
+		SessionStats.Reset();
+	}
+
+	/// <summary>
+	/// Benchmarks DLOG_* against direct logging calls (which write to the application
+	/// log) and writes the report.
+	/// </summary>
+	/// <returns>Process exit code (non-zero if the report could not be written or a deferred message was lost).</returns>
+	int RunLoggingBenchmark()
+	{
+		std::ofstream out(std::filesystem::path(Options().BenchLoggingPath), std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			LOG_ERROR(L"Could not create logging benchmark report: %ls", Options().BenchLoggingPath.c_str());
+			return 2;
+		}
+
+		return LogBenchmark::Run(out, [](const long long totalUs, const wchar_t* detail)
+			{
+				LOG_INFO(L"Toggle completed in %lld us (%ls)", totalUs, detail);
+			}) ? 0 : 1;
+	}
+
+	/// <summary>
+	/// Runs the discovery benchmark against simulated desktops (or the --replay-tree
+	/// snapshots, if given) and writes the report.
+	/// </summary>
+	/// <returns>Process exit code (non-zero if the report could not be written, a snapshot could not be read, or a scenario chose the wrong window).</returns>
+	int RunDiscoveryBenchmark()
+	{
+		std::ofstream out(std::filesystem::path(Options().BenchDiscoveryPath), std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			return 2;
+		}
+
+		if (Options().ReplayTreePaths.empty())
+		{
+			return DiscoveryBenchmark::Run(out, DiscoveryBenchmark::DefaultCases()) ? 0 : 1;
+		}
+
+		bool allCorrect = true;
+		for (const auto& path : Options().ReplayTreePaths)
+		{
+			std::ifstream in(std::filesystem::path(path), std::ios::in | std::ios::binary);
+			TreeSnapshotReader reader;
+			if (!in || !reader.Open(in))
+			{
+				return 2;
+			}
+
+			allCorrect = DiscoveryBenchmark::RunSnapshot(out, std::filesystem::path(path).filename().string(), reader) && allCorrect;
+		}
+
+		return allCorrect ? 0 : 1;
+	}
+
+	/// <summary>
+	/// Captures the Zoom windows' element trees to the --capture-tree file.
+	/// </summary>
+	/// <returns>Process exit code.</returns>
+	int CaptureTree()
+	{
+		std::ofstream out(std::filesystem::path(Options().CaptureTreePath), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!out)
+		{
+			LOG_ERROR(L"Could not create tree snapshot file: %ls", Options().CaptureTreePath.c_str());
+			return 2;
+		}
+
+		const std::vector<std::uint32_t> processIds = ProcessesService().GetProcessIds(ProviderRegistry::Zoom().ProcessNames);
+		if (processIds.empty())
+		{
+			LOG_WARN(L"Zoom is not running; the tree snapshot holds no windows");
+		}
+
+		const AutomationService automation;
+		const TreeCaptureResult result = UiaTreeCapture::Capture(
+			automation.GetAutomationInterface(), automation.DesktopElement(), MediaWindowSelectors::Zoom(), processIds, out);
+
+		if (!result.Ok)
+		{
+			LOG_ERROR(L"Tree capture failed");
+			return 1;
+		}
+
+		LOG_INFO(L"Captured %d window(s) of %zu Zoom process(es), %d element(s) to %ls (%d candidate(s), selected element %d)",
+			result.Windows, processIds.size(), result.Elements, Options().CaptureTreePath.c_str(), result.Candidates, result.SelectedElement);
+		return 0;
+	}
+
+	/// <summary>
+	/// Applies or reverts the --scene scene.
+	/// </summary>
+	/// <returns>Process exit code.</returns>
+	int ToggleScene()
+	{
+		SettingsService settingsService;
+		const SceneService sceneService(&settingsService);
+		const SceneToggleResult result = sceneService.Toggle(Options().SceneName);
+
+		if (!result.Ok)
+		{
+			LOG_ERROR(L"Scene %ls could not be %ls", Options().SceneName.c_str(), result.Applied ? L"applied" : L"reverted");
+			return 1;
+		}
+
+		LOG_INFO(L"Scene %ls %ls: %zu window(s) moved, %zu unresolved%ls", Options().SceneName.c_str(),
+			result.Applied ? L"applied" : L"reverted", result.Moved, result.Unresolved,
+			result.Corrected ? L" (corrected after DPI change)" : L"");
+		return 0;
+	}
+
+	/// <summary>
+	/// Creates a ZoomService whose toggles make their calls through Win32 and the given
+	/// UI Automation service (owned by the ZoomService).
+	/// </summary>
+	std::unique_ptr<ZoomService> NewZoomService(AutomationService* automationService)
+	{
+		return std::make_unique<ZoomService>(automationService, std::make_unique<Win32PlatformBackend>(automationService));
+	}
+
+	/// <summary>
+	/// Runs the --selftest-soak leak checks: the discovery logic against counted fake
+	/// automation objects (100,000 toggles), then the real ZoomService toggle, sampling
+	/// the process's handles, GDI/USER objects and private bytes.
+	/// </summary>
+	/// <returns>Process exit code (non-zero if the report could not be written or a leak was detected).</returns>
+	int RunSoakSelfTest()
+	{
+		std::ofstream out(std::filesystem::path(Options().SoakReportPath), std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			LOG_ERROR(L"Could not create soak report file: %ls", Options().SoakReportPath.c_str());
+			return 2;
+		}
+
+		bool ok = SoakBenchmark::RunSimulated(out, SoakOptions(), &ProcessResources::Sample);
+		LOG_INFO(L"Simulated soak %ls", ok ? L"passed" : L"detected a leak");
+
+		// Real toggles move the Zoom window (when present), so far fewer of them.
+		SoakOptions options;
+		options.Toggles = RealSoakToggles;
+		options.Warmup = RealSoakWarmup;
+		options.ReportEvery = RealSoakReportEvery;
+
+		const std::unique_ptr<ZoomService> zs = NewZoomService(new AutomationService());
+		const bool realOk = SoakBenchmark::Run(out, "toggle", [&zs] { return zs->Toggle().AllOk; }, &ProcessResources::Sample, options);
+		LOG_INFO(L"Toggle soak %ls", realOk ? L"passed" : L"detected a leak");
+
+		ok = ok && realOk;
+		return ok ? 0 : 1;
+	}
+
+	void ShowStats()
+	{
+		const ToggleStats stats = LoadStatsFile();
+		MessageBoxW(nullptr, stats.FormatReport().c_str(), L"ProjectorSwitch Statistics", MB_OK | MB_ICONINFORMATION | MB_SETFOREGROUND | MB_TOPMOST);
+	}
+
+	/// <summary>
+	/// Writes the flight recorder contents to a timestamped file in the Logs folder.
+	/// </summary>
+	/// <param name="reason">Short description written to the file header.</param>
+	void DumpFlightRecorder(const char* reason)
+	{
+		SYSTEMTIME now{};
+		GetLocalTime(&now);
+
+		wchar_t fileName[64];
+		swprintf_s(fileName, L"flight-%04u%02u%02u-%02u%02u%02u-%03u.log",
+			now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond, now.wMilliseconds);
+
+		const std::filesystem::path folder = std::filesystem::path(GetCurrentFolder()) / L"Logs";
+		std::error_code ec;
+		std::filesystem::create_directories(folder, ec);
+
+		std::ofstream out(folder / fileName, std::ios::out | std::ios::trunc);
+		if (!out)
+		{
+			LOG_WARN(L"Could not write flight recorder dump");
+			return;
+		}
+
+		out << "# ProjectorSwitch flight recorder: " << reason << "\n";
+		FlightRecorder::Instance().Dump(out);
+		LOG_INFO(L"Flight recorder dumped to %ls (%hs)", fileName, reason);
+	}
+
+	/// <summary>
+	/// Records a toggle outcome in the session statistics, logs failures and dumps
+	/// the flight recorder if the toggle failed or exceeded its latency budget.
+	/// </summary>
+	void RecordToggleResult(const DisplayWindowResult& result)
+	{
+		static const std::int64_t budgetUs = static_cast<std::int64_t>(SettingsService().LoadToggleLatencyBudgetMs()) * 1000;
+
+		SessionStats.Record(result);
+		TheAppState.Update([&result](AppState& state) { state.ApplyToggleResult(result); });
+		DLOG_DEBUG(L"Toggle calls: %ls", result.Calls.Format().c_str());
+		DLOG_DEBUG(L"Toggle resize events: %u", result.ResizeEvents);
+#if defined(_DEBUG)
+		DLOG_DEBUG(L"COM ownership transfers so far: %llu", static_cast<unsigned long long>(UniqueRefStats::Transfers.load()));
+#endif
+
+		if (result.AllOk)
+		{
+			DLOG_INFO(L"Toggle completed in %lld us", static_cast<long long>(result.Timings.TotalUs));
+			if (result.Timings.ClickToVisibleUs > 0)
+			{
+				DLOG_INFO(L"Click to visible: %lld us", static_cast<long long>(result.Timings.ClickToVisibleUs));
 			}
-			else
+			if (result.Calls.Exceeds(CallCounts::DefaultToggleBudget()))
 			{
-				LOG_WARN(L"--monitor index %lu out of range (1..%zu)", oneBased, monitors.size());
-				return false;
+				DLOG_WARN(L"Toggle exceeded its call budget: %ls", result.Calls.Format().c_str());
+			}
+			if (budgetUs > 0 && result.Timings.TotalUs > budgetUs)
+			{
+				DumpFlightRecorder("toggle exceeded latency budget");
 			}
 		}
 		else
 		{
-			for (size_t i = 0; i < monitors.size(); ++i)
-			{
-				const auto& m = monitors[i];
-				if (_wcsicmp(m.Key.c_str(), arg.c_str()) == 0 ||
-					_wcsicmp(m.FriendlyName.c_str(), arg.c_str()) == 0 ||
-					_wcsicmp(m.DeviceName.c_str(), arg.c_str()) == 0)
-				{
-					index = static_cast<int>(i);
-					break;
-				}
-			}
-			if (index < 0)
-			{
-				LOG_WARN(L"--monitor value '%ls' did not match any Key/FriendlyName/DeviceName", arg.c_str());
-				return false;
-			}
+			DLOG_WARN(L"Toggle failed: %ls", result.ErrorMessage.c_str());
+			DumpFlightRecorder("toggle failed");
 		}
-
-		const MonitorData& md = monitors[static_cast<size_t>(index)];
-		const SettingsService ss;
-		ss.SaveSelectedMonitorKey(md.Key);
-		ss.SaveSelectedMonitorRect(md.MonitorRect);
-		LOG_INFO(L"Applied monitor selection via CLI: index=%d key=%ls rect=[%ld,%ld,%ld,%ld]",
-			index + 1, md.Key.c_str(), md.MonitorRect.left, md.MonitorRect.top, md.MonitorRect.right, md.MonitorRect.bottom);
-		return true;
 	}
 
 	/// <summary>
-	/// Saves main window position to settings
+	/// Logs what was done to follow a screen share; a media window moved along with it
+	/// counts as a toggle.
 	/// </summary>
-	/// <param name="hWnd">Main window handle</param>
-	void SaveWindowPosition(const HWND hWnd)
+	void ReportShareFollow(const ShareFollowReport& report)
 	{
-		SettingsService ss;
-		const WindowPlacementService wps(&ss);
-		wps.SaveWindowPlace(hWnd);
-		LOG_DEBUG(L"Saved window position");
+		if (report.Steps.ShowShare != 0)
+		{
+			DLOG_INFO(L"Followed screen share onto the projector: %lld us event to visible", static_cast<long long>(report.EventToVisibleUs));
+		}
+		if (report.Steps.SendShareHome != 0)
+		{
+			DLOG_INFO(L"Screen share window sent back");
+		}
+		if (report.MediaToggled)
+		{
+			RecordToggleResult(report.MediaToggle);
+		}
 	}
 
-	/// <summary>
-	/// Restores main window position from settings
-	/// </summary>
-	/// <param name="hwnd">Main window handle</param>
-	void RestoreWindowPosition(const HWND hwnd)
+	std::unique_ptr<ZoomService> CreateZoomService(AutomationService* automationService = new AutomationService())
 	{
-		SettingsService ss;
-		const WindowPlacementService wps(&ss);
-		wps.RestoreWindowPlace(hwnd);
-		LOG_DEBUG(L"Restored window position");
+		std::unique_ptr<ZoomService> zoomService = NewZoomService(automationService);
+		zoomService->EnableHoldingSlide();
+		zoomService->EnableShareFollow(TheReactor, ReportShareFollow);
+		return zoomService;
+	}
+
+	void LogFootprint(const wchar_t* transition, const wchar_t* reason, const ResourceSample& before, const ResourceSample& after)
+	{
+		LOG_INFO(L"%ls (%ls): private bytes %lld -> %lld, handles %lld -> %lld, GDI %lld -> %lld",
+			transition, reason,
+			static_cast<long long>(before.PrivateBytes), static_cast<long long>(after.PrivateBytes),
+			static_cast<long long>(before.Handles), static_cast<long long>(after.Handles),
+			static_cast<long long>(before.GdiObjects), static_cast<long long>(after.GdiObjects));
 	}
 
 	/// <summary>
-	/// Handles resizing of the main window, rearranging controls as needed
+	/// Re-enumerates the monitors into the combo box if the list was released while
+	/// idle, reselecting the saved monitor (the layout may have changed meanwhile).
 	/// </summary>
-	/// <param name="hwnd">Main window handle (unused)</param>
-	/// <param name="lParam">lParam value (new width and height)</param>
+	void EnsureMonitorList()
+	{
+		const HWND comboBox = GetDlgItem(MainWindow(), ComboBoxId);
+		if (!comboBox || !TheAppState.Current()->Monitors.empty())
+		{
+			return;
+		}
+
+		SendMessage(comboBox, CB_RESETCONTENT, 0, 0);
+		SelectMonitor(comboBox, AddMonitorsToCombo(comboBox));
+	}
+
 	/// <summary>
-	/// Handles resizing of the main window, rearranging controls as needed
+	/// Releases what the window only needs while in use: the published monitor list
+	/// (the combo box keeps its own strings). The font stays, as the window (which
+	/// cannot be minimized) is always painted.
 	/// </summary>
-	/// <param name="hwnd">Main window handle (unused)</param>
-	/// <param name="lParam">lParam value (new width and height)</param>
-	void HandleResize(HWND hwnd, const LPARAM lParam)
+	void ReleaseIdleUi()
 	{
-		if (!BtnHandle || !ComboBoxHandle) return;
-
-		const UINT width = LOWORD(lParam);
-		const UINT height = HIWORD(lParam);
-		UNREFERENCED_PARAMETER(height);
+		TheAppState.Update([](AppState& state) { std::vector<MonitorEntry>().swap(state.Monitors); });
+	}
 
-		// Always compute sizes from logical DIPs so they rescale with DPI
-		const int btnW = Scale(ButtonWidth);
-		const int btnH = Scale(ButtonHeight);
-		const int comboW = Scale(ComboBoxWidth);
-		const int comboH = Scale(ComboBoxHeight);
+	void RestoreIdleUi()
+	{
+		EnsureMonitorList();
+	}
 
-		// Center and position with scaled margins
-		int x = static_cast<int>(width - btnW) / 2;
-		int y = Scale(10);
-		MoveWindow(BtnHandle, x, y, btnW, btnH, TRUE);
+	/// <summary>
+	/// Creates the ZoomService from the worker's AutomationService once the worker has
+	/// finished (waiting for it if need be).
+	/// </summary>
+	/// <param name="generation">The acquisition to adopt; a stale one is ignored.</param>
+	void AdoptAcquisition(const std::uint64_t generation)
+	{
+		if (generation != AcquisitionGeneration || !AcquisitionWorker.joinable())
+		{
+			return;
+		}
 
-		x = static_cast<int>(width - comboW) / 2;
-		y = y + btnH + Scale(20);
-		MoveWindow(ComboBoxHandle, x, y, comboW, comboH, TRUE);
+		AcquisitionWorker.join();
+		SetWindowZoomService(MainWindow(), CreateZoomService(PendingAutomation.release()));
+		RestoreIdleUi();
+		LogFootprint(L"Active", AcquisitionReason, AcquisitionBefore, ProcessResources::Sample());
 	}
 
 	/// <summary>
-	/// Adds monitor entries to the combo box
+	/// Starts acquiring released resources in the background. This thread joins the
+	/// COM apartment, which is cheap and keeps the worker's objects alive after it
+	/// exits; the worker loads UI Automation and locates the desktop element, then the
+	/// result is posted back through the reactor, so hovering Toggle never blocks.
 	/// </summary>
-	/// <param name="comboHandle">ComboBox handle</param>
-	void AddMonitorsToCombo(const HWND comboHandle)
+	/// <param name="reason">Why (for the log).</param>
+	void StartAcquisition(const wchar_t* reason)
 	{
-		constexpr MonitorService ms;
-		TheMonitorData = ms.GetMonitorsData();
-
-		for (const auto& i : TheMonitorData)
+		if (WindowZoomService() || AcquisitionWorker.joinable())
 		{
-			const std::wstring displayText = i.GetDisplayName();
-			SendMessage(comboHandle, CB_ADDSTRING, 0, reinterpret_cast<LPARAM>(displayText.c_str()));
+			return;
 		}
 
-		// Show ~8 items when dropped (no need to inflate the control's selection height)
-		SendMessage(comboHandle, CB_SETMINVISIBLE, 8, 0);
-		LOG_INFO(L"Enumerated %zu monitor(s) into combo box", TheMonitorData.size());
+		AcquisitionReason = reason;
+		AcquisitionBefore = ProcessResources::Sample();
+		PendingAutomation = std::make_unique<AutomationService>(AutomationService::Creation::Deferred);
+
+		const std::uint64_t generation = ++AcquisitionGeneration;
+		AutomationService* automation = PendingAutomation.get();
+		AcquisitionWorker = std::thread([automation, generation]
+		{
+			const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+			automation->Create();
+			if (SUCCEEDED(hr))
+			{
+				CoUninitialize();
+			}
+			TheReactor.Post([generation] { AdoptAcquisition(generation); });
+		});
 	}
 
 	/// <summary>
-	/// Creates the toggle button
+	/// Makes sure the ZoomService exists now (a toggle needs it): finishes an acquisition
+	/// in progress, or acquires synchronously if none was started.
 	/// </summary>
-	/// <param name="parent">Parent handle</param>
-	/// <returns>Button handle</returns>
-	HWND CreateButton(const HWND parent)
+	/// <param name="reason">Why (for the log).</param>
+	void AcquireResources(const wchar_t* reason)
 	{
-		return CreateWindowW(
-			L"BUTTON",
-			L"Toggle Zoom Window",
-			WS_TABSTOP | WS_VISIBLE | WS_CHILD | WS_DISABLED,
-			Scale(10), // x position 
-			Scale(10), // y position 
-			Scale(ButtonWidth),
-			Scale(ButtonHeight),
-			parent,
-			reinterpret_cast<HMENU>(static_cast<UINT_PTR>(ButtonId)), // NOLINT(performance-no-int-to-ptr)
-			reinterpret_cast<HINSTANCE>(GetWindowLongPtr(parent, GWLP_HINSTANCE)), // NOLINT(performance-no-int-to-ptr)
-			nullptr); // Pointer not needed.
+		if (AcquisitionWorker.joinable())
+		{
+			AdoptAcquisition(AcquisitionGeneration);
+			return;
+		}
+
+		if (WindowZoomService())
+		{
+			return;
+		}
+
+		const ResourceSample before = ProcessResources::Sample();
+		SetWindowZoomService(MainWindow(), CreateZoomService());
+		RestoreIdleUi();
+		LogFootprint(L"Active", reason, before, ProcessResources::Sample());
 	}
 
 	/// <summary>
-	/// Responds to selection of a monitor in the combo box
+	/// Destroys the ZoomService, releasing UI Automation, the desktop element, the COM
+	/// apartment and the frame metrics cache, releases the monitor list and font, and
+	/// trims the working set.
 	/// </summary>
-	/// <param name="comboHandle">ComboBox handle</param>
-	void SelectMonitor(const HWND comboHandle)
+	void ReleaseIdleResources()
 	{
-		const SettingsService ss;
-		const std::wstring savedKey = ss.LoadSelectedMonitorKey();
-		const RECT savedRect = ss.LoadSelectedMonitorRect();
+		// An acquisition still running is finished first, so that it is released too.
+		AdoptAcquisition(AcquisitionGeneration);
+		if (!WindowZoomService())
+		{
+			return;
+		}
 
-		const int index = MonitorService::FindMonitorIndex(TheMonitorData, savedKey, savedRect);
+		const ResourceSample before = ProcessResources::Sample();
+		SetWindowZoomService(MainWindow(), nullptr);
+		ReleaseIdleUi();
+		HeapCompact(GetProcessHeap(), 0);
+		SetProcessWorkingSetSize(GetCurrentProcess(), static_cast<SIZE_T>(-1), static_cast<SIZE_T>(-1));
+		LogFootprint(L"Idle", L"Zoom absent", before, ProcessResources::Sample());
+	}
 
-		if (index >= 0)
+	void ApplyIdleAction(const IdleAction action, const wchar_t* reason)
+	{
+		if (action == IdleAction::Release)
 		{
-			SendMessage(comboHandle, CB_SETCURSEL, index, 0);
-			EnableWindow(BtnHandle, TRUE);
-			LOG_INFO(L"Preselected monitor index %d", index);
+			ReleaseIdleResources();
 		}
-		else
+		else if (action == IdleAction::Acquire)
 		{
-			// clear
-			SendMessage(comboHandle, CB_SETCURSEL, static_cast<WPARAM>(-1), 0);
-			LOG_WARN(L"No persisted monitor selection matched");
+			StartAcquisition(reason);
+		}
+	}
+
+	void NoteUserIntent()
+	{
+		if (TheIdlePolicy)
+		{
+			ApplyIdleAction(TheIdlePolicy->OnUserIntent(IdlePolicy::Clock::now()), L"user");
 		}
 	}
 
 	/// <summary>
-	/// Creates a screen font similar to modern Windows UI
+	/// Periodic check (on the reactor) for the Zoom process, releasing or acquiring
+	/// resources as the idle policy decides.
 	/// </summary>
-	/// <returns>Font handle</returns>
-	HFONT CreateModernFont()
+	void CheckZoomPresence()
 	{
-		// ~10pt Segoe UI; negative => character height
-		constexpr int pointSize = 10;
-		const int lfHeight = -MulDiv(pointSize, static_cast<int>(CurrentDpi), 72);
-		return CreateFont(
-			lfHeight, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
-			DEFAULT_CHARSET, OUT_OUTLINE_PRECIS,
-			CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH,
-			L"Segoe UI");
+		const bool running = ZoomService::IsProviderRunning();
+		const ZoomPresence presence = running ? ZoomPresence::Running : ZoomPresence::NotRunning;
+		if (TheAppState.Current()->Presence != presence)
+		{
+			TheAppState.Update([presence](AppState& state) { state.Presence = presence; });
+		}
+
+		ApplyIdleAction(TheIdlePolicy->OnZoomPresence(running, IdlePolicy::Clock::now()), L"Zoom started");
 	}
 
 	/// <summary>
-	/// Sets a modern font for the controls
-	/// </summary>	
-	void SetModernFont()
+	/// Starts the periodic Zoom presence check that drives idle resource release
+	/// (IdleReleaseSeconds). A waitable timer on the reactor; no thread of its own.
+	/// </summary>
+	void StartPresenceChecks()
 	{
-		if (ModernFont)
+		const int releaseSeconds = SettingsService().LoadIdleReleaseSeconds();
+		TheIdlePolicy = std::make_unique<IdlePolicy>(std::chrono::seconds(releaseSeconds), IdlePolicy::Clock::now());
+		if (releaseSeconds <= 0)
 		{
-			DeleteObject(ModernFont);
+			LOG_INFO(L"Idle resource release disabled");
+			return;
 		}
-		ModernFont = CreateModernFont();
 
-		if (ModernFont)
+		PresenceTimer.Attach(CreateWaitableTimerW(nullptr, FALSE, nullptr));
+		LARGE_INTEGER due{};
+		due.QuadPart = -static_cast<LONGLONG>(PresenceCheckMs) * 10000; // relative, in 100ns units
+		if (!PresenceTimer || !SetWaitableTimerEx(PresenceTimer, &due, PresenceCheckMs, nullptr, nullptr, nullptr, PresenceCheckToleranceMs))
 		{
-			// WM_SETFONT is meaningful for child controls
-			if (BtnHandle) SendMessage(BtnHandle, WM_SETFONT, reinterpret_cast<WPARAM>(ModernFont), TRUE);
-			if (ComboBoxHandle) SendMessage(ComboBoxHandle, WM_SETFONT, reinterpret_cast<WPARAM>(ModernFont), TRUE);
+			Logger::LogLastError(Logger::Level::Warn, L"SetWaitableTimerEx");
+			return;
 		}
-		LOG_DEBUG(L"Applied modern font (DPI=%u)", CurrentDpi);
+
+		TheReactor.Register(PresenceTimer, CheckZoomPresence);
+		LOG_INFO(L"Releasing UI Automation after Zoom has been absent for %d s", releaseSeconds);
 	}
 
 	/// <summary>
-	/// Creates the combo box for monitor selection
+	/// Sets the click-to-visible latency of a toggle that put the media window on the
+	/// projector: from the input event to the vertical blank at which the compositor
+	/// first presents it fully opaque.
 	/// </summary>
-	/// <param name="parent">Parent handle</param>
-	/// <returns>ComboBox handle</returns>
-	HWND CreateComboBox(const HWND parent)
+	void MeasureClickToVisible(const std::int64_t inputQpc, DisplayWindowResult& result)
 	{
-		const auto result = CreateWindowW(
-			L"COMBOBOX",
-			nullptr,
-			WS_TABSTOP | WS_VISIBLE | WS_CHILD | CBS_DROPDOWNLIST | WS_VSCROLL,
-			Scale(10),   // x
-			Scale(100),  // y
-			Scale(ComboBoxWidth),
-			Scale(ComboBoxHeight), // single-line selection; dropdown height handled by CB_SETMINVISIBLE
-			parent,
-			reinterpret_cast<HMENU>(static_cast<UINT_PTR>(ComboBoxId)),  // NOLINT(performance-no-int-to-ptr)
-			reinterpret_cast<HINSTANCE>(GetWindowLongPtr(parent, GWLP_HINSTANCE)), // NOLINT(performance-no-int-to-ptr)
-			nullptr);
+		CompositionSample sample;
+		if (inputQpc <= 0 || result.OpaqueQpc <= 0 || !CompositionClock::Sample(sample))
+		{
+			return;
+		}
 
-		AddMonitorsToCombo(result);
-		SelectMonitor(result);
-		return result;
+		const std::int64_t presentQpc = PresentTiming::FirstPresentAfter(sample, result.OpaqueQpc);
+		if (presentQpc > inputQpc)
+		{
+			result.Timings.ClickToVisibleUs = PresentTiming::ToMicroseconds(presentQpc - inputQpc, CompositionClock::Frequency());
+		}
 	}
 
 	/// <summary>
 	/// Toggle location of Zoom secondary window
 	/// </summary>
-	void ToggleZoomWindow()
+	/// <param name="inputQpc">When the input that asked for the toggle happened (CompositionClock).</param>
+	void ToggleZoomWindow(const std::int64_t inputQpc)
 	{
-		if (TheZoomService)
+		TRACE_ZONE("ToggleZoomWindow");
+		NoteUserIntent();
+		AcquireResources(L"toggle");
+		if (ZoomService* const zoomService = WindowZoomService())
 		{
-			LOG_INFO(L"Toggling Zoom window");
-			TheZoomService->Toggle();
+			DLOG_INFO(L"Toggling Zoom window");
+			DisplayWindowResult result = zoomService->Toggle();
+			MeasureClickToVisible(inputQpc, result);
+			RecordToggleResult(result);
+
+			PinStats pin;
+			if (zoomService->TakeEndedPinStats(pin))
+			{
+				DLOG_INFO(L"Pin ended: %llu drift event(s), %llu correction(s) (mean %lld us, max %lld us), %llu rate limited, %llu backoff(s)",
+					static_cast<unsigned long long>(pin.DriftEvents), static_cast<unsigned long long>(pin.Corrections),
+					static_cast<long long>(pin.Corrections > 0 ? pin.TotalLatencyUs / static_cast<std::int64_t>(pin.Corrections) : 0),
+					static_cast<long long>(pin.MaxLatencyUs),
+					static_cast<unsigned long long>(pin.RateLimited), static_cast<unsigned long long>(pin.Backoffs));
+			}
 
 			// Keep window topmost after toggling
-			SetWindowPos(MainWindowHandle, HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
+			SetWindowPos(MainWindow(), HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
 		}
 		else
 		{
-			LOG_WARN(L"ZoomService not initialized");
+			DLOG_WARN(L"ZoomService not initialized");
 		}
 	}
 
@@ -444,20 +1370,23 @@ namespace
 	/// <param name="selectedIndex">Index in ComboBox</param>
 	void SaveSelectedMonitorId(const int selectedIndex)
 	{
-		if (selectedIndex < 0 || static_cast<size_t>(selectedIndex) >= TheMonitorData.size())
+		const AppStateStore::Snapshot state = TheAppState.Current();
+		if (selectedIndex < 0 || static_cast<size_t>(selectedIndex) >= state->Monitors.size())
 		{
-			LOG_WARN(L"Selected monitor index %d out of range", selectedIndex);
+			DLOG_WARN(L"Selected monitor index %d out of range", selectedIndex);
 			return;
 		}
 
-		const MonitorData& md = TheMonitorData[static_cast<size_t>(selectedIndex)];
+		const MonitorEntry& monitor = state->Monitors[static_cast<size_t>(selectedIndex)];
+		const RECT rect{ monitor.Rect.Left, monitor.Rect.Top, monitor.Rect.Right, monitor.Rect.Bottom };
 
 		// Save both the robust key and the RECT for legacy behavior
 		const SettingsService ss;
-		ss.SaveSelectedMonitorKey(md.Key);
-		ss.SaveSelectedMonitorRect(md.MonitorRect);
-		LOG_INFO(L"Saved monitor selection: index=%d key=%ls rect=[%ld,%ld,%ld,%ld]",
-			selectedIndex, md.Key.c_str(), md.MonitorRect.left, md.MonitorRect.top, md.MonitorRect.right, md.MonitorRect.bottom);
+		ss.SaveSelectedMonitorKey(monitor.Key);
+		ss.SaveSelectedMonitorRect(rect);
+		PublishSelectedMonitor(monitor.Key);
+		DLOG_INFO(L"Saved monitor selection: index=%d key=%ls rect=[%ld,%ld,%ld,%ld]",
+			selectedIndex, monitor.Key.c_str(), rect.left, rect.top, rect.right, rect.bottom);
 	}
 
 	/// <summary>
@@ -474,9 +1403,9 @@ namespace
 		{
 		case WM_DPICHANGED:
 		{
-			CurrentDpi = HIWORD(wParam);
-			LOG_INFO(L"WM_DPICHANGED -> DPI=%u", CurrentDpi);
-			SetModernFont();
+			PublishWindowDpi(HIWORD(wParam));
+			LOG_INFO(L"WM_DPICHANGED -> DPI=%u", WindowDpi());
+			SetModernFont(hWnd);
 
 			const auto* const prcNewWindow = reinterpret_cast<RECT*>(lParam);  // NOLINT(performance-no-int-to-ptr)
 			SetWindowPos(hWnd,
@@ -511,17 +1440,43 @@ namespace
 		}
 
 		case WM_CREATE:
-			CurrentDpi = GetDpiForWindow(hWnd);
-			LOG_INFO(L"WM_CREATE -> initial DPI=%u", CurrentDpi);
-			BtnHandle = CreateButton(hWnd);
-			ComboBoxHandle = CreateComboBox(hWnd);
-			SetModernFont();
-			TheZoomService = std::unique_ptr<ZoomService>(new ZoomService(new AutomationService(), new ProcessesService()));
-			if (!BtnHandle || !ComboBoxHandle)
+		{
+			TheAppState.SetChangeListener([hWnd](const std::uint64_t version)
+			{
+				PostMessage(hWnd, WM_APP_STATE_CHANGED, static_cast<WPARAM>(version), 0);
+			});
+			const UINT dpi = GetDpiForWindow(hWnd);
+			TheAppState.Update([hWnd, dpi](AppState& state)
+			{
+				state.MainWindow = reinterpret_cast<std::uintptr_t>(hWnd);
+				state.WindowDpi = dpi;
+			});
+			LOG_INFO(L"WM_CREATE -> initial DPI=%u", dpi);
+			const HWND button = CreateButton(hWnd);
+			const HWND comboBox = CreateComboBox(hWnd);
+			SetModernFont(hWnd);
+			{
+				StartupProfiler::Scope phase(TheStartupProfiler, "AutomationService");
+				SetWindowZoomService(hWnd, CreateZoomService());
+			}
+			if (!button || !comboBox)
 			{
 				LOG_ERROR(L"Failed to create child controls");
 			}
 			break;
+		}
+
+		case WM_NOTIFY:
+		{
+			// Hovering Toggle re-acquires released resources before the click arrives.
+			const auto* header = reinterpret_cast<const NMHDR*>(lParam);  // NOLINT(performance-no-int-to-ptr)
+			if (header->idFrom == ButtonId && header->code == BCN_HOTITEMCHANGE &&
+				(reinterpret_cast<const NMBCHOTITEM*>(header)->dwFlags & HICF_ENTERING) != 0)
+			{
+				NoteUserIntent();
+			}
+			break;
+		}
 
 		case WM_COMMAND:
 		{
@@ -530,7 +1485,17 @@ namespace
 			case BN_CLICKED:
 				if (LOWORD(wParam) == ButtonId)
 				{
-					ToggleZoomWindow();
+					// A click, a keypress on the button, or --toggle: all stamped by GetMessageTime.
+					ToggleZoomWindow(CompositionClock::MessageTime());
+				}
+				break;
+
+			case CBN_SETFOCUS:
+			case CBN_DROPDOWN:
+				if (LOWORD(wParam) == ComboBoxId)
+				{
+					EnsureMonitorList();
+					NoteUserIntent();
 				}
 				break;
 
@@ -538,11 +1503,10 @@ namespace
 			{
 				if (LOWORD(wParam) == ComboBoxId)
 				{
-					const int selectedIndex = static_cast<int>(SendMessage(ComboBoxHandle, CB_GETCURSEL, 0, 0));
+					const int selectedIndex = static_cast<int>(SendMessage(reinterpret_cast<HWND>(lParam), CB_GETCURSEL, 0, 0));  // NOLINT(performance-no-int-to-ptr)
 					if (selectedIndex != CB_ERR)
 					{
 						SaveSelectedMonitorId(selectedIndex);
-						EnableWindow(BtnHandle, TRUE);
 					}
 					else
 					{
@@ -558,23 +1522,32 @@ namespace
 		}
 		break;
 
+		case WM_APP_STATE_CHANGED:
+			OnAppStateChanged(static_cast<std::uint64_t>(wParam));
+			break;
+
 		case WM_PAINT:
 		{
+			const auto paintStartUs = TheStartupProfiler.NowUs();
 			PAINTSTRUCT ps;
 			const HDC hdc = BeginPaint(hWnd, &ps);
 			UNREFERENCED_PARAMETER(hdc);
 			EndPaint(hWnd, &ps);
+
+			if (!FirstPaintRecorded)
+			{
+				FirstPaintRecorded = true;
+				TheStartupProfiler.AddPhase("FirstPaint", paintStartUs, TheStartupProfiler.NowUs() - paintStartUs);
+			}
 		}
 		break;
 
 		case WM_DESTROY:
 			LOG_INFO(L"WM_DESTROY");
 			SaveWindowPosition(hWnd);
-			if (ModernFont)
-			{
-				DeleteObject(ModernFont);
-				ModernFont = nullptr;
-			}
+			DeleteModernFont(hWnd);
+			SetWindowZoomService(hWnd, nullptr);
+			TheAppState.Update([](AppState& state) { state.MainWindow = 0; });
 			PostQuitMessage(0);
 			break;
 
@@ -609,10 +1582,9 @@ namespace
 
 	BOOL InitInstance(const HINSTANCE hInstance, const int nCmdShow)
 	{
-		CurrentInstance = hInstance;
-
-		// Use system DPI to compute a reasonable initial size; WM_CREATE updates CurrentDpi to window DPI.
-		CurrentDpi = GetDpiForSystem();
+		// Use system DPI to compute a reasonable initial size; WM_CREATE publishes the window DPI.
+		const UINT dpi = GetDpiForSystem();
+		PublishWindowDpi(dpi);
 
 		// Desired client size in DIPs based on content layout
 		constexpr int topMarginDip = 10;
@@ -622,8 +1594,8 @@ namespace
 		constexpr int clientDipH = topMarginDip + ButtonHeight + spacingDip + ComboBoxHeight + bottomDip; // 10 + 60 + 20 + 20 + 10 = 120
 
 		// Convert to pixels at the current DPI
-		const int clientPxW = MulDiv(clientDipW, static_cast<int>(CurrentDpi), BaseDpi);
-		const int clientPxH = MulDiv(clientDipH, static_cast<int>(CurrentDpi), BaseDpi);
+		const int clientPxW = MulDiv(clientDipW, static_cast<int>(dpi), BaseDpi);
+		const int clientPxH = MulDiv(clientDipH, static_cast<int>(dpi), BaseDpi);
 
 		constexpr DWORD exStyle = WS_EX_TOPMOST;
 		constexpr DWORD style = ((WS_OVERLAPPEDWINDOW | WS_CLIPCHILDREN) & ~(WS_MINIMIZEBOX | WS_MAXIMIZEBOX | WS_THICKFRAME));
@@ -637,7 +1609,7 @@ namespace
 			const auto pAdjust = reinterpret_cast<PFN_AdjustWindowRectExForDpi>(  // NOLINT(clang-diagnostic-cast-function-type-strict)
 				GetProcAddress(user32, "AdjustWindowRectExForDpi"));
 
-			if (pAdjust) pAdjust(&rc, style, FALSE, exStyle, CurrentDpi);
+			if (pAdjust) pAdjust(&rc, style, FALSE, exStyle, dpi);
 			else AdjustWindowRectEx(&rc, style, FALSE, exStyle);
 		}
 		else
@@ -648,7 +1620,7 @@ namespace
 		const int winW = rc.right - rc.left;
 		const int winH = rc.bottom - rc.top;
 
-		MainWindowHandle = CreateWindowExW(
+		const HWND hWnd = CreateWindowExW(
 			exStyle,
 			MainWindowClass,
 			TitleBarCaption,
@@ -662,16 +1634,16 @@ namespace
 			hInstance,
 			nullptr);
 
-		if (!MainWindowHandle)
+		if (!hWnd)
 		{
 			Logger::LogLastError(Logger::Level::Error, L"CreateWindowExW");
 			return FALSE;
 		}
 
-		RestoreWindowPosition(MainWindowHandle);
+		RestoreWindowPosition(hWnd);
 
-		ShowWindow(MainWindowHandle, nCmdShow);
-		UpdateWindow(MainWindowHandle);
+		ShowWindow(hWnd, nCmdShow);
+		UpdateWindow(hWnd);
 
 		return TRUE;
 	}
@@ -688,16 +1660,31 @@ int APIENTRY wWinMain(
 	UNREFERENCED_PARAMETER(lpCmdLine);
 
 	// Parse command-line early (before logger/UI)
-	const auto args = GetArgs();
-	ParseCommandLine(args, CmdOptions);
+	{
+		StartupProfiler::Scope phase(TheStartupProfiler, "ParseCommandLine");
+		static_cast<void>(Options());
+	}
 
 	// If help requested, show it and exit early (no logger needed)
-	if (CmdOptions.ShowHelp)
+	if (Options().ShowHelp)
 	{
 		ShowHelp();
 		return 0;
 	}
 
+	// Likewise for the statistics report
+	if (Options().ShowStats)
+	{
+		ShowStats();
+		return 0;
+	}
+
+	// ...and the discovery benchmark (simulated desktops only; no UI Automation involved)
+	if (!Options().BenchDiscoveryPath.empty())
+	{
+		return RunDiscoveryBenchmark();
+	}
+
 	// Set DPI awareness to per-monitor v2
 	SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
 
@@ -709,47 +1696,104 @@ int APIENTRY wWinMain(
 
 	// Initialize logger as early as possible
 	const std::filesystem::path base = GetCurrentFolder();
-	Logger::Init(L"ProjectorSwitch", base / L"Logs");
+	{
+		StartupProfiler::Scope phase(TheStartupProfiler, "Logger::Init");
+		Logger::Init(L"ProjectorSwitch", base / L"Logs");
+		DeferredLog::Instance().Start(WriteDeferredLog);
+	}
 	LOG_INFO(L"Starting ProjectorSwitch");
 
-	if (!CmdOptions.Unknown.empty())
+	if (!Options().Unknown.empty())
 	{
 		std::wstring unk;
-		for (size_t i = 0; i < CmdOptions.Unknown.size(); ++i)
+		for (size_t i = 0; i < Options().Unknown.size(); ++i)
 		{
 			if (i) unk += L", ";
-			unk += CmdOptions.Unknown[i];
+			unk += Options().Unknown[i];
 		}
 		LOG_WARN(L"Unknown command-line argument(s): %ls", unk.c_str());
 	}
 
+	// Diagnostic capture does not interfere with a running instance, so runs before the guard
+	if (!Options().CaptureTreePath.empty())
+	{
+		const int exitCode = CaptureTree();
+		ShutdownLogging();
+		return exitCode;
+	}
+
+	// The logging benchmark compares against the real log, so needs it open
+	if (!Options().BenchLoggingPath.empty())
+	{
+		const int exitCode = RunLoggingBenchmark();
+		ShutdownLogging();
+		return exitCode;
+	}
+
+	// Scenes move other applications' windows only, so also run alongside an instance
+	if (!Options().SceneName.empty())
+	{
+		const int exitCode = ToggleScene();
+		ShutdownLogging();
+		return exitCode;
+	}
+
 	// Single-instance guard
+	const auto mutexStartUs = TheStartupProfiler.NowUs();
 	CHandle appMutex(CreateMutex(nullptr, TRUE, AppName.c_str()));
-	if (GetLastError() == ERROR_ALREADY_EXISTS)
+	const bool alreadyRunning = GetLastError() == ERROR_ALREADY_EXISTS;
+	TheStartupProfiler.AddPhase("MutexCheck", mutexStartUs, TheStartupProfiler.NowUs() - mutexStartUs);
+	if (alreadyRunning)
 	{
 		LOG_WARN(L"Another instance is already running");
-		Logger::Shutdown();
+		ShutdownLogging();
 		return FALSE;
 	}
 
+	// The soak test toggles the Zoom window, so only runs without another instance
+	if (!Options().SoakReportPath.empty())
+	{
+		const int exitCode = RunSoakSelfTest();
+		ShutdownLogging();
+		return exitCode;
+	}
+
 	// Headless mode: do not create UI
-	if (CmdOptions.NoGui)
+	if (Options().NoGui)
 	{
 		LOG_INFO(L"Running in headless mode (--no-gui)");
-		if (!CmdOptions.MonitorArg.empty())
+		if (!Options().MonitorArg.empty())
 		{
-			ApplyMonitorSelection(CmdOptions.MonitorArg);
+			ApplyMonitorSelection(Options().MonitorArg);
 		}
 
-		if (CmdOptions.Toggle)
+		if (Options().Toggle)
 		{
 			LOG_INFO(L"Headless --toggle requested");
-			const std::unique_ptr<ZoomService> zs(new ZoomService(new AutomationService(), new ProcessesService()));
-			zs->Toggle();
+			if (SettingsService().LoadMirrorMode())
+			{
+				LOG_WARN(L"ToggleMode=mirror only lasts while ProjectorSwitch is running; use the window instead of --no-gui");
+			}
+			const auto automationStartUs = TheStartupProfiler.NowUs();
+			const std::unique_ptr<ZoomService> zs = NewZoomService(new AutomationService());
+			zs->EnableWarmStart(SettingsService().GetSiblingFilePath(DiscoveryCacheFileName));
+			TheStartupProfiler.AddPhase("AutomationService", automationStartUs, TheStartupProfiler.NowUs() - automationStartUs);
+
+			// Warm and cold toggles are reported as separate phases so they can be compared.
+			const auto toggleStartUs = TheStartupProfiler.NowUs();
+			const DisplayWindowResult result = zs->Toggle();
+			const bool warm = (result.Fallbacks & ToggleFallbackWarmStart) != 0;
+			TheStartupProfiler.AddPhase(warm ? "Toggle.Warm" : "Toggle.Cold", toggleStartUs, TheStartupProfiler.NowUs() - toggleStartUs);
+			LOG_INFO(L"Headless toggle: %ls start (discovery cache %ls), %lld us",
+				warm ? L"warm" : L"cold", DiscoveryCache::ValidityName(zs->WarmStartValidity()), static_cast<long long>(result.Timings.TotalUs));
+			RecordToggleResult(result);
 		}
 
+		WriteStartupReport();
+		MergeStatsFile();
+		WriteTraceFile();
 		LOG_INFO(L"Headless run complete");
-		Logger::Shutdown();
+		ShutdownLogging();
 		return 0;
 	}
 
@@ -758,54 +1802,83 @@ int APIENTRY wWinMain(
 	INITCOMMONCONTROLSEX commonCtrlsEx{};
 	commonCtrlsEx.dwSize = sizeof(INITCOMMONCONTROLSEX);
 	commonCtrlsEx.dwICC = ICC_WIN95_CLASSES;
-	if (!InitCommonControlsEx(&commonCtrlsEx))
 	{
-		LOG_ERROR(L"InitCommonControlsEx failed");
+		StartupProfiler::Scope phase(TheStartupProfiler, "InitCommonControlsEx");
+		if (!InitCommonControlsEx(&commonCtrlsEx))
+		{
+			LOG_ERROR(L"InitCommonControlsEx failed");
+		}
 	}
 
 	// Initialize global strings
-	LoadStringW(hInstance, IDS_APP_TITLE, TitleBarCaption, MaxLoadStringLength);
-	LoadStringW(hInstance, IDC_PROJECTOR_SWITCH, MainWindowClass, MaxLoadStringLength);
-	ProjectSwitchRegisterClass(hInstance);
+	{
+		StartupProfiler::Scope phase(TheStartupProfiler, "RegisterClass");
+		LoadStringW(hInstance, IDS_APP_TITLE, TitleBarCaption, MaxLoadStringLength);
+		LoadStringW(hInstance, IDC_PROJECTOR_SWITCH, MainWindowClass, MaxLoadStringLength);
+		ProjectSwitchRegisterClass(hInstance);
+	}
 
 	// If --monitor is provided, persist selection before window creation so UI can preselect it
-	if (!CmdOptions.MonitorArg.empty())
+	if (!Options().MonitorArg.empty())
 	{
-		ApplyMonitorSelection(CmdOptions.MonitorArg);
+		ApplyMonitorSelection(Options().MonitorArg);
 	}
 
 	// Perform application initialization:
 	if (!InitInstance(hInstance, nCmdShow))
 	{
 		LOG_ERROR(L"InitInstance failed");
-		Logger::Shutdown();
+		ShutdownLogging();
 		return FALSE;
 	}
 
+	StartPresenceChecks();
+
 	// If --toggle provided with UI, trigger one-shot toggle after window init
-	if (CmdOptions.Toggle && MainWindowHandle)
+	if (Options().Toggle && MainWindow())
 	{
 		LOG_INFO(L"Queuing one-shot toggle (--toggle) after UI initialization");
-		PostMessage(MainWindowHandle, WM_COMMAND, MAKEWPARAM(ButtonId, BN_CLICKED), 0);
+		PostMessage(MainWindow(), WM_COMMAND, MAKEWPARAM(ButtonId, BN_CLICKED), 0);
 	}
 
 	const HACCEL hAccelTable = LoadAccelerators(hInstance, MAKEINTRESOURCE(IDC_PROJECTOR_SWITCH));
 
-	MSG msg;
-
-	// Main message loop:
-	while (GetMessage(&msg, nullptr, 0, 0))
+	// Main event loop: window messages and registered kernel objects on this thread.
+	TheReactor.SetMessageFilter([hAccelTable](MSG& msg)
 	{
 		// Use the main window handle for accelerator translation
-		if (MainWindowHandle && hAccelTable && !TranslateAccelerator(MainWindowHandle, hAccelTable, &msg))		
+		const HWND hWnd = MainWindow();
+		return hWnd && hAccelTable && TranslateAccelerator(hWnd, hAccelTable, &msg);
+	});
+
+	// The first time the queue drains (after the first WM_PAINT), startup is complete.
+	// After a toggle, its statistics are merged once the queue drains.
+	TheReactor.SetIdleCallback([]
+	{
+		if (!TheStartupProfiler.IsFinished())
 		{
-			TranslateMessage(&msg);
-			DispatchMessage(&msg);
+			WriteStartupReport();
 		}
+		MergeStatsFile();
+	});
+
+	const int exitCode = TheReactor.Run();
+
+	if (AcquisitionWorker.joinable())
+	{
+		AcquisitionWorker.join();
 	}
+	PendingAutomation.reset();
+
+	WriteTraceFile();
+	MergeStatsFile();
 
-	const int exitCode = static_cast<int>(msg.wParam);
+	const ReactorStats loopStats = TheReactor.Stats();
+	LOG_INFO(L"Event loop: %llu wakeups (%llu idle), %llu messages, %llu handle events, %llu tasks",
+		static_cast<unsigned long long>(loopStats.Wakeups), static_cast<unsigned long long>(loopStats.IdleWakeups),
+		static_cast<unsigned long long>(loopStats.Messages), static_cast<unsigned long long>(loopStats.HandleEvents),
+		static_cast<unsigned long long>(loopStats.Tasks));
 	LOG_INFO(L"Exiting with code %d", exitCode);
-	Logger::Shutdown();
+	ShutdownLogging();
 	return exitCode;
 }
\ No newline at end of file
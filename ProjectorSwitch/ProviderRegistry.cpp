@@ -0,0 +1,159 @@
+#include <unordered_set>
+#include <utility>
+#include "ProviderRegistry.h"
+
+namespace
+{
+	// Windows file names are case-insensitive; process and provider names are ASCII in practice.
+	std::wstring Fold(const std::wstring& text)
+	{
+		std::wstring folded = text;
+		for (auto& c : folded)
+		{
+			if (c >= L'A' && c <= L'Z')
+			{
+				c = static_cast<wchar_t>(c - L'A' + L'a');
+			}
+		}
+		return folded;
+	}
+}
+
+int ProviderRegistry::IndexOf(const std::wstring& name) const
+{
+	const std::wstring folded = Fold(name);
+	for (size_t i = 0; i < entries_.size(); ++i)
+	{
+		if (Fold(entries_[i].Provider.Name) == folded)
+		{
+			return static_cast<int>(i);
+		}
+	}
+
+	return -1;
+}
+
+void ProviderRegistry::Add(MediaWindowProvider provider)
+{
+	const int existing = IndexOf(provider.Name);
+	if (existing >= 0)
+	{
+		entries_[static_cast<size_t>(existing)] = Entry{ std::move(provider), nullptr };
+		return;
+	}
+
+	entries_.push_back(Entry{ std::move(provider), nullptr });
+}
+
+void ProviderRegistry::Prioritize(const std::vector<std::wstring>& names)
+{
+	std::vector<int> order;
+	for (const auto& name : names)
+	{
+		const int index = IndexOf(name);
+		bool repeated = false;
+		for (const int i : order)
+		{
+			repeated = repeated || i == index;
+		}
+
+		if (index >= 0 && !repeated)
+		{
+			order.push_back(index);
+		}
+	}
+
+	if (order.empty())
+	{
+		// Nothing recognised (e.g. a misspelt list): better every provider than none.
+		return;
+	}
+
+	std::vector<Entry> ordered;
+	ordered.reserve(order.size());
+	for (const int i : order)
+	{
+		ordered.push_back(std::move(entries_[static_cast<size_t>(i)]));
+	}
+
+	entries_ = std::move(ordered);
+}
+
+/// <summary>
+/// One pass over the running processes, then a lookup per provider process name.
+/// </summary>
+std::vector<int> ProviderRegistry::Resolve(const std::vector<std::wstring>& runningProcessNames) const
+{
+	std::unordered_set<std::wstring> running;
+	running.reserve(runningProcessNames.size());
+	for (const auto& name : runningProcessNames)
+	{
+		running.insert(Fold(name));
+	}
+
+	std::vector<int> resolved;
+	for (size_t i = 0; i < entries_.size(); ++i)
+	{
+		for (const auto& processName : entries_[i].Provider.ProcessNames)
+		{
+			if (running.count(Fold(processName)) != 0)
+			{
+				resolved.push_back(static_cast<int>(i));
+				break;
+			}
+		}
+	}
+
+	return resolved;
+}
+
+std::shared_ptr<const MediaWindowSelectors> ProviderRegistry::Selectors(const int index)
+{
+	Entry& entry = entries_[static_cast<size_t>(index)];
+	if (!entry.Selectors && entry.Provider.LoadSelectors)
+	{
+		entry.Selectors = std::make_shared<const MediaWindowSelectors>(entry.Provider.LoadSelectors());
+	}
+
+	return entry.Selectors;
+}
+
+int ProviderRegistry::LoadedCount() const
+{
+	int loaded = 0;
+	for (const auto& entry : entries_)
+	{
+		loaded += entry.Selectors ? 1 : 0;
+	}
+	return loaded;
+}
+
+std::vector<std::wstring> ProviderRegistry::ParseList(const std::wstring& text)
+{
+	std::vector<std::wstring> items;
+	size_t start = 0;
+	while (start <= text.size())
+	{
+		size_t end = text.find(L',', start);
+		if (end == std::wstring::npos)
+		{
+			end = text.size();
+		}
+
+		const size_t first = text.find_first_not_of(L" \t", start);
+		if (first != std::wstring::npos && first < end)
+		{
+			const size_t last = text.find_last_not_of(L" \t", end - 1);
+			items.push_back(text.substr(first, last - first + 1));
+		}
+
+		start = end + 1;
+	}
+
+	return items;
+}
+
+MediaWindowProvider ProviderRegistry::Zoom()
+{
+	return MediaWindowProvider{ L"Zoom", { L"Zoom.exe" }, [] { return MediaWindowSelectors::Zoom(); } };
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MediaWindowSelectors.h"
+
+// An app whose media window can be moved to the projector (Zoom, or one defined in settings).
+struct MediaWindowProvider
+{
+	std::wstring Name;
+	std::vector<std::wstring> ProcessNames; // executable file names, compared case-insensitively
+
+	// Called the first time the provider is searched for, i.e. only once one of its processes is running.
+	std::function<MediaWindowSelectors()> LoadSelectors;
+};
+
+/// <summary>
+/// The media window providers in precedence order. Resolution (against the names
+/// of the running processes) is cheap; a provider's selectors, and so the UI
+/// Automation conditions built from them, are only created when it is running.
+/// Portable (no Windows dependencies).
+/// </summary>
+class ProviderRegistry
+{
+private:
+	struct Entry
+	{
+		MediaWindowProvider Provider;
+		std::shared_ptr<const MediaWindowSelectors> Selectors; // null until first used
+	};
+
+	std::vector<Entry> entries_;
+
+	int IndexOf(const std::wstring& name) const;
+
+public:
+	// Adds a provider at the lowest precedence, or replaces (in place) one with the same name.
+	void Add(MediaWindowProvider provider);
+
+	// Keeps only the named providers, in the order given (names are case-insensitive;
+	// unknown ones are ignored). If no name is known, every provider is kept.
+	void Prioritize(const std::vector<std::wstring>& names);
+
+	// Indexes of the providers with a running process, highest precedence first.
+	std::vector<int> Resolve(const std::vector<std::wstring>& runningProcessNames) const;
+
+	int Count() const { return static_cast<int>(entries_.size()); }
+	const MediaWindowProvider& Provider(int index) const { return entries_[static_cast<size_t>(index)].Provider; }
+
+	// The provider's selectors, loaded on first use.
+	std::shared_ptr<const MediaWindowSelectors> Selectors(int index);
+
+	// How many providers have had their selectors loaded.
+	int LoadedCount() const;
+
+	// Splits a comma-separated settings value, trimming spaces and dropping empty items.
+	static std::vector<std::wstring> ParseList(const std::wstring& text);
+
+	// The built-in Zoom provider.
+	static MediaWindowProvider Zoom();
+};
@@ -0,0 +1,99 @@
+#include "ReplayDiscoveryBackend.h"
+#include "CallCounters.h"
+
+namespace
+{
+	constexpr std::uint32_t ChunkSize = 256;
+	constexpr std::uint32_t RootElement = 0;
+}
+
+ReplayDiscoveryBackend::ReplayDiscoveryBackend(TreeSnapshotReader& reader)
+	: reader_(reader)
+	, elementsVisited_(0)
+{
+}
+
+int ReplayDiscoveryBackend::CandidateElement(const int candidateIndex) const
+{
+	return candidateIndex >= 0 && static_cast<size_t>(candidateIndex) < candidates_.size()
+		? static_cast<int>(candidates_[static_cast<size_t>(candidateIndex)])
+		: -1;
+}
+
+/// <summary>
+/// Scans the snapshot for top-level elements (children of the root) matching the
+/// selector name and class name.
+/// </summary>
+int ReplayDiscoveryBackend::FindCandidates(const MediaWindowSelectors& selectors)
+{
+	CallCountScope::Count(CallCategory::UiaFind);
+	candidates_.clear();
+
+	const std::uint32_t count = reader_.ElementCount();
+	for (std::uint32_t first = 0; first < count; first += ChunkSize)
+	{
+		if (!reader_.ReadElements(first, ChunkSize, chunk_))
+		{
+			return -1;
+		}
+
+		for (std::uint32_t i = 0; i < chunk_.size(); ++i)
+		{
+			const TreeSnapshotElement& e = chunk_[i];
+			if (e.Parent == RootElement &&
+				reader_.String(e.NameId) == selectors.WindowName &&
+				reader_.String(e.ClassNameId) == selectors.WindowClassName)
+			{
+				candidates_.push_back(first + i);
+			}
+		}
+
+		elementsVisited_ += chunk_.size();
+	}
+
+	return static_cast<int>(candidates_.size());
+}
+
+/// <summary>
+/// Searches the candidate's descendants (a contiguous pre-order range) for a
+/// main-window marker, stopping at the first match.
+/// </summary>
+int ReplayDiscoveryBackend::CandidateHasMainWindowMarker(const int candidateIndex, const MediaWindowSelectors& selectors)
+{
+	CallCountScope::Count(CallCategory::UiaFind);
+
+	if (candidateIndex < 0 || static_cast<size_t>(candidateIndex) >= candidates_.size())
+	{
+		return CandidateUnavailable;
+	}
+
+	const std::uint32_t root = candidates_[static_cast<size_t>(candidateIndex)];
+	const std::uint32_t count = reader_.ElementCount();
+	for (std::uint32_t first = root + 1; first < count; first += ChunkSize)
+	{
+		if (!reader_.ReadElements(first, ChunkSize, chunk_))
+		{
+			return -1;
+		}
+
+		for (const auto& e : chunk_)
+		{
+			if (e.Parent == TreeSnapshotElement::NoParent || e.Parent < root)
+			{
+				return 0; // left the candidate's subtree
+			}
+
+			++elementsVisited_;
+			const std::wstring& helpText = reader_.String(e.HelpTextId);
+			for (const auto& marker : selectors.MainWindowHelpTexts)
+			{
+				if (helpText == marker)
+				{
+					return 1;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
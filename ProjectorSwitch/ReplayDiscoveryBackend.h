@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "DiscoveryBackend.h"
+#include "TreeSnapshot.h"
+
+/// <summary>
+/// Serves a captured snapshot (see --capture-tree) to the discovery logic, so
+/// selector changes can be checked offline against trees from real machines.
+/// Records are streamed from the reader in chunks; nothing is loaded up front.
+/// Portable (no Windows dependencies).
+/// </summary>
+class ReplayDiscoveryBackend : public DiscoveryBackend
+{
+private:
+	TreeSnapshotReader& reader_;
+	std::vector<std::uint32_t> candidates_; // element indices of top-level matches
+	std::vector<TreeSnapshotElement> chunk_;
+	std::uint64_t elementsVisited_;
+
+public:
+	explicit ReplayDiscoveryBackend(TreeSnapshotReader& reader);
+
+	std::uint64_t ElementsVisited() const { return elementsVisited_; }
+	void ResetCounters() { elementsVisited_ = 0; }
+
+	// The snapshot element index of a candidate from the last FindCandidates (or -1).
+	int CandidateElement(int candidateIndex) const;
+
+	int FindCandidates(const MediaWindowSelectors& selectors) override;
+	int CandidateHasMainWindowMarker(int candidateIndex, const MediaWindowSelectors& selectors) override;
+};
@@ -0,0 +1,94 @@
+#include "ResizeEventCounter.h"
+
+namespace
+{
+	SIZE WindowSize(const HWND window)
+	{
+		RECT rect{};
+		GetWindowRect(window, &rect);
+		return SIZE{ rect.right - rect.left, rect.bottom - rect.top };
+	}
+}
+
+ResizeEventCounter::ResizeEventCounter(const HWND window)
+	: window_(window)
+	, hook_(nullptr)
+	, previous_(current_)
+	, lastSize_(WindowSize(window))
+	, lastEventTick_(GetTickCount64())
+	, count_(0)
+{
+	DWORD processId = 0;
+	const DWORD threadId = GetWindowThreadProcessId(window, &processId);
+	if (threadId != 0)
+	{
+		hook_ = SetWinEventHook(
+			EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE,
+			nullptr, OnLocationChange, processId, threadId,
+			WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+	}
+
+	current_ = this;
+}
+
+ResizeEventCounter::~ResizeEventCounter()
+{
+	if (hook_ != nullptr)
+	{
+		UnhookWinEvent(hook_);
+		hook_ = nullptr;
+	}
+
+	current_ = previous_;
+}
+
+void CALLBACK ResizeEventCounter::OnLocationChange(HWINEVENTHOOK /*hook*/, DWORD /*event*/, const HWND hwnd,
+	const LONG idObject, const LONG idChild, DWORD /*eventThread*/, DWORD /*eventTime*/)
+{
+	ResizeEventCounter* counter = current_;
+	if (counter == nullptr || hwnd != counter->window_ || idObject != OBJID_WINDOW || idChild != CHILDID_SELF)
+	{
+		return;
+	}
+
+	const SIZE size = WindowSize(hwnd);
+	if (size.cx != counter->lastSize_.cx || size.cy != counter->lastSize_.cy)
+	{
+		counter->lastSize_ = size;
+		counter->lastEventTick_ = GetTickCount64();
+		++counter->count_;
+	}
+}
+
+/// <summary>
+/// Pumps (without removing messages) so queued WinEvents are delivered.
+/// </summary>
+/// <param name="quietMs">How long without a resize counts as settled.</param>
+/// <param name="maxMs">Upper bound on the wait.</param>
+void ResizeEventCounter::Settle(const DWORD quietMs, const DWORD maxMs)
+{
+	if (hook_ == nullptr)
+	{
+		return;
+	}
+
+	const ULONGLONG start = GetTickCount64();
+	if (lastEventTick_ < start)
+	{
+		lastEventTick_ = start;
+	}
+
+	for (;;)
+	{
+		MSG msg;
+		PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE);
+
+		const ULONGLONG now = GetTickCount64();
+		if (now - lastEventTick_ >= quietMs || now - start >= maxMs)
+		{
+			break;
+		}
+
+		MsgWaitForMultipleObjectsEx(0, nullptr, 5, QS_ALLINPUT, 0);
+	}
+}
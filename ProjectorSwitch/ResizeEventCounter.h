@@ -0,0 +1,35 @@
+#pragma once
+#include <windows.h>
+#include <cstdint>
+
+/// <summary>
+/// Counts size changes of a window (in another process) while in scope, using an
+/// out-of-context WinEvent hook. Events are delivered while this thread pumps
+/// messages, so call Settle() to wait for the window's own follow-up resizes
+/// (e.g. in response to WM_DPICHANGED) to arrive.
+/// </summary>
+class ResizeEventCounter  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	static inline thread_local ResizeEventCounter* current_ = nullptr;
+
+	HWND window_;
+	HWINEVENTHOOK hook_;
+	ResizeEventCounter* previous_;
+	SIZE lastSize_;
+	ULONGLONG lastEventTick_;
+	std::uint32_t count_;
+
+	static void CALLBACK OnLocationChange(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+		LONG idObject, LONG idChild, DWORD eventThread, DWORD eventTime);
+
+public:
+	explicit ResizeEventCounter(HWND window);
+	~ResizeEventCounter();
+
+	// Pumps until no resize has arrived for quietMs, or maxMs has passed.
+	void Settle(DWORD quietMs, DWORD maxMs);
+
+	std::uint32_t Count() const { return count_; }
+	bool IsActive() const { return hook_ != nullptr; }
+};
@@ -0,0 +1,369 @@
+#include <cwctype>
+#include "Scene.h"
+
+namespace
+{
+	std::wstring Trim(const std::wstring& value)
+	{
+		const auto first = value.find_first_not_of(L" \t");
+		if (first == std::wstring::npos)
+		{
+			return {};
+		}
+
+		const auto last = value.find_last_not_of(L" \t");
+		return value.substr(first, last - first + 1);
+	}
+
+	std::wstring ToLower(std::wstring value)
+	{
+		for (auto& ch : value)
+		{
+			ch = static_cast<wchar_t>(std::towlower(static_cast<std::wint_t>(ch)));
+		}
+		return value;
+	}
+
+	std::vector<std::wstring> Split(const std::wstring& value, const wchar_t separator)
+	{
+		std::vector<std::wstring> parts;
+		size_t start = 0;
+		while (true)
+		{
+			const auto end = value.find(separator, start);
+			parts.push_back(value.substr(start, end == std::wstring::npos ? std::wstring::npos : end - start));
+			if (end == std::wstring::npos)
+			{
+				return parts;
+			}
+			start = end + 1;
+		}
+	}
+
+	bool ParseInt(const std::wstring& text, long long& value)
+	{
+		const std::wstring trimmed = Trim(text);
+		if (trimmed.empty())
+		{
+			return false;
+		}
+
+		size_t consumed = 0;
+		try
+		{
+			value = std::stoll(trimmed, &consumed);
+		}
+		catch (...)
+		{
+			return false;
+		}
+		return consumed == trimmed.size();
+	}
+
+	bool ParsePlacement(const std::wstring& text, ScenePlacement& placement)
+	{
+		const std::wstring value = ToLower(text);
+		if (value == L"fill")
+		{
+			placement = ScenePlacement::Fill;
+		}
+		else if (value == L"workarea")
+		{
+			placement = ScenePlacement::FillWorkArea;
+		}
+		else if (value == L"center")
+		{
+			placement = ScenePlacement::Center;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	ScreenRect Expand(const ScreenRect& rect, const FrameInsets& insets)
+	{
+		return ScreenRect
+		{
+			rect.Left - insets.Left,
+			rect.Top - insets.Top,
+			rect.Right + insets.Right,
+			rect.Bottom + insets.Bottom
+		};
+	}
+
+	const SceneMonitor* FindMonitor(const std::wstring& key, const std::vector<SceneMonitor>& monitors)
+	{
+		for (const auto& monitor : monitors)
+		{
+			if (monitor.Key == key)
+			{
+				return &monitor;
+			}
+		}
+		return nullptr;
+	}
+
+	SceneMove MakeMove(const SceneWindow& window, const ScreenRect& to, const unsigned toDpi)
+	{
+		SceneMove move;
+		move.Handle = window.Handle;
+		move.From = window.Rect;
+		move.To = to;
+		move.FromDpi = window.Metrics.Dpi;
+		move.ToDpi = toDpi;
+		move.Move = WindowGeometry::PrecompensateForDpiChange(to, move.FromDpi, move.ToDpi);
+		move.Restore = window.Minimized;
+		return move;
+	}
+}
+
+bool ScenePlanner::ParseEntry(const std::wstring& text, SceneEntry& entry)
+{
+	entry = SceneEntry{};
+
+	for (const auto& part : Split(text, L';'))
+	{
+		if (Trim(part).empty())
+		{
+			continue;
+		}
+
+		const auto separator = part.find(L'=');
+		if (separator == std::wstring::npos)
+		{
+			return false;
+		}
+
+		const std::wstring key = ToLower(Trim(part.substr(0, separator)));
+		const std::wstring value = Trim(part.substr(separator + 1));
+		if (key == L"process")
+		{
+			entry.Selector.ProcessName = value;
+		}
+		else if (key == L"class")
+		{
+			entry.Selector.ClassName = value;
+		}
+		else if (key == L"title")
+		{
+			entry.Selector.TitleContains = value;
+		}
+		else if (key == L"monitor")
+		{
+			entry.MonitorKey = value;
+		}
+		else if (key == L"placement")
+		{
+			if (!ParsePlacement(value, entry.Placement))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return !entry.MonitorKey.empty() && !entry.Selector.IsEmpty();
+}
+
+bool ScenePlanner::Matches(const WindowSelector& selector, const SceneWindow& window)
+{
+	if (!selector.ProcessName.empty() && ToLower(selector.ProcessName) != ToLower(window.ProcessName))
+	{
+		return false;
+	}
+
+	if (!selector.ClassName.empty() && selector.ClassName != window.ClassName)
+	{
+		return false;
+	}
+
+	if (!selector.TitleContains.empty() && ToLower(window.Title).find(ToLower(selector.TitleContains)) == std::wstring::npos)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+ScenePlan ScenePlanner::Plan(const Scene& scene, const std::vector<SceneWindow>& windows, const std::vector<SceneMonitor>& monitors)
+{
+	ScenePlan plan;
+	std::vector<bool> claimed(windows.size(), false);
+
+	for (size_t i = 0; i < scene.Entries.size(); ++i)
+	{
+		const SceneEntry& entry = scene.Entries[i];
+		const SceneMonitor* monitor = FindMonitor(entry.MonitorKey, monitors);
+		if (monitor == nullptr)
+		{
+			plan.Unresolved.push_back(i);
+			continue;
+		}
+
+		size_t match = windows.size();
+		for (size_t j = 0; j < windows.size(); ++j)
+		{
+			if (!claimed[j] && Matches(entry.Selector, windows[j]))
+			{
+				match = j;
+				break;
+			}
+		}
+
+		if (match == windows.size())
+		{
+			plan.Unresolved.push_back(i);
+			continue;
+		}
+
+		claimed[match] = true;
+		const SceneWindow& window = windows[match];
+		plan.Moves.push_back(MakeMove(window, PlaceWindow(window, *monitor, entry.Placement), monitor->Dpi));
+	}
+
+	return plan;
+}
+
+ScenePlan ScenePlanner::PlanRevert(const std::vector<SceneRestorePoint>& points, const std::vector<SceneWindow>& windows,
+	const std::vector<SceneMonitor>& monitors)
+{
+	ScenePlan plan;
+
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		const SceneRestorePoint& point = points[i];
+		const SceneWindow* window = nullptr;
+		for (const auto& candidate : windows)
+		{
+			if (candidate.Handle == point.Handle)
+			{
+				window = &candidate;
+				break;
+			}
+		}
+
+		if (window == nullptr)
+		{
+			// Closed since the scene was applied.
+			plan.Unresolved.push_back(i);
+			continue;
+		}
+
+		const SceneMonitor* monitor = MonitorForRect(point.Rect, monitors);
+		SceneMove move = MakeMove(*window, point.Rect, monitor != nullptr ? monitor->Dpi : window->Metrics.Dpi);
+		move.Minimize = point.Minimized;
+		plan.Moves.push_back(move);
+	}
+
+	return plan;
+}
+
+std::vector<SceneRestorePoint> ScenePlanner::RestorePoints(const ScenePlan& plan)
+{
+	std::vector<SceneRestorePoint> points;
+	points.reserve(plan.Moves.size());
+	for (const auto& move : plan.Moves)
+	{
+		points.push_back(SceneRestorePoint{ move.Handle, move.From, move.Restore });
+	}
+	return points;
+}
+
+ScreenRect ScenePlanner::PlaceWindow(const SceneWindow& window, const SceneMonitor& monitor, const ScenePlacement placement)
+{
+	const FrameMetrics metrics = window.Metrics.ScaledTo(monitor.Dpi);
+
+	switch (placement)
+	{
+	case ScenePlacement::FillWorkArea:
+		return Expand(monitor.WorkRect, metrics.Invisible);
+
+	case ScenePlacement::Center:
+	{
+		const ScreenRect visible = WindowGeometry::SuggestedRectAfterDpiChange(
+			WindowGeometry::VisibleRect(window.Rect, window.Metrics), window.Metrics.Dpi, monitor.Dpi);
+		const ScreenRect& work = monitor.WorkRect;
+		const int width = visible.Width() < work.Width() ? visible.Width() : work.Width();
+		const int height = visible.Height() < work.Height() ? visible.Height() : work.Height();
+		const int left = work.Left + ((work.Width() - width) / 2);
+		const int top = work.Top + ((work.Height() - height) / 2);
+		return Expand(ScreenRect{ left, top, left + width, top + height }, metrics.Invisible);
+	}
+
+	case ScenePlacement::Fill:
+	default:
+		return WindowGeometry::TargetRect(monitor.MonitorRect, metrics);
+	}
+}
+
+const SceneMonitor* ScenePlanner::MonitorForRect(const ScreenRect& rect, const std::vector<SceneMonitor>& monitors)
+{
+	const SceneMonitor* best = nullptr;
+	long long bestArea = 0;
+	for (const auto& monitor : monitors)
+	{
+		const ScreenRect intersection
+		{
+			rect.Left > monitor.MonitorRect.Left ? rect.Left : monitor.MonitorRect.Left,
+			rect.Top > monitor.MonitorRect.Top ? rect.Top : monitor.MonitorRect.Top,
+			rect.Right < monitor.MonitorRect.Right ? rect.Right : monitor.MonitorRect.Right,
+			rect.Bottom < monitor.MonitorRect.Bottom ? rect.Bottom : monitor.MonitorRect.Bottom
+		};
+		if (intersection.IsEmpty())
+		{
+			continue;
+		}
+
+		const long long area = static_cast<long long>(intersection.Width()) * intersection.Height();
+		if (area > bestArea)
+		{
+			best = &monitor;
+			bestArea = area;
+		}
+	}
+	return best;
+}
+
+std::wstring ScenePlanner::FormatRestorePoint(const SceneRestorePoint& point)
+{
+	return std::to_wstring(point.Handle) + L","
+		+ std::to_wstring(point.Rect.Left) + L","
+		+ std::to_wstring(point.Rect.Top) + L","
+		+ std::to_wstring(point.Rect.Right) + L","
+		+ std::to_wstring(point.Rect.Bottom) + L","
+		+ (point.Minimized ? L"1" : L"0");
+}
+
+bool ScenePlanner::ParseRestorePoint(const std::wstring& text, SceneRestorePoint& point)
+{
+	const auto parts = Split(text, L',');
+	if (parts.size() != 6)
+	{
+		return false;
+	}
+
+	long long values[6] = {};
+	for (size_t i = 0; i < parts.size(); ++i)
+	{
+		if (!ParseInt(parts[i], values[i]))
+		{
+			return false;
+		}
+	}
+
+	point.Handle = static_cast<std::uint64_t>(values[0]);
+	point.Rect = ScreenRect
+	{
+		static_cast<int>(values[1]),
+		static_cast<int>(values[2]),
+		static_cast<int>(values[3]),
+		static_cast<int>(values[4])
+	};
+	point.Minimized = values[5] != 0;
+	return point.Handle != 0 && !point.Rect.IsEmpty();
+}
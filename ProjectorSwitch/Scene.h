@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "WindowGeometry.h"
+
+enum class ScenePlacement
+{
+	Fill,         // client area covers the monitor (like the media window)
+	FillWorkArea, // visible frame covers the work area
+	Center        // current size (scaled for DPI), centered in the work area
+};
+
+// Matches top-level windows. Empty fields match anything.
+struct WindowSelector
+{
+	std::wstring ProcessName;   // executable file name, case-insensitive
+	std::wstring ClassName;     // exact
+	std::wstring TitleContains; // substring of the title, case-insensitive
+
+	bool IsEmpty() const { return ProcessName.empty() && ClassName.empty() && TitleContains.empty(); }
+};
+
+struct SceneEntry
+{
+	WindowSelector Selector;
+	std::wstring MonitorKey;
+	ScenePlacement Placement = ScenePlacement::Fill;
+};
+
+struct Scene
+{
+	std::wstring Name;
+	std::vector<SceneEntry> Entries;
+};
+
+// A top-level window as seen when a scene is planned.
+struct SceneWindow
+{
+	std::uint64_t Handle = 0;
+	std::wstring ProcessName;
+	std::wstring ClassName;
+	std::wstring Title;
+	ScreenRect Rect;      // window rect (the restored rect if minimized)
+	FrameMetrics Metrics; // at the window's current DPI
+	bool Minimized = false;
+};
+
+struct SceneMonitor
+{
+	std::wstring Key;
+	ScreenRect MonitorRect;
+	ScreenRect WorkRect;
+	unsigned Dpi = FrameMetrics::BaseDpi;
+};
+
+struct SceneMove
+{
+	std::uint64_t Handle = 0;
+	ScreenRect From;        // current window rect
+	ScreenRect To;          // final window rect
+	ScreenRect Move;        // rect to pass to DeferWindowPos (precompensated for a DPI change)
+	unsigned FromDpi = FrameMetrics::BaseDpi;
+	unsigned ToDpi = FrameMetrics::BaseDpi;
+	bool Restore = false;   // restore from minimized before moving
+	bool Minimize = false;  // minimize after moving
+};
+
+// Where a window was before a scene was applied, persisted so the scene can be reverted.
+struct SceneRestorePoint
+{
+	std::uint64_t Handle = 0;
+	ScreenRect Rect;
+	bool Minimized = false;
+};
+
+struct ScenePlan
+{
+	std::vector<SceneMove> Moves;
+	std::vector<size_t> Unresolved; // entries with no matching window or no matching monitor
+};
+
+/// <summary>
+/// Resolves scene entries against the current windows and monitors and plans the
+/// moves needed to apply or revert a scene. Each window is moved at most once,
+/// so the plan can be executed as a single DeferWindowPos batch.
+/// Portable (no Windows dependencies).
+/// </summary>
+class ScenePlanner
+{
+public:
+	static constexpr size_t MaxEntries = 16;
+
+	// Parses "process=zoom.exe; class=...; title=...; monitor=<key>; placement=fill".
+	// A monitor and at least one selector field are required.
+	static bool ParseEntry(const std::wstring& text, SceneEntry& entry);
+
+	static bool Matches(const WindowSelector& selector, const SceneWindow& window);
+
+	// Entries are resolved in order; each claims the first unclaimed matching window.
+	static ScenePlan Plan(const Scene& scene, const std::vector<SceneWindow>& windows, const std::vector<SceneMonitor>& monitors);
+
+	// Moves windows that still exist back to their restore points.
+	static ScenePlan PlanRevert(const std::vector<SceneRestorePoint>& points, const std::vector<SceneWindow>& windows,
+		const std::vector<SceneMonitor>& monitors);
+
+	static std::vector<SceneRestorePoint> RestorePoints(const ScenePlan& plan);
+
+	// Window rect for the placement on the monitor, with metrics at the window's current DPI.
+	static ScreenRect PlaceWindow(const SceneWindow& window, const SceneMonitor& monitor, ScenePlacement placement);
+
+	// The monitor with the largest intersection with rect (nullptr if none intersects).
+	static const SceneMonitor* MonitorForRect(const ScreenRect& rect, const std::vector<SceneMonitor>& monitors);
+
+	// "handle,left,top,right,bottom,minimized"
+	static std::wstring FormatRestorePoint(const SceneRestorePoint& point);
+	static bool ParseRestorePoint(const std::wstring& text, SceneRestorePoint& point);
+};
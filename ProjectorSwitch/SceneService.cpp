@@ -0,0 +1,418 @@
+#include <atlbase.h>
+#include <dwmapi.h>
+#include <ShellScalingApi.h>
+#include <map>
+#include <optional>
+#include "SceneService.h"
+#include "MonitorService.h"
+#include "TraceRecorder.h"
+#include "ResizeEventCounter.h"
+#include "WindowTransition.h"
+#include "Win32PlatformBackend.h"
+#include "Logger.h"
+
+namespace
+{
+	// How long to wait for windows' own WM_DPICHANGED resizes after a cross-DPI batch.
+	constexpr DWORD DpiSettleQuietMs = 30;
+	constexpr DWORD DpiSettleMaxMs = 250;
+
+	constexpr UINT BatchFlags = SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOACTIVATE | SWP_NOCOPYBITS;
+
+	struct EnumerationContext
+	{
+		std::vector<SceneWindow> Windows;
+		std::map<DWORD, std::wstring> ProcessNames;
+	};
+
+	ScreenRect ToScreenRect(const RECT& rect)
+	{
+		return ScreenRect{ rect.left, rect.top, rect.right, rect.bottom };
+	}
+
+	HWND ToHandle(const std::uint64_t handle)
+	{
+		return reinterpret_cast<HWND>(static_cast<std::uintptr_t>(handle));
+	}
+
+	std::wstring GetProcessName(const DWORD processId, EnumerationContext& context)
+	{
+		const auto cached = context.ProcessNames.find(processId);
+		if (cached != context.ProcessNames.end())
+		{
+			return cached->second;
+		}
+
+		std::wstring name;
+		const CHandle process(OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId));
+		if (process != nullptr)
+		{
+			wchar_t path[MAX_PATH];
+			DWORD length = MAX_PATH;
+			if (QueryFullProcessImageNameW(process, 0, path, &length))
+			{
+				name.assign(path, length);
+				const auto separator = name.find_last_of(L'\\');
+				if (separator != std::wstring::npos)
+				{
+					name.erase(0, separator + 1);
+				}
+			}
+		}
+
+		context.ProcessNames.emplace(processId, name);
+		return name;
+	}
+
+	/// <summary>
+	/// Measures the window's frame at its current DPI. A minimized window cannot be
+	/// measured, so its restored rect and the standard frame for its style are used.
+	/// </summary>
+	bool DescribeWindow(const HWND hwnd, SceneWindow& window)
+	{
+		const UINT dpi = GetDpiForWindow(hwnd);
+		window.Minimized = IsIconic(hwnd) != FALSE;
+
+		if (window.Minimized)
+		{
+			WINDOWPLACEMENT placement{};
+			placement.length = sizeof(placement);
+			if (!GetWindowPlacement(hwnd, &placement))
+			{
+				return false;
+			}
+
+			RECT frame{};
+			const auto style = static_cast<DWORD>(GetWindowLongPtr(hwnd, GWL_STYLE)) & ~WS_MINIMIZE;
+			const auto exStyle = static_cast<DWORD>(GetWindowLongPtr(hwnd, GWL_EXSTYLE));
+			AdjustWindowRectExForDpi(&frame, style, FALSE, exStyle, dpi);
+
+			window.Rect = ToScreenRect(placement.rcNormalPosition);
+			window.Metrics = FrameMetrics{};
+			window.Metrics.Dpi = dpi;
+			window.Metrics.Client = FrameInsets{ -frame.left, -frame.top, frame.right, frame.bottom };
+			return true;
+		}
+
+		RECT windowRect{};
+		RECT clientRect{};
+		if (!GetWindowRect(hwnd, &windowRect) || !GetClientRect(hwnd, &clientRect))
+		{
+			return false;
+		}
+		MapWindowPoints(hwnd, nullptr, reinterpret_cast<POINT*>(&clientRect), 2);
+
+		RECT visibleFrame{};
+		if (FAILED(DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &visibleFrame, sizeof(visibleFrame))))
+		{
+			visibleFrame = RECT{};
+		}
+
+		window.Rect = ToScreenRect(windowRect);
+		window.Metrics = FrameMetrics::Measure(window.Rect, ToScreenRect(clientRect), ToScreenRect(visibleFrame), dpi);
+		return true;
+	}
+
+	BOOL CALLBACK EnumWindowsCallback(const HWND hwnd, const LPARAM lParam)
+	{
+		auto& context = *reinterpret_cast<EnumerationContext*>(lParam);
+
+		// Skip invisible windows and those cloaked by the shell (e.g. on other virtual desktops).
+		DWORD cloaked = 0;
+		if (!IsWindowVisible(hwnd) ||
+			(SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked != 0))
+		{
+			return TRUE;
+		}
+
+		SceneWindow window;
+		window.Handle = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(hwnd));
+
+		wchar_t text[256]{};
+		GetClassNameW(hwnd, text, static_cast<int>(std::size(text)));
+		window.ClassName = text;
+		text[0] = L'\0';
+		GetWindowTextW(hwnd, text, static_cast<int>(std::size(text)));
+		window.Title = text;
+
+		DWORD processId = 0;
+		GetWindowThreadProcessId(hwnd, &processId);
+		window.ProcessName = GetProcessName(processId, context);
+
+		if (DescribeWindow(hwnd, window))
+		{
+			context.Windows.push_back(std::move(window));
+		}
+
+		return TRUE;
+	}
+}
+
+/// <summary>
+/// Loads and parses a scene from settings.
+/// </summary>
+/// <param name="name">The scene name.</param>
+/// <param name="scene">Receives the scene.</param>
+/// <returns>True if the scene has at least one valid entry.</returns>
+bool SceneService::LoadScene(const std::wstring& name, Scene& scene) const
+{
+	scene = Scene{};
+	scene.Name = name;
+
+	for (const auto& text : settingsService_->LoadSceneEntries(name))
+	{
+		SceneEntry entry;
+		if (!ScenePlanner::ParseEntry(text, entry))
+		{
+			LOG_WARN(L"Ignoring invalid entry in scene %ls: %ls", name.c_str(), text.c_str());
+			continue;
+		}
+
+		if (scene.Entries.size() == ScenePlanner::MaxEntries)
+		{
+			break;
+		}
+		scene.Entries.push_back(std::move(entry));
+	}
+
+	return !scene.Entries.empty();
+}
+
+/// <summary>
+/// Applies the named scene, or reverts it if it is currently applied. Windows that
+/// have closed since the scene was applied are skipped on revert.
+/// </summary>
+/// <param name="name">The scene name.</param>
+/// <returns>What was done.</returns>
+SceneToggleResult SceneService::Toggle(const std::wstring& name) const
+{
+	TRACE_ZONE("SceneService::Toggle");
+	SceneToggleResult result;
+
+	const std::vector<std::wstring> state = settingsService_->LoadSceneState(name);
+	result.Applied = state.empty();
+
+	ScenePlan plan;
+	if (result.Applied)
+	{
+		Scene scene;
+		if (!LoadScene(name, scene))
+		{
+			LOG_ERROR(L"Scene %ls is not configured", name.c_str());
+			return result;
+		}
+
+		plan = ScenePlanner::Plan(scene, EnumerateWindows(), EnumerateMonitors());
+	}
+	else
+	{
+		std::vector<SceneRestorePoint> points;
+		for (const auto& text : state)
+		{
+			SceneRestorePoint point;
+			if (ScenePlanner::ParseRestorePoint(text, point))
+			{
+				points.push_back(point);
+			}
+		}
+
+		plan = ScenePlanner::PlanRevert(points, EnumerateWindows(), EnumerateMonitors());
+	}
+
+	result.Moved = plan.Moves.size();
+	result.Unresolved = plan.Unresolved.size();
+
+	if (plan.Moves.empty())
+	{
+		// Nothing to revert (all windows closed) still leaves the scene not applied.
+		result.Ok = !result.Applied;
+	}
+	else
+	{
+		result.Ok = Execute(plan, result.Corrected);
+	}
+
+	if (!result.Applied)
+	{
+		settingsService_->SaveSceneState(name, {});
+	}
+	else if (result.Ok)
+	{
+		std::vector<std::wstring> restorePoints;
+		for (const auto& point : ScenePlanner::RestorePoints(plan))
+		{
+			restorePoints.push_back(ScenePlanner::FormatRestorePoint(point));
+		}
+		settingsService_->SaveSceneState(name, restorePoints);
+	}
+
+	return result;
+}
+
+std::vector<SceneWindow> SceneService::EnumerateWindows()
+{
+	TRACE_ZONE("SceneService::EnumerateWindows");
+	EnumerationContext context;
+	EnumWindows(EnumWindowsCallback, reinterpret_cast<LPARAM>(&context));
+	return std::move(context.Windows);
+}
+
+std::vector<SceneMonitor> SceneService::EnumerateMonitors()
+{
+	TRACE_ZONE("SceneService::EnumerateMonitors");
+	constexpr MonitorService monitorService;
+
+	std::vector<SceneMonitor> monitors;
+	for (const auto& data : monitorService.GetMonitorsData())
+	{
+		SceneMonitor monitor;
+		monitor.Key = data.Key;
+		monitor.MonitorRect = ToScreenRect(data.MonitorRect);
+		monitor.WorkRect = IsRectEmpty(&data.WorkRect) ? monitor.MonitorRect : ToScreenRect(data.WorkRect);
+
+		UINT dpiX = 0;
+		UINT dpiY = 0;
+		const HMONITOR handle = MonitorFromRect(&data.MonitorRect, MONITOR_DEFAULTTONEAREST);
+		monitor.Dpi = handle != nullptr && SUCCEEDED(GetDpiForMonitor(handle, MDT_EFFECTIVE_DPI, &dpiX, &dpiY)) && dpiX != 0
+			? dpiX
+			: GetDpiForSystem();
+
+		monitors.push_back(std::move(monitor));
+	}
+
+	return monitors;
+}
+
+/// <summary>
+/// Moves all windows in one batch, so they are repositioned in a single window-manager
+/// transaction. Falls back to individual moves if the batch cannot be built.
+/// </summary>
+/// <param name="moves">Windows and their window rects.</param>
+/// <returns>True if the moves were made.</returns>
+bool SceneService::MoveBatch(const std::vector<std::pair<HWND, ScreenRect>>& moves)
+{
+	TRACE_ZONE("SceneService::MoveBatch");
+	HDWP batch = BeginDeferWindowPos(static_cast<int>(moves.size()));
+	for (const auto& [hwnd, rect] : moves)
+	{
+		if (batch == nullptr)
+		{
+			break;
+		}
+		batch = DeferWindowPos(batch, hwnd, nullptr, rect.Left, rect.Top, rect.Width(), rect.Height(), BatchFlags);
+	}
+
+	if (batch != nullptr && EndDeferWindowPos(batch))
+	{
+		return true;
+	}
+
+	// DeferWindowPos destroys the batch on failure (e.g. a window closed meanwhile).
+	bool anyMoved = false;
+	for (const auto& [hwnd, rect] : moves)
+	{
+		anyMoved = SetWindowPos(hwnd, nullptr, rect.Left, rect.Top, rect.Width(), rect.Height(), BatchFlags) || anyMoved;
+	}
+	return anyMoved;
+}
+
+/// <summary>
+/// Executes a plan with the same cloak-move-fade sequence as the media window toggle,
+/// applied to all windows at once.
+/// </summary>
+/// <param name="plan">The moves.</param>
+/// <param name="corrected">Set if a second batch was needed because a window did not
+/// end up where expected after a DPI change.</param>
+/// <returns>True if the windows were moved.</returns>
+bool SceneService::Execute(const ScenePlan& plan, bool& corrected)
+{
+	TRACE_ZONE("SceneService::Execute");
+	Win32PlatformBackend platform;
+	std::vector<WindowTransitionState> transitions;
+	std::vector<bool> minimize; // per transition
+	std::vector<std::pair<HWND, ScreenRect>> moves;
+	HWND firstCrossDpi = nullptr;
+
+	for (const auto& move : plan.Moves)
+	{
+		const HWND hwnd = ToHandle(move.Handle);
+		if (!IsWindow(hwnd))
+		{
+			continue;
+		}
+
+		const PlatformWindow window = move.Handle;
+		WindowTransition::Begin(platform, window);
+		if (move.Restore && IsIconic(hwnd))
+		{
+			WindowTransition::RestoreFromMinimized(platform, window);
+		}
+
+		transitions.push_back(WindowTransition::Conceal(platform, window));
+		minimize.push_back(move.Minimize);
+		moves.emplace_back(hwnd, move.Move);
+		if (firstCrossDpi == nullptr && move.FromDpi != move.ToDpi)
+		{
+			firstCrossDpi = hwnd;
+		}
+	}
+
+	if (moves.empty())
+	{
+		return false;
+	}
+
+	// Windows respond to WM_DPICHANGED in their own threads; waiting on one of them is enough.
+	std::optional<ResizeEventCounter> resizes;
+	if (firstCrossDpi != nullptr)
+	{
+		resizes.emplace(firstCrossDpi);
+	}
+
+	const bool moved = MoveBatch(moves);
+
+	if (resizes.has_value())
+	{
+		resizes->Settle(DpiSettleQuietMs, DpiSettleMaxMs);
+
+		std::vector<std::pair<HWND, ScreenRect>> corrections;
+		for (const auto& move : plan.Moves)
+		{
+			const HWND hwnd = ToHandle(move.Handle);
+			RECT actual{};
+			if (move.FromDpi != move.ToDpi && GetWindowRect(hwnd, &actual) && !(ToScreenRect(actual) == move.To))
+			{
+				corrections.emplace_back(hwnd, move.To);
+			}
+		}
+
+		if (!corrections.empty())
+		{
+			corrected = true;
+			MoveBatch(corrections);
+		}
+	}
+
+	for (size_t i = 0; i < transitions.size(); ++i)
+	{
+		if (minimize[i])
+		{
+			// Was minimized before the scene was applied: minimize while concealed, no fade.
+			ShowWindow(Win32PlatformBackend::ToHandle(transitions[i].Window), SW_MINIMIZE);
+		}
+		else
+		{
+			WindowTransition::PrepareFadeIn(platform, transitions[i]);
+		}
+		WindowTransition::Reveal(platform, transitions[i]);
+	}
+
+	WindowTransition::FadeIn(platform, transitions);
+
+	for (const auto& transition : transitions)
+	{
+		WindowTransition::End(platform, transition.Window);
+	}
+
+	return moved;
+}
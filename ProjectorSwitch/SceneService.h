@@ -0,0 +1,42 @@
+#pragma once
+#include <windows.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Scene.h"
+#include "SettingsService.h"
+
+struct SceneToggleResult
+{
+	bool Ok = false;        // false if the scene is not configured or nothing could be moved
+	bool Applied = false;   // true if the scene was applied, false if it was reverted
+	size_t Moved = 0;
+	size_t Unresolved = 0;  // entries (or restore points) with no window or monitor
+	bool Corrected = false; // a second batch was needed after a DPI change
+};
+
+/// <summary>
+/// Applies and reverts named scenes from settings.ini. All of a scene's windows
+/// are cloaked, moved in a single DeferWindowPos batch and faded in together.
+/// </summary>
+class SceneService
+{
+private:
+	SettingsService* settingsService_;
+
+	bool LoadScene(const std::wstring& name, Scene& scene) const;
+
+	static std::vector<SceneWindow> EnumerateWindows();
+	static std::vector<SceneMonitor> EnumerateMonitors();
+	static bool Execute(const ScenePlan& plan, bool& corrected);
+	static bool MoveBatch(const std::vector<std::pair<HWND, ScreenRect>>& moves);
+
+public:
+	explicit SceneService(SettingsService* settingsService)
+		: settingsService_(settingsService)
+	{
+	}
+
+	// Applies the scene, or reverts it if it is currently applied.
+	SceneToggleResult Toggle(const std::wstring& name) const;
+};
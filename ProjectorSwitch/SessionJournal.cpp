@@ -0,0 +1,231 @@
+#include <cstring>
+#include <sstream>
+#include "SessionJournal.h"
+#include "BinaryIo.h"
+
+namespace
+{
+	constexpr std::uint32_t SlotMagic = 0x4A535350; // "PSSJ"
+	constexpr std::uint32_t SlotVersion = 1;
+
+	// Slot layout: magic, version, CRC-32 and length of the payload, then the payload.
+	constexpr std::size_t SlotHeaderSize = 16;
+	constexpr std::size_t MaxPayloadSize = SessionJournal::SlotSize - SlotHeaderSize;
+
+	std::uint32_t Crc32(const std::uint8_t* data, const std::size_t size)
+	{
+		std::uint32_t crc = 0xFFFFFFFFu;
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; ++bit)
+			{
+				crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+			}
+		}
+		return ~crc;
+	}
+
+	void WriteString(std::ostream& out, const std::wstring& value, const std::size_t maxLength)
+	{
+		const std::size_t length = value.size() < maxLength ? value.size() : maxLength;
+		BinaryIo::WriteU16(out, static_cast<std::uint16_t>(length));
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			BinaryIo::WriteU16(out, static_cast<std::uint16_t>(value[i]));
+		}
+	}
+
+	bool ReadString(std::istream& in, std::wstring& value, const std::size_t maxLength)
+	{
+		std::uint16_t length = 0;
+		if (!BinaryIo::ReadU16(in, length) || length > maxLength)
+		{
+			return false;
+		}
+
+		value.clear();
+		value.reserve(length);
+		for (std::uint16_t i = 0; i < length; ++i)
+		{
+			std::uint16_t c = 0;
+			if (!BinaryIo::ReadU16(in, c))
+			{
+				return false;
+			}
+			value.push_back(static_cast<wchar_t>(c));
+		}
+		return true;
+	}
+
+	std::string EncodePayload(const PlacementRecord& record)
+	{
+		std::ostringstream out(std::ios::binary);
+		BinaryIo::WriteU64(out, record.Sequence);
+		BinaryIo::WriteU64(out, record.Window.WindowHandle);
+		BinaryIo::WriteU32(out, record.Window.ProcessId);
+		BinaryIo::WriteU64(out, record.Window.ProcessStartTime);
+		BinaryIo::WriteU32(out, static_cast<std::uint32_t>(record.Rect.Left));
+		BinaryIo::WriteU32(out, static_cast<std::uint32_t>(record.Rect.Top));
+		BinaryIo::WriteU32(out, static_cast<std::uint32_t>(record.Rect.Right));
+		BinaryIo::WriteU32(out, static_cast<std::uint32_t>(record.Rect.Bottom));
+		BinaryIo::WriteU32(out, static_cast<std::uint32_t>(record.ShowCmd));
+		BinaryIo::WriteU32(out, (record.Minimized ? 1u : 0u) | (record.Active ? 2u : 0u));
+		WriteString(out, record.Window.ClassName, SessionJournal::MaxClassNameLength);
+		WriteString(out, record.MonitorKey, SessionJournal::MaxMonitorKeyLength);
+		return out.str();
+	}
+
+	bool DecodePayload(const std::string& payload, PlacementRecord& record)
+	{
+		std::istringstream in(payload, std::ios::binary);
+		std::uint32_t rect[4];
+		std::uint32_t showCmd = 0;
+		std::uint32_t flags = 0;
+		if (!BinaryIo::ReadU64(in, record.Sequence) ||
+			!BinaryIo::ReadU64(in, record.Window.WindowHandle) ||
+			!BinaryIo::ReadU32(in, record.Window.ProcessId) ||
+			!BinaryIo::ReadU64(in, record.Window.ProcessStartTime) ||
+			!BinaryIo::ReadU32(in, rect[0]) || !BinaryIo::ReadU32(in, rect[1]) ||
+			!BinaryIo::ReadU32(in, rect[2]) || !BinaryIo::ReadU32(in, rect[3]) ||
+			!BinaryIo::ReadU32(in, showCmd) ||
+			!BinaryIo::ReadU32(in, flags) ||
+			!ReadString(in, record.Window.ClassName, SessionJournal::MaxClassNameLength) ||
+			!ReadString(in, record.MonitorKey, SessionJournal::MaxMonitorKeyLength))
+		{
+			return false;
+		}
+
+		record.Rect = ScreenRect{ static_cast<int>(rect[0]), static_cast<int>(rect[1]), static_cast<int>(rect[2]), static_cast<int>(rect[3]) };
+		record.ShowCmd = static_cast<std::int32_t>(showCmd);
+		record.Minimized = (flags & 1u) != 0;
+		record.Active = (flags & 2u) != 0;
+		return true;
+	}
+
+	std::uint32_t LoadU32(const std::uint8_t* bytes)
+	{
+		return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+			(static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+	}
+
+	void StoreU32(std::uint8_t* bytes, const std::uint32_t value)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			bytes[i] = static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF);
+		}
+	}
+
+	// Sequence numbers are compared modulo 2^64, so the journal keeps working when they wrap.
+	bool IsNewer(const std::uint64_t sequence, const std::uint64_t than)
+	{
+		return static_cast<std::int64_t>(sequence - than) > 0;
+	}
+
+	// A slot's record, if the slot is intact.
+	bool ReadSlot(const std::uint8_t* slot, PlacementRecord& record)
+	{
+		const std::uint32_t length = LoadU32(slot + 12);
+		if (LoadU32(slot) != SlotMagic || LoadU32(slot + 4) != SlotVersion || length > MaxPayloadSize ||
+			LoadU32(slot + 8) != Crc32(slot + SlotHeaderSize, length))
+		{
+			return false;
+		}
+
+		return DecodePayload(std::string(reinterpret_cast<const char*>(slot + SlotHeaderSize), length), record);
+	}
+}
+
+bool SessionJournal::ReadLatest(const std::uint8_t* journal, PlacementRecord& record)
+{
+	PlacementRecord first;
+	PlacementRecord second;
+	const bool firstOk = ReadSlot(journal, first);
+	const bool secondOk = ReadSlot(journal + SlotSize, second);
+	if (!firstOk && !secondOk)
+	{
+		record = PlacementRecord();
+		return false;
+	}
+
+	record = !secondOk || (firstOk && IsNewer(first.Sequence, second.Sequence)) ? first : second;
+	return true;
+}
+
+/// <summary>
+/// The payload is written before the header that validates it, although only the
+/// checksum matters: the other slot is untouched, and a slot whose bytes are any
+/// mix of old and new fails the checksum and is ignored.
+/// </summary>
+std::size_t SessionJournal::Write(std::uint8_t* journal, const PlacementRecord& record)
+{
+	PlacementRecord first;
+	PlacementRecord second;
+	const bool firstOk = ReadSlot(journal, first);
+	const bool secondOk = ReadSlot(journal + SlotSize, second);
+
+	std::uint64_t newest = 0;
+	std::size_t offset = 0;
+	if (firstOk && (!secondOk || IsNewer(first.Sequence, second.Sequence)))
+	{
+		newest = first.Sequence;
+		offset = SlotSize;
+	}
+	else if (secondOk)
+	{
+		newest = second.Sequence;
+	}
+
+	PlacementRecord numbered = record;
+	numbered.Sequence = newest + 1;
+	const std::string payload = EncodePayload(numbered);
+
+	std::uint8_t* slot = journal + offset;
+	std::memcpy(slot + SlotHeaderSize, payload.data(), payload.size());
+	StoreU32(slot, SlotMagic);
+	StoreU32(slot + 4, SlotVersion);
+	StoreU32(slot + 8, Crc32(slot + SlotHeaderSize, payload.size()));
+	StoreU32(slot + 12, static_cast<std::uint32_t>(payload.size()));
+	return offset;
+}
+
+/// <summary>
+/// A record is restorable only to the window it was taken from, in the same process
+/// instance (a handle or process id may have been reused), and only while the window
+/// is still away (once sent back, the session is over).
+/// </summary>
+JournalMatch SessionJournal::Match(const PlacementRecord& record, const WindowIdentity& observed)
+{
+	if (!record.Active || record.Window.WindowHandle == 0)
+	{
+		return JournalMatch::NoSession;
+	}
+
+	if (observed.WindowHandle != record.Window.WindowHandle)
+	{
+		return JournalMatch::UnrelatedWindow;
+	}
+
+	if (observed.ProcessId != record.Window.ProcessId ||
+		observed.ProcessStartTime != record.Window.ProcessStartTime ||
+		observed.ClassName != record.Window.ClassName)
+	{
+		return JournalMatch::StaleSession;
+	}
+
+	return JournalMatch::Restorable;
+}
+
+const wchar_t* SessionJournal::MatchName(const JournalMatch match)
+{
+	switch (match)
+	{
+	case JournalMatch::Restorable: return L"restorable";
+	case JournalMatch::NoSession: return L"no session";
+	case JournalMatch::UnrelatedWindow: return L"unrelated window";
+	case JournalMatch::StaleSession: return L"stale session";
+	}
+
+	return L"?";
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "WindowGeometry.h"
+#include "WindowIdentity.h"
+
+// The media window's placement before a toggle moved it, journaled before each move.
+struct PlacementRecord
+{
+	std::uint64_t Sequence = 0; // assigned by SessionJournal::Write
+	WindowIdentity Window;
+	ScreenRect Rect;            // where the window was (its bounding rectangle)
+	std::int32_t ShowCmd = 0;   // SW_* from its WINDOWPLACEMENT
+	bool Minimized = false;
+	bool Active = false;        // the window is away from Rect (false once sent back)
+	std::wstring MonitorKey;    // the monitor that contained Rect
+};
+
+enum class JournalMatch : std::uint8_t
+{
+	Restorable,
+	NoSession,       // nothing journaled, or the last session was ended by a send back
+	UnrelatedWindow, // the record is for another window
+	StaleSession     // same handle, but not the same process instance (Zoom restarted)
+};
+
+/// <summary>
+/// Crash-safe journal of the media window's pre-move placement, so a send back from
+/// another process (a headless --toggle, or the app after a crash or restart) can
+/// restore it. The journal is a fixed-size region (a page, suitable for memory
+/// mapping) of two checksummed slots: a write fills the slot not holding the newest
+/// record, so a write interrupted at any point leaves the previous record readable.
+/// Reading examines both slots, so it takes constant time. Surviving a power loss is
+/// not needed: it ends the window's process too, so no record could match afterwards.
+/// Portable (no Windows dependencies).
+/// </summary>
+class SessionJournal
+{
+public:
+	static constexpr std::size_t SlotSize = 2048;
+	static constexpr std::size_t Size = 2 * SlotSize;
+
+	// Longer values are truncated (a truncated monitor key then matches no monitor).
+	static constexpr std::size_t MaxClassNameLength = 256;
+	static constexpr std::size_t MaxMonitorKeyLength = 512;
+
+	// The newest intact record; false if neither slot holds one (e.g. a new journal).
+	static bool ReadLatest(const std::uint8_t* journal, PlacementRecord& record);
+
+	// Writes record, numbered after the newest, into the other slot. Returns the offset
+	// of the slot written, so that only it need be flushed.
+	static std::size_t Write(std::uint8_t* journal, const PlacementRecord& record);
+
+	// Whether the record may be restored to the window observed now.
+	static JournalMatch Match(const PlacementRecord& record, const WindowIdentity& observed);
+
+	static const wchar_t* MatchName(JournalMatch match);
+};
@@ -1,4 +1,7 @@
 #include "SettingsService.h"
+#include "TraceRecorder.h"
+#include "CallCounters.h"
+#include "ProviderRegistry.h"
 
 namespace
 {
@@ -8,6 +11,41 @@ namespace
 	const std::wstring SelectedMonitorR = L"SelectedMonitorR";
 	const std::wstring SelectedMonitorB = L"SelectedMonitorB";
 	const std::wstring SelectedMonitorKey = L"SelectedMonitorKey";
+	const std::wstring ToggleLatencyBudgetMs = L"ToggleLatencyBudgetMs";
+	constexpr int DefaultToggleLatencyBudgetMs = 2000;
+	const std::wstring UiaDeadlineMs = L"UiaDeadlineMs";
+	constexpr int DefaultUiaDeadlineMs = 3000;
+	const std::wstring IdleReleaseSeconds = L"IdleReleaseSeconds";
+	constexpr int DefaultIdleReleaseSeconds = 600;
+	const std::wstring PinToProjector = L"PinToProjector";
+	const std::wstring HoldingSlide = L"HoldingSlide";
+	const std::wstring ShareFollow = L"ShareFollow";
+	const std::wstring ShareFollowMove = L"move";
+	const std::wstring ShareFollowSwap = L"swap";
+	const std::wstring ShareSettleMs = L"ShareSettleMs";
+	const std::wstring ShareWindowName = L"ShareWindowName";
+	const std::wstring ShareWindowClass = L"ShareWindowClass";
+
+	const std::wstring ToggleMode = L"ToggleMode";
+	const std::wstring ToggleModeMirror = L"mirror";
+	const std::wstring MirrorCropLeft = L"MirrorCropLeft";
+	const std::wstring MirrorCropTop = L"MirrorCropTop";
+	const std::wstring MirrorCropRight = L"MirrorCropRight";
+	const std::wstring MirrorCropBottom = L"MirrorCropBottom";
+
+	const std::wstring Providers = L"Providers";
+	const std::wstring ProviderSectionPrefix = L"PROVIDER:";
+	const std::wstring ProviderProcess = L"Process";
+	const std::wstring ProviderWindowName = L"WindowName";
+	const std::wstring ProviderWindowClass = L"WindowClass";
+	const std::wstring ProviderHelpTextPrefix = L"MainWindowHelpText";
+	constexpr int MaxProviderHelpTexts = 8;
+
+	const std::wstring SceneSectionPrefix = L"SCENE:";
+	const std::wstring SceneStateSectionPrefix = L"SCENESTATE:";
+	const std::wstring SceneWindowPrefix = L"Window";
+	const std::wstring SceneStateCount = L"Count";
+	constexpr int MaxSceneWindows = 16;
 
 	const std::wstring WindowSection = L"WINDOW";
 	const std::wstring ShowCmd = L"ShowCmd";
@@ -127,6 +165,259 @@ std::wstring SettingsService::LoadSelectedMonitorKey() const
 	return InternalLoadString(SettingsSection, SelectedMonitorKey);
 }
 
+/// <summary>
+/// Loads the toggle latency budget. Toggles that take longer are treated like
+/// failures for diagnostics (the flight recorder is dumped).
+/// </summary>
+/// <returns>Budget in milliseconds; 0 disables the check.</returns>
+int SettingsService::LoadToggleLatencyBudgetMs() const
+{
+	return InternalLoadInt(SettingsSection, ToggleLatencyBudgetMs, DefaultToggleLatencyBudgetMs);
+}
+
+/// <summary>
+/// Determines whether toggling mirrors the media window onto the target monitor
+/// (a DWM thumbnail) rather than moving it there.
+/// </summary>
+/// <returns>True if ToggleMode is "mirror".</returns>
+bool SettingsService::LoadMirrorMode() const
+{
+	return _wcsicmp(InternalLoadString(SettingsSection, ToggleMode).c_str(), ToggleModeMirror.c_str()) == 0;
+}
+
+/// <summary>
+/// Loads how much to crop from each edge of the mirrored window's client area.
+/// </summary>
+/// <returns>Insets in pixels at 96 DPI (default none).</returns>
+FrameInsets SettingsService::LoadMirrorCrop() const
+{
+	return FrameInsets
+	{
+		InternalLoadInt(SettingsSection, MirrorCropLeft, 0),
+		InternalLoadInt(SettingsSection, MirrorCropTop, 0),
+		InternalLoadInt(SettingsSection, MirrorCropRight, 0),
+		InternalLoadInt(SettingsSection, MirrorCropBottom, 0)
+	};
+}
+
+/// <summary>
+/// Loads which media window providers to look for, highest precedence first.
+/// </summary>
+/// <returns>Provider names (built-in or defined in a PROVIDER section); empty for the default.</returns>
+std::vector<std::wstring> SettingsService::LoadProviderNames() const
+{
+	return ProviderRegistry::ParseList(InternalLoadString(SettingsSection, Providers));
+}
+
+/// <summary>
+/// Loads the process names of a provider defined in settings. Read for every provider
+/// up front, as they decide whether the rest of its definition is needed.
+/// </summary>
+/// <param name="providerName">The provider name.</param>
+/// <returns>Executable names; empty if the section does not define any.</returns>
+std::vector<std::wstring> SettingsService::LoadProviderProcesses(const std::wstring& providerName) const
+{
+	return ProviderRegistry::ParseList(InternalLoadString(ProviderSectionPrefix + providerName, ProviderProcess));
+}
+
+/// <summary>
+/// Loads how to recognise a settings-defined provider's media window. Only called
+/// once one of its processes is running.
+/// </summary>
+/// <param name="providerName">The provider name.</param>
+/// <returns>The selectors (the HelpText markers may be empty).</returns>
+MediaWindowSelectors SettingsService::LoadProviderSelectors(const std::wstring& providerName) const
+{
+	const std::wstring section = ProviderSectionPrefix + providerName;
+	MediaWindowSelectors selectors
+	{
+		InternalLoadString(section, ProviderWindowName),
+		InternalLoadString(section, ProviderWindowClass),
+		{}
+	};
+
+	for (int i = 1; i <= MaxProviderHelpTexts; ++i)
+	{
+		std::wstring helpText = InternalLoadString(section, ProviderHelpTextPrefix + std::to_wstring(i));
+		if (!helpText.empty())
+		{
+			selectors.MainWindowHelpTexts.push_back(std::move(helpText));
+		}
+	}
+
+	return selectors;
+}
+
+/// <summary>
+/// Loads the window entries of a scene (unparsed; see ScenePlanner::ParseEntry).
+/// </summary>
+/// <param name="sceneName">The scene name.</param>
+/// <returns>The non-empty entries Window1..Window16, in order.</returns>
+std::vector<std::wstring> SettingsService::LoadSceneEntries(const std::wstring& sceneName) const
+{
+	std::vector<std::wstring> entries;
+	for (int i = 1; i <= MaxSceneWindows; ++i)
+	{
+		std::wstring entry = InternalLoadString(SceneSectionPrefix + sceneName, SceneWindowPrefix + std::to_wstring(i));
+		if (!entry.empty())
+		{
+			entries.push_back(std::move(entry));
+		}
+	}
+
+	return entries;
+}
+
+/// <summary>
+/// Saves the restore points of an applied scene, replacing any previous state.
+/// </summary>
+/// <param name="sceneName">The scene name.</param>
+/// <param name="restorePoints">Formatted restore points (see ScenePlanner::FormatRestorePoint);
+/// empty to mark the scene as not applied.</param>
+void SettingsService::SaveSceneState(const std::wstring& sceneName, const std::vector<std::wstring>& restorePoints) const
+{
+	const std::wstring section = SceneStateSectionPrefix + sceneName;
+	InternalDeleteSection(section);
+	if (restorePoints.empty())
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < restorePoints.size(); ++i)
+	{
+		InternalSaveString(section, SceneWindowPrefix + std::to_wstring(i + 1), restorePoints[i]);
+	}
+	InternalSaveInt(section, SceneStateCount, static_cast<int>(restorePoints.size()));
+}
+
+/// <summary>
+/// Loads the restore points of an applied scene.
+/// </summary>
+/// <param name="sceneName">The scene name.</param>
+/// <returns>Formatted restore points; empty if the scene is not applied.</returns>
+std::vector<std::wstring> SettingsService::LoadSceneState(const std::wstring& sceneName) const
+{
+	const std::wstring section = SceneStateSectionPrefix + sceneName;
+	const int count = InternalLoadInt(section, SceneStateCount, 0);
+
+	std::vector<std::wstring> restorePoints;
+	for (int i = 1; i <= count && i <= MaxSceneWindows; ++i)
+	{
+		restorePoints.push_back(InternalLoadString(section, SceneWindowPrefix + std::to_wstring(i)));
+	}
+
+	return restorePoints;
+}
+
+/// <summary>
+/// Loads the UI Automation deadline: how long finding the media window may take
+/// before the toggle fails rather than waiting on an unresponsive application.
+/// </summary>
+/// <returns>Deadline in milliseconds; 0 disables it.</returns>
+int SettingsService::LoadUiaDeadlineMs() const
+{
+	return InternalLoadInt(SettingsSection, UiaDeadlineMs, DefaultUiaDeadlineMs);
+}
+
+/// <summary>
+/// Loads how long Zoom must have been absent before UI Automation and the other
+/// resources only needed for toggling are released.
+/// </summary>
+/// <returns>Period in seconds; 0 keeps them for the life of the process.</returns>
+int SettingsService::LoadIdleReleaseSeconds() const
+{
+	return InternalLoadInt(SettingsSection, IdleReleaseSeconds, DefaultIdleReleaseSeconds);
+}
+
+/// <summary>
+/// Determines whether the media window is held at its projector position while it is
+/// there, undoing moves and resizes made by Zoom itself.
+/// </summary>
+/// <returns>True if PinToProjector is non-zero.</returns>
+bool SettingsService::LoadPinToProjector() const
+{
+	return InternalLoadInt(SettingsSection, PinToProjector, 0) != 0;
+}
+
+/// <summary>
+/// Gets what to show on the projector while the media window is not there: a colour
+/// ("#RRGGBB") or the full path of an image file.
+/// </summary>
+/// <returns>The colour or path; empty if no holding slide is configured.</returns>
+std::wstring SettingsService::LoadHoldingSlide() const
+{
+	const std::wstring value = InternalLoadString(SettingsSection, HoldingSlide);
+	const bool isAbsolute = value.find(L':') != std::wstring::npos || (!value.empty() && value[0] == L'\\');
+	if (value.empty() || value[0] == L'#' || isAbsolute)
+	{
+		return value;
+	}
+
+	return GetSiblingFilePath(value);
+}
+
+/// <summary>
+/// Loads whether (and how) screen shares are followed onto the projector.
+/// </summary>
+/// <param name="options">Receives the mode and settling delay if following is on.</param>
+/// <returns>True if ShareFollow is "move" or "swap".</returns>
+bool SettingsService::LoadShareFollow(ShareFollowOptions& options) const
+{
+	const std::wstring mode = InternalLoadString(SettingsSection, ShareFollow);
+	if (_wcsicmp(mode.c_str(), ShareFollowSwap.c_str()) == 0)
+	{
+		options.Mode = ShareFollowMode::Swap;
+	}
+	else if (_wcsicmp(mode.c_str(), ShareFollowMove.c_str()) == 0)
+	{
+		options.Mode = ShareFollowMode::Move;
+	}
+	else
+	{
+		return false;
+	}
+
+	const int settleMs = InternalLoadInt(SettingsSection, ShareSettleMs, static_cast<int>(options.SettleDelay.count()));
+	options.SettleDelay = std::chrono::milliseconds(settleMs > 0 ? settleMs : 0);
+	return true;
+}
+
+/// <summary>
+/// Loads how to recognise the share-viewing window; each value not set keeps Zoom's default.
+/// </summary>
+MediaWindowSelectors SettingsService::LoadShareWindowSelectors() const
+{
+	MediaWindowSelectors selectors = MediaWindowSelectors::ZoomShare();
+	std::wstring name = InternalLoadString(SettingsSection, ShareWindowName);
+	std::wstring className = InternalLoadString(SettingsSection, ShareWindowClass);
+	if (!name.empty())
+	{
+		selectors.WindowName = std::move(name);
+	}
+	if (!className.empty())
+	{
+		selectors.WindowClassName = std::move(className);
+	}
+
+	return selectors;
+}
+
+/// <summary>
+/// Gets the full path of a file stored in the same folder as the settings file.
+/// </summary>
+/// <param name="fileName">File name (no folder).</param>
+/// <returns>Full path to the file.</returns>
+std::wstring SettingsService::GetSiblingFilePath(const std::wstring& fileName) const
+{
+	const auto separator = pathToFile_.find_last_of(L'\\');
+	if (separator == std::wstring::npos)
+	{
+		return fileName;
+	}
+
+	return pathToFile_.substr(0, separator + 1) + fileName;
+}
+
 /// <summary>
 /// Saves a string value to a specified section and key in the settings file.
 /// </summary>
@@ -136,7 +427,19 @@ std::wstring SettingsService::LoadSelectedMonitorKey() const
 void SettingsService::InternalSaveString(
 	const std::wstring& section, const std::wstring& keyName, const std::wstring& keyValue) const
 {
-	WritePrivateProfileString(section.c_str(), keyName.c_str(), keyValue.c_str(), pathToFile_.c_str());
+	TRACE_ZONE("SettingsService::InternalSaveString");
+	CallCountScope::Count(CallCategory::IniFileAccess);
+	WritePrivateProfileStringW(section.c_str(), keyName.c_str(), keyValue.c_str(), pathToFile_.c_str());
+}
+
+/// <summary>
+/// Removes a section and all its keys from the settings file.
+/// </summary>
+/// <param name="section">The section to remove.</param>
+void SettingsService::InternalDeleteSection(const std::wstring& section) const
+{
+	CallCountScope::Count(CallCategory::IniFileAccess);
+	WritePrivateProfileStringW(section.c_str(), nullptr, nullptr, pathToFile_.c_str());
 }
 
 /// <summary>
@@ -162,8 +465,10 @@ void SettingsService::InternalSaveInt(
 std::wstring SettingsService::InternalLoadString(
 	const std::wstring& section, const std::wstring& keyName) const
 {
-	WCHAR buffer[256];
-	GetPrivateProfileString(
+	TRACE_ZONE("SettingsService::InternalLoadString");
+	WCHAR buffer[1024]; // scene entries hold monitor device paths
+	CallCountScope::Count(CallCategory::IniFileAccess);
+	GetPrivateProfileStringW(
 		section.c_str(),
 		keyName.c_str(),
 		L"",
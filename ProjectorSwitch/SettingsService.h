@@ -1,7 +1,11 @@
 #pragma once
 #include <windows.h>
 #include <string>
+#include <vector>
 #include <WinUser.h>
+#include "WindowGeometry.h"
+#include "MediaWindowSelectors.h"
+#include "ShareFollowPolicy.h"
 
 class SettingsService
 {
@@ -19,10 +23,58 @@ public:
 	void SaveWindowPlacement(const WINDOWPLACEMENT& placement) const;
 	WINDOWPLACEMENT LoadWindowPlacement() const;
 
+	// UI Automation discovery gives up after this long, e.g. if Zoom is hung (0 = wait indefinitely)
+	int LoadUiaDeadlineMs() const;
+
+	// UI Automation is released once Zoom has been absent this long (0 = never)
+	int LoadIdleReleaseSeconds() const;
+
+	// toggles slower than this dump the flight recorder to the Logs folder (0 = never)
+	int LoadToggleLatencyBudgetMs() const;
+
+	// PinToProjector=1 moves the media window back if Zoom moves or resizes it on the projector
+	bool LoadPinToProjector() const;
+
+	// HoldingSlide=#RRGGBB or an image file (relative to settings.ini) shown on the projector while the media window is home
+	std::wstring LoadHoldingSlide() const;
+
+	// ShareFollow=move|swap puts the share-viewing window on the projector while a share lasts (empty = off);
+	// ShareSettleMs is how long a share must have ended before it is undone
+	bool LoadShareFollow(ShareFollowOptions& options) const;
+
+	// ShareWindowName and ShareWindowClass recognise the share-viewing window (unset: Zoom's)
+	MediaWindowSelectors LoadShareWindowSelectors() const;
+
+	// ToggleMode=mirror shows a DWM thumbnail of the media window instead of moving it
+	bool LoadMirrorMode() const;
+
+	// content cropped from the mirrored media window's client area, at 96 DPI (e.g. Zoom's toolbar)
+	FrameInsets LoadMirrorCrop() const;
+
+	// Providers=Zoom,Teams: the apps to look for, in precedence order (empty = Zoom only)
+	std::vector<std::wstring> LoadProviderNames() const;
+
+	// Process=a.exe,b.exe of the [PROVIDER:<name>] section (empty if the provider is not defined there)
+	std::vector<std::wstring> LoadProviderProcesses(const std::wstring& providerName) const;
+
+	// WindowName, WindowClass and MainWindowHelpText1..N of the [PROVIDER:<name>] section
+	MediaWindowSelectors LoadProviderSelectors(const std::wstring& providerName) const;
+
+	// window entries Window1..WindowN of the [SCENE:<name>] section
+	std::vector<std::wstring> LoadSceneEntries(const std::wstring& sceneName) const;
+
+	// restore points of an applied scene (empty when the scene is not applied)
+	void SaveSceneState(const std::wstring& sceneName, const std::vector<std::wstring>& restorePoints) const;
+	std::vector<std::wstring> LoadSceneState(const std::wstring& sceneName) const;
+
+	// path of another file stored alongside settings.ini
+	std::wstring GetSiblingFilePath(const std::wstring& fileName) const;
+
 private:
 	std::wstring pathToFile_;
 
 	void InternalSaveString(const std::wstring& section, const std::wstring& keyName, const std::wstring& keyValue) const;
+	void InternalDeleteSection(const std::wstring& section) const;
 	void InternalSaveInt(const std::wstring& section, const std::wstring& keyName, const int keyValue) const;
 
 	std::wstring InternalLoadString(const std::wstring& section, const std::wstring& keyName) const;
@@ -0,0 +1,112 @@
+#include "ShareFollowPolicy.h"
+
+ShareFollowPolicy::ShareFollowPolicy(const ShareFollowOptions& options)
+	: options_(options)
+	, shown_(0)
+	, ended_(0)
+	, settling_(false)
+	, mediaSwapped_(false)
+{
+}
+
+/// <summary>
+/// Shows the new share window. If another is on the projector, or a share has just
+/// ended, the new one takes its place; otherwise, in Swap mode, the media window goes
+/// home (after the share window is up, so the projector never shows the desktop).
+/// </summary>
+ShareFollowSteps ShareFollowPolicy::OnShareOpened(const std::uint64_t window, const bool mediaOnProjector)
+{
+	ShareFollowSteps steps;
+	if (window == 0 || window == shown_)
+	{
+		return steps;
+	}
+
+	steps.ShowShare = window;
+	if (settling_)
+	{
+		steps.SendShareHome = ended_ != window ? ended_ : 0;
+	}
+	else if (shown_ != 0)
+	{
+		steps.SendShareHome = shown_;
+	}
+	else if (options_.Mode == ShareFollowMode::Swap && mediaOnProjector)
+	{
+		steps.SendMediaHome = true;
+		mediaSwapped_ = true;
+	}
+
+	shown_ = window;
+	ended_ = 0;
+	settling_ = false;
+	++stats_.Follows;
+	return steps;
+}
+
+ShareFollowSteps ShareFollowPolicy::OnShareClosed(const std::uint64_t window, const Clock::time_point now)
+{
+	ShareFollowSteps steps;
+	if (window == 0 || window != shown_)
+	{
+		return steps;
+	}
+
+	ended_ = shown_;
+	shown_ = 0;
+	settling_ = true;
+	settleAt_ = now + options_.SettleDelay;
+	steps.SettleAfter = options_.SettleDelay;
+	return steps;
+}
+
+ShareFollowSteps ShareFollowPolicy::OnSettle(const Clock::time_point now)
+{
+	ShareFollowSteps steps;
+	if (!settling_)
+	{
+		return steps;
+	}
+
+	if (now < settleAt_)
+	{
+		// Woken early (timers are not exact): wait out the rest, rounded up.
+		steps.SettleAfter = std::chrono::ceil<std::chrono::milliseconds>(settleAt_ - now);
+		return steps;
+	}
+
+	return Restore(ended_);
+}
+
+ShareFollowSteps ShareFollowPolicy::OnOperatorToggle()
+{
+	if (!IsFollowing())
+	{
+		return ShareFollowSteps();
+	}
+
+	return Restore(shown_ != 0 ? shown_ : ended_);
+}
+
+ShareFollowSteps ShareFollowPolicy::Restore(const std::uint64_t shareWindow)
+{
+	ShareFollowSteps steps;
+	steps.ShowMedia = mediaSwapped_;
+	steps.SendShareHome = shareWindow;
+
+	shown_ = 0;
+	ended_ = 0;
+	settling_ = false;
+	mediaSwapped_ = false;
+	++stats_.Restores;
+	return steps;
+}
+
+void ShareFollowPolicy::OnShown(const std::chrono::microseconds latency)
+{
+	stats_.TotalLatencyUs += latency.count();
+	if (latency.count() > stats_.MaxLatencyUs)
+	{
+		stats_.MaxLatencyUs = latency.count();
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+enum class ShareFollowMode
+{
+	Move, // put the share window on the projector, over the media window if that is there
+	Swap  // also send the media window home while the share lasts
+};
+
+struct ShareFollowOptions
+{
+	ShareFollowMode Mode = ShareFollowMode::Move;
+	std::chrono::milliseconds SettleDelay{ 1500 }; // a share that ends is undone only if no other starts within this
+};
+
+// What to do about a share event, in the order of the fields. Windows are identified
+// by an opaque value (an HWND on Windows).
+struct ShareFollowSteps
+{
+	std::uint64_t ShowShare = 0;      // share window to put on the projector
+	bool ShowMedia = false;           // put the media window back on the projector
+	std::uint64_t SendShareHome = 0;  // share window to return to where it was
+	bool SendMediaHome = false;       // take the media window off the projector
+	std::chrono::milliseconds SettleAfter{ 0 }; // call OnSettle after this long (0 = no need)
+
+	bool IsEmpty() const
+	{
+		return ShowShare == 0 && !ShowMedia && SendShareHome == 0 && !SendMediaHome && SettleAfter.count() == 0;
+	}
+};
+
+struct ShareFollowStats
+{
+	std::uint64_t Follows = 0;          // share windows put on the projector
+	std::uint64_t Restores = 0;         // shares undone (ended, or dismissed by a toggle)
+	std::int64_t TotalLatencyUs = 0;    // share window opened to visible on the projector
+	std::int64_t MaxLatencyUs = 0;
+};
+
+/// <summary>
+/// Decides how to follow screen shares onto the projector: a share window that opens
+/// is shown there (sending the media window home, in Swap mode), and when the share
+/// ends everything is put back. A share that ends is undone only after a settling
+/// delay, so a share passing straight to another participant, or Zoom recreating
+/// its window, swaps windows instead of flashing the media window. A toggle by the
+/// operator while following dismisses the share. Time is passed in, so the policy
+/// is driven by scripted event streams in tests.
+/// Portable (no Windows dependencies).
+/// </summary>
+class ShareFollowPolicy
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+private:
+	ShareFollowOptions options_;
+	std::uint64_t shown_;       // share window on the projector
+	std::uint64_t ended_;       // share window whose share ended, while settling
+	bool settling_;
+	bool mediaSwapped_;         // the media window was sent home for the share
+	Clock::time_point settleAt_;
+	ShareFollowStats stats_;
+
+	ShareFollowSteps Restore(std::uint64_t shareWindow);
+
+public:
+	explicit ShareFollowPolicy(const ShareFollowOptions& options = ShareFollowOptions());
+
+	// A share window opened; mediaOnProjector is whether the media window is there now.
+	ShareFollowSteps OnShareOpened(std::uint64_t window, bool mediaOnProjector);
+
+	// The share window closed (or was hidden).
+	ShareFollowSteps OnShareClosed(std::uint64_t window, Clock::time_point now);
+
+	// The settling delay requested by SettleAfter has (probably) passed.
+	ShareFollowSteps OnSettle(Clock::time_point now);
+
+	// The operator toggled; if a share is being followed this undoes it instead.
+	ShareFollowSteps OnOperatorToggle();
+
+	// A share window was shown; latency is from its window opening.
+	void OnShown(std::chrono::microseconds latency);
+
+	bool IsFollowing() const { return shown_ != 0 || settling_; }
+	std::uint64_t Shown() const { return shown_; }
+	const ShareFollowStats& Stats() const { return stats_; }
+};
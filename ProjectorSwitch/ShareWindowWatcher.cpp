@@ -0,0 +1,209 @@
+#include <atomic>
+#include <string>
+#include <utility>
+#include "ShareWindowWatcher.h"
+#include "CompositionClock.h"
+
+namespace
+{
+	std::wstring TakeBstr(BSTR value)
+	{
+		std::wstring result;
+		if (value != nullptr)
+		{
+			result.assign(value, SysStringLen(value));
+			SysFreeString(value);
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Receives the window events on UI Automation's threads and posts them on. It only
+	/// reads what was cached with the event and never touches the watcher, which lives
+	/// on the UI thread.
+	/// </summary>
+	class WindowEventHandler final : public IUIAutomationEventHandler
+	{
+	private:
+		std::atomic<ULONG> references_;
+		std::shared_ptr<ShareWindowWatcher::Link> link_;
+		MediaWindowSelectors selectors_;
+
+		bool Matches(IUIAutomationElement* sender) const
+		{
+			BSTR value = nullptr;
+			const std::wstring className = SUCCEEDED(sender->get_CachedClassName(&value)) ? TakeBstr(value) : std::wstring();
+			value = nullptr;
+			const std::wstring name = SUCCEEDED(sender->get_CachedName(&value)) ? TakeBstr(value) : std::wstring();
+
+			return (!selectors_.WindowClassName.empty() || !selectors_.WindowName.empty()) &&
+				(selectors_.WindowClassName.empty() || className == selectors_.WindowClassName) &&
+				(selectors_.WindowName.empty() || name == selectors_.WindowName);
+		}
+
+	public:
+		WindowEventHandler(std::shared_ptr<ShareWindowWatcher::Link> link, MediaWindowSelectors selectors)
+			: references_(1)
+			, link_(std::move(link))
+			, selectors_(std::move(selectors))
+		{
+		}
+
+		HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+		{
+			if (object == nullptr)
+			{
+				return E_POINTER;
+			}
+
+			if (riid == __uuidof(IUnknown) || riid == __uuidof(IUIAutomationEventHandler))
+			{
+				*object = static_cast<IUIAutomationEventHandler*>(this);
+				AddRef();
+				return S_OK;
+			}
+
+			*object = nullptr;
+			return E_NOINTERFACE;
+		}
+
+		ULONG STDMETHODCALLTYPE AddRef() override
+		{
+			return references_.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+
+		ULONG STDMETHODCALLTYPE Release() override
+		{
+			const ULONG remaining = references_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+			if (remaining == 0)
+			{
+				delete this;
+			}
+			return remaining;
+		}
+
+		HRESULT STDMETHODCALLTYPE HandleAutomationEvent(IUIAutomationElement* sender, const EVENTID eventId) override
+		{
+			const std::int64_t eventQpc = CompositionClock::Now();
+			const std::shared_ptr<ShareWindowWatcher::Link> link = link_;
+
+			// A closed window's properties cannot be read; the watcher's owner checks its own.
+			if (eventId == UIA_Window_WindowClosedEventId)
+			{
+				link->Reactor->Post([link] { if (link->Watcher != nullptr) link->Watcher->DispatchClosed(); });
+				return S_OK;
+			}
+
+			UIA_HWND nativeHandle = nullptr;
+			if (sender == nullptr || !Matches(sender) || FAILED(sender->get_CachedNativeWindowHandle(&nativeHandle)) || nativeHandle == nullptr)
+			{
+				return S_OK;
+			}
+
+			const HWND window = static_cast<HWND>(nativeHandle);
+			link->Reactor->Post([link, window, eventQpc] { if (link->Watcher != nullptr) link->Watcher->DispatchOpened(window, eventQpc); });
+			return S_OK;
+		}
+	};
+}
+
+ShareWindowWatcher::ShareWindowWatcher(EventReactor& reactor, IUIAutomation* automation, IUIAutomationElement* root,
+	MediaWindowSelectors selectors, OpenedCallback opened, ClosedCallback closed)
+	: reactor_(reactor)
+	, automation_(UniqueRef<IUIAutomation>::Share(automation))
+	, root_(UniqueRef<IUIAutomationElement>::Share(root))
+	, link_(std::make_shared<Link>(Link{ &reactor, this }))
+	, opened_(std::move(opened))
+	, closed_(std::move(closed))
+	, settleRegistration_(EventReactor::InvalidRegistration)
+{
+	settleTimer_.Attach(CreateWaitableTimerW(nullptr, FALSE, nullptr));
+	if (settleTimer_)
+	{
+		settleRegistration_ = reactor_.Register(settleTimer_, [this] { RunSettled(); });
+	}
+
+	if (!automation_ || !root_)
+	{
+		return;
+	}
+
+	UniqueRef<IUIAutomationCacheRequest> cacheRequest;
+	if (FAILED(automation_->CreateCacheRequest(cacheRequest.Out())) ||
+		FAILED(cacheRequest->AddProperty(UIA_ClassNamePropertyId)) ||
+		FAILED(cacheRequest->AddProperty(UIA_NamePropertyId)) ||
+		FAILED(cacheRequest->AddProperty(UIA_NativeWindowHandlePropertyId)))
+	{
+		return;
+	}
+
+	UniqueRef<IUIAutomationEventHandler> handler(new WindowEventHandler(link_, std::move(selectors)));
+	if (FAILED(automation_->AddAutomationEventHandler(UIA_Window_WindowOpenedEventId, root_.Get(), TreeScope_Subtree, cacheRequest.Get(), handler.Get())))
+	{
+		return;
+	}
+
+	if (FAILED(automation_->AddAutomationEventHandler(UIA_Window_WindowClosedEventId, root_.Get(), TreeScope_Subtree, nullptr, handler.Get())))
+	{
+		automation_->RemoveAutomationEventHandler(UIA_Window_WindowOpenedEventId, root_.Get(), handler.Get());
+		return;
+	}
+
+	handler_ = std::move(handler);
+}
+
+ShareWindowWatcher::~ShareWindowWatcher()
+{
+	// Events already posted find the watcher gone.
+	link_->Watcher = nullptr;
+
+	if (handler_)
+	{
+		automation_->RemoveAutomationEventHandler(UIA_Window_WindowOpenedEventId, root_.Get(), handler_.Get());
+		automation_->RemoveAutomationEventHandler(UIA_Window_WindowClosedEventId, root_.Get(), handler_.Get());
+		handler_.Reset();
+	}
+
+	if (settleRegistration_ != EventReactor::InvalidRegistration)
+	{
+		reactor_.Unregister(settleRegistration_);
+	}
+}
+
+void ShareWindowWatcher::CallAfter(const std::chrono::milliseconds delay, EventReactor::Callback callback)
+{
+	settled_ = std::move(callback);
+	LARGE_INTEGER due{};
+	due.QuadPart = -static_cast<LONGLONG>(delay.count()) * 10000; // relative, in 100ns units
+	if (!settleTimer_ || !SetWaitableTimer(settleTimer_, &due, 0, nullptr, nullptr, FALSE))
+	{
+		// Without a timer, settle now rather than never.
+		reactor_.Post([link = link_] { if (link->Watcher != nullptr) link->Watcher->RunSettled(); });
+	}
+}
+
+void ShareWindowWatcher::RunSettled()
+{
+	EventReactor::Callback settled = std::move(settled_);
+	settled_ = nullptr;
+	if (settled)
+	{
+		settled();
+	}
+}
+
+void ShareWindowWatcher::DispatchOpened(const HWND window, const std::int64_t eventQpc) const
+{
+	if (opened_)
+	{
+		opened_(window, eventQpc);
+	}
+}
+
+void ShareWindowWatcher::DispatchClosed() const
+{
+	if (closed_)
+	{
+		closed_();
+	}
+}
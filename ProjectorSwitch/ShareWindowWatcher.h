@@ -0,0 +1,61 @@
+#pragma once
+#include <windows.h>
+#include <uiautomation.h>
+#include <atlbase.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "EventReactor.h"
+#include "MediaWindowSelectors.h"
+#include "UniqueRef.h"
+
+/// <summary>
+/// Reports the share-viewing window opening and windows closing, from UI Automation
+/// window events on the desktop. UI Automation delivers them on its own threads; they
+/// are posted to the reactor, so the callbacks (and the settle timer's) run on the UI
+/// thread. The properties needed to recognise the share window are cached with the
+/// event, so the handler makes no cross-process calls.
+/// </summary>
+class ShareWindowWatcher  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+	// eventQpc is when the event was received (CompositionClock).
+	using OpenedCallback = std::function<void(HWND window, std::int64_t eventQpc)>;
+	using ClosedCallback = std::function<void()>;
+
+	// Shared with the handler, which outlives the watcher if UI Automation holds on to it.
+	struct Link
+	{
+		EventReactor* Reactor;
+		ShareWindowWatcher* Watcher; // reactor thread only; null once the watcher is gone
+	};
+
+private:
+	EventReactor& reactor_;
+	UniqueRef<IUIAutomation> automation_;
+	UniqueRef<IUIAutomationElement> root_;
+	UniqueRef<IUIAutomationEventHandler> handler_;
+	std::shared_ptr<Link> link_;
+	OpenedCallback opened_;
+	ClosedCallback closed_;
+	CHandle settleTimer_;
+	EventReactor::RegistrationId settleRegistration_;
+	EventReactor::Callback settled_;
+
+	void RunSettled();
+
+public:
+	ShareWindowWatcher(EventReactor& reactor, IUIAutomation* automation, IUIAutomationElement* root,
+		MediaWindowSelectors selectors, OpenedCallback opened, ClosedCallback closed);
+	~ShareWindowWatcher();
+
+	bool IsWatching() const { return static_cast<bool>(handler_); }
+
+	// Runs callback on the UI thread after delay (replacing any pending one).
+	void CallAfter(std::chrono::milliseconds delay, EventReactor::Callback callback);
+
+	// Reactor thread, from the handler's posts.
+	void DispatchOpened(HWND window, std::int64_t eventQpc) const;
+	void DispatchClosed() const;
+};
@@ -0,0 +1,170 @@
+#include <iomanip>
+#include "SoakBenchmark.h"
+#include "CountedAutomation.h"
+#include "MediaWindowDiscovery.h"
+
+namespace
+{
+	constexpr int SimulatedZoomCandidates = 3;
+
+	struct ResourceCount
+	{
+		const char* Name;
+		std::int64_t ResourceSample::* Field;
+	};
+
+	constexpr ResourceCount ResourceCounts[] =
+	{
+		{ "liveObjects", &ResourceSample::LiveObjects },
+		{ "handles", &ResourceSample::Handles },
+		{ "gdiObjects", &ResourceSample::GdiObjects },
+		{ "userObjects", &ResourceSample::UserObjects },
+		{ "privateBytes", &ResourceSample::PrivateBytes },
+	};
+
+	/// <summary>
+	/// Writes a name as a JSON string, escaping quotes and backslashes.
+	/// </summary>
+	void WriteJsonString(std::ostream& out, const std::string& value)
+	{
+		out << '"';
+		for (const char ch : value)
+		{
+			if (ch == '"' || ch == '\\')
+			{
+				out << '\\';
+			}
+			out << ch;
+		}
+		out << '"';
+	}
+
+	void WriteSample(std::ostream& out, const ResourceSample& sample)
+	{
+		for (const ResourceCount& count : ResourceCounts)
+		{
+			if (sample.*count.Field >= 0)
+			{
+				out << ",\"" << count.Name << "\":" << sample.*count.Field;
+			}
+		}
+	}
+
+	bool IsSampled(const ResourceSample& baseline, const ResourceSample& final, const ResourceCount& count)
+	{
+		return baseline.*count.Field >= 0 && final.*count.Field >= 0;
+	}
+}
+
+bool SoakBenchmark::Run(std::ostream& out, const std::string& name, const ToggleFunction& toggle,
+	const SampleFunction& sample, const SoakOptions& options)
+{
+	for (int i = 0; i < options.Warmup; ++i)
+	{
+		toggle();
+	}
+
+	const ResourceSample baseline = sample();
+	int failures = 0;
+
+	for (int i = 1; i <= options.Toggles; ++i)
+	{
+		if (!toggle())
+		{
+			++failures;
+		}
+
+		if ((options.ReportEvery > 0 && i % options.ReportEvery == 0) || i == options.Toggles)
+		{
+			out << "{\"soak\":";
+			WriteJsonString(out, name);
+			out << ",\"toggles\":" << i;
+			WriteSample(out, sample());
+			out << "}\n";
+		}
+	}
+
+	const ResourceSample final = sample();
+	const double per1k = options.Toggles > 0 ? 1000.0 / options.Toggles : 0.0;
+	bool leak = false;
+
+	out << "{\"soak\":";
+	WriteJsonString(out, name);
+	out << ",\"summary\":true"
+		<< ",\"toggles\":" << options.Toggles
+		<< ",\"failures\":" << failures
+		<< ",\"growthPer1k\":{";
+
+	bool first = true;
+	for (const ResourceCount& count : ResourceCounts)
+	{
+		if (!IsSampled(baseline, final, count))
+		{
+			continue;
+		}
+
+		const std::int64_t growth = final.*count.Field - baseline.*count.Field;
+		const double growthPer1k = static_cast<double>(growth) * per1k;
+
+		// Object and handle counts return exactly to the baseline; the heap is allowed some slack.
+		if (count.Field == &ResourceSample::PrivateBytes
+			? growthPer1k > static_cast<double>(options.PrivateBytesTolerancePer1k)
+			: growth > 0)
+		{
+			leak = true;
+		}
+
+		out << (first ? "" : ",") << '"' << count.Name << "\":" << std::fixed << std::setprecision(2) << growthPer1k;
+		first = false;
+	}
+
+	out << "},\"leak\":" << (leak ? "true" : "false") << "}\n";
+	out.flush();
+	return !leak;
+}
+
+bool SoakBenchmark::RunSimulated(std::ostream& out, const SoakOptions& options, const SampleFunction& processSample)
+{
+	DesktopScenario scenario;
+	scenario.ZoomCandidates = SimulatedZoomCandidates;
+
+	DesktopModel model = DesktopModel::Generate(scenario);
+	const MediaWindowSelectors selectors = MediaWindowSelectors::Zoom();
+	std::int64_t live = 0;
+
+	// The desktop element, cached across toggles as ZoomService caches it.
+	UniqueRef<CountedElement> desktop(new CountedElement(live, 0));
+
+	const auto toggle = [&]
+	{
+		// Each discovery run holds its own reference to the desktop element and
+		// keeps the selected window's element after the backend is gone.
+		UniqueRef<CountedElement> selected;
+		{
+			const UniqueRef<CountedElement> root = UniqueRef<CountedElement>::Share(desktop.Get());
+			CountedDiscoveryBackend backend(model, live, root.Get());
+			const DiscoveryOutcome outcome = MediaWindowDiscovery::Locate(backend, selectors);
+			selected = backend.DetachCandidate(outcome.SelectedIndex);
+		}
+
+		return static_cast<bool>(selected);
+	};
+
+	const auto sample = [&]
+	{
+		ResourceSample result = processSample ? processSample() : ResourceSample();
+		result.LiveObjects = live;
+		return result;
+	};
+
+	bool ok = Run(out, "simulated", toggle, sample, options);
+
+	desktop.Reset();
+	if (live != 0)
+	{
+		out << "{\"soak\":\"simulated\",\"liveObjectsAfterTeardown\":" << live << "}\n";
+		ok = false;
+	}
+
+	return ok;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+// Resource counts sampled during a soak run (-1 where a count is not available).
+struct ResourceSample
+{
+	std::int64_t LiveObjects = -1;  // reference-counted automation objects (simulated runs)
+	std::int64_t Handles = -1;      // kernel handles
+	std::int64_t GdiObjects = -1;
+	std::int64_t UserObjects = -1;
+	std::int64_t PrivateBytes = -1;
+};
+
+struct SoakOptions
+{
+	int Toggles = 100000;
+	int Warmup = 1000;       // toggles before the baseline sample (lazy initialization, caches)
+	int ReportEvery = 1000;
+	std::int64_t PrivateBytesTolerancePer1k = 16 * 1024; // heap growth allowed for allocator noise
+};
+
+/// <summary>
+/// Toggles repeatedly and accounts for automation objects, handles, GDI/USER
+/// objects and private memory, reporting counts every ReportEvery toggles and the
+/// growth per 1000 toggles as JSON lines. Any growth in a count after warmup is a leak.
+/// Portable (no Windows dependencies).
+/// </summary>
+class SoakBenchmark
+{
+public:
+	using ToggleFunction = std::function<bool()>;
+	using SampleFunction = std::function<ResourceSample()>;
+
+	// Returns false if a leak was detected.
+	static bool Run(std::ostream& out, const std::string& name, const ToggleFunction& toggle,
+		const SampleFunction& sample, const SoakOptions& options);
+
+	// Soaks the real discovery logic against a CountedDiscoveryBackend, whose objects
+	// are released as UiaDiscoveryBackend and ZoomService release theirs. processSample
+	// (optional) adds the process-wide counts. Returns false if a leak was detected or
+	// any object was not released at the end.
+	static bool RunSimulated(std::ostream& out, const SoakOptions& options, const SampleFunction& processSample = {});
+};
@@ -0,0 +1,191 @@
+#include <istream>
+#include <ostream>
+#include <utility>
+#include "StartupProfiler.h"
+
+namespace
+{
+	const std::string TotalPhaseName = "total";
+
+	/// <summary>
+	/// Writes a phase name as a JSON string (names are ASCII identifiers, so only
+	/// quotes and backslashes need escaping).
+	/// </summary>
+	void WriteJsonString(std::ostream& out, const std::string& value)
+	{
+		out << '"';
+		for (const char ch : value)
+		{
+			if (ch == '"' || ch == '\\')
+			{
+				out << '\\';
+			}
+			out << ch;
+		}
+		out << '"';
+	}
+
+	const StartupPhase* FindPhase(const std::vector<StartupPhase>& phases, const std::string& name)
+	{
+		for (const auto& p : phases)
+		{
+			if (p.Name == name)
+			{
+				return &p;
+			}
+		}
+		return nullptr;
+	}
+
+	void WritePhaseLine(std::ostream& out, const StartupPhase& phase, const std::vector<StartupPhase>* baseline)
+	{
+		out << "{\"phase\":";
+		WriteJsonString(out, phase.Name);
+		out << ",\"start_us\":" << phase.StartUs << ",\"duration_us\":" << phase.DurationUs;
+
+		if (baseline != nullptr)
+		{
+			if (const StartupPhase* b = FindPhase(*baseline, phase.Name))
+			{
+				out << ",\"baseline_us\":" << b->DurationUs << ",\"delta_us\":" << (phase.DurationUs - b->DurationUs);
+			}
+		}
+
+		out << "}\n";
+	}
+
+	/// <summary>
+	/// Extracts the string value of "key" from a single JSON line produced by WriteReport.
+	/// </summary>
+	bool ReadStringField(const std::string& line, const std::string& key, std::string& value)
+	{
+		const std::string marker = "\"" + key + "\":\"";
+		const auto pos = line.find(marker);
+		if (pos == std::string::npos)
+		{
+			return false;
+		}
+
+		value.clear();
+		for (size_t i = pos + marker.size(); i < line.size(); ++i)
+		{
+			if (line[i] == '\\' && i + 1 < line.size())
+			{
+				value += line[++i];
+			}
+			else if (line[i] == '"')
+			{
+				return true;
+			}
+			else
+			{
+				value += line[i];
+			}
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Extracts the integer value of "key" from a single JSON line produced by WriteReport.
+	/// </summary>
+	bool ReadIntField(const std::string& line, const std::string& key, std::int64_t& value)
+	{
+		const std::string marker = "\"" + key + "\":";
+		const auto pos = line.find(marker);
+		if (pos == std::string::npos)
+		{
+			return false;
+		}
+
+		size_t i = pos + marker.size();
+		bool negative = false;
+		if (i < line.size() && line[i] == '-')
+		{
+			negative = true;
+			++i;
+		}
+
+		if (i >= line.size() || line[i] < '0' || line[i] > '9')
+		{
+			return false;
+		}
+
+		std::int64_t result = 0;
+		while (i < line.size() && line[i] >= '0' && line[i] <= '9')
+		{
+			result = (result * 10) + (line[i] - '0');
+			++i;
+		}
+
+		value = negative ? -result : result;
+		return true;
+	}
+}
+
+StartupProfiler::StartupProfiler()
+	: totalUs_(0)
+	, finished_(false)
+{
+	phases_.reserve(16);
+}
+
+/// <summary>
+/// Records a completed phase. Phases recorded after Finish() are ignored.
+/// </summary>
+void StartupProfiler::AddPhase(const char* name, const std::int64_t startUs, const std::int64_t durationUs)
+{
+	if (!finished_)
+	{
+		phases_.push_back(StartupPhase{ name, startUs, durationUs });
+	}
+}
+
+/// <summary>
+/// Marks the end of startup (message loop idle) and fixes the total duration.
+/// </summary>
+void StartupProfiler::Finish()
+{
+	if (!finished_)
+	{
+		totalUs_ = NowUs();
+		finished_ = true;
+	}
+}
+
+/// <summary>
+/// Writes one JSON object per phase, followed by a "total" line. If a baseline is
+/// supplied, each line with a matching baseline phase also carries baseline_us and delta_us.
+/// </summary>
+/// <param name="out">Destination stream.</param>
+/// <param name="baseline">Optional baseline phases (e.g. from ReadReport), or nullptr.</param>
+void StartupProfiler::WriteReport(std::ostream& out, const std::vector<StartupPhase>* baseline) const
+{
+	for (const auto& p : phases_)
+	{
+		WritePhaseLine(out, p, baseline);
+	}
+
+	WritePhaseLine(out, StartupPhase{ TotalPhaseName, 0, totalUs_ }, baseline);
+}
+
+/// <summary>
+/// Reads a report previously written by WriteReport. Lines that are not phase
+/// records are skipped.
+/// </summary>
+std::vector<StartupPhase> StartupProfiler::ReadReport(std::istream& in)
+{
+	std::vector<StartupPhase> result;
+
+	std::string line;
+	while (std::getline(in, line))
+	{
+		StartupPhase phase{ {}, 0, 0 };
+		if (ReadStringField(line, "phase", phase.Name) && ReadIntField(line, "duration_us", phase.DurationUs))
+		{
+			ReadIntField(line, "start_us", phase.StartUs);
+			result.push_back(std::move(phase));
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "Stopwatch.h"
+
+struct StartupPhase
+{
+	std::string Name;
+	std::int64_t StartUs;
+	std::int64_t DurationUs;
+};
+
+/// <summary>
+/// Records named startup phases relative to process entry and writes them as
+/// JSON lines. Portable (no Windows dependencies).
+/// </summary>
+class StartupProfiler  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	Stopwatch clock_;
+	std::vector<StartupPhase> phases_;
+	std::int64_t totalUs_;
+	bool finished_;
+
+public:
+	/// <summary>
+	/// RAII helper that records a phase from construction to destruction.
+	/// </summary>
+	class Scope  // NOLINT(cppcoreguidelines-special-member-functions)
+	{
+	private:
+		StartupProfiler& profiler_;
+		const char* name_;
+		std::int64_t startUs_;
+
+	public:
+		Scope(StartupProfiler& profiler, const char* name)
+			: profiler_(profiler)
+			, name_(name)
+			, startUs_(profiler.NowUs())
+		{
+		}
+
+		~Scope()
+		{
+			profiler_.AddPhase(name_, startUs_, profiler_.NowUs() - startUs_);
+		}
+	};
+
+	StartupProfiler();
+
+	std::int64_t NowUs() const { return clock_.ElapsedMicroseconds(); }
+	void AddPhase(const char* name, std::int64_t startUs, std::int64_t durationUs);
+	void Finish();
+
+	bool IsFinished() const { return finished_; }
+	std::int64_t TotalUs() const { return totalUs_; }
+	const std::vector<StartupPhase>& Phases() const { return phases_; }
+
+	void WriteReport(std::ostream& out, const std::vector<StartupPhase>* baseline) const;
+	static std::vector<StartupPhase> ReadReport(std::istream& in);
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/// <summary>
+/// Minimal monotonic stopwatch (no platform dependencies). steady_clock maps
+/// to QueryPerformanceCounter on Windows.
+/// </summary>
+class Stopwatch
+{
+private:
+	std::chrono::steady_clock::time_point start_;
+
+public:
+	Stopwatch()
+		: start_(std::chrono::steady_clock::now())
+	{
+	}
+
+	void Restart()
+	{
+		start_ = std::chrono::steady_clock::now();
+	}
+
+	std::int64_t ElapsedMicroseconds() const
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - start_).count();
+	}
+
+	std::int64_t ElapsedMilliseconds() const
+	{
+		return ElapsedMicroseconds() / 1000;
+	}
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include "WindowGeometry.h"
+
+/// <summary>
+/// Shows a live thumbnail of another window in a host window of our own. The
+/// compositor (DWM on Windows) draws it; nothing is copied in our process.
+/// Portable interface (no Windows dependencies), so MirrorSession can be
+/// exercised with a fake compositor.
+/// </summary>
+class ThumbnailCompositor
+{
+public:
+	virtual ~ThumbnailCompositor() = default;
+
+	// Creates the (hidden) borderless topmost host window covering the monitor rect.
+	virtual bool CreateHost(const ScreenRect& monitorRect) = 0;
+	virtual void DestroyHost() = 0;
+	virtual void ShowHost() = 0;
+
+	// Registers a thumbnail of the source window into the host.
+	virtual bool Register(std::uint64_t sourceWindow) = 0;
+	virtual void Unregister() = 0;
+
+	// Size of the whole source window; fails if the source has gone.
+	virtual bool QuerySourceSize(int& width, int& height) = 0;
+
+	// source is part of the source window (window coordinates); destination is in
+	// host client coordinates.
+	virtual bool Update(const ScreenRect& source, const ScreenRect& destination) = 0;
+};
@@ -0,0 +1,276 @@
+#include <iomanip>
+#include <sstream>
+#include "ToggleStats.h"
+#include "BinaryIo.h"
+
+namespace
+{
+	constexpr std::uint32_t StatsFileMagic = 0x54535350; // "PSST"
+	constexpr std::uint32_t StatsFileVersion = 1;
+
+	const wchar_t* const StageNames[ToggleStats::StageCount] =
+	{
+		L"Total",
+		L"ProcessSnapshot",
+		L"Discovery",
+		L"Identify",
+		L"Move",
+		L"ClickToVisible",
+	};
+
+	const wchar_t* const ErrorNames[ToggleStats::ErrorCount] =
+	{
+		L"None",
+		L"AutomationUnavailable",
+		L"DesktopUnavailable",
+		L"ZoomNotRunning",
+		L"MediaWindowNotFound",
+		L"TargetMonitorNotFound",
+		L"NoNativeWindowHandle",
+		L"InvalidWindowHandle",
+		L"NoWindowPosition",
+		L"MirrorUnavailable",
+		L"DeadlineExceeded",
+	};
+
+	const wchar_t* const FallbackNames[ToggleFallbackCount] =
+	{
+		L"SingleCandidate",
+		L"MultipleCandidates",
+		L"RestoredFromMinimized",
+		L"HiddenInsteadOfCloaked",
+		L"NoFade",
+		L"FabricatedRestoreRect",
+		L"MinimizedSendBack",
+		L"DpiPrecompensated",
+		L"CorrectiveResize",
+		L"WarmStart",
+	};
+
+	/// <summary>
+	/// Reads a length-prefixed counter array, accepting files written with fewer or
+	/// more entries than this build knows about.
+	/// </summary>
+	template <size_t N>
+	bool ReadCounters(std::istream& in, std::array<std::uint64_t, N>& counters)
+	{
+		std::uint32_t stored = 0;
+		if (!BinaryIo::ReadU32(in, stored))
+		{
+			return false;
+		}
+
+		for (std::uint32_t i = 0; i < stored; ++i)
+		{
+			std::uint64_t value = 0;
+			if (!BinaryIo::ReadU64(in, value))
+			{
+				return false;
+			}
+
+			if (i < N)
+			{
+				counters[i] = value;
+			}
+		}
+
+		return true;
+	}
+
+	template <size_t N>
+	void WriteCounters(std::ostream& out, const std::array<std::uint64_t, N>& counters)
+	{
+		BinaryIo::WriteU32(out, static_cast<std::uint32_t>(N));
+		for (const auto c : counters)
+		{
+			BinaryIo::WriteU64(out, c);
+		}
+	}
+
+	double ToMs(const std::uint64_t us)
+	{
+		return static_cast<double>(us) / 1000.0;
+	}
+}
+
+ToggleStats::ToggleStats()
+{
+	Reset();
+}
+
+void ToggleStats::Reset()
+{
+	toggles_ = 0;
+	for (auto& h : stages_)
+	{
+		h.Reset();
+	}
+	failures_.fill(0);
+	fallbacks_.fill(0);
+}
+
+/// <summary>
+/// Records the outcome of one toggle. Stages that did not run (0 us) are not
+/// recorded so they don't skew the percentiles.
+/// </summary>
+void ToggleStats::Record(const DisplayWindowResult& result)
+{
+	++toggles_;
+
+	const ToggleStageTimings& t = result.Timings;
+	stages_[static_cast<size_t>(ToggleStage::Total)].Record(t.TotalUs);
+
+	if (t.ProcessSnapshotUs > 0) stages_[static_cast<size_t>(ToggleStage::ProcessSnapshot)].Record(t.ProcessSnapshotUs);
+	if (t.DiscoveryUs > 0) stages_[static_cast<size_t>(ToggleStage::Discovery)].Record(t.DiscoveryUs);
+	if (t.IdentifyUs > 0) stages_[static_cast<size_t>(ToggleStage::Identify)].Record(t.IdentifyUs);
+	if (t.MoveUs > 0) stages_[static_cast<size_t>(ToggleStage::Move)].Record(t.MoveUs);
+	if (t.ClickToVisibleUs > 0) stages_[static_cast<size_t>(ToggleStage::ClickToVisible)].Record(t.ClickToVisibleUs);
+
+	if (!result.AllOk)
+	{
+		const auto error = static_cast<size_t>(result.Error);
+		if (error < failures_.size())
+		{
+			++failures_[error];
+		}
+	}
+
+	for (int bit = 0; bit < ToggleFallbackCount; ++bit)
+	{
+		if ((result.Fallbacks & (1u << bit)) != 0)
+		{
+			++fallbacks_[static_cast<size_t>(bit)];
+		}
+	}
+}
+
+void ToggleStats::Merge(const ToggleStats& other)
+{
+	toggles_ += other.toggles_;
+
+	for (size_t i = 0; i < stages_.size(); ++i)
+	{
+		stages_[i].Merge(other.stages_[i]);
+	}
+
+	for (size_t i = 0; i < failures_.size(); ++i)
+	{
+		failures_[i] += other.failures_[i];
+	}
+
+	for (size_t i = 0; i < fallbacks_.size(); ++i)
+	{
+		fallbacks_[i] += other.fallbacks_[i];
+	}
+}
+
+void ToggleStats::Write(std::ostream& out) const
+{
+	BinaryIo::WriteU32(out, StatsFileMagic);
+	BinaryIo::WriteU32(out, StatsFileVersion);
+	BinaryIo::WriteU64(out, toggles_);
+
+	BinaryIo::WriteU32(out, static_cast<std::uint32_t>(stages_.size()));
+	for (const auto& h : stages_)
+	{
+		h.Write(out);
+	}
+
+	WriteCounters(out, failures_);
+	WriteCounters(out, fallbacks_);
+}
+
+/// <summary>
+/// Reads statistics written by Write, replacing the current contents. Returns
+/// false (leaving the object empty) if the data is missing or malformed.
+/// </summary>
+bool ToggleStats::Read(std::istream& in)
+{
+	Reset();
+
+	std::uint32_t magic = 0;
+	std::uint32_t version = 0;
+	std::uint32_t stageCount = 0;
+	if (!BinaryIo::ReadU32(in, magic) || magic != StatsFileMagic ||
+		!BinaryIo::ReadU32(in, version) || version != StatsFileVersion ||
+		!BinaryIo::ReadU64(in, toggles_) ||
+		!BinaryIo::ReadU32(in, stageCount))
+	{
+		Reset();
+		return false;
+	}
+
+	for (std::uint32_t i = 0; i < stageCount; ++i)
+	{
+		bool read = false;
+		if (i < stages_.size())
+		{
+			read = stages_[i].Read(in);
+		}
+		else
+		{
+			// A stage this build does not know about: read and drop it.
+			LatencyHistogram unknown;
+			read = unknown.Read(in);
+		}
+
+		if (!read)
+		{
+			Reset();
+			return false;
+		}
+	}
+
+	if (!ReadCounters(in, failures_) || !ReadCounters(in, fallbacks_))
+	{
+		Reset();
+		return false;
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Formats a human-readable summary (percentiles in milliseconds, failure and
+/// fallback counts).
+/// </summary>
+std::wstring ToggleStats::FormatReport() const
+{
+	std::wostringstream s;
+	s << std::fixed << std::setprecision(1);
+
+	s << L"Toggles recorded: " << toggles_ << L"\n\n";
+	s << L"Latency (ms): count / p50 / p95 / p99 / max\n";
+	for (size_t i = 0; i < stages_.size(); ++i)
+	{
+		const auto& h = stages_[i];
+		s << L"  " << StageNames[i] << L": " << h.TotalCount()
+			<< L" / " << ToMs(h.ValueAtPercentile(50.0))
+			<< L" / " << ToMs(h.ValueAtPercentile(95.0))
+			<< L" / " << ToMs(h.ValueAtPercentile(99.0))
+			<< L" / " << ToMs(h.Max()) << L"\n";
+	}
+
+	s << L"\nFailures:\n";
+	bool anyFailures = false;
+	for (size_t i = 0; i < failures_.size(); ++i)
+	{
+		if (failures_[i] != 0)
+		{
+			s << L"  " << ErrorNames[i] << L": " << failures_[i] << L"\n";
+			anyFailures = true;
+		}
+	}
+	if (!anyFailures)
+	{
+		s << L"  (none)\n";
+	}
+
+	s << L"\nFallback paths:\n";
+	for (size_t i = 0; i < fallbacks_.size(); ++i)
+	{
+		s << L"  " << FallbackNames[i] << L": " << fallbacks_[i] << L"\n";
+	}
+
+	return s.str();
+}
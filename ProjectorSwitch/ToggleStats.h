@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include "DisplayWindowResult.h"
+#include "LatencyHistogram.h"
+
+enum class ToggleStage : std::uint8_t
+{
+	Total,
+	ProcessSnapshot,
+	Discovery,
+	Identify,
+	Move,
+	ClickToVisible,
+	Count
+};
+
+/// <summary>
+/// Long-running toggle statistics: per-stage latency histograms, failure counts
+/// by DisplayWindowError and fallback path counts. Record() never allocates.
+/// Portable (no Windows dependencies).
+/// </summary>
+class ToggleStats
+{
+public:
+	static constexpr int StageCount = static_cast<int>(ToggleStage::Count);
+	static constexpr int ErrorCount = static_cast<int>(DisplayWindowError::Count);
+
+	ToggleStats();
+
+	void Record(const DisplayWindowResult& result);
+	void Merge(const ToggleStats& other);
+	void Reset();
+
+	std::uint64_t ToggleCount() const { return toggles_; }
+	const LatencyHistogram& Stage(ToggleStage stage) const { return stages_[static_cast<size_t>(stage)]; }
+	std::uint64_t FailureCount(DisplayWindowError error) const { return failures_[static_cast<size_t>(error)]; }
+	std::uint64_t FallbackCount(int fallbackBit) const { return fallbacks_[static_cast<size_t>(fallbackBit)]; }
+
+	void Write(std::ostream& out) const;
+	bool Read(std::istream& in);
+
+	std::wstring FormatReport() const;
+
+private:
+	std::uint64_t toggles_;
+	std::array<LatencyHistogram, StageCount> stages_;
+	std::array<std::uint64_t, ErrorCount> failures_;
+	std::array<std::uint64_t, ToggleFallbackCount> fallbacks_;
+};
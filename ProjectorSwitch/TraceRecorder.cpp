@@ -0,0 +1,138 @@
+#include <ostream>
+#include "TraceRecorder.h"
+
+namespace
+{
+	thread_local ThreadTraceBuffer* CurrentThreadBuffer = nullptr;
+
+	// Hands the thread's buffer back when the thread exits.
+	struct BufferRelease  // NOLINT(cppcoreguidelines-special-member-functions)
+	{
+		~BufferRelease()
+		{
+			if (CurrentThreadBuffer != nullptr)
+			{
+				CurrentThreadBuffer->Owned.store(false, std::memory_order_release);
+				CurrentThreadBuffer = nullptr;
+			}
+		}
+	};
+}
+
+/// <summary>
+/// Returns the process-wide recorder.
+/// </summary>
+TraceRecorder& TraceRecorder::Instance()
+{
+	static TraceRecorder instance;
+	return instance;
+}
+
+/// <summary>
+/// Takes a buffer for the calling thread: one handed back by an exited thread once
+/// RecycleAfter exist, otherwise a new one pushed onto the lock-free list. Buffers
+/// are never freed, so that export can run at any time.
+/// </summary>
+ThreadTraceBuffer* TraceRecorder::RegisterThread()
+{
+	if (bufferCount_.load(std::memory_order_relaxed) >= RecycleAfter)
+	{
+		if (ThreadTraceBuffer* buffer = Recycle())
+		{
+			return buffer;
+		}
+	}
+
+	auto* buffer = new ThreadTraceBuffer();
+	buffer->ThreadIndex = threadCount_.fetch_add(1, std::memory_order_relaxed) + 1;
+	bufferCount_.fetch_add(1, std::memory_order_relaxed);
+
+	ThreadTraceBuffer* expected = head_.load(std::memory_order_relaxed);
+	do
+	{
+		buffer->Next = expected;
+	} while (!head_.compare_exchange_weak(expected, buffer, std::memory_order_release, std::memory_order_relaxed));
+
+	return buffer;
+}
+
+/// <summary>
+/// Takes over a buffer whose thread has exited, clearing it for the calling thread.
+/// </summary>
+/// <returns>The buffer, or null if every buffer is in use.</returns>
+ThreadTraceBuffer* TraceRecorder::Recycle()
+{
+	const std::lock_guard<std::mutex> lock(recycleMutex_);
+	for (ThreadTraceBuffer* buffer = head_.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->Next)
+	{
+		bool owned = false;
+		if (buffer->Owned.compare_exchange_strong(owned, true, std::memory_order_acquire, std::memory_order_relaxed))
+		{
+			buffer->Count.store(0, std::memory_order_relaxed);
+			buffer->Dropped.store(0, std::memory_order_relaxed);
+			buffer->ThreadIndex = threadCount_.fetch_add(1, std::memory_order_relaxed) + 1;
+			return buffer;
+		}
+	}
+
+	return nullptr;
+}
+
+/// <summary>
+/// Appends a completed zone to the calling thread's buffer. Events beyond the
+/// buffer capacity are counted as dropped.
+/// </summary>
+void TraceRecorder::Record(const char* name, const std::int64_t startUs, const std::int64_t durationUs)
+{
+	if (CurrentThreadBuffer == nullptr)
+	{
+		thread_local const BufferRelease release;
+		CurrentThreadBuffer = RegisterThread();
+	}
+
+	ThreadTraceBuffer* buffer = CurrentThreadBuffer;
+	const std::uint32_t index = buffer->Count.load(std::memory_order_relaxed);
+	if (index >= ThreadTraceBuffer::Capacity)
+	{
+		buffer->Dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	buffer->Events[index] = TraceEvent{ name, startUs, durationUs };
+	buffer->Count.store(index + 1, std::memory_order_release);
+}
+
+/// <summary>
+/// Writes all recorded zones as Chrome trace event JSON ("X" complete events),
+/// loadable in chrome://tracing or ui.perfetto.dev.
+/// </summary>
+void TraceRecorder::ExportChromeTrace(std::ostream& out) const
+{
+	const std::lock_guard<std::mutex> lock(recycleMutex_);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	for (const ThreadTraceBuffer* buffer = head_.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->Next)
+	{
+		const std::uint32_t count = buffer->Count.load(std::memory_order_acquire);
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			const TraceEvent& e = buffer->Events[i];
+			out << (first ? "\n" : ",\n")
+				<< "{\"name\":\"" << e.Name << "\",\"cat\":\"toggle\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ThreadIndex
+				<< ",\"ts\":" << e.StartUs << ",\"dur\":" << e.DurationUs << "}";
+			first = false;
+		}
+
+		const std::uint32_t dropped = buffer->Dropped.load(std::memory_order_relaxed);
+		if (dropped > 0)
+		{
+			out << (first ? "\n" : ",\n")
+				<< "{\"name\":\"dropped_events\",\"ph\":\"C\",\"pid\":1,\"tid\":" << buffer->ThreadIndex
+				<< ",\"ts\":0,\"args\":{\"count\":" << dropped << "}}";
+			first = false;
+		}
+	}
+
+	out << "\n]}\n";
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include "Stopwatch.h"
+
+struct TraceEvent
+{
+	const char* Name; // must be a string literal
+	std::int64_t StartUs;
+	std::int64_t DurationUs;
+};
+
+/// <summary>
+/// Fixed-size event buffer owned by a single thread at a time. Only the owning
+/// thread writes; readers see events up to the published count.
+/// </summary>
+struct ThreadTraceBuffer
+{
+	static constexpr std::uint32_t Capacity = 8192;
+
+	TraceEvent Events[Capacity];
+	std::atomic<std::uint32_t> Count{ 0 };
+	std::atomic<std::uint32_t> Dropped{ 0 };
+	std::uint32_t ThreadIndex{ 0 };
+	std::atomic<bool> Owned{ true }; // false once its thread has exited
+	ThreadTraceBuffer* Next{ nullptr };
+};
+
+/// <summary>
+/// Process-wide recorder for scoped trace zones. Each thread records into its
+/// own buffer (no locks); buffers are linked into a lock-free list on first use
+/// and handed back when their thread exits. Once RecycleAfter buffers exist, a
+/// new thread takes over (and clears) one handed back, so short-lived threads
+/// cannot grow the recorder without bound. Export produces Chrome/Perfetto trace JSON.
+/// Portable (no Windows dependencies).
+/// </summary>
+class TraceRecorder
+{
+public:
+	// Buffers allocated before those of exited threads are reused (their events lost).
+	static constexpr std::uint32_t RecycleAfter = 8;
+
+private:
+	Stopwatch clock_;
+	std::atomic<ThreadTraceBuffer*> head_{ nullptr };
+	std::atomic<std::uint32_t> threadCount_{ 0 };
+	std::atomic<std::uint32_t> bufferCount_{ 0 };
+	mutable std::mutex recycleMutex_; // a buffer is not cleared while it is exported
+
+	TraceRecorder() = default;
+	ThreadTraceBuffer* RegisterThread();
+	ThreadTraceBuffer* Recycle();
+
+public:
+	static TraceRecorder& Instance();
+
+	// Buffers allocated so far (at most RecycleAfter, or the most threads recording at once).
+	std::uint32_t BufferCount() const { return bufferCount_.load(std::memory_order_relaxed); }
+
+	std::int64_t NowUs() const { return clock_.ElapsedMicroseconds(); }
+	void Record(const char* name, std::int64_t startUs, std::int64_t durationUs);
+	void ExportChromeTrace(std::ostream& out) const;
+};
+
+/// <summary>
+/// RAII zone; records its lifetime into the current thread's buffer.
+/// </summary>
+class TraceZone  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	const char* name_;
+	std::int64_t startUs_;
+
+public:
+	explicit TraceZone(const char* name)
+		: name_(name)
+		, startUs_(TraceRecorder::Instance().NowUs())
+	{
+	}
+
+	~TraceZone()
+	{
+		auto& recorder = TraceRecorder::Instance();
+		recorder.Record(name_, startUs_, recorder.NowUs() - startUs_);
+	}
+};
+
+// Trace zones compile to nothing unless PROJECTORSWITCH_TRACE is defined (Debug builds).
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if defined(PROJECTORSWITCH_TRACE)
+#define TRACE_ZONE(name) const TraceZone TRACE_CONCAT(traceZone_, __LINE__)(name)
+#else
+#define TRACE_ZONE(name) ((void)0)
+#endif
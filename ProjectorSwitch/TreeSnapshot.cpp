@@ -0,0 +1,246 @@
+#include <algorithm>
+#include "TreeSnapshot.h"
+#include "BinaryIo.h"
+
+namespace
+{
+	constexpr std::uint32_t MaxStringLength = 1u << 20; // sanity limit on corrupt files
+
+	/// <summary>
+	/// Converts a wide string to UTF-16 code units (wchar_t is 32-bit on Linux).
+	/// </summary>
+	std::vector<std::uint16_t> ToUtf16(const std::wstring& value)
+	{
+		std::vector<std::uint16_t> units;
+		units.reserve(value.size());
+		for (const wchar_t ch : value)
+		{
+			const auto cp = static_cast<std::uint32_t>(ch);
+			if (cp > 0xFFFF)
+			{
+				units.push_back(static_cast<std::uint16_t>(0xD800 + ((cp - 0x10000) >> 10)));
+				units.push_back(static_cast<std::uint16_t>(0xDC00 + ((cp - 0x10000) & 0x3FF)));
+			}
+			else
+			{
+				units.push_back(static_cast<std::uint16_t>(cp));
+			}
+		}
+		return units;
+	}
+
+	std::wstring FromUtf16(const std::vector<std::uint16_t>& units)
+	{
+		std::wstring value;
+		value.reserve(units.size());
+		for (size_t i = 0; i < units.size(); ++i)
+		{
+			const std::uint32_t unit = units[i];
+			if constexpr (sizeof(wchar_t) > 2)
+			{
+				if (unit >= 0xD800 && unit < 0xDC00 && i + 1 < units.size() && units[i + 1] >= 0xDC00 && units[i + 1] < 0xE000)
+				{
+					const std::uint32_t low = units[++i];
+					value.push_back(static_cast<wchar_t>(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00)));
+					continue;
+				}
+			}
+			value.push_back(static_cast<wchar_t>(unit));
+		}
+		return value;
+	}
+}
+
+TreeSnapshotWriter::TreeSnapshotWriter(std::ostream& out)
+	: out_(out)
+	, position_(0)
+	, elementCount_(0)
+	, finished_(false)
+{
+	BinaryIo::WriteU32(out_, TreeSnapshotReader::Magic);
+	BinaryIo::WriteU32(out_, TreeSnapshotReader::Version);
+	BinaryIo::WriteU32(out_, 0);
+	BinaryIo::WriteU32(out_, TreeSnapshotReader::RecordSize);
+	position_ = TreeSnapshotReader::HeaderSize;
+}
+
+std::uint32_t TreeSnapshotWriter::Intern(const std::wstring& value)
+{
+	const auto [it, inserted] = stringIds_.emplace(value, static_cast<std::uint32_t>(strings_.size()));
+	if (inserted)
+	{
+		strings_.push_back(&it->first);
+	}
+	return it->second;
+}
+
+int TreeSnapshotWriter::AddElement(const int parent, const std::wstring& name, const std::wstring& className,
+	const std::wstring& helpText, const std::uint32_t processId)
+{
+	BinaryIo::WriteU32(out_, parent < 0 ? TreeSnapshotElement::NoParent : static_cast<std::uint32_t>(parent));
+	BinaryIo::WriteU32(out_, Intern(name));
+	BinaryIo::WriteU32(out_, Intern(className));
+	BinaryIo::WriteU32(out_, Intern(helpText));
+	BinaryIo::WriteU32(out_, processId);
+	position_ += TreeSnapshotReader::RecordSize;
+	return static_cast<int>(elementCount_++);
+}
+
+void TreeSnapshotWriter::Finish(const int selectedElement)
+{
+	if (finished_)
+	{
+		return;
+	}
+	finished_ = true;
+
+	std::vector<std::uint64_t> offsets;
+	offsets.reserve(strings_.size());
+	for (const std::wstring* value : strings_)
+	{
+		offsets.push_back(position_);
+
+		const std::vector<std::uint16_t> units = ToUtf16(*value);
+		BinaryIo::WriteU32(out_, static_cast<std::uint32_t>(units.size()));
+		for (const std::uint16_t unit : units)
+		{
+			const char bytes[2] = { static_cast<char>(unit & 0xFF), static_cast<char>(unit >> 8) };
+			out_.write(bytes, sizeof(bytes));
+		}
+		position_ += 4 + (units.size() * 2);
+	}
+
+	const std::uint64_t indexOffset = position_;
+	for (const std::uint64_t offset : offsets)
+	{
+		BinaryIo::WriteU64(out_, offset);
+	}
+
+	BinaryIo::WriteU32(out_, elementCount_);
+	BinaryIo::WriteU32(out_, static_cast<std::uint32_t>(strings_.size()));
+	BinaryIo::WriteU64(out_, indexOffset);
+	BinaryIo::WriteU32(out_, static_cast<std::uint32_t>(selectedElement));
+	BinaryIo::WriteU32(out_, TreeSnapshotReader::TrailerMagic);
+	out_.flush();
+}
+
+TreeSnapshotReader::TreeSnapshotReader()
+	: in_(nullptr)
+	, elementCount_(0)
+	, stringCount_(0)
+	, stringIndexOffset_(0)
+	, selectedElement_(-1)
+{
+}
+
+/// <summary>
+/// Validates the header and trailer. Nothing else is read until needed.
+/// </summary>
+bool TreeSnapshotReader::Open(std::istream& in)
+{
+	in_ = nullptr;
+	stringCache_.clear();
+
+	std::uint32_t magic = 0;
+	std::uint32_t version = 0;
+	std::uint32_t reserved = 0;
+	std::uint32_t recordSize = 0;
+	in.seekg(0, std::ios::beg);
+	if (!BinaryIo::ReadU32(in, magic) || magic != Magic ||
+		!BinaryIo::ReadU32(in, version) || version != Version ||
+		!BinaryIo::ReadU32(in, reserved) ||
+		!BinaryIo::ReadU32(in, recordSize) || recordSize != RecordSize)
+	{
+		return false;
+	}
+
+	in.seekg(-static_cast<std::streamoff>(TrailerSize), std::ios::end);
+	std::uint32_t selected = 0;
+	std::uint32_t trailerMagic = 0;
+	if (!BinaryIo::ReadU32(in, elementCount_) ||
+		!BinaryIo::ReadU32(in, stringCount_) ||
+		!BinaryIo::ReadU64(in, stringIndexOffset_) ||
+		!BinaryIo::ReadU32(in, selected) ||
+		!BinaryIo::ReadU32(in, trailerMagic) || trailerMagic != TrailerMagic)
+	{
+		return false;
+	}
+
+	selectedElement_ = selected < elementCount_ ? static_cast<int>(selected) : -1;
+	in_ = &in;
+	return true;
+}
+
+bool TreeSnapshotReader::ReadElements(const std::uint32_t first, const std::uint32_t count, std::vector<TreeSnapshotElement>& elements)
+{
+	elements.clear();
+	if (in_ == nullptr || first >= elementCount_)
+	{
+		return in_ != nullptr;
+	}
+
+	const std::uint32_t available = std::min(count, elementCount_ - first);
+	in_->clear();
+	in_->seekg(static_cast<std::streamoff>(HeaderSize + (static_cast<std::uint64_t>(first) * RecordSize)), std::ios::beg);
+
+	elements.resize(available);
+	for (auto& e : elements)
+	{
+		if (!BinaryIo::ReadU32(*in_, e.Parent) ||
+			!BinaryIo::ReadU32(*in_, e.NameId) ||
+			!BinaryIo::ReadU32(*in_, e.ClassNameId) ||
+			!BinaryIo::ReadU32(*in_, e.HelpTextId) ||
+			!BinaryIo::ReadU32(*in_, e.ProcessId))
+		{
+			elements.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const std::wstring& TreeSnapshotReader::String(const std::uint32_t id)
+{
+	const auto cached = stringCache_.find(id);
+	if (cached != stringCache_.end())
+	{
+		return cached->second;
+	}
+
+	std::wstring& value = stringCache_[id];
+	if (in_ == nullptr || id >= stringCount_)
+	{
+		return value;
+	}
+
+	in_->clear();
+	in_->seekg(static_cast<std::streamoff>(stringIndexOffset_ + (static_cast<std::uint64_t>(id) * 8)), std::ios::beg);
+	std::uint64_t offset = 0;
+	if (!BinaryIo::ReadU64(*in_, offset))
+	{
+		return value;
+	}
+
+	in_->seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+	std::uint32_t length = 0;
+	if (!BinaryIo::ReadU32(*in_, length) || length > MaxStringLength)
+	{
+		return value;
+	}
+
+	std::vector<unsigned char> bytes(static_cast<size_t>(length) * 2);
+	if (length > 0 && !in_->read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+	{
+		return value;
+	}
+
+	std::vector<std::uint16_t> units(length);
+	for (size_t i = 0; i < units.size(); ++i)
+	{
+		units[i] = static_cast<std::uint16_t>(bytes[i * 2] | (bytes[(i * 2) + 1] << 8));
+	}
+
+	value = FromUtf16(units);
+	return value;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One captured element. Strings are indices into the snapshot's string table.
+struct TreeSnapshotElement
+{
+	static constexpr std::uint32_t NoParent = 0xFFFFFFFF;
+
+	std::uint32_t Parent = NoParent;
+	std::uint32_t NameId = 0;
+	std::uint32_t ClassNameId = 0;
+	std::uint32_t HelpTextId = 0;
+	std::uint32_t ProcessId = 0;
+};
+
+/// <summary>
+/// Streams a captured element tree to a snapshot file (see TreeSnapshotReader for
+/// the layout). Elements must be added in pre-order, element 0 being the root;
+/// records are written as they are added and strings are interned. Portable (no
+/// Windows dependencies).
+/// </summary>
+class TreeSnapshotWriter
+{
+private:
+	std::ostream& out_;
+	std::uint64_t position_;
+	std::uint32_t elementCount_;
+	std::unordered_map<std::wstring, std::uint32_t> stringIds_;
+	std::vector<const std::wstring*> strings_; // in id order; points into stringIds_ keys
+	bool finished_;
+
+	std::uint32_t Intern(const std::wstring& value);
+
+public:
+	explicit TreeSnapshotWriter(std::ostream& out);
+
+	// Returns the new element's index. parent is -1 for the root only.
+	int AddElement(int parent, const std::wstring& name, const std::wstring& className,
+		const std::wstring& helpText, std::uint32_t processId);
+
+	// Writes the string table and trailer. selectedElement is the index of the
+	// window chosen as the media window when the snapshot was taken (or -1).
+	void Finish(int selectedElement);
+
+	std::uint32_t ElementCount() const { return elementCount_; }
+};
+
+/// <summary>
+/// Lazily reads a snapshot file. Only the header and trailer are read on Open;
+/// element records (fixed size, pre-order) and strings are read on demand and
+/// strings are cached once resolved.
+///
+/// Layout (little-endian):
+///   header:   magic "PSTT", version, reserved, record size
+///   records:  parent, name id, class name id, help text id, process id (u32 each)
+///   strings:  per string, u32 length then UTF-16 code units
+///   index:    u64 file offset of each string
+///   trailer:  element count, string count, u64 index offset, selected element, magic "PSTE"
+///
+/// In pre-order, the descendants of element i are exactly the elements after i
+/// up to the first one whose parent index is less than i.
+/// Portable (no Windows dependencies).
+/// </summary>
+class TreeSnapshotReader
+{
+private:
+	std::istream* in_;
+	std::uint32_t elementCount_;
+	std::uint32_t stringCount_;
+	std::uint64_t stringIndexOffset_;
+	int selectedElement_;
+	std::unordered_map<std::uint32_t, std::wstring> stringCache_;
+
+public:
+	static constexpr std::uint32_t Magic = 0x54545350;        // "PSTT"
+	static constexpr std::uint32_t TrailerMagic = 0x45545350; // "PSTE"
+	static constexpr std::uint32_t Version = 2;
+	static constexpr std::uint32_t HeaderSize = 16;
+	static constexpr std::uint32_t RecordSize = 20;
+	static constexpr std::uint32_t TrailerSize = 24;
+
+	TreeSnapshotReader();
+
+	// The stream must stay alive (and seekable) for the lifetime of the reader.
+	bool Open(std::istream& in);
+
+	std::uint32_t ElementCount() const { return elementCount_; }
+	std::uint32_t StringCount() const { return stringCount_; }
+	int SelectedElement() const { return selectedElement_; } // -1 if none was selected
+
+	// Reads up to count records starting at first; returns false on a read error.
+	bool ReadElements(std::uint32_t first, std::uint32_t count, std::vector<TreeSnapshotElement>& elements);
+
+	// Returns the string with the given id (empty if it cannot be read).
+	const std::wstring& String(std::uint32_t id);
+};
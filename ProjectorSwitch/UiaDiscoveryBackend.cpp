@@ -0,0 +1,140 @@
+#include <utility>
+#include "UiaDiscoveryBackend.h"
+#include "VariantWrapper.h"
+#include "FlightRecorder.h"
+#include "CallCounters.h"
+#include "Stopwatch.h"
+
+/// <summary>
+/// Constructs a backend that searches beneath the given root (normally the desktop).
+/// The automation interface and root are borrowed, not owned.
+/// </summary>
+UiaDiscoveryBackend::UiaDiscoveryBackend(IUIAutomation* automation, IUIAutomationElement* root)
+	: automation_(automation)
+	, root_(root)
+{
+}
+
+/// <summary>
+/// Finds the desktop's child windows matching both the selector name and class name.
+/// </summary>
+int UiaDiscoveryBackend::FindCandidates(const MediaWindowSelectors& selectors)
+{
+	candidates_.Reset();
+
+	// The marker condition belongs to the selectors searched for (several providers may share a backend).
+	markerCondition_.Reset();
+
+	if (automation_ == nullptr || root_ == nullptr)
+	{
+		return -1;
+	}
+
+	VariantWrapper varName;
+	varName.SetString(selectors.WindowName);
+
+	AutomationConditionWrapper nameCondition;
+	automation_->CreatePropertyCondition(UIA_NamePropertyId, *varName, nameCondition.Out());
+
+	VariantWrapper varClassName;
+	varClassName.SetString(selectors.WindowClassName);
+
+	AutomationConditionWrapper classNameCondition;
+	automation_->CreatePropertyCondition(UIA_ClassNamePropertyId, *varClassName, classNameCondition.Out());
+
+	AutomationConditionWrapper andCondition;
+	automation_->CreateAndCondition(nameCondition.Get(), classNameCondition.Get(), andCondition.Out());
+
+	const Stopwatch findAllClock;
+	CallCountScope::Count(CallCategory::UiaFind);
+	const HRESULT hrFindAll = root_->FindAll(TreeScope_Children, andCondition.Get(), candidates_.Out());
+
+	if (FAILED(hrFindAll) || !candidates_)
+	{
+		FlightRecorder::Instance().Record(FlightEventKind::FindAll, hrFindAll, -1, findAllClock.ElapsedMicroseconds());
+		candidates_.Reset();
+		return -1;
+	}
+
+	int elementCount = 0;
+	candidates_->get_Length(&elementCount);
+	FlightRecorder::Instance().Record(FlightEventKind::FindAll, hrFindAll, elementCount, findAllClock.ElapsedMicroseconds());
+	return elementCount;
+}
+
+AutomationConditionWrapper UiaDiscoveryBackend::CreateHelpTextCondition(const std::wstring& helpText) const
+{
+	VariantWrapper varHelpText;
+	varHelpText.SetString(helpText);
+
+	AutomationConditionWrapper condition;
+	automation_->CreatePropertyCondition(UIA_HelpTextPropertyId, *varHelpText, condition.Out());
+	return condition;
+}
+
+/// <summary>
+/// Builds (once) an OR condition over the selector's main-window HelpText markers.
+/// </summary>
+IUIAutomationCondition* UiaDiscoveryBackend::GetMarkerCondition(const MediaWindowSelectors& selectors)
+{
+	if (markerCondition_ || selectors.MainWindowHelpTexts.empty())
+	{
+		return markerCondition_.Get();
+	}
+
+	AutomationConditionWrapper combined = CreateHelpTextCondition(selectors.MainWindowHelpTexts[0]);
+	for (size_t i = 1; i < selectors.MainWindowHelpTexts.size() && combined; ++i)
+	{
+		const AutomationConditionWrapper right = CreateHelpTextCondition(selectors.MainWindowHelpTexts[i]);
+
+		AutomationConditionWrapper orCondition;
+		automation_->CreateOrCondition(combined.Get(), right.Get(), orCondition.Out());
+		combined = std::move(orCondition);
+	}
+
+	markerCondition_ = std::move(combined);
+	return markerCondition_.Get();
+}
+
+/// <summary>
+/// Checks whether the candidate window contains a control that identifies the conference window.
+/// </summary>
+int UiaDiscoveryBackend::CandidateHasMainWindowMarker(const int candidateIndex, const MediaWindowSelectors& selectors)
+{
+	IUIAutomationCondition* markerCondition = GetMarkerCondition(selectors);
+	if (!candidates_ || markerCondition == nullptr)
+	{
+		return -1;
+	}
+
+	AutomationElementWrapper currentElement;
+	if (FAILED(candidates_->GetElement(candidateIndex, currentElement.Out())) || !currentElement)
+	{
+		return CandidateUnavailable;
+	}
+
+	const Stopwatch probeClock;
+	AutomationElementWrapper infoButton;
+	CallCountScope::Count(CallCategory::UiaFind);
+	const HRESULT hrFindButton = currentElement->FindFirst(TreeScope_Descendants, markerCondition, infoButton.Out());
+	FlightRecorder::Instance().Record(FlightEventKind::CandidateProbe, hrFindButton,
+		candidateIndex, infoButton ? 1 : 0, probeClock.ElapsedMicroseconds());
+
+	if (FAILED(hrFindButton))
+	{
+		return -1;
+	}
+
+	return infoButton ? 1 : 0;
+}
+
+AutomationElementWrapper UiaDiscoveryBackend::DetachCandidate(const int candidateIndex) const
+{
+	AutomationElementWrapper element;
+	if (!candidates_ || FAILED(candidates_->GetElement(candidateIndex, element.Out())))
+	{
+		return AutomationElementWrapper();
+	}
+
+	return element;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <uiautomation.h>
+#include "DiscoveryBackend.h"
+#include "AutomationElementWrapper.h"
+#include "AutomationConditionWrapper.h"
+
+/// <summary>
+/// DiscoveryBackend over UI Automation. Conditions are built once per search
+/// (FindCandidates) and reused for every candidate.
+/// </summary>
+class UiaDiscoveryBackend : public DiscoveryBackend
+{
+private:
+	IUIAutomation* automation_;
+	IUIAutomationElement* root_;
+	AutomationElementArrayWrapper candidates_;
+	AutomationConditionWrapper markerCondition_;
+
+	AutomationConditionWrapper CreateHelpTextCondition(const std::wstring& helpText) const;
+	IUIAutomationCondition* GetMarkerCondition(const MediaWindowSelectors& selectors);
+
+public:
+	UiaDiscoveryBackend(IUIAutomation* automation, IUIAutomationElement* root);
+
+	int FindCandidates(const MediaWindowSelectors& selectors) override;
+	int CandidateHasMainWindowMarker(int candidateIndex, const MediaWindowSelectors& selectors) override;
+
+	// Returns a new reference to the candidate element (empty if unavailable).
+	AutomationElementWrapper DetachCandidate(int candidateIndex) const;
+};
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "UiaTreeCapture.h"
+#include "UiaDiscoveryBackend.h"
+#include "MediaWindowDiscovery.h"
+#include "TreeSnapshot.h"
+#include "Logger.h"
+
+namespace
+{
+	struct ElementProperties
+	{
+		std::wstring Name;
+		std::wstring ClassName;
+		std::wstring HelpText;
+		std::uint32_t ProcessId = 0;
+	};
+
+	std::wstring TakeBstr(BSTR value)
+	{
+		std::wstring result;
+		if (value != nullptr)
+		{
+			result.assign(value, SysStringLen(value));
+			SysFreeString(value);
+		}
+		return result;
+	}
+
+	ElementProperties ReadProperties(IUIAutomationElement* element)
+	{
+		ElementProperties properties;
+
+		BSTR value = nullptr;
+		if (SUCCEEDED(element->get_CurrentName(&value)))
+		{
+			properties.Name = TakeBstr(value);
+		}
+
+		value = nullptr;
+		if (SUCCEEDED(element->get_CurrentClassName(&value)))
+		{
+			properties.ClassName = TakeBstr(value);
+		}
+
+		value = nullptr;
+		if (SUCCEEDED(element->get_CurrentHelpText(&value)))
+		{
+			properties.HelpText = TakeBstr(value);
+		}
+
+		int processId = 0;
+		if (SUCCEEDED(element->get_CurrentProcessId(&processId)))
+		{
+			properties.ProcessId = static_cast<std::uint32_t>(processId);
+		}
+
+		return properties;
+	}
+
+	int WriteElement(TreeSnapshotWriter& writer, const int parent, const ElementProperties& p)
+	{
+		return writer.AddElement(parent, p.Name, p.ClassName, p.HelpText, p.ProcessId);
+	}
+
+	int WriteElement(TreeSnapshotWriter& writer, const int parent, IUIAutomationElement* element)
+	{
+		return WriteElement(writer, parent, ReadProperties(element));
+	}
+
+	/// <summary>
+	/// Writes the children of element (recursively, in pre-order) using the raw view walker.
+	/// </summary>
+	void WriteDescendants(TreeSnapshotWriter& writer, IUIAutomationTreeWalker* walker,
+		IUIAutomationElement* element, const int index, const int depth, const int maxDepth)
+	{
+		if (depth >= maxDepth)
+		{
+			return;
+		}
+
+		AutomationElementWrapper child;
+		walker->GetFirstChildElement(element, child.Out());
+		while (child)
+		{
+			const int childIndex = WriteElement(writer, index, child.Get());
+			WriteDescendants(writer, walker, child.Get(), childIndex, depth + 1, maxDepth);
+
+			AutomationElementWrapper next;
+			walker->GetNextSiblingElement(child.Get(), next.Out());
+			child = std::move(next);
+		}
+	}
+}
+
+/// <summary>
+/// Captures the top-level windows of the given processes beneath root to the stream.
+/// </summary>
+/// <param name="automation">UI Automation interface.</param>
+/// <param name="root">Search root (normally the desktop element); written as element 0.</param>
+/// <param name="selectors">Used to record which window the current discovery logic selects.</param>
+/// <param name="processIds">The processes whose windows are captured (e.g. every Zoom.exe).</param>
+/// <param name="out">Snapshot destination (binary).</param>
+/// <returns>What was captured.</returns>
+TreeCaptureResult UiaTreeCapture::Capture(IUIAutomation* automation, IUIAutomationElement* root,
+	const MediaWindowSelectors& selectors, const std::vector<std::uint32_t>& processIds, std::ostream& out)
+{
+	TreeCaptureResult result;
+	if (automation == nullptr || root == nullptr)
+	{
+		return result;
+	}
+
+	// A failed search still leaves the windows to capture.
+	UiaDiscoveryBackend backend(automation, root);
+	const DiscoveryOutcome outcome = MediaWindowDiscovery::Locate(backend, selectors);
+	if (outcome.CandidateCount < 0)
+	{
+		LOG_WARN(L"Could not search the desktop for candidate windows");
+	}
+
+	result.Candidates = outcome.CandidateCount;
+	const AutomationElementWrapper selected = backend.DetachCandidate(outcome.SelectedIndex);
+
+	UniqueRef<IUIAutomationTreeWalker> walker;
+	if (FAILED(automation->get_RawViewWalker(walker.Out())) || !walker)
+	{
+		return result;
+	}
+
+	TreeSnapshotWriter writer(out);
+	WriteElement(writer, -1, root);
+
+	AutomationElementWrapper window;
+	walker->GetFirstChildElement(root, window.Out());
+	while (window)
+	{
+		const ElementProperties properties = ReadProperties(window.Get());
+		if (std::find(processIds.begin(), processIds.end(), properties.ProcessId) != processIds.end())
+		{
+			const int windowIndex = WriteElement(writer, 0, properties);
+			WriteDescendants(writer, walker.Get(), window.Get(), windowIndex, 1, MaxDepth);
+			++result.Windows;
+
+			BOOL same = FALSE;
+			if (selected && SUCCEEDED(automation->CompareElements(selected.Get(), window.Get(), &same)) && same)
+			{
+				result.SelectedElement = windowIndex;
+			}
+		}
+
+		AutomationElementWrapper next;
+		walker->GetNextSiblingElement(window.Get(), next.Out());
+		window = std::move(next);
+	}
+
+	writer.Finish(result.SelectedElement);
+	result.Elements = static_cast<int>(writer.ElementCount());
+	result.Ok = static_cast<bool>(out);
+	return result;
+}
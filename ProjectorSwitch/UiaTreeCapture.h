@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include <uiautomation.h>
+#include "MediaWindowSelectors.h"
+
+struct TreeCaptureResult
+{
+	bool Ok = false;
+	int Windows = 0;            // top-level windows captured
+	int Elements = 0;           // elements written, including the root
+	int Candidates = 0;         // windows matching the current selectors
+	int SelectedElement = -1;   // media window chosen by the current discovery logic
+};
+
+/// <summary>
+/// Writes every top-level window of the given processes and all their descendants
+/// to a snapshot (see TreeSnapshotReader), for offline replay with
+/// ReplayDiscoveryBackend. Windows are captured whether or not they match the
+/// current selectors, so a snapshot taken after an update renamed the media window
+/// still holds it; the window the current discovery logic selects is recorded
+/// separately.
+/// </summary>
+class UiaTreeCapture
+{
+private:
+	static constexpr int MaxDepth = 64;
+
+public:
+	static TreeCaptureResult Capture(IUIAutomation* automation, IUIAutomationElement* root,
+		const MediaWindowSelectors& selectors, const std::vector<std::uint32_t>& processIds, std::ostream& out);
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#if defined(_DEBUG)
+/// <summary>
+/// Counts UniqueRef ownership transfers (moves and detaches) in Debug builds, so
+/// unexpected copies through intermediate owners show up in diagnostics.
+/// </summary>
+struct UniqueRefStats
+{
+	static inline std::atomic<std::uint64_t> Transfers{ 0 };
+};
+#define UNIQUE_REF_TRANSFER() (UniqueRefStats::Transfers.fetch_add(1, std::memory_order_relaxed))
+#else
+#define UNIQUE_REF_TRANSFER() ((void)0)
+#endif
+
+/// <summary>
+/// Move-only owner of one reference to a COM-style object (anything with Release).
+/// Adopts the reference it is given (no AddRef) and releases it exactly once; use
+/// Share to take an additional reference explicitly. Portable (no Windows dependencies).
+/// </summary>
+template <typename T>
+class UniqueRef
+{
+private:
+	T* pointer_;
+
+public:
+	UniqueRef() noexcept
+		: pointer_(nullptr)
+	{
+	}
+
+	explicit UniqueRef(T* pointer) noexcept
+		: pointer_(pointer)
+	{
+	}
+
+	UniqueRef(const UniqueRef&) = delete;
+	UniqueRef& operator=(const UniqueRef&) = delete;
+
+	UniqueRef(UniqueRef&& other) noexcept
+		: pointer_(other.pointer_)
+	{
+		other.pointer_ = nullptr;
+		UNIQUE_REF_TRANSFER();
+	}
+
+	UniqueRef& operator=(UniqueRef&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset(other.pointer_);
+			other.pointer_ = nullptr;
+			UNIQUE_REF_TRANSFER();
+		}
+		return *this;
+	}
+
+	~UniqueRef()
+	{
+		Reset();
+	}
+
+	// Takes a new reference to a borrowed pointer (AddRef).
+	static UniqueRef Share(T* pointer)
+	{
+		if (pointer != nullptr)
+		{
+			pointer->AddRef();
+		}
+		return UniqueRef(pointer);
+	}
+
+	T* Get() const noexcept { return pointer_; }
+	T* operator->() const noexcept { return pointer_; }
+	explicit operator bool() const noexcept { return pointer_ != nullptr; }
+
+	// Releases the current reference and adopts pointer.
+	void Reset(T* pointer = nullptr) noexcept
+	{
+		T* old = pointer_;
+		pointer_ = pointer;
+		if (old != nullptr)
+		{
+			old->Release();
+		}
+	}
+
+	// Gives up ownership without releasing; the caller must Release the result.
+	T* Detach() noexcept
+	{
+		T* pointer = pointer_;
+		pointer_ = nullptr;
+		if (pointer != nullptr)
+		{
+			UNIQUE_REF_TRANSFER();
+		}
+		return pointer;
+	}
+
+	// Releases the current reference and returns the address to receive a new one
+	// (for out parameters such as FindAll's).
+	T** Out() noexcept
+	{
+		Reset();
+		return &pointer_;
+	}
+};
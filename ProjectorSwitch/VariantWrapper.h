@@ -1,19 +1,51 @@
 #pragma once
 #include <atlstr.h>
 #include <string>
+#include "UniqueRef.h"
 
-class VariantWrapper  // NOLINT(cppcoreguidelines-special-member-functions)
+/// <summary>
+/// Owns a VARIANT (move-only). Each Set* clears the previous value first, so
+/// strings it held are freed.
+/// </summary>
+class VariantWrapper
 {
 private:
 	VARIANT variant_;
 
 public:
 	VariantWrapper()
-	{		
+	{
 		VariantInit(&variant_);
 	}
 
+	VariantWrapper(const VariantWrapper&) = delete;
+	VariantWrapper& operator=(const VariantWrapper&) = delete;
+
+	VariantWrapper(VariantWrapper&& other) noexcept
+		: variant_(other.variant_)
+	{
+		VariantInit(&other.variant_);
+		UNIQUE_REF_TRANSFER();
+	}
+
+	VariantWrapper& operator=(VariantWrapper&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Clear();
+			variant_ = other.variant_;
+			VariantInit(&other.variant_);
+			UNIQUE_REF_TRANSFER();
+		}
+		return *this;
+	}
+
 	~VariantWrapper()
+	{
+		Clear();
+	}
+
+	void Clear()
 	{
 		if (variant_.vt != VT_EMPTY)
 		{
@@ -23,30 +55,35 @@ public:
 
 	void SetString(const std::wstring& value)
 	{
+		Clear();
 		variant_.vt = VT_BSTR;
 		variant_.bstrVal = SysAllocString(value.c_str());
 	}
 
 	void SetBool(bool value)
 	{
+		Clear();
 		variant_.vt = VT_BOOL;
 		variant_.boolVal = value ? VARIANT_TRUE : VARIANT_FALSE;
 	}
 
 	void SetInt(int value)
 	{
+		Clear();
 		variant_.vt = VT_I4;
 		variant_.lVal = value;
 	}
 
 	void SetDouble(double value)
 	{
+		Clear();
 		variant_.vt = VT_R8;
 		variant_.dblVal = value;
 	}
 
 	void SetNull()
 	{
+		Clear();
 		variant_.vt = VT_NULL;
 	}
 
@@ -0,0 +1,170 @@
+#include <utility>
+#include "Win32EventReactor.h"
+#include "TraceRecorder.h"
+
+Win32EventReactor::Win32EventReactor()
+	: taskEvent_(CreateEventW(nullptr, FALSE, FALSE, nullptr))
+	, quit_(false)
+	, exitCode_(0)
+{
+}
+
+Win32EventReactor::~Win32EventReactor()
+{
+	if (taskEvent_ != nullptr)
+	{
+		CloseHandle(taskEvent_);
+		taskEvent_ = nullptr;
+	}
+}
+
+EventReactor::RegistrationId Win32EventReactor::Register(const NativeWaitHandle handle, Callback callback)
+{
+	return handlers_.Add(handle, std::move(callback));
+}
+
+void Win32EventReactor::Unregister(const RegistrationId id)
+{
+	handlers_.Remove(id);
+}
+
+void Win32EventReactor::Post(Callback callback)
+{
+	if (tasks_.Push(std::move(callback)))
+	{
+		SetEvent(taskEvent_);
+	}
+}
+
+void Win32EventReactor::SetIdleCallback(Callback callback)
+{
+	idle_ = std::move(callback);
+}
+
+void Win32EventReactor::SetMessageFilter(MessageFilter filter)
+{
+	filter_ = std::move(filter);
+}
+
+void Win32EventReactor::Quit(const int exitCode)
+{
+	quit_ = true;
+	exitCode_ = exitCode;
+}
+
+/// <summary>
+/// Dispatches the messages in the queue, stopping at WM_QUIT.
+/// </summary>
+/// <returns>The number of messages dispatched.</returns>
+std::uint64_t Win32EventReactor::PumpMessages()
+{
+	std::uint64_t count = 0;
+	MSG msg;
+	while (!quit_ && PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE))
+	{
+		if (msg.message == WM_QUIT)
+		{
+			Quit(static_cast<int>(msg.wParam));
+			break;
+		}
+
+		if (!filter_ || !filter_(msg))
+		{
+			TranslateMessage(&msg);
+			DispatchMessageW(&msg);
+		}
+		++count;
+	}
+
+	stats_.Messages += count;
+	return count;
+}
+
+/// <summary>
+/// Waits for handles, posted callbacks, messages and APCs together and dispatches
+/// them until WM_QUIT or Quit.
+/// </summary>
+/// <returns>The exit code (WM_QUIT's wParam).</returns>
+int Win32EventReactor::Run()
+{
+	if (taskEvent_ == nullptr)
+	{
+		return -1;
+	}
+
+	std::vector<NativeWaitHandle> handles;
+	std::vector<RegistrationId> ids;
+	quit_ = false;
+
+	while (!quit_)
+	{
+		handlers_.Compact();
+		handlers_.Snapshot(handles, ids);
+		if (handles.size() > MaxHandles)
+		{
+			handles.resize(MaxHandles);
+			ids.resize(MaxHandles);
+		}
+
+		// The task event comes first; registered handles follow in order.
+		handles.insert(handles.begin(), taskEvent_);
+		const auto count = static_cast<DWORD>(handles.size());
+
+		const DWORD wait = MsgWaitForMultipleObjectsEx(count, handles.data(), INFINITE, QS_ALLINPUT,
+			MWMO_ALERTABLE | MWMO_INPUTAVAILABLE);
+		if (wait == WAIT_FAILED)
+		{
+			return -1;
+		}
+
+		TRACE_ZONE("EventReactor.Dispatch");
+		++stats_.Wakeups;
+		std::uint64_t dispatched = 0;
+
+		if (wait == WAIT_IO_COMPLETION)
+		{
+			++dispatched; // an APC ran during the wait
+		}
+		else if (wait > WAIT_OBJECT_0 && wait < WAIT_OBJECT_0 + count)
+		{
+			if (handlers_.Invoke(ids[wait - WAIT_OBJECT_0 - 1]))
+			{
+				++stats_.HandleEvents;
+				++dispatched;
+			}
+		}
+		else if (wait > WAIT_ABANDONED_0 && wait < WAIT_ABANDONED_0 + count)
+		{
+			// An abandoned mutex is owned by this thread now; its owner decides what that means.
+			if (handlers_.Invoke(ids[wait - WAIT_ABANDONED_0 - 1]))
+			{
+				++stats_.HandleEvents;
+				++dispatched;
+			}
+		}
+
+		// Posted tasks and messages are handled on every wakeup, so a busy handle (which
+		// the wait always reports first) cannot starve them.
+		if (!quit_)
+		{
+			// Reset first: a task posted after the reset sets the event again.
+			ResetEvent(taskEvent_);
+			const std::uint64_t tasks = tasks_.RunAll();
+			stats_.Tasks += tasks;
+			dispatched += tasks;
+		}
+
+		dispatched += PumpMessages();
+
+		if (dispatched == 0)
+		{
+			++stats_.IdleWakeups;
+		}
+		else if (idle_ && !quit_)
+		{
+			idle_();
+		}
+	}
+
+	return exitCode_;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <windows.h>
+#include "EventReactor.h"
+
+/// <summary>
+/// EventReactor over MsgWaitForMultipleObjectsEx: one wait covers the registered
+/// handles, posted callbacks (an auto-reset event), window messages and APCs, and
+/// everything is dispatched on the UI thread. At most MaxHandles registrations are
+/// waited on at once (the wait's limit, less the internal event).
+/// </summary>
+class Win32EventReactor : public EventReactor  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+	// Gives a message to the application first (e.g. TranslateAccelerator); return
+	// true if it was handled and must not be translated and dispatched.
+	using MessageFilter = std::function<bool(MSG&)>;
+
+	static constexpr DWORD MaxHandles = MAXIMUM_WAIT_OBJECTS - 2;
+
+private:
+	ReactorHandlers handlers_;
+	ReactorTaskQueue tasks_;
+	Callback idle_;
+	MessageFilter filter_;
+	ReactorStats stats_;
+	HANDLE taskEvent_;
+	bool quit_;
+	int exitCode_;
+
+	std::uint64_t PumpMessages();
+
+public:
+	Win32EventReactor();
+	~Win32EventReactor() override;
+
+	RegistrationId Register(NativeWaitHandle handle, Callback callback) override;
+	void Unregister(RegistrationId id) override;
+	void Post(Callback callback) override;
+	void SetIdleCallback(Callback callback) override;
+	int Run() override;
+	void Quit(int exitCode) override;
+	ReactorStats Stats() const override { return stats_; }
+
+	void SetMessageFilter(MessageFilter filter);
+};
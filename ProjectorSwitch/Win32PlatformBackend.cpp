@@ -0,0 +1,646 @@
+#include <atlbase.h>
+#include <dwmapi.h>
+#include <ShellScalingApi.h>
+#pragma comment(lib, "Dwmapi.lib")  // link DWM
+#pragma comment(lib, "Shcore.lib")  // GetDpiForMonitor
+#include "Win32PlatformBackend.h"
+#include "CallCounters.h"
+#include "SettingsService.h"
+#include "MonitorService.h"
+#include "UiaDiscoveryBackend.h"
+#include "CompositionClock.h"
+#include "FlightRecorder.h"
+#include "Stopwatch.h"
+#include "TraceRecorder.h"
+
+namespace
+{
+	// UI Automation's default; lowered to the deadline if that is shorter.
+	constexpr DWORD UiaConnectionTimeoutMs = 2000;
+
+	constexpr UINT MoveFlags = SWP_NOCOPYBITS | SWP_NOSENDCHANGING;
+
+	// Discovery state shared with the worker thread, which outlives the toggle that
+	// started it if UI Automation calls hang past the deadline.
+	struct DiscoveryRun
+	{
+		UniqueRef<IUIAutomation> Automation;
+		AutomationElementWrapper Root;
+		UiaDiscoveryBackend Backend;
+		DiscoveryOutcome Outcome;
+		AutomationElementWrapper Selected;
+		CallCounts Calls;
+
+		DiscoveryRun(IUIAutomation* automation, IUIAutomationElement* root)
+			: Automation(UniqueRef<IUIAutomation>::Share(automation))
+			, Root(AutomationElementWrapper::Share(root))
+			, Backend(automation, root)
+		{
+		}
+	};
+
+	ScreenRect ToScreenRect(const RECT& rect)
+	{
+		return ScreenRect{ rect.left, rect.top, rect.right, rect.bottom };
+	}
+
+	RECT ToRect(const ScreenRect& rect)
+	{
+		return RECT{ rect.Left, rect.Top, rect.Right, rect.Bottom };
+	}
+
+	PlatformResult ResultOf(const HRESULT hr)
+	{
+		if (hr == UIA_E_TIMEOUT)
+		{
+			return PlatformResult::TimedOut;
+		}
+
+		return SUCCEEDED(hr) ? PlatformResult::Ok : PlatformResult::Failed;
+	}
+}
+
+/// <summary>
+/// Constructs the backend, bounding the automation's cross-process calls by the
+/// UiaDeadlineMs setting.
+/// </summary>
+/// <param name="automation">The UI Automation service (not owned), or null.</param>
+Win32PlatformBackend::Win32PlatformBackend(AutomationService* automation)
+	: automation_(automation)
+	, uiaDeadlineMs_(SettingsService().LoadUiaDeadlineMs())
+{
+	if (automation_ != nullptr && uiaDeadlineMs_ > 0)
+	{
+		// Calls made outside discovery (e.g. reading the window handle) are bounded too.
+		const auto deadlineMs = static_cast<DWORD>(uiaDeadlineMs_);
+		automation_->SetTimeouts(deadlineMs < UiaConnectionTimeoutMs ? deadlineMs : UiaConnectionTimeoutMs, deadlineMs);
+	}
+}
+
+Win32PlatformBackend::~Win32PlatformBackend()
+{
+	// Released before the AutomationService that created them.
+	element_.Reset();
+	desktop_.Reset();
+}
+
+HWND Win32PlatformBackend::ToHandle(const PlatformWindow window)
+{
+	return reinterpret_cast<HWND>(static_cast<std::uintptr_t>(window)); // NOLINT(performance-no-int-to-ptr)
+}
+
+PlatformWindow Win32PlatformBackend::FromHandle(const HWND window)
+{
+	return static_cast<PlatformWindow>(reinterpret_cast<std::uintptr_t>(window));
+}
+
+WindowShowState Win32PlatformBackend::ShowStateOf(const UINT showCmd)
+{
+	switch (showCmd)
+	{
+	case SW_SHOWMINIMIZED:
+	case SW_MINIMIZE:
+	case SW_SHOWMINNOACTIVE:
+		return WindowShowState::Minimized;
+	case SW_SHOWMAXIMIZED:
+		return WindowShowState::Maximized;
+	default:
+		return WindowShowState::Normal;
+	}
+}
+
+UINT Win32PlatformBackend::ShowCommand(const WindowShowState state)
+{
+	switch (state)
+	{
+	case WindowShowState::Minimized:
+		return SW_SHOWMINIMIZED;
+	case WindowShowState::Maximized:
+		return SW_SHOWMAXIMIZED;
+	default:
+		return SW_SHOWNORMAL;
+	}
+}
+
+bool Win32PlatformBackend::HasAutomation() const
+{
+	return automation_ != nullptr;
+}
+
+bool Win32PlatformBackend::ConnectDesktop()
+{
+	if (!desktop_ && automation_ != nullptr)
+	{
+		IUIAutomationElement* desktop = automation_->DesktopElement();
+		if (desktop != nullptr)
+		{
+			// The AutomationService keeps (and releases) its own reference.
+			desktop_ = AutomationElementWrapper::Share(desktop);
+		}
+	}
+
+	return static_cast<bool>(desktop_);
+}
+
+/// <summary>
+/// Attempts to locate the media window of each provider in turn (highest precedence
+/// first) by finding all windows with matching name/class and, if there are several,
+/// identifying the main window by the presence of conference controls. The search runs
+/// on a worker thread bounded by the UiaDeadlineMs setting; its calls are counted there
+/// and added to the caller's scope.
+/// </summary>
+/// <param name="selectors">The running providers' selectors.</param>
+/// <param name="outcome">Receives the candidates found and which was selected.</param>
+/// <returns>Whether the search completed within the deadline.</returns>
+OperationStatus Win32PlatformBackend::LocateMediaWindow(const std::vector<std::shared_ptr<const MediaWindowSelectors>>& selectors,
+	DiscoveryOutcome& outcome)
+{
+	TRACE_ZONE("Win32PlatformBackend::LocateMediaWindow");
+	element_.Reset();
+	if (!desktop_)
+	{
+		return OperationStatus::Completed;
+	}
+
+	// Shared with the worker, which may outlive this toggle.
+	const Stopwatch clock;
+	const auto run = std::make_shared<DiscoveryRun>(automation_->GetAutomationInterface(), desktop_.Get());
+	const OperationStatus status = discovery_.Run([run, selectors](const CancellationToken& cancel)
+	{
+		const HRESULT hrInit = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+		{
+			const CallCountScope callScope(run->Calls);
+			for (const auto& providerSelectors : selectors)
+			{
+				run->Outcome = MediaWindowDiscovery::Locate(run->Backend, *providerSelectors, cancel);
+				if (run->Outcome.SelectedIndex >= 0 || run->Outcome.Cancelled)
+				{
+					break;
+				}
+			}
+
+			if (run->Outcome.SelectedIndex >= 0 && !run->Outcome.Cancelled)
+			{
+				run->Selected = run->Backend.DetachCandidate(run->Outcome.SelectedIndex);
+			}
+		}
+
+		if (SUCCEEDED(hrInit))
+		{
+			CoUninitialize();
+		}
+	}, Deadline::FromNow(uiaDeadlineMs_));
+
+	FlightRecorder::Instance().Record(FlightEventKind::Deadline, static_cast<std::int32_t>(status),
+		uiaDeadlineMs_, clock.ElapsedMicroseconds());
+	if (status != OperationStatus::Completed)
+	{
+		return status;
+	}
+
+	// The worker's calls belong to this toggle.
+	CallCountScope::Add(run->Calls);
+
+	outcome = run->Outcome;
+	if (!run->Selected)
+	{
+		// Selected, but gone before it could be taken.
+		outcome.SelectedIndex = -1;
+	}
+	element_ = std::move(run->Selected);
+	return status;
+}
+
+bool Win32PlatformBackend::IsWindow(const PlatformWindow window)
+{
+	return ::IsWindow(ToHandle(window)) != FALSE;
+}
+
+bool Win32PlatformBackend::IsMinimized(const PlatformWindow window)
+{
+	return IsIconic(ToHandle(window)) != FALSE;
+}
+
+bool Win32PlatformBackend::GetWindowRect(const PlatformWindow window, ScreenRect& rect)
+{
+	RECT windowRect{};
+	if (!::GetWindowRect(ToHandle(window), &windowRect))
+	{
+		return false;
+	}
+
+	rect = ToScreenRect(windowRect);
+	return true;
+}
+
+unsigned Win32PlatformBackend::WindowDpi(const PlatformWindow window)
+{
+	return GetDpiForWindow(ToHandle(window));
+}
+
+/// <summary>
+/// Retrieves the effective DPI of the monitor containing (most of) the given rectangle.
+/// </summary>
+/// <returns>The DPI, or the system DPI if it cannot be determined.</returns>
+unsigned Win32PlatformBackend::MonitorDpi(const ScreenRect& monitorRect)
+{
+	const RECT rect = ToRect(monitorRect);
+	const HMONITOR monitor = MonitorFromRect(&rect, MONITOR_DEFAULTTONEAREST);
+
+	UINT dpiX = 0;
+	UINT dpiY = 0;
+	if (monitor == nullptr || FAILED(GetDpiForMonitor(monitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY)) || dpiX == 0)
+	{
+		return GetDpiForSystem();
+	}
+
+	return dpiX;
+}
+
+unsigned Win32PlatformBackend::SystemDpi()
+{
+	return GetDpiForSystem();
+}
+
+/// <summary>
+/// Retrieves the rectangle of the primary monitor, preferring the work area if available.
+/// </summary>
+/// <returns>The primary monitor's work area if not empty, otherwise its full rectangle;
+/// empty if no primary monitor is found.</returns>
+ScreenRect Win32PlatformBackend::PrimaryWorkArea()
+{
+	TRACE_ZONE("Win32PlatformBackend::PrimaryWorkArea");
+	constexpr MonitorService monitorService;
+
+	const std::vector<MonitorData> monitorData = monitorService.GetMonitorsData();
+	for (auto& i : monitorData)
+	{
+		if (i.IsPrimary)
+		{
+			if (IsRectEmpty(&i.WorkRect))
+			{
+				return ToScreenRect(i.MonitorRect);
+			}
+
+			return ToScreenRect(i.WorkRect);
+		}
+	}
+
+	return ScreenRect{};
+}
+
+/// <summary>
+/// Gets the frame metrics the window has (or will have) at the given DPI. They are measured
+/// once per window class and DPI, at the window's current DPI, and scaled for other DPIs until
+/// measured there. A minimized window cannot be measured; if its class has never been measured,
+/// the standard frame for its style is assumed.
+/// </summary>
+/// <param name="window">The window.</param>
+/// <param name="dpi">The DPI of interest (normally that of the monitor it is moving to).</param>
+/// <returns>The window's frame metrics.</returns>
+FrameMetrics Win32PlatformBackend::WindowFrameMetrics(const PlatformWindow window, const unsigned dpi)
+{
+	TRACE_ZONE("Win32PlatformBackend::WindowFrameMetrics");
+	const HWND windowHandle = ToHandle(window);
+	wchar_t className[256]{};
+	GetClassNameW(windowHandle, className, static_cast<int>(std::size(className)));
+	const UINT windowDpi = GetDpiForWindow(windowHandle);
+
+	FrameMetrics metrics;
+	if (!frameMetrics_.Contains(className, windowDpi) && !IsIconic(windowHandle))
+	{
+		RECT windowRect{};
+		RECT clientRect{};
+		if (::GetWindowRect(windowHandle, &windowRect) && GetClientRect(windowHandle, &clientRect))
+		{
+			MapWindowPoints(windowHandle, nullptr, reinterpret_cast<POINT*>(&clientRect), 2);
+
+			RECT visibleFrame{};
+			if (FAILED(DwmGetWindowAttribute(windowHandle, DWMWA_EXTENDED_FRAME_BOUNDS, &visibleFrame, sizeof(visibleFrame))))
+			{
+				visibleFrame = RECT{};
+			}
+
+			frameMetrics_.Store(className,
+				FrameMetrics::Measure(ToScreenRect(windowRect), ToScreenRect(clientRect), ToScreenRect(visibleFrame), windowDpi));
+		}
+	}
+
+	if (frameMetrics_.TryGet(className, dpi, metrics))
+	{
+		return metrics;
+	}
+
+	// Not measurable and never measured: use the standard frame for the window's style.
+	RECT frame{};
+	const auto style = static_cast<DWORD>(GetWindowLongPtr(windowHandle, GWL_STYLE)) & ~WS_MINIMIZE;
+	const auto exStyle = static_cast<DWORD>(GetWindowLongPtr(windowHandle, GWL_EXSTYLE));
+	AdjustWindowRectExForDpi(&frame, style, FALSE, exStyle, dpi);
+
+	metrics = FrameMetrics{};
+	metrics.Dpi = dpi;
+	metrics.Client = FrameInsets{ -frame.left, -frame.top, frame.right, frame.bottom };
+	return metrics;
+}
+
+/// <summary>
+/// Changes the window's show state and normal (restore) position, keeping the rest of
+/// its placement.
+/// </summary>
+void Win32PlatformBackend::SetWindowPlacement(const PlatformWindow window, const WindowPlacementInfo& placement)
+{
+	const HWND windowHandle = ToHandle(window);
+	WINDOWPLACEMENT wp{};
+	wp.length = sizeof(wp);
+	CallCountScope::Count(CallCategory::GetWindowPlacement);
+	if (!::GetWindowPlacement(windowHandle, &wp))
+	{
+		return;
+	}
+
+	wp.showCmd = ShowCommand(placement.ShowState);
+	wp.rcNormalPosition = ToRect(placement.NormalRect);
+	CallCountScope::Count(CallCategory::SetWindowPlacement);
+	::SetWindowPlacement(windowHandle, &wp);
+}
+
+void Win32PlatformBackend::Minimize(const PlatformWindow window)
+{
+	CallCountScope::Count(CallCategory::ShowWindow);
+	ShowWindowAsync(ToHandle(window), SW_MINIMIZE);
+}
+
+void Win32PlatformBackend::Maximize(const PlatformWindow window)
+{
+	CallCountScope::Count(CallCategory::ShowWindow);
+	ShowWindowAsync(ToHandle(window), SW_MAXIMIZE);
+}
+
+void Win32PlatformBackend::Restore(const PlatformWindow window)
+{
+	CallCountScope::Count(CallCategory::ShowWindow);
+	ShowWindowAsync(ToHandle(window), SW_RESTORE);
+}
+
+void Win32PlatformBackend::Show(const PlatformWindow window)
+{
+	CallCountScope::Count(CallCategory::ShowWindow);
+	ShowWindow(ToHandle(window), SW_SHOW);
+}
+
+void Win32PlatformBackend::Hide(const PlatformWindow window)
+{
+	CallCountScope::Count(CallCategory::ShowWindow);
+	ShowWindow(ToHandle(window), SW_HIDE);
+}
+
+void Win32PlatformBackend::Activate(const PlatformWindow window)
+{
+	CallCountScope::Count(CallCategory::SetForegroundWindow);
+	SetForegroundWindow(ToHandle(window));
+}
+
+bool Win32PlatformBackend::HasLayeredStyle(const PlatformWindow window)
+{
+	return (GetWindowLongPtr(ToHandle(window), GWL_EXSTYLE) & WS_EX_LAYERED) != 0;
+}
+
+void Win32PlatformBackend::SetLayeredStyle(const PlatformWindow window, const bool layered)
+{
+	const HWND windowHandle = ToHandle(window);
+	const LONG_PTR exStyle = GetWindowLongPtr(windowHandle, GWL_EXSTYLE);
+	CallCountScope::Count(CallCategory::SetWindowLong);
+	SetWindowLongPtr(windowHandle, GWL_EXSTYLE, layered ? (exStyle | WS_EX_LAYERED) : (exStyle & ~static_cast<LONG_PTR>(WS_EX_LAYERED)));
+}
+
+void Win32PlatformBackend::Redraw(const PlatformWindow window)
+{
+	CallCountScope::Count(CallCategory::RedrawWindow);
+	RedrawWindow(ToHandle(window), nullptr, nullptr, RDW_INVALIDATE | RDW_ALLCHILDREN | RDW_UPDATENOW);
+}
+
+void Win32PlatformBackend::BeginResizeCount(const PlatformWindow window)
+{
+	resizes_ = std::make_unique<ResizeEventCounter>(ToHandle(window));
+}
+
+void Win32PlatformBackend::SettleResizes(const unsigned quietMs, const unsigned maxMs)
+{
+	if (resizes_)
+	{
+		resizes_->Settle(quietMs, maxMs);
+	}
+}
+
+std::uint32_t Win32PlatformBackend::EndResizeCount()
+{
+	const std::uint32_t count = resizes_ ? resizes_->Count() : 0;
+	resizes_.reset();
+	return count;
+}
+
+std::uint64_t Win32PlatformBackend::TickMs()
+{
+	return GetTickCount64();
+}
+
+void Win32PlatformBackend::SleepMs(const unsigned ms)
+{
+	Sleep(ms);
+}
+
+std::int64_t Win32PlatformBackend::CompositionNow()
+{
+	return CompositionClock::Now();
+}
+
+std::vector<std::wstring> Win32PlatformBackend::ProcessNames()
+{
+	return processes_.GetProcessNames();
+}
+
+ScreenRect Win32PlatformBackend::LoadTargetMonitorRect()
+{
+	TRACE_ZONE("Win32PlatformBackend::LoadTargetMonitorRect");
+	return ToScreenRect(SettingsService().LoadSelectedMonitorRect());
+}
+
+bool Win32PlatformBackend::LoadMirrorMode()
+{
+	return SettingsService().LoadMirrorMode();
+}
+
+FrameInsets Win32PlatformBackend::LoadMirrorCrop()
+{
+	return SettingsService().LoadMirrorCrop();
+}
+
+PlatformResult Win32PlatformBackend::AdoptWindowElement(const PlatformWindow window)
+{
+	element_.Reset();
+	if (automation_ == nullptr)
+	{
+		return PlatformResult::Failed;
+	}
+
+	AutomationElementWrapper element;
+	CallCountScope::Count(CallCategory::UiaFind);
+	const HRESULT hr = automation_->GetAutomationInterface()->ElementFromHandle(ToHandle(window), element.Out());
+	if (FAILED(hr) || !element)
+	{
+		return hr == UIA_E_TIMEOUT ? PlatformResult::TimedOut : PlatformResult::Failed;
+	}
+
+	element_ = std::move(element);
+	return PlatformResult::Ok;
+}
+
+PlatformResult Win32PlatformBackend::ReadElementWindow(PlatformWindow& window)
+{
+	if (!element_)
+	{
+		return PlatformResult::Failed;
+	}
+
+	UIA_HWND uiaHwnd{};
+	CallCountScope::Count(CallCategory::UiaPropertyRead);
+	const HRESULT hr = element_->get_CurrentNativeWindowHandle(&uiaHwnd);
+	FlightRecorder::Instance().Record(FlightEventKind::NativeWindowHandle, hr,
+		static_cast<std::int64_t>(reinterpret_cast<std::intptr_t>(uiaHwnd)));
+	window = FromHandle(static_cast<HWND>(uiaHwnd));
+	return ResultOf(hr);
+}
+
+PlatformResult Win32PlatformBackend::ReadElementRect(ScreenRect& rect)
+{
+	if (!element_)
+	{
+		return PlatformResult::Failed;
+	}
+
+	RECT bounds{};
+	CallCountScope::Count(CallCategory::UiaPropertyRead);
+	const HRESULT hr = element_->get_CurrentBoundingRectangle(&bounds);
+	FlightRecorder::Instance().Record(FlightEventKind::BoundingRect, hr, bounds.left, bounds.top, bounds.right, bounds.bottom);
+	rect = ToScreenRect(bounds);
+	return ResultOf(hr);
+}
+
+bool Win32PlatformBackend::GetWindowPlacement(const PlatformWindow window, WindowPlacementInfo& placement)
+{
+	WINDOWPLACEMENT wp{};
+	wp.length = sizeof(wp);
+	CallCountScope::Count(CallCategory::GetWindowPlacement);
+	if (!::GetWindowPlacement(ToHandle(window), &wp))
+	{
+		return false;
+	}
+
+	placement.ShowState = ShowStateOf(wp.showCmd);
+	placement.NormalRect = ToScreenRect(wp.rcNormalPosition);
+	return true;
+}
+
+bool Win32PlatformBackend::MoveTopmost(const PlatformWindow window, const ScreenRect& rect)
+{
+	CallCountScope::Count(CallCategory::SetWindowPos);
+	return SetWindowPos(ToHandle(window), HWND_TOPMOST, rect.Left, rect.Top, rect.Width(), rect.Height(),
+		MoveFlags | SWP_NOACTIVATE) != FALSE;
+}
+
+/// <summary>
+/// Force the specified window to the foreground, even if our process is not foreground. This
+/// helps to ensure the Zoom window is on top of all other windows, even if another
+/// topmost window has focus.
+/// </summary>
+bool Win32PlatformBackend::ForceToForeground(const PlatformWindow window)
+{
+	TRACE_ZONE("Win32PlatformBackend::ForceToForeground");
+	const HWND windowHandle = ToHandle(window);
+	const HWND fg = GetForegroundWindow();
+	const DWORD thisThread = GetCurrentThreadId();
+	const DWORD fgThread = fg ? GetWindowThreadProcessId(fg, nullptr) : 0;
+	const DWORD targetThread = GetWindowThreadProcessId(windowHandle, nullptr);
+
+	struct AttachGuard  // NOLINT(cppcoreguidelines-special-member-functions)
+	{
+		DWORD Current{};
+		DWORD ForegroundThread{};
+		DWORD TargetThread{};
+		bool AttachedForeground{ false };
+		bool AttachedTarget{ false };
+
+		~AttachGuard()
+		{
+			if (AttachedTarget)
+			{
+				AttachThreadInput(Current, TargetThread, FALSE);
+			}
+
+			if (AttachedForeground)
+			{
+				AttachThreadInput(Current, ForegroundThread, FALSE);
+			}
+		}
+	} guard{ thisThread, fgThread, targetThread };
+
+	if (fgThread && (fgThread != thisThread))
+	{
+		guard.AttachedForeground = AttachThreadInput(thisThread, fgThread, TRUE) != FALSE;
+	}
+
+	if (targetThread && (targetThread != thisThread))
+	{
+		guard.AttachedTarget = AttachThreadInput(thisThread, targetThread, TRUE) != FALSE;
+	}
+
+	// BringWindowToTop is a SetWindowPos to the top of the z-order.
+	CallCountScope::Count(CallCategory::SetWindowPos);
+	BringWindowToTop(windowHandle);
+	CallCountScope::Count(CallCategory::SetForegroundWindow);
+	SetForegroundWindow(windowHandle);
+
+	// Assert z-order again without moving/sizing.
+	CallCountScope::Count(CallCategory::SetWindowPos);
+	return SetWindowPos(windowHandle, HWND_TOPMOST, 0, 0, 0, 0,
+		SWP_NOMOVE | SWP_NOSIZE | SWP_NOOWNERZORDER | SWP_NOSENDCHANGING) != FALSE;
+}
+
+bool Win32PlatformBackend::LowerFromTopmost(const PlatformWindow window)
+{
+	CallCountScope::Count(CallCategory::SetWindowPos);
+	return SetWindowPos(ToHandle(window), HWND_NOTOPMOST, 0, 0, 0, 0,
+		SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE | SWP_NOSENDCHANGING) != FALSE;
+}
+
+bool Win32PlatformBackend::RestoreWindow(const PlatformWindow window, const ScreenRect& rect)
+{
+	CallCountScope::Count(CallCategory::SetWindowPos);
+	return SetWindowPos(ToHandle(window), HWND_NOTOPMOST, rect.Left, rect.Top, rect.Width(), rect.Height(),
+		MoveFlags | SWP_SHOWWINDOW) != FALSE;
+}
+
+bool Win32PlatformBackend::SetWindowAlpha(const PlatformWindow window, const std::uint8_t alpha)
+{
+	CallCountScope::Count(CallCategory::SetLayeredWindowAttributes);
+	return SetLayeredWindowAttributes(ToHandle(window), 0, alpha, LWA_ALPHA) != FALSE;
+}
+
+bool Win32PlatformBackend::SetCloaked(const PlatformWindow window, const bool cloaked)
+{
+	const BOOL cloak = cloaked ? TRUE : FALSE;
+	CallCountScope::Count(CallCategory::DwmSetWindowAttribute);
+	const HRESULT hr = DwmSetWindowAttribute(ToHandle(window), DWMWA_CLOAK, &cloak, sizeof(cloak));
+	if (cloaked)
+	{
+		FlightRecorder::Instance().Record(FlightEventKind::Cloak, hr, static_cast<std::int64_t>(window));
+	}
+	return SUCCEEDED(hr);
+}
+
+bool Win32PlatformBackend::SetTransitionsDisabled(const PlatformWindow window, const bool disabled)
+{
+	const BOOL value = disabled ? TRUE : FALSE;
+	CallCountScope::Count(CallCategory::DwmSetWindowAttribute);
+	return SUCCEEDED(DwmSetWindowAttribute(ToHandle(window), DWMWA_TRANSITIONS_FORCEDISABLED, &value, sizeof(value)));
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <windows.h>
+#include <memory>
+#include "AutomationService.h"
+#include "BoundedOperation.h"
+#include "PlatformBackend.h"
+#include "ProcessesService.h"
+#include "ResizeEventCounter.h"
+
+/// <summary>
+/// PlatformBackend over Win32, DWM and UI Automation. The search runs on a worker
+/// bounded by the UiaDeadlineMs setting, so a hung app fails the toggle instead of
+/// blocking it; the automation's timeouts bound its other calls.
+/// </summary>
+class Win32PlatformBackend final : public PlatformBackend  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	AutomationService* automation_; // not owned; null without UI Automation (e.g. for scenes)
+	ProcessesService processes_;
+	AutomationElementWrapper desktop_;
+	AutomationElementWrapper element_; // the current element
+	int uiaDeadlineMs_;
+	BoundedOperation discovery_;
+	FrameMetricsCache frameMetrics_;
+	std::unique_ptr<ResizeEventCounter> resizes_;
+
+public:
+	// The automation service, if any, must outlive the backend.
+	explicit Win32PlatformBackend(AutomationService* automation = nullptr);
+	~Win32PlatformBackend() override;
+
+	static HWND ToHandle(PlatformWindow window);
+	static PlatformWindow FromHandle(HWND window);
+
+	// WINDOWPLACEMENT::showCmd to and from WindowShowState.
+	static WindowShowState ShowStateOf(UINT showCmd);
+	static UINT ShowCommand(WindowShowState state);
+
+	std::vector<std::wstring> ProcessNames() override;
+	ScreenRect LoadTargetMonitorRect() override;
+	bool LoadMirrorMode() override;
+	FrameInsets LoadMirrorCrop() override;
+
+	bool HasAutomation() const override;
+	bool ConnectDesktop() override;
+	OperationStatus LocateMediaWindow(const std::vector<std::shared_ptr<const MediaWindowSelectors>>& selectors,
+		DiscoveryOutcome& outcome) override;
+	PlatformResult AdoptWindowElement(PlatformWindow window) override;
+	PlatformResult ReadElementWindow(PlatformWindow& window) override;
+	PlatformResult ReadElementRect(ScreenRect& rect) override;
+
+	bool IsWindow(PlatformWindow window) override;
+	bool IsMinimized(PlatformWindow window) override;
+	bool GetWindowRect(PlatformWindow window, ScreenRect& rect) override;
+	unsigned WindowDpi(PlatformWindow window) override;
+	unsigned MonitorDpi(const ScreenRect& monitorRect) override;
+	unsigned SystemDpi() override;
+	ScreenRect PrimaryWorkArea() override;
+	FrameMetrics WindowFrameMetrics(PlatformWindow window, unsigned dpi) override;
+
+	bool GetWindowPlacement(PlatformWindow window, WindowPlacementInfo& placement) override;
+	void SetWindowPlacement(PlatformWindow window, const WindowPlacementInfo& placement) override;
+	bool MoveTopmost(PlatformWindow window, const ScreenRect& rect) override;
+	bool ForceToForeground(PlatformWindow window) override;
+	bool LowerFromTopmost(PlatformWindow window) override;
+	bool RestoreWindow(PlatformWindow window, const ScreenRect& rect) override;
+	void Minimize(PlatformWindow window) override;
+	void Maximize(PlatformWindow window) override;
+	void Restore(PlatformWindow window) override;
+	void Show(PlatformWindow window) override;
+	void Hide(PlatformWindow window) override;
+	void Activate(PlatformWindow window) override;
+	bool HasLayeredStyle(PlatformWindow window) override;
+	void SetLayeredStyle(PlatformWindow window, bool layered) override;
+	void Redraw(PlatformWindow window) override;
+	bool SetWindowAlpha(PlatformWindow window, std::uint8_t alpha) override;
+	bool SetCloaked(PlatformWindow window, bool cloaked) override;
+	bool SetTransitionsDisabled(PlatformWindow window, bool disabled) override;
+
+	void BeginResizeCount(PlatformWindow window) override;
+	void SettleResizes(unsigned quietMs, unsigned maxMs) override;
+	std::uint32_t EndResizeCount() override;
+
+	std::uint64_t TickMs() override;
+	void SleepMs(unsigned ms) override;
+	std::int64_t CompositionNow() override;
+};
@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include "WindowGeometry.h"
+
+namespace
+{
+	/// <summary>
+	/// value * numerator / denominator, rounded to nearest (half away from zero).
+	/// </summary>
+	int MulDivRound(const int value, const unsigned numerator, const unsigned denominator)
+	{
+		if (denominator == 0)
+		{
+			return value;
+		}
+
+		const std::int64_t product = static_cast<std::int64_t>(value) * numerator;
+		const std::int64_t half = denominator / 2;
+		const std::int64_t result = product >= 0
+			? (product + half) / denominator
+			: -((-product + half) / static_cast<std::int64_t>(denominator));
+		return static_cast<int>(result);
+	}
+
+	FrameInsets InsetsBetween(const ScreenRect& outer, const ScreenRect& inner)
+	{
+		return FrameInsets
+		{
+			std::max(0, inner.Left - outer.Left),
+			std::max(0, inner.Top - outer.Top),
+			std::max(0, outer.Right - inner.Right),
+			std::max(0, outer.Bottom - inner.Bottom)
+		};
+	}
+
+	FrameInsets ScaleInsets(const FrameInsets& insets, const unsigned dpi, const unsigned fromDpi)
+	{
+		return FrameInsets
+		{
+			MulDivRound(insets.Left, dpi, fromDpi),
+			MulDivRound(insets.Top, dpi, fromDpi),
+			MulDivRound(insets.Right, dpi, fromDpi),
+			MulDivRound(insets.Bottom, dpi, fromDpi)
+		};
+	}
+}
+
+/// <summary>
+/// Measures frame insets from actual window geometry (rather than halving the
+/// difference between window and client sizes, which misplaces the caption).
+/// </summary>
+/// <param name="windowRect">GetWindowRect.</param>
+/// <param name="clientRect">GetClientRect mapped to screen coordinates.</param>
+/// <param name="visibleFrame">DWMWA_EXTENDED_FRAME_BOUNDS, or an empty rect if unavailable.</param>
+/// <param name="dpi">The window's DPI when measured.</param>
+FrameMetrics FrameMetrics::Measure(const ScreenRect& windowRect, const ScreenRect& clientRect,
+	const ScreenRect& visibleFrame, const unsigned dpi)
+{
+	FrameMetrics metrics;
+	metrics.Dpi = dpi == 0 ? BaseDpi : dpi;
+	metrics.Client = InsetsBetween(windowRect, clientRect);
+
+	if (!visibleFrame.IsEmpty())
+	{
+		// The invisible resize border lies within the non-client area.
+		const FrameInsets invisible = InsetsBetween(windowRect, visibleFrame);
+		metrics.Invisible = FrameInsets
+		{
+			std::min(invisible.Left, metrics.Client.Left),
+			std::min(invisible.Top, metrics.Client.Top),
+			std::min(invisible.Right, metrics.Client.Right),
+			std::min(invisible.Bottom, metrics.Client.Bottom)
+		};
+	}
+
+	return metrics;
+}
+
+FrameMetrics FrameMetrics::ScaledTo(const unsigned dpi) const
+{
+	if (dpi == 0 || dpi == Dpi)
+	{
+		return *this;
+	}
+
+	FrameMetrics scaled;
+	scaled.Dpi = dpi;
+	scaled.Client = ScaleInsets(Client, dpi, Dpi);
+	scaled.Invisible = ScaleInsets(Invisible, dpi, Dpi);
+	return scaled;
+}
+
+int WindowGeometry::ScaleForDpi(const int value, const unsigned dpi)
+{
+	return MulDivRound(value, dpi == 0 ? FrameMetrics::BaseDpi : dpi, FrameMetrics::BaseDpi);
+}
+
+/// <summary>
+/// Calculates the window rect that places the client area exactly over the monitor.
+/// </summary>
+/// <param name="monitorRect">The target monitor rectangle.</param>
+/// <param name="metrics">The window's frame metrics at the target monitor's DPI.</param>
+/// <returns>The rect to pass to SetWindowPos.</returns>
+ScreenRect WindowGeometry::TargetRect(const ScreenRect& monitorRect, const FrameMetrics& metrics)
+{
+	return ScreenRect
+	{
+		monitorRect.Left - metrics.Client.Left,
+		monitorRect.Top - metrics.Client.Top,
+		monitorRect.Right + metrics.Client.Right,
+		monitorRect.Bottom + metrics.Client.Bottom
+	};
+}
+
+/// <summary>
+/// Calculates a restore position on the given work area for a window whose
+/// original position is unknown.
+/// </summary>
+/// <param name="workArea">Work area of the monitor to restore to (normally the primary).</param>
+/// <param name="metrics">The window's frame metrics at that monitor's DPI.</param>
+/// <returns>The rect to pass to SetWindowPos.</returns>
+ScreenRect WindowGeometry::FallbackRestoreRect(const ScreenRect& workArea, const FrameMetrics& metrics)
+{
+	const int margin = ScaleForDpi(RestoreMargin, metrics.Dpi);
+	const int width = std::max(1, std::min(ScaleForDpi(RestoreWidth, metrics.Dpi), workArea.Width() - (2 * margin)));
+	const int height = std::max(1, std::min(ScaleForDpi(RestoreHeight, metrics.Dpi), workArea.Height() - (2 * margin)));
+
+	const ScreenRect visible
+	{
+		workArea.Left + margin,
+		workArea.Top + margin,
+		workArea.Left + margin + width,
+		workArea.Top + margin + height
+	};
+
+	return ScreenRect
+	{
+		visible.Left - metrics.Invisible.Left,
+		visible.Top - metrics.Invisible.Top,
+		visible.Right + metrics.Invisible.Right,
+		visible.Bottom + metrics.Invisible.Bottom
+	};
+}
+
+ScreenRect WindowGeometry::VisibleRect(const ScreenRect& windowRect, const FrameMetrics& metrics)
+{
+	return ScreenRect
+	{
+		windowRect.Left + metrics.Invisible.Left,
+		windowRect.Top + metrics.Invisible.Top,
+		windowRect.Right - metrics.Invisible.Right,
+		windowRect.Bottom - metrics.Invisible.Bottom
+	};
+}
+
+ScreenRect WindowGeometry::SuggestedRectAfterDpiChange(const ScreenRect& windowRect, const unsigned fromDpi, const unsigned toDpi)
+{
+	if (fromDpi == 0 || toDpi == 0 || fromDpi == toDpi)
+	{
+		return windowRect;
+	}
+
+	return ScreenRect
+	{
+		windowRect.Left,
+		windowRect.Top,
+		windowRect.Left + MulDivRound(windowRect.Width(), toDpi, fromDpi),
+		windowRect.Top + MulDivRound(windowRect.Height(), toDpi, fromDpi)
+	};
+}
+
+/// <summary>
+/// Inverts SuggestedRectAfterDpiChange. Where rounding makes an exact inverse
+/// impossible (the target size is not reachable from any whole-pixel size), the
+/// nearest reachable size is used.
+/// </summary>
+ScreenRect WindowGeometry::PrecompensateForDpiChange(const ScreenRect& targetRect, const unsigned fromDpi, const unsigned toDpi)
+{
+	if (fromDpi == 0 || toDpi == 0 || fromDpi == toDpi)
+	{
+		return targetRect;
+	}
+
+	const auto invert = [fromDpi, toDpi](const int target)
+	{
+		const int estimate = MulDivRound(target, fromDpi, toDpi);
+		int best = estimate;
+		int bestError = -1;
+		for (int candidate = estimate - 2; candidate <= estimate + 2; ++candidate)
+		{
+			const int error = std::abs(MulDivRound(candidate, toDpi, fromDpi) - target);
+			if (bestError < 0 || error < bestError)
+			{
+				best = candidate;
+				bestError = error;
+			}
+		}
+		return best;
+	};
+
+	return ScreenRect
+	{
+		targetRect.Left,
+		targetRect.Top,
+		targetRect.Left + invert(targetRect.Width()),
+		targetRect.Top + invert(targetRect.Height())
+	};
+}
+
+ScreenRect WindowGeometry::AspectFit(const int sourceWidth, const int sourceHeight, const ScreenRect& destination)
+{
+	if (sourceWidth <= 0 || sourceHeight <= 0 || destination.IsEmpty())
+	{
+		return destination;
+	}
+
+	const int destWidth = destination.Width();
+	const int destHeight = destination.Height();
+	int width = destWidth;
+	int height = destHeight;
+
+	// A destination already of the source's ratio (to the pixel) is kept, so that fitting
+	// a fitted rect again does not move it by the rounding of its other side.
+	if (MulDivRound(sourceHeight, static_cast<unsigned>(destWidth), static_cast<unsigned>(sourceWidth)) == destHeight
+		|| MulDivRound(sourceWidth, static_cast<unsigned>(destHeight), static_cast<unsigned>(sourceHeight)) == destWidth)
+	{
+		return destination;
+	}
+
+	// Compare aspect ratios without division: the source is wider if sw/sh > dw/dh.
+	if (static_cast<std::int64_t>(sourceWidth) * destHeight > static_cast<std::int64_t>(sourceHeight) * destWidth)
+	{
+		height = std::max(1, MulDivRound(sourceHeight, static_cast<unsigned>(destWidth), static_cast<unsigned>(sourceWidth)));
+	}
+	else
+	{
+		width = std::max(1, MulDivRound(sourceWidth, static_cast<unsigned>(destHeight), static_cast<unsigned>(sourceHeight)));
+	}
+
+	const int left = destination.Left + ((destWidth - width) / 2);
+	const int top = destination.Top + ((destHeight - height) / 2);
+	return ScreenRect{ left, top, left + width, top + height };
+}
+
+ScreenRect WindowGeometry::MirrorSourceRect(const int windowWidth, const int windowHeight, const FrameMetrics& metrics, const FrameInsets& chromeCrop)
+{
+	const ScreenRect cropped
+	{
+		metrics.Client.Left + ScaleForDpi(chromeCrop.Left, metrics.Dpi),
+		metrics.Client.Top + ScaleForDpi(chromeCrop.Top, metrics.Dpi),
+		windowWidth - metrics.Client.Right - ScaleForDpi(chromeCrop.Right, metrics.Dpi),
+		windowHeight - metrics.Client.Bottom - ScaleForDpi(chromeCrop.Bottom, metrics.Dpi)
+	};
+
+	if (cropped.IsEmpty() || cropped.Left < 0 || cropped.Top < 0)
+	{
+		return ScreenRect{ 0, 0, windowWidth, windowHeight };
+	}
+
+	return cropped;
+}
+
+bool FrameMetricsCache::TryGet(const std::wstring& windowClass, const unsigned dpi, FrameMetrics& metrics) const
+{
+	const auto exact = entries_.find({ windowClass, dpi });
+	if (exact != entries_.end())
+	{
+		metrics = exact->second;
+		return true;
+	}
+
+	// Scale from the measurement at the nearest DPI.
+	const FrameMetrics* nearest = nullptr;
+	unsigned nearestDistance = 0;
+	for (auto it = entries_.lower_bound({ windowClass, 0 }); it != entries_.end() && it->first.first == windowClass; ++it)
+	{
+		const unsigned distance = it->first.second > dpi ? it->first.second - dpi : dpi - it->first.second;
+		if (nearest == nullptr || distance < nearestDistance)
+		{
+			nearest = &it->second;
+			nearestDistance = distance;
+		}
+	}
+
+	if (nearest == nullptr)
+	{
+		return false;
+	}
+
+	metrics = nearest->ScaledTo(dpi);
+	return true;
+}
+
+bool FrameMetricsCache::Contains(const std::wstring& windowClass, const unsigned dpi) const
+{
+	return entries_.find({ windowClass, dpi }) != entries_.end();
+}
+
+void FrameMetricsCache::Store(const std::wstring& windowClass, const FrameMetrics& metrics)
+{
+	entries_[{ windowClass, metrics.Dpi }] = metrics;
+}
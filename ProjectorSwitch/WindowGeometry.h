@@ -0,0 +1,115 @@
+#pragma once
+#include <map>
+#include <string>
+#include <utility>
+
+// Screen rectangle in physical pixels (same convention as RECT: right/bottom exclusive).
+struct ScreenRect
+{
+	int Left = 0;
+	int Top = 0;
+	int Right = 0;
+	int Bottom = 0;
+
+	int Width() const { return Right - Left; }
+	int Height() const { return Bottom - Top; }
+	bool IsEmpty() const { return Right <= Left || Bottom <= Top; }
+
+	bool operator==(const ScreenRect& other) const = default;
+};
+
+// Distance from each edge of a window rect inwards to an inner rect.
+struct FrameInsets
+{
+	int Left = 0;
+	int Top = 0;
+	int Right = 0;
+	int Bottom = 0;
+
+	bool operator==(const FrameInsets& other) const = default;
+};
+
+// Non-client frame sizes of a window at a given DPI.
+struct FrameMetrics
+{
+	static constexpr unsigned BaseDpi = 96;
+
+	FrameInsets Client;    // window rect to client area (borders, caption)
+	FrameInsets Invisible; // window rect to the visible frame (DWM resize borders)
+	unsigned Dpi = BaseDpi;
+
+	// Derives the metrics from a window rect, its client rect (in screen
+	// coordinates) and its visible frame (DWMWA_EXTENDED_FRAME_BOUNDS).
+	static FrameMetrics Measure(const ScreenRect& windowRect, const ScreenRect& clientRect,
+		const ScreenRect& visibleFrame, unsigned dpi);
+
+	// Scales the metrics to another DPI (frames scale with DPI under per-monitor v2).
+	FrameMetrics ScaledTo(unsigned dpi) const;
+
+	bool operator==(const FrameMetrics& other) const = default;
+};
+
+/// <summary>
+/// Side-effect-free target and restore rect calculations for the media window.
+/// Portable (no Windows dependencies).
+/// </summary>
+class WindowGeometry
+{
+public:
+	// Fallback restore rect (at 96 DPI), used when the original position is unknown.
+	static constexpr int RestoreMargin = 10;
+	static constexpr int RestoreWidth = 450;
+	static constexpr int RestoreHeight = 300;
+
+	// Window rect that makes the client area exactly cover the monitor rect,
+	// with borders and caption outside it.
+	static ScreenRect TargetRect(const ScreenRect& monitorRect, const FrameMetrics& metrics);
+
+	// Window rect whose visible frame sits RestoreMargin inside the top-left of
+	// the work area, clipped to the work area where it is smaller than the fallback size.
+	static ScreenRect FallbackRestoreRect(const ScreenRect& workArea, const FrameMetrics& metrics);
+
+	// The visible part of a window with the given window rect.
+	static ScreenRect VisibleRect(const ScreenRect& windowRect, const FrameMetrics& metrics);
+
+	// The rect the system suggests (WM_DPICHANGED) when a window at fromDpi is
+	// moved onto a toDpi monitor: the top-left is kept and the size scaled.
+	static ScreenRect SuggestedRectAfterDpiChange(const ScreenRect& windowRect, unsigned fromDpi, unsigned toDpi);
+
+	// The rect to pass to SetWindowPos when moving a window from fromDpi to toDpi
+	// so that the suggested rect, which a per-monitor aware app applies itself, is
+	// exactly targetRect (a single resize at the new DPI).
+	static ScreenRect PrecompensateForDpiChange(const ScreenRect& targetRect, unsigned fromDpi, unsigned toDpi);
+
+	// The largest rect with the source's aspect ratio that fits in destination, centered.
+	static ScreenRect AspectFit(int sourceWidth, int sourceHeight, const ScreenRect& destination);
+
+	// The part of a window (in window coordinates, origin at its top-left) to mirror: the
+	// client area less chromeCrop (given at 96 DPI, e.g. a toolbar), or the whole window
+	// if nothing would be left.
+	static ScreenRect MirrorSourceRect(int windowWidth, int windowHeight, const FrameMetrics& metrics, const FrameInsets& chromeCrop);
+
+	static int ScaleForDpi(int value, unsigned dpi);
+};
+
+/// <summary>
+/// Frame metrics measured once per window class and DPI. Lookups for a DPI that
+/// has not been measured are scaled from another measurement of the same class.
+/// Portable (no Windows dependencies).
+/// </summary>
+class FrameMetricsCache
+{
+private:
+	std::map<std::pair<std::wstring, unsigned>, FrameMetrics> entries_;
+
+public:
+	// True if metrics for the class are known, exactly or scaled from another DPI.
+	bool TryGet(const std::wstring& windowClass, unsigned dpi, FrameMetrics& metrics) const;
+
+	// True only if metrics were measured at exactly this DPI.
+	bool Contains(const std::wstring& windowClass, unsigned dpi) const;
+
+	void Store(const std::wstring& windowClass, const FrameMetrics& metrics);
+
+	void Clear() { entries_.clear(); }
+};
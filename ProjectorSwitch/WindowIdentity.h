@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// What identifies a window across processes: a handle alone may be reused once
+// the window is destroyed, so it is qualified by its owning process.
+struct WindowIdentity
+{
+	std::uint64_t WindowHandle = 0;
+	std::uint32_t ProcessId = 0;        // 0 if the window no longer exists
+	std::uint64_t ProcessStartTime = 0; // FILETIME ticks; distinguishes a reused process id
+	std::wstring ClassName;
+};
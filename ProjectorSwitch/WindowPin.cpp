@@ -0,0 +1,138 @@
+#include "WindowPin.h"
+#include "FlightRecorder.h"
+
+namespace
+{
+	// A frame at 60 Hz: long enough for a burst of changes to finish, short enough not to be seen.
+	constexpr UINT CorrectionDelayMs = 16;
+
+	ScreenRect CurrentRect(const HWND window)
+	{
+		RECT rect{};
+		GetWindowRect(window, &rect);
+		return ScreenRect{ rect.left, rect.top, rect.right, rect.bottom };
+	}
+}
+
+WindowPin::WindowPin(const HWND window, const RECT& target)
+	: window_(window)
+	, locationHook_(nullptr)
+	, moveSizeHook_(nullptr)
+	, correctionTimer_(0)
+	, policy_(ScreenRect{ target.left, target.top, target.right, target.bottom })
+{
+	DWORD processId = 0;
+	const DWORD threadId = GetWindowThreadProcessId(window, &processId);
+	if (threadId == 0)
+	{
+		return;
+	}
+
+	locationHook_ = SetWinEventHook(
+		EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE,
+		nullptr, OnWinEvent, processId, threadId,
+		WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+	moveSizeHook_ = SetWinEventHook(
+		EVENT_SYSTEM_MOVESIZESTART, EVENT_SYSTEM_MOVESIZEEND,
+		nullptr, OnWinEvent, processId, threadId,
+		WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+
+	// One pin at a time: a new one replaces the previous.
+	current_ = this;
+}
+
+WindowPin::~WindowPin()
+{
+	Unhook();
+	if (current_ == this)
+	{
+		current_ = nullptr;
+	}
+}
+
+void WindowPin::Unhook()
+{
+	if (correctionTimer_ != 0)
+	{
+		KillTimer(nullptr, correctionTimer_);
+		correctionTimer_ = 0;
+	}
+
+	if (locationHook_ != nullptr)
+	{
+		UnhookWinEvent(locationHook_);
+		locationHook_ = nullptr;
+	}
+
+	if (moveSizeHook_ != nullptr)
+	{
+		UnhookWinEvent(moveSizeHook_);
+		moveSizeHook_ = nullptr;
+	}
+}
+
+void CALLBACK WindowPin::OnWinEvent(HWINEVENTHOOK /*hook*/, const DWORD event, const HWND hwnd,
+	const LONG idObject, const LONG idChild, DWORD /*eventThread*/, DWORD /*eventTime*/)
+{
+	WindowPin* pin = current_;
+	if (pin == nullptr || hwnd != pin->window_ || idObject != OBJID_WINDOW || idChild != CHILDID_SELF)
+	{
+		return;
+	}
+
+	if (event == EVENT_SYSTEM_MOVESIZESTART || event == EVENT_SYSTEM_MOVESIZEEND)
+	{
+		if (pin->policy_.OnUserMoveSize(event == EVENT_SYSTEM_MOVESIZESTART) == PinAction::Unpin)
+		{
+			pin->Unhook();
+		}
+		return;
+	}
+
+	// A correction already scheduled covers this change too.
+	if (pin->correctionTimer_ != 0)
+	{
+		return;
+	}
+
+	const auto now = PinPolicy::Clock::now();
+	if (pin->policy_.OnLocationChange(CurrentRect(hwnd), IsIconic(hwnd) != FALSE, now) == PinAction::Correct)
+	{
+		pin->driftSeen_ = now;
+		pin->correctionTimer_ = SetTimer(nullptr, 0, CorrectionDelayMs, OnCorrectionTimer);
+		if (pin->correctionTimer_ == 0)
+		{
+			pin->Correct();
+		}
+	}
+}
+
+void CALLBACK WindowPin::OnCorrectionTimer(HWND /*hwnd*/, UINT /*message*/, const UINT_PTR id, DWORD /*time*/)
+{
+	KillTimer(nullptr, id);
+	WindowPin* pin = current_;
+	if (pin == nullptr || pin->correctionTimer_ != id)
+	{
+		return;
+	}
+
+	pin->correctionTimer_ = 0;
+	pin->Correct();
+}
+
+/// <summary>
+/// Moves the window back to the target. The move is asynchronous so a hung
+/// application cannot block this thread.
+/// </summary>
+void WindowPin::Correct()
+{
+	const ScreenRect& target = policy_.Target();
+	const BOOL ok = SetWindowPos(window_, nullptr, target.Left, target.Top, target.Width(), target.Height(),
+		SWP_NOZORDER | SWP_NOOWNERZORDER | SWP_NOACTIVATE | SWP_ASYNCWINDOWPOS);
+
+	const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(PinPolicy::Clock::now() - driftSeen_);
+	policy_.OnCorrected(latency);
+	FlightRecorder::Instance().Record(FlightEventKind::PinCorrection, ok ? 1 : 0,
+		static_cast<std::int64_t>(reinterpret_cast<std::intptr_t>(window_)), latency.count(),
+		static_cast<std::int64_t>(policy_.Stats().Backoffs));
+}
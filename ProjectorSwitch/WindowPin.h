@@ -0,0 +1,37 @@
+#pragma once
+#include <windows.h>
+#include "PinPolicy.h"
+
+/// <summary>
+/// Keeps a window (in another process) at a target rectangle while in scope. Out-of-
+/// context WinEvent hooks report its location changes and the user's moves; drift
+/// is corrected by a one-shot timer a frame later, so a burst of changes costs one
+/// correction. Nothing polls: hooks and timer are delivered while the thread that
+/// created the pin pumps messages.
+/// </summary>
+class WindowPin  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+private:
+	static inline WindowPin* current_ = nullptr;
+
+	HWND window_;
+	HWINEVENTHOOK locationHook_;
+	HWINEVENTHOOK moveSizeHook_;
+	UINT_PTR correctionTimer_;
+	PinPolicy policy_;
+	PinPolicy::Clock::time_point driftSeen_;
+
+	static void CALLBACK OnWinEvent(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+		LONG idObject, LONG idChild, DWORD eventThread, DWORD eventTime);
+	static void CALLBACK OnCorrectionTimer(HWND hwnd, UINT message, UINT_PTR id, DWORD time);
+
+	void Correct();
+	void Unhook();
+
+public:
+	WindowPin(HWND window, const RECT& target);
+	~WindowPin();
+
+	bool IsPinned() const { return policy_.IsPinned() && locationHook_ != nullptr; }
+	const PinStats& Stats() const { return policy_.Stats(); }
+};
@@ -0,0 +1,103 @@
+#include "WindowTransition.h"
+
+void WindowTransition::Begin(PlatformBackend& platform, const PlatformWindow window)
+{
+	platform.SetTransitionsDisabled(window, true);
+}
+
+unsigned WindowTransition::RestoreFromMinimized(PlatformBackend& platform, const PlatformWindow window)
+{
+	platform.Restore(window);
+
+	unsigned waited = 0;
+	while (platform.IsMinimized(window) && waited < MaxRestoreWaitMs)
+	{
+		platform.SleepMs(FadeStepMs);
+		waited += FadeStepMs;
+	}
+
+	return waited;
+}
+
+WindowTransitionState WindowTransition::Conceal(PlatformBackend& platform, const PlatformWindow window)
+{
+	WindowTransitionState state;
+	state.Window = window;
+	state.Cloaked = platform.SetCloaked(window, true);
+
+	if (!state.Cloaked)
+	{
+		platform.Hide(window);
+	}
+
+	return state;
+}
+
+void WindowTransition::PrepareFadeIn(PlatformBackend& platform, WindowTransitionState& state)
+{
+	state.HadLayered = platform.HasLayeredStyle(state.Window);
+	if (!state.HadLayered)
+	{
+		platform.SetLayeredStyle(state.Window, true);
+	}
+
+	// If the alpha cannot be set, the window is still shown, just without a fade.
+	state.AlphaOk = platform.SetWindowAlpha(state.Window, 0);
+}
+
+void WindowTransition::Reveal(PlatformBackend& platform, const WindowTransitionState& state)
+{
+	if (state.Cloaked)
+	{
+		platform.SetCloaked(state.Window, false);
+	}
+
+	platform.Show(state.Window);
+}
+
+int WindowTransition::FadeIn(PlatformBackend& platform, const std::vector<WindowTransitionState>& states)
+{
+	const std::uint64_t start = platform.TickMs();
+	std::uint8_t alpha;
+	int fadeSteps = 0;
+
+	do
+	{
+		const std::uint64_t elapsed = platform.TickMs() - start;
+		const std::uint64_t scaled = (elapsed >= FadeDurationMs) ? 255 : (elapsed * 255u) / FadeDurationMs;
+		alpha = static_cast<std::uint8_t>(scaled);
+		for (const auto& state : states)
+		{
+			if (state.AlphaOk)
+			{
+				platform.SetWindowAlpha(state.Window, alpha);
+			}
+		}
+
+		++fadeSteps;
+		if (alpha < 255)
+		{
+			platform.SleepMs(FadeStepMs); // yield a bit for smoothness
+		}
+	} while (alpha < 255);
+
+	// Return windows to their original style if we added the layered style.
+	for (const auto& state : states)
+	{
+		if (state.AlphaOk && !state.HadLayered)
+		{
+			// Ensure fully opaque before removing the layered style.
+			platform.SetWindowAlpha(state.Window, 255);
+			platform.SetLayeredStyle(state.Window, false);
+		}
+	}
+
+	return fadeSteps;
+}
+
+void WindowTransition::End(PlatformBackend& platform, const PlatformWindow window)
+{
+	// Ensure a clean repaint after showing.
+	platform.Redraw(window);
+	platform.SetTransitionsDisabled(window, false);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "PlatformBackend.h"
+
+// A window being concealed, moved and faded back in.
+struct WindowTransitionState
+{
+	PlatformWindow Window = 0;
+	bool Cloaked = false;   // false if it was hidden instead (cloaking unavailable)
+	bool HadLayered = false; // already had the layered style before PrepareFadeIn
+	bool AlphaOk = false;   // alpha was set to 0, so it can be faded in
+};
+
+/// <summary>
+/// Cloak-move-fade steps shared by the media window toggle and scenes, so that
+/// windows are never seen mid-move. Several windows can be faded in together.
+/// Portable (no Windows dependencies).
+/// </summary>
+class WindowTransition
+{
+public:
+	static constexpr unsigned FadeDurationMs = 300;
+	static constexpr unsigned FadeStepMs = 10;
+	static constexpr unsigned MaxRestoreWaitMs = 500;
+
+	// Disables DWM min/restore/max animations during our own animation.
+	static void Begin(PlatformBackend& platform, PlatformWindow window);
+
+	// Restores a minimized window and waits briefly for it to leave the iconic state.
+	// Returns the time waited in milliseconds.
+	static unsigned RestoreFromMinimized(PlatformBackend& platform, PlatformWindow window);
+
+	// Cloaks the window (Win8+), or hides it if cloaking is unavailable.
+	static WindowTransitionState Conceal(PlatformBackend& platform, PlatformWindow window);
+
+	// Temporarily applies the layered style with alpha 0.
+	static void PrepareFadeIn(PlatformBackend& platform, WindowTransitionState& state);
+
+	// Uncloaks or shows the window (still transparent if PrepareFadeIn succeeded).
+	static void Reveal(PlatformBackend& platform, const WindowTransitionState& state);
+
+	// Animates the windows (those with AlphaOk) to full opacity together and
+	// restores their original style. Returns the number of steps.
+	static int FadeIn(PlatformBackend& platform, const std::vector<WindowTransitionState>& states);
+
+	// Repaints the window and re-enables DWM transitions.
+	static void End(PlatformBackend& platform, PlatformWindow window);
+};
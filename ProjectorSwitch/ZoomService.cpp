@@ -1,29 +1,92 @@
+#include <utility>
+#include <filesystem>
+#include <fstream>
 #include <atlbase.h>
-#include <dwmapi.h>
-#pragma comment(lib, "Dwmapi.lib")  // link DWM
+#include <ShellScalingApi.h>
+#pragma comment(lib, "Shcore.lib")  // GetDpiForMonitor
 #include "ZoomService.h"
 #include "SettingsService.h"
 #include "MonitorService.h"
-#include "AutomationConditionWrapper.h"
-#include "VariantWrapper.h"
+#include "ProcessesService.h"
+#include "Win32PlatformBackend.h"
+#include "TraceRecorder.h"
+#include "Stopwatch.h"
+#include "FlightRecorder.h"
+#include "CompositionClock.h"
+#include "SessionJournal.h"
 
 namespace
 {
-	const std::wstring ZoomProcessName = L"Zoom.exe";
+	const std::wstring SessionJournalFileName = L"session.bin";
+
+	std::int64_t HandleValue(const HWND hwnd)
+	{
+		return static_cast<std::int64_t>(reinterpret_cast<std::intptr_t>(hwnd));
+	}
+
+	ScreenRect ToScreenRect(const RECT& rect)
+	{
+		return ScreenRect{ rect.left, rect.top, rect.right, rect.bottom };
+	}
+
+	RECT ToRect(const ScreenRect& rect)
+	{
+		return RECT{ rect.Left, rect.Top, rect.Right, rect.Bottom };
+	}
+
+	std::uint64_t WindowId(const HWND hwnd)
+	{
+		return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(hwnd));
+	}
+
+	HWND WindowFromId(const std::uint64_t id)
+	{
+		return reinterpret_cast<HWND>(static_cast<std::uintptr_t>(id)); // NOLINT(performance-no-int-to-ptr)
+	}
+
+	/// <summary>
+	/// The built-in Zoom provider plus those defined in settings, in the precedence of
+	/// the Providers setting. Only process names are read here.
+	/// </summary>
+	ProviderRegistry LoadProviders()
+	{
+		const SettingsService settings;
+		ProviderRegistry providers;
+		providers.Add(ProviderRegistry::Zoom());
+
+		const std::vector<std::wstring> names = settings.LoadProviderNames();
+		for (const auto& name : names)
+		{
+			std::vector<std::wstring> processes = settings.LoadProviderProcesses(name);
+			if (!processes.empty())
+			{
+				providers.Add(MediaWindowProvider{ name, std::move(processes), [name] { return SettingsService().LoadProviderSelectors(name); } });
+			}
+		}
+
+		providers.Prioritize(names);
+		return providers;
+	}
 }
 
 /// <summary>
 /// Constructs a ZoomService object and initializes its member variables.
 /// </summary>
-/// <param name="automationService">Pointer to an AutomationService instance used by the ZoomService.</param>
-/// <param name="processesService">Pointer to a ProcessesService instance used by the ZoomService.</param>
-ZoomService::ZoomService(AutomationService* automationService, ProcessesService *processesService)
-	: mediaWindowOriginalPosition_({ 0,0,0,0 })
-	, mediaWindowWasMinimized_(false)
-	, cachedDesktopWindow_(nullptr)
+/// <param name="automationService">Pointer to an AutomationService instance used by the ZoomService (owned).</param>
+/// <param name="platform">The platform calls made by toggles (Win32PlatformBackend, over automationService).</param>
+ZoomService::ZoomService(AutomationService* automationService, std::unique_ptr<PlatformBackend> platform)
+	: journal_(std::make_unique<MappedFile>(SettingsService().GetSiblingFilePath(SessionJournalFileName), SessionJournal::Size))
 	, automationService_(automationService)
-	, processesService_(processesService)	
-{	
+	, platform_(std::move(platform))
+	, providers_(LoadProviders())
+	, toggle_(*platform_, providers_, this)
+	, mirrorCompositor_(std::make_unique<DwmThumbnailCompositor>([this] { RefreshMirror(); }))
+	, mirror_(mirrorCompositor_.get())
+	, pinToProjector_(SettingsService().LoadPinToProjector())
+	, warmStartValidity_(CacheValidity::Empty)
+	, displayedWindow_(nullptr)
+	, displayedRect_({ 0,0,0,0 })
+{
 }
 
 /// <summary>
@@ -31,23 +94,17 @@ ZoomService::ZoomService(AutomationService* automationService, ProcessesService
 /// </summary>
 ZoomService::~ZoomService()
 {
-	if (cachedDesktopWindow_ != nullptr)
-	{
-		cachedDesktopWindow_->Release();
-		cachedDesktopWindow_ = nullptr;
-	}
+	pin_.reset();
+	shareWatcher_.reset();
+
+	// Holds UI Automation elements, released before the AutomationService that created them.
+	platform_.reset();
 
 	if (automationService_ != nullptr)
 	{
 		delete automationService_;
 		automationService_ = nullptr;
 	}
-
-	if (processesService_ != nullptr)
-	{
-		delete processesService_;
-		processesService_ = nullptr;
-	}
 }
 
 /// <summary>
@@ -56,575 +113,647 @@ ZoomService::~ZoomService()
 /// </summary>
 /// <returns>
 /// A DisplayWindowResult object indicating whether the operation was successful
-/// and containing an error message if it failed.
+/// and containing an error message if it failed, plus stage timings and the
+/// fallback paths taken.
 /// </returns>
 DisplayWindowResult ZoomService::Toggle()
 {
-	DisplayWindowResult result;
-
-	const FindWindowsResult findWindowsResult = FindMediaWindow();
-
-	if (!findWindowsResult.BespokeErrorMsg.empty())
+	// While a share is being followed, the operator's toggle undoes that instead.
+	if (shareFollow_ && shareFollow_->IsFollowing())
 	{
-		result.AllOk = false;
-		result.ErrorMessage = findWindowsResult.BespokeErrorMsg;
-		return result;
+		return DismissShare();
 	}
 
-	if (!findWindowsResult.IsRunning)
-	{
-		result.AllOk = false;
-		result.ErrorMessage = L"Zoom is not running!";
-		return result;
-	}
+	return ToggleMediaWindow();
+}
 
-	if (findWindowsResult.Element == nullptr || !findWindowsResult.FoundMediaWindow)
-	{
-		result.AllOk = false;
-		result.ErrorMessage = L"Could not find Zoom media window!";
-		return result;
-	}
+/// <summary>
+/// Toggles the media window (between its place and the projector), timing and
+/// recording the toggle.
+/// </summary>
+DisplayWindowResult ZoomService::ToggleMediaWindow()
+{
+	TRACE_ZONE("ZoomService::Toggle");
+	auto& flightRecorder = FlightRecorder::Instance();
+	flightRecorder.Record(FlightEventKind::ToggleBegin);
 
-	const auto mediaMonitorRect = GetTargetMonitorRect();
-	if (IsRectEmpty(&mediaMonitorRect))
+	const Stopwatch toggleClock;
+	DisplayWindowResult result;
 	{
-		result.AllOk = false;
-		result.ErrorMessage = L"Could not find target monitor!";
-		return result;
+		const CallCountScope callScope(result.Calls);
+		InternalToggle(result);
 	}
+	result.Timings.TotalUs = toggleClock.ElapsedMicroseconds();
 
-	UIA_HWND uiaHwnd{};
-	const HRESULT hrNativeHwnd = findWindowsResult.Element->get_CurrentNativeWindowHandle(&uiaHwnd);
-	if (FAILED(hrNativeHwnd) || uiaHwnd == nullptr)
+	flightRecorder.Record(FlightEventKind::ToggleEnd, static_cast<std::int32_t>(result.Error),
+		result.AllOk ? 1 : 0, result.Timings.TotalUs, result.Fallbacks);
+	return result;
+}
+
+bool ZoomService::IsProviderRunning()
+{
+	return !LoadProviders().Resolve(ProcessesService().GetProcessNames()).empty();
+}
+
+/// <summary>
+/// Performs the toggle, recording the outcome, timings and fallbacks in result.
+/// </summary>
+void ZoomService::InternalToggle(DisplayWindowResult& result)
+{
+	// Any toggle ends the pin: it sends the window back, or moves (and pins) it again.
+	EndPin();
+
+	// Whatever the mode now, a running mirror is toggled off without looking for the window.
+	if (mirror_.IsActive())
 	{
-		result.AllOk = false;
-		result.ErrorMessage = L"Could not get native window handle for Zoom media window.";
-		return result;
+		StopMirror();
+		result.Placement = MediaWindowPlacement::Restored;
+		result.AllOk = true;
+		return;
 	}
-	const HWND hwnd = static_cast<HWND>(uiaHwnd);
-	if (!IsWindow(hwnd))
+
+	toggle_.Run(result);
+}
+
+/// <summary>
+/// Mirrors the media window onto the target monitor with a DWM thumbnail, leaving the
+/// window itself where it is.
+/// </summary>
+/// <param name="window">The media window.</param>
+/// <param name="monitorRect">The target monitor rectangle.</param>
+/// <param name="result">Receives the outcome.</param>
+void ZoomService::Mirror(const PlatformWindow window, const ScreenRect& monitorRect, DisplayWindowResult& result)
+{
+	TRACE_ZONE("ZoomService::Mirror");
+
+	// A minimized window has no content to mirror.
+	if (platform_->IsMinimized(window))
 	{
-		result.AllOk = false;
-		result.ErrorMessage = L"Native window handle is not a valid window.";
-		return result;
+		result.Fallbacks |= ToggleFallbackRestoredFromMinimized;
+		WindowTransition::RestoreFromMinimized(*platform_, window);
 	}
 
-	RECT mediaWindowPos;
-	const HRESULT hrRect = findWindowsResult.Element->get_CurrentBoundingRectangle(&mediaWindowPos);
-	if (FAILED(hrRect))
+	const Stopwatch moveClock;
+	const bool started = mirror_.Start(
+		window,
+		monitorRect,
+		platform_->WindowFrameMetrics(window, platform_->WindowDpi(window)),
+		platform_->LoadMirrorCrop());
+	result.Timings.MoveUs = moveClock.ElapsedMicroseconds();
+
+	FlightRecorder::Instance().Record(FlightEventKind::Mirror, started ? 1 : 0, static_cast<std::int64_t>(window), 1, mirror_.Updates());
+	if (!started)
 	{
-		result.AllOk = false;
-		result.ErrorMessage = L"Could not get position of Zoom media window.";
-		return result;
+		result.Fail(DisplayWindowError::MirrorUnavailable, L"Could not mirror the Zoom media window.");
+		return;
 	}
 
-	const RECT targetRect = CalculateTargetRect(mediaMonitorRect, hwnd);
+	result.OpaqueQpc = platform_->CompositionNow();
+	result.Placement = MediaWindowPlacement::Mirrored;
+	result.AllOk = true;
+}
 
-	if (EqualRect(&targetRect, &mediaWindowPos))
+/// <summary>
+/// Called periodically while mirroring: re-fits the thumbnail when the media window
+/// is resized or changes DPI, and stops mirroring when it closes.
+/// </summary>
+void ZoomService::RefreshMirror()
+{
+	const PlatformWindow source = mirror_.Source();
+	if (!platform_->IsWindow(source) || !mirror_.Refresh(platform_->WindowFrameMetrics(source, platform_->WindowDpi(source))))
 	{
-		// already displayed
-		InternalHide(hwnd);
+		StopMirror();
 	}
-	else
+}
+
+/// <summary>
+/// Ends the pin on the media window, if any, keeping its statistics for TakeEndedPinStats.
+/// </summary>
+void ZoomService::EndPin()
+{
+	if (pin_)
 	{
-		mediaWindowWasMinimized_ = IsIconic(hwnd) != FALSE;
-		mediaWindowOriginalPosition_ = mediaWindowPos;
-		InternalDisplay(hwnd, targetRect);
+		endedPinStats_ = std::make_unique<PinStats>(pin_->Stats());
+		pin_.reset();
 	}
-
-	return result;
 }
 
 /// <summary>
-/// Retrieves the rectangle of the primary monitor, preferring the work area if available.
+/// Whether the media window is where the last toggle put it on the projector (from
+/// the window itself; no UI Automation).
 /// </summary>
-/// <returns>
-/// A RECT structure representing the work area of the primary monitor if it is not empty;
-/// otherwise, the full monitor rectangle. Returns an empty RECT if no primary monitor
-/// is found.
-/// </returns>
-RECT ZoomService::GetPrimaryMonitorRect()
+bool ZoomService::IsMediaOnProjector() const
 {
-	constexpr MonitorService monitorService;
+	RECT current{};
+	return displayedWindow_ != nullptr && IsWindow(displayedWindow_) && GetWindowRect(displayedWindow_, &current) &&
+		EqualRect(&current, &displayedRect_);
+}
 
-	const std::vector<MonitorData> monitorData = monitorService.GetMonitorsData();
-	for (auto& i : monitorData)
+bool ZoomService::TakeEndedPinStats(PinStats& stats)
+{
+	if (!endedPinStats_)
 	{
-		if (i.IsPrimary)
-		{
-			if (IsRectEmpty(&i.WorkRect))
-			{
-				return i.MonitorRect;
-			}
-
-			return i.WorkRect;
-		}
+		return false;
 	}
 
-	return RECT{};
+	stats = *endedPinStats_;
+	endedPinStats_.reset();
+	return true;
 }
 
+void ZoomService::StopMirror()
+{
+	const std::uint64_t source = mirror_.Source();
+	mirror_.Stop();
+	FlightRecorder::Instance().Record(FlightEventKind::Mirror, 1, static_cast<std::int64_t>(source), 0, mirror_.Updates());
+}
+
+
 /// <summary>
-/// Calculates the target rectangle for a media window by adjusting the given monitor rectangle
-/// to account for the window's non-client borders.
+/// The media window is about to be sent back: if it was moved by another process (or
+/// before a restart), its journal says where from; a holding slide is put behind it.
 /// </summary>
-/// <param name="mediaMonitorRect">The rectangle representing the area of the monitor where
-/// the media window is displayed.</param>
-/// <param name="mediaWindowHandle">The handle to the media window whose borders are to
-/// be considered.</param>
-/// <returns>
-/// A RECT structure representing the adjusted rectangle that includes the window's borders.
-/// </returns>
-RECT ZoomService::CalculateTargetRect(const RECT mediaMonitorRect, const HWND mediaWindowHandle)
+void ZoomService::OnSendingBack(const PlatformWindow window, const ScreenRect& monitorRect, SendBackPlacement& placement)
 {
-	RECT mediaWindowClientRect;
-	GetClientRect(mediaWindowHandle, &mediaWindowClientRect);
+	const HWND hwnd = Win32PlatformBackend::ToHandle(window);
+	if (placement.Rect.IsEmpty())
+	{
+		AdoptJournaledPlacement(hwnd, placement);
+	}
 
-	RECT mediaWindowRect;
-	GetWindowRect(mediaWindowHandle, &mediaWindowRect);
+	if (holdingSlide_)
+	{
+		// Uncovered (instead of the desktop) as the media window leaves.
+		holdingSlide_->ShowBelow(hwnd, monitorRect);
+	}
+}
 
-	const auto clientWidth = mediaWindowClientRect.right - mediaWindowClientRect.left;
-	const auto clientHeight = mediaWindowClientRect.bottom - mediaWindowClientRect.top;
+void ZoomService::OnSentBack(const PlatformWindow window, const SendBackPlacement& placement)
+{
+	JournalPlacement(Win32PlatformBackend::ToHandle(window), placement, false);
+	displayedWindow_ = nullptr;
+}
 
-	const auto windowWidth = mediaWindowRect.right - mediaWindowRect.left;
-	const auto windowHeight = mediaWindowRect.bottom - mediaWindowRect.top;
+void ZoomService::OnDisplaying(const PlatformWindow window, const SendBackPlacement& placement)
+{
+	JournalPlacement(Win32PlatformBackend::ToHandle(window), placement, true);
+}
 
-	const auto xBorder = (windowWidth - clientWidth) / 2;
-	const auto yBorder = (windowHeight - clientHeight) / 2;
+void ZoomService::OnDisplayed(const PlatformWindow window, const ScreenRect& targetRect)
+{
+	if (holdingSlide_)
+	{
+		// Only now that the media window has faded in over it.
+		holdingSlide_->Hide();
+	}
 
-	const RECT result
+	displayedWindow_ = Win32PlatformBackend::ToHandle(window);
+	displayedRect_ = ToRect(targetRect);
+	if (pinToProjector_)
 	{
-		mediaMonitorRect.left - xBorder,
-		mediaMonitorRect.top - yBorder,
-		mediaMonitorRect.right + (xBorder * 2),
-		mediaMonitorRect.bottom + (yBorder * 2)
-	};
+		pin_ = std::make_unique<WindowPin>(displayedWindow_, displayedRect_);
+	}
+}
 
-	return result;
+void ZoomService::OnToggled(const PlatformWindow window, const std::uint32_t fallbacks)
+{
+	SaveWarmStart(Win32PlatformBackend::ToHandle(window), fallbacks);
 }
 
 /// <summary>
-/// Hides or repositions the specified window, ensuring it is placed at a suitable location
-/// if its original position is not set.
+/// Starts decoding and scaling the configured holding slide for the target monitor, so
+/// the first send-back only has to show it.
 /// </summary>
-/// <param name="windowHandle">Handle to the window to be hidden or repositioned.</param>
-void ZoomService::InternalHide(const HWND windowHandle)
+void ZoomService::EnableHoldingSlide()
 {
-	// If it was originally minimized, minimize again, but make sure its normal position is on the primary monitor.
-	if (mediaWindowWasMinimized_)
+	const std::wstring slide = SettingsService().LoadHoldingSlide();
+	if (slide.empty())
 	{
-		// Place the window's normal (restore) position on the primary monitor so future restores happen there.
-		const RECT primaryMonitorRect = GetPrimaryMonitorRect();
-
-		RECT restoreRect{};
-		restoreRect.left = primaryMonitorRect.left + 10;
-		restoreRect.top = primaryMonitorRect.top + 10;
-		restoreRect.right = restoreRect.left + 450;
-		restoreRect.bottom = restoreRect.top + 300;
+		holdingSlide_.reset();
+		return;
+	}
 
-		WINDOWPLACEMENT wp{};
-		wp.length = sizeof(wp);
-		if (GetWindowPlacement(windowHandle, &wp))
-		{
-			wp.showCmd = SW_SHOWNORMAL;               // define where it should restore to
-			wp.rcNormalPosition = restoreRect;             // set restore rect on primary
-			SetWindowPlacement(windowHandle, &wp);
-		}
+	std::uint32_t color = 0;
+	const bool isColor = HoldingSlide::ParseColor(slide, color);
+	holdingSlide_ = std::make_unique<HoldingSlideWindow>(isColor ? std::wstring() : slide, color, platform_->LoadTargetMonitorRect());
+}
 
-		// Drop out of topmost band before minimizing.
-		SetWindowPos(
-			windowHandle,
-			HWND_NOTOPMOST,
-			0, 0, 0, 0,
-			SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE | SWP_NOSENDCHANGING);
+/// <summary>
+/// Subscribes to the share-viewing window opening and closing, if ShareFollow is set.
+/// </summary>
+void ZoomService::EnableShareFollow(EventReactor& reactor, ShareFollowCallback callback)
+{
+	shareWatcher_.reset();
+	shareFollow_.reset();
 
-		ShowWindowAsync(windowHandle, SW_MINIMIZE);
-		mediaWindowWasMinimized_ = false;
+	ShareFollowOptions options;
+	const SettingsService settings;
+	if (automationService_ == nullptr || !settings.LoadShareFollow(options))
+	{
 		return;
 	}
 
-	SetForegroundWindow(windowHandle);
+	shareFollow_ = std::make_unique<ShareFollowPolicy>(options);
+	shareFollowed_ = std::move(callback);
+	shareWatcher_ = std::make_unique<ShareWindowWatcher>(reactor,
+		automationService_->GetAutomationInterface(), automationService_->DesktopElement(),
+		settings.LoadShareWindowSelectors(),
+		[this](const HWND window, const std::int64_t eventQpc) { OnShareOpened(window, eventQpc); },
+		[this] { OnShareClosed(); });
+}
 
-	if (IsRectEmpty(&mediaWindowOriginalPosition_))
+void ZoomService::OnShareOpened(const HWND window, const std::int64_t eventQpc)
+{
+	TRACE_ZONE("ZoomService::OnShareOpened");
+	if (window == displayedWindow_ || !IsWindow(window))
 	{
-		// fabricate a suitable location on the primary monitor
-		const RECT primaryMonitorRect = GetPrimaryMonitorRect();
-
-		mediaWindowOriginalPosition_.left = primaryMonitorRect.left + 10;
-		mediaWindowOriginalPosition_.top = primaryMonitorRect.top + 10;
-		mediaWindowOriginalPosition_.right = mediaWindowOriginalPosition_.left + 450;
-		mediaWindowOriginalPosition_.bottom = mediaWindowOriginalPosition_.top + 300;
+		return;
 	}
 
-	SetWindowPos(
-		windowHandle,
-		HWND_NOTOPMOST,
-		mediaWindowOriginalPosition_.left,
-		mediaWindowOriginalPosition_.top,
-		mediaWindowOriginalPosition_.right - mediaWindowOriginalPosition_.left,
-		mediaWindowOriginalPosition_.bottom - mediaWindowOriginalPosition_.top,
-		SWP_NOCOPYBITS | SWP_NOSENDCHANGING | SWP_SHOWWINDOW);
+	const ShareFollowReport report = RunShareSteps(shareFollow_->OnShareOpened(WindowId(window), IsMediaOnProjector()), eventQpc);
+	if (shareFollowed_ && !report.Steps.IsEmpty())
+	{
+		shareFollowed_(report);
+	}
 }
 
 /// <summary>
-/// Force the specified window to the foreground, even if our process is not foreground. This
-/// helps to ensure the Zoom window is on top of all other windows, even if another
-/// topmost window has focus.
+/// Some window closed: if it was the share window being followed (it is gone or
+/// hidden), the share has ended.
 /// </summary>
-/// <param name="windowHandle"></param>
-void ZoomService::ForceZoomWindowForeground(const HWND windowHandle)
+void ZoomService::OnShareClosed()
 {
-	const HWND fg = GetForegroundWindow();
-	const DWORD thisThread = GetCurrentThreadId();
-	const DWORD fgThread = fg ? GetWindowThreadProcessId(fg, nullptr) : 0;
-	const DWORD targetThread = GetWindowThreadProcessId(windowHandle, nullptr);
-
-	struct AttachGuard  // NOLINT(cppcoreguidelines-special-member-functions)
+	const HWND shown = WindowFromId(shareFollow_->Shown());
+	if (shown == nullptr || (IsWindow(shown) && IsWindowVisible(shown)))
 	{
-		DWORD Current{};
-		DWORD ForegroundThread{};
-		DWORD TargetThread{};
-		bool AttachedForeground{ false };
-		bool AttachedTarget{ false };
-
-		~AttachGuard()
-		{
-			if (AttachedTarget)
-			{
-				AttachThreadInput(Current, TargetThread, FALSE);
-			}
+		return;
+	}
 
-			if (AttachedForeground)
-			{
-				AttachThreadInput(Current, ForegroundThread, FALSE);
-			}
-		}
-	} guard{ thisThread, fgThread, targetThread };
+	RunShareSteps(shareFollow_->OnShareClosed(WindowId(shown), ShareFollowPolicy::Clock::now()), 0);
+}
 
-	if (fgThread && (fgThread != thisThread))
+void ZoomService::OnShareSettle()
+{
+	const ShareFollowReport report = RunShareSteps(shareFollow_->OnSettle(ShareFollowPolicy::Clock::now()), 0);
+	if (shareFollowed_ && (report.Steps.ShowMedia || report.Steps.SendShareHome != 0))
 	{
-		guard.AttachedForeground = AttachThreadInput(thisThread, fgThread, TRUE) != FALSE;
+		shareFollowed_(report);
 	}
+}
 
-	if (targetThread && (targetThread != thisThread))
+/// <summary>
+/// Undoes the share being followed, as if it had ended, in place of a toggle.
+/// </summary>
+/// <returns>The media window's toggle if it was moved back; otherwise a result for where it is.</returns>
+DisplayWindowResult ZoomService::DismissShare()
+{
+	ShareFollowReport report = RunShareSteps(shareFollow_->OnOperatorToggle(), 0);
+	DisplayWindowResult result;
+	if (report.MediaToggled)
 	{
-		guard.AttachedTarget = AttachThreadInput(thisThread, targetThread, TRUE) != FALSE;
+		// Reported by the caller, as its toggle.
+		result = std::move(report.MediaToggle);
+		report.MediaToggled = false;
+		report.MediaToggle = DisplayWindowResult();
+	}
+	else
+	{
+		result.Placement = IsMediaOnProjector() ? MediaWindowPlacement::OnProjector : MediaWindowPlacement::Restored;
+		result.AllOk = true;
 	}
 
-	BringWindowToTop(windowHandle);
-	SetForegroundWindow(windowHandle);
-
-	// Assert z-order again without moving/sizing.
-	SetWindowPos(
-		windowHandle,
-		HWND_TOPMOST,
-		0, 0, 0, 0,
-		SWP_NOMOVE | SWP_NOSIZE | SWP_NOOWNERZORDER | SWP_NOSENDCHANGING);
+	if (shareFollowed_)
+	{
+		shareFollowed_(report);
+	}
+	return result;
 }
 
 /// <summary>
-/// Displays a window at a specified position and size with a smooth fade-in animation, handling DWM
-/// transitions and window cloaking for a seamless visual effect.
+/// Carries out the policy's steps: the share window first (it is what the audience
+/// is waiting for), then the media window, by toggling it.
 /// </summary>
-/// <param name="windowHandle">Handle to the window to be displayed and animated.</param>
-/// <param name="targetRect">The target rectangle specifying the desired position and size
-/// of the window, in screen coordinates.</param>
-void ZoomService::InternalDisplay(const HWND windowHandle, const RECT targetRect)
+ShareFollowReport ZoomService::RunShareSteps(const ShareFollowSteps& steps, const std::int64_t eventQpc)
 {
-	if (!IsWindow(windowHandle))
+	ShareFollowReport report;
+	report.Steps = steps;
+
+	if (steps.ShowShare != 0)
 	{
-		return;
+		ShowShareWindow(WindowFromId(steps.ShowShare), eventQpc, report);
 	}
 
-	const int width = targetRect.right - targetRect.left;
-	const int height = targetRect.bottom - targetRect.top;
-
-	// Disable DWM transitions (min/restore/max animations) during our manual animation.
-	BOOL disableTransitions = TRUE;
-	DwmSetWindowAttribute(windowHandle, DWMWA_TRANSITIONS_FORCEDISABLED, &disableTransitions, sizeof(disableTransitions));
-
-	// If minimized, restore first so SetWindowPos will take effect correctly.
-	if (IsIconic(windowHandle))
+	if (steps.ShowMedia && !IsMediaOnProjector())
 	{
-		ShowWindowAsync(windowHandle, SW_RESTORE);
-
-		// Wait briefly for the window to leave the iconic state.
-		DWORD waited = 0;
-		constexpr DWORD maxWaitMs = 500;
-		while (IsIconic(windowHandle) && waited < maxWaitMs)
-		{
-			Sleep(10);
-			waited += 10;
-		}
+		report.MediaToggle = ToggleMediaWindow();
+		report.MediaToggled = true;
 	}
 
-	// Cloak to avoid intermediate frames while moving/sizing (Win8+). Fallback to hide.
-	const bool canCloak = SUCCEEDED(DwmSetWindowAttribute(windowHandle, DWMWA_CLOAK, &disableTransitions, sizeof(disableTransitions)));
-	if (!canCloak)
+	if (steps.SendShareHome != 0)
 	{
-		ShowWindow(windowHandle, SW_HIDE);
+		SendShareWindowHome(WindowFromId(steps.SendShareHome));
 	}
 
-	// Reposition/resize while hidden/cloaked.
-	SetWindowPos(
-		windowHandle,
-		HWND_TOPMOST,
-		targetRect.left,
-		targetRect.top,
-		width,
-		height,
-		SWP_NOCOPYBITS | SWP_NOSENDCHANGING | SWP_NOACTIVATE);
+	if (steps.SendMediaHome && IsMediaOnProjector())
+	{
+		report.MediaToggle = ToggleMediaWindow();
+		report.MediaToggled = true;
+	}
 
-	// Prepare fade-in: temporarily apply layered style and set alpha to 0.
-	const LONG_PTR exStyle = GetWindowLongPtr(windowHandle, GWL_EXSTYLE);
-	const bool hadLayered = (exStyle & WS_EX_LAYERED) != 0;
-	if (!hadLayered)
+	if (steps.SettleAfter.count() > 0 && shareWatcher_)
 	{
-		SetWindowLongPtr(windowHandle, GWL_EXSTYLE, exStyle | WS_EX_LAYERED);
+		shareWatcher_->CallAfter(steps.SettleAfter, [this] { OnShareSettle(); });
 	}
 
-	// If SetLayeredWindowAttributes fails, we'll still show without fade.
-	const BOOL setAlpha0Ok = SetLayeredWindowAttributes(windowHandle, 0, 0 /* alpha */, LWA_ALPHA);
+	return report;
+}
 
-	// Uncloak or show and allow activation (no NOACTIVATE) so we can become topmost of the topmost band.
-	if (canCloak)
+/// <summary>
+/// Moves a share window onto the projector with the media window's cloak-and-fade
+/// transition, remembering its placement, and measures event to visible.
+/// </summary>
+void ZoomService::ShowShareWindow(const HWND window, const std::int64_t eventQpc, ShareFollowReport& report)
+{
+	TRACE_ZONE("ZoomService::ShowShareWindow");
+	const ScreenRect monitorRect = platform_->LoadTargetMonitorRect();
+	if (!IsWindow(window) || monitorRect.IsEmpty())
 	{
-		constexpr BOOL uncloak = FALSE;
-		DwmSetWindowAttribute(windowHandle, DWMWA_CLOAK, &uncloak, sizeof(uncloak));
-		ShowWindow(windowHandle, SW_SHOW);
+		return;
 	}
-	else
+
+	if (sharePlacements_.find(window) == sharePlacements_.end())
 	{
-		ShowWindow(windowHandle, SW_SHOW);
+		WINDOWPLACEMENT placement{};
+		placement.length = sizeof(placement);
+		if (GetWindowPlacement(window, &placement))
+		{
+			sharePlacements_[window] = placement;
+		}
 	}
 
-	ForceZoomWindowForeground(windowHandle);
+	const PlatformWindow shareWindow = Win32PlatformBackend::FromHandle(window);
+	const unsigned targetDpi = platform_->MonitorDpi(monitorRect);
+	DisplayWindowResult diagnostics;
+	toggle_.Display(shareWindow, toggle_.TargetRect(monitorRect, shareWindow, targetDpi), targetDpi, diagnostics);
 
-	// If alpha was set successfully, animate to full opacity.
-	if (setAlpha0Ok)
+	CompositionSample sample;
+	if (eventQpc > 0 && diagnostics.OpaqueQpc > 0 && CompositionClock::Sample(sample))
 	{
-		const ULONGLONG start = GetTickCount64();
-		BYTE alpha;
+		const std::int64_t presentQpc = PresentTiming::FirstPresentAfter(sample, diagnostics.OpaqueQpc);
+		if (presentQpc > eventQpc)
+		{
+			report.EventToVisibleUs = PresentTiming::ToMicroseconds(presentQpc - eventQpc, CompositionClock::Frequency());
+			shareFollow_->OnShown(std::chrono::microseconds(report.EventToVisibleUs));
+		}
+	}
 
-		do
+	FlightRecorder::Instance().Record(FlightEventKind::ShareFollow, 1, HandleValue(window), report.EventToVisibleUs,
+		static_cast<std::int64_t>(diagnostics.Fallbacks));
+}
+
+/// <summary>
+/// Returns a share window to where it was before it was followed (staying hidden if
+/// Zoom has hidden it).
+/// </summary>
+void ZoomService::SendShareWindowHome(const HWND window)
+{
+	const auto it = sharePlacements_.find(window);
+	if (IsWindow(window))
+	{
+		platform_->LowerFromTopmost(Win32PlatformBackend::FromHandle(window));
+		if (it != sharePlacements_.end())
 		{
-			constexpr DWORD durationMs = 300;
-			const ULONGLONG elapsed = GetTickCount64() - start;
-			const ULONGLONG scaled = (elapsed >= durationMs) ? 255 : (elapsed * 255u) / durationMs;
-			alpha = static_cast<BYTE>(scaled);
-			SetLayeredWindowAttributes(windowHandle, 0, alpha, LWA_ALPHA);
-			if (alpha < 255)
+			WINDOWPLACEMENT placement = it->second;
+			if (!IsWindowVisible(window))
 			{
-				Sleep(10); // yield a bit for smoothness
+				placement.showCmd = SW_HIDE;
 			}
-		} while (alpha < 255);
-
-		// Return window to its original style if we added WS_EX_LAYERED.
-		if (!hadLayered)
-		{
-			// Ensure fully opaque before removing the layered style.
-			SetLayeredWindowAttributes(windowHandle, 0, 255, LWA_ALPHA);
-			SetWindowLongPtr(windowHandle, GWL_EXSTYLE, exStyle);
+			SetWindowPlacement(window, &placement);
 		}
 	}
 
-	// Ensure a clean repaint after showing.
-	RedrawWindow(windowHandle, nullptr, nullptr, RDW_INVALIDATE | RDW_ALLCHILDREN | RDW_UPDATENOW);
-
-	// Re-enable DWM transitions.
-	disableTransitions = FALSE;
-	DwmSetWindowAttribute(windowHandle, DWMWA_TRANSITIONS_FORCEDISABLED, &disableTransitions, sizeof(disableTransitions));
+	if (it != sharePlacements_.end())
+	{
+		sharePlacements_.erase(it);
+	}
+	FlightRecorder::Instance().Record(FlightEventKind::ShareFollow, 0, HandleValue(window), 0, 0);
 }
 
 /// <summary>
-/// Retrieves the rectangle of the target monitor as specified in the settings.
+/// Loads the discovery cache written by a previous run; toggles then check it before searching.
 /// </summary>
-/// <returns>
-/// A RECT structure representing the area of the selected monitor.
-/// </returns>
-RECT ZoomService::GetTargetMonitorRect()
+/// <param name="cacheFilePath">The cache file (created on the first successful toggle).</param>
+void ZoomService::EnableWarmStart(const std::wstring& cacheFilePath)
 {
-	const SettingsService settingsService;
-	return settingsService.LoadSelectedMonitorRect();
+	warmStartPath_ = cacheFilePath;
+	std::ifstream in(std::filesystem::path(cacheFilePath), std::ios::in | std::ios::binary);
+	if (in)
+	{
+		DiscoveryCache::Read(in, warmStart_);
+	}
 }
 
 /// <summary>
-/// Attempts to locate the Zoom media window and returns the result, including status and
-/// any found elements.
+/// Returns the cached media window if it is still valid: the handle names a window of
+/// the same Zoom process instance and class, and the monitors are unchanged. This takes
+/// a handful of calls in place of the process snapshot and the UI Automation search.
 /// </summary>
-/// <returns>
-/// A FindWindowsResult structure containing information about whether the desktop and Zoom
-/// media window were found, if Zoom is running, and any error messages.
-/// </returns>
-FindWindowsResult ZoomService::FindMediaWindow()
+/// <returns>The media window, or 0 to search as usual.</returns>
+PlatformWindow ZoomService::WarmStartWindow()
 {
-	FindWindowsResult result;
-
-	if (automationService_ == nullptr)
+	TRACE_ZONE("ZoomService::WarmStartWindow");
+	if (warmStartPath_.empty())
 	{
-		result.BespokeErrorMsg = L"AutomationService is not initialized.";
-		return result;
+		return 0;
 	}
 
-	if (cachedDesktopWindow_ == nullptr)
-	{
-		IUIAutomationElement* desktop = automationService_->DesktopElement();
-		if (desktop == nullptr)
-		{
-			result.BespokeErrorMsg = L"Failed to get Desktop Element.";
-			return result;
-		}	
-
-		cachedDesktopWindow_ = desktop;
-	}
+	const HWND cachedHandle = Win32PlatformBackend::ToHandle(warmStart_.Window.WindowHandle);
+	warmStartValidity_ = warmStart_.Window.WindowHandle == 0
+		? CacheValidity::Empty
+		: DiscoveryCache::Validate(warmStart_, ObserveWindow(cachedHandle), CurrentTopologyHash());
+	return warmStartValidity_ == CacheValidity::Valid ? warmStart_.Window.WindowHandle : 0;
+}
 
-	result.FoundDesktop = true;
+void ZoomService::WarmStartUnavailable()
+{
+	warmStartValidity_ = CacheValidity::WindowGone;
+}
 
-	const std::vector<std::unique_ptr<void, HandleDeleter>> zoomProcesses = 
-		processesService_->GetProcessesByName(ZoomProcessName);
 
-	if (zoomProcesses.empty())
+/// <summary>
+/// Writes the media window to the discovery cache (if enabled).
+/// </summary>
+/// <param name="windowHandle">The media window just toggled.</param>
+/// <param name="fallbacks">The toggle's fallback flags, which record how the window was found.</param>
+void ZoomService::SaveWarmStart(const HWND windowHandle, const std::uint32_t fallbacks)
+{
+	if (warmStartPath_.empty())
 	{
-		return result;
+		return;
 	}
 
-	result.IsRunning = true;
-
-	IUIAutomationElement* mediaWindow = LocateZoomMediaWindow();
-	if (mediaWindow != nullptr)
+	DiscoveryCacheEntry entry;
+	entry.Window = ObserveWindow(windowHandle);
+	if ((fallbacks & ToggleFallbackWarmStart) != 0)
 	{
-		result.Element = mediaWindow;
-		result.FoundMediaWindow = true;
+		entry.Path = warmStart_.Path;
 	}
 	else
 	{
-		OutputDebugString(L"Could not get Zoom window!");
+		entry.Path = (fallbacks & ToggleFallbackMultipleCandidates) != 0
+			? DiscoveryPath::IdentifiedByMarkers
+			: DiscoveryPath::SingleCandidate;
 	}
+	entry.TopologyHash = CurrentTopologyHash();
 
-	return result;
+	std::ofstream out(std::filesystem::path(warmStartPath_), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (out)
+	{
+		DiscoveryCache::Write(out, entry);
+		warmStart_ = entry;
+	}
 }
 
 /// <summary>
-/// Attempts to locate the Zoom media window by finding all windows with matching name/class
-/// and identifying the main window by the presence of "MeetingTopBarInfoButton".
+/// Records the media window's original placement in the session journal, before it is
+/// moved (active) or once it has been sent back (inactive, ending the session).
 /// </summary>
-/// <returns>An IUIAutomationElement representing the Zoom media window, or nullptr if not found.</returns>
-IUIAutomationElement* ZoomService::LocateZoomMediaWindow() const
+/// <param name="windowHandle">The media window.</param>
+/// <param name="placement">Its original placement.</param>
+/// <param name="active">Whether the window is being moved away from its original placement.</param>
+void ZoomService::JournalPlacement(const HWND windowHandle, const SendBackPlacement& placement, const bool active)
 {
-	if (cachedDesktopWindow_ == nullptr)
+	TRACE_ZONE("ZoomService::JournalPlacement");
+	if (journal_->Data() == nullptr)
 	{
-		return nullptr;
+		return;
 	}
 
-	// Find the Zoom media window by searching for the specific class name and name.
-	// The class name and name may vary based on the Zoom version and configuration!
-
-	IUIAutomation* pAutomation = automationService_->GetAutomationInterface();
-
-	VariantWrapper varName;
-	varName.SetString(L"Zoom Meeting");
-
-	IUIAutomationCondition* nameCondition;
-	pAutomation->CreatePropertyCondition(UIA_NamePropertyId, *varName, &nameCondition);
-	AutomationConditionWrapper nameConditionWrapper(nameCondition);
-
-	VariantWrapper varClassName;
-	varClassName.SetString(L"ConfMultiTabContentWndClass");
-
-	IUIAutomationCondition* classNameCondition;
-	pAutomation->CreatePropertyCondition(UIA_ClassNamePropertyId, *varClassName, &classNameCondition);
-	AutomationConditionWrapper classNameConditionWrapper(classNameCondition);
+	PlacementRecord record;
+	record.Window = ObserveWindow(windowHandle);
+	record.Rect = placement.Rect;
+	record.ShowCmd = static_cast<std::int32_t>(Win32PlatformBackend::ShowCommand(placement.ShowState));
+	record.Minimized = placement.WasMinimized;
+	record.Active = active;
+	record.MonitorKey = MonitorKeyForRect(ToRect(placement.Rect));
 
-	IUIAutomationCondition* andCondition;
-	pAutomation->CreateAndCondition(
-		nameConditionWrapper.GetCondition(),
-		classNameConditionWrapper.GetCondition(),
-		&andCondition);
-	AutomationConditionWrapper andConditionWrapper(andCondition);
+	const std::size_t offset = SessionJournal::Write(journal_->Data(), record);
+	journal_->Flush(offset, SessionJournal::SlotSize);
+}
 
-	IUIAutomationElementArray* foundElements = nullptr;
-	const HRESULT hrFindAll = cachedDesktopWindow_->FindAll(TreeScope_Children, andConditionWrapper.GetCondition(), &foundElements);
+/// <summary>
+/// Takes the original placement from the session journal if it was recorded for this
+/// window (same process instance) and its monitor is still connected; otherwise the
+/// send back falls back to a fabricated position as before.
+/// </summary>
+/// <param name="windowHandle">The media window about to be sent back.</param>
+/// <param name="placement">Receives the journaled placement, if adopted.</param>
+void ZoomService::AdoptJournaledPlacement(const HWND windowHandle, SendBackPlacement& placement)
+{
+	TRACE_ZONE("ZoomService::AdoptJournaledPlacement");
+	PlacementRecord record;
+	if (journal_->Data() == nullptr || !SessionJournal::ReadLatest(journal_->Data(), record))
+	{
+		return;
+	}
 
-	if (FAILED(hrFindAll) || foundElements == nullptr)
+	const JournalMatch match = SessionJournal::Match(record, ObserveWindow(windowHandle));
+	const bool adopt = match == JournalMatch::Restorable && !record.MonitorKey.empty() &&
+		record.MonitorKey == MonitorKeyForRect(ToRect(record.Rect));
+	FlightRecorder::Instance().Record(FlightEventKind::JournalRead, static_cast<std::int32_t>(match),
+		HandleValue(windowHandle), static_cast<std::int64_t>(record.Sequence), adopt ? 1 : 0);
+	if (!adopt)
 	{
-		return nullptr;
+		return;
 	}
 
-	int elementCount = 0;
-	foundElements->get_Length(&elementCount);
+	placement.Rect = record.Rect;
+	placement.WasMinimized = record.Minimized;
+	placement.ShowState = Win32PlatformBackend::ShowStateOf(static_cast<UINT>(record.ShowCmd));
+}
 
-	if (elementCount == 0)
+/// <summary>
+/// Returns the key of the monitor containing (most of) the rectangle, or an empty
+/// string if the rectangle is empty or the monitor cannot be identified.
+/// </summary>
+std::wstring ZoomService::MonitorKeyForRect(const RECT rect)
+{
+	if (IsRectEmpty(&rect))
 	{
-		foundElements->Release();
-		return nullptr;
+		return std::wstring();
 	}
 
-	// If only one window found, assume it's the media window
-	if (elementCount == 1)
+	MONITORINFO info{};
+	info.cbSize = sizeof(info);
+	const HMONITOR monitor = MonitorFromRect(&rect, MONITOR_DEFAULTTONULL);
+	if (monitor == nullptr || !GetMonitorInfoW(monitor, &info))
 	{
-		IUIAutomationElement* singleElement = nullptr;
-		foundElements->GetElement(0, &singleElement);
-		foundElements->Release();
-		return singleElement;
+		return std::wstring();
 	}
 
-	// Multiple windows found - need to identify which is the main window
-	IUIAutomationElement *identifiedWindow = IdentifyFromMultipleCandidates(foundElements, elementCount, pAutomation);
-	foundElements->Release();
-	return identifiedWindow;
-}
-
-IUIAutomationElement* ZoomService::IdentifyFromMultipleCandidates(
-	IUIAutomationElementArray* foundElements, int elementCount, IUIAutomation* pAutomation)
-{
-	IUIAutomationElement* mediaWindow = nullptr;
-
-	for (int i = 0; i < elementCount; ++i)
+	constexpr MonitorService monitorService;
+	for (const auto& data : monitorService.GetMonitorsData())
 	{
-		IUIAutomationElement* currentElement = nullptr;
-		if (FAILED(foundElements->GetElement(i, &currentElement)) || currentElement == nullptr)
+		if (EqualRect(&data.MonitorRect, &info.rcMonitor))
 		{
-			continue;
+			return data.Key;
 		}
+	}
 
-		// Check if this window contains a control that identifies the conference window.
-		VariantWrapper varConfInfoHelpText;
-		varConfInfoHelpText.SetString(L"{\"controlID\":\"btn_conf_info\",\"isEnabled\":true}");
-
-		IUIAutomationCondition* confInfoHelpTextCondition = nullptr;
-		pAutomation->CreatePropertyCondition(UIA_HelpTextPropertyId, *varConfInfoHelpText, &confInfoHelpTextCondition);
-		AutomationConditionWrapper confInfoHelpTextConditionWrapper(confInfoHelpTextCondition);
+	return std::wstring();
+}
 
-		VariantWrapper varConfTitleHelpText;
-		varConfTitleHelpText.SetString(L"{\"controlID\":\"conf_title\",\"isEnabled\":true}");
+/// <summary>
+/// Reads what identifies the window a handle names now: its process (id and start
+/// time) and class. ProcessId is 0 if the handle no longer names a window.
+/// </summary>
+WindowIdentity ZoomService::ObserveWindow(const HWND windowHandle)
+{
+	WindowIdentity identity;
+	identity.WindowHandle = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(windowHandle));
+	if (!IsWindow(windowHandle))
+	{
+		return identity;
+	}
 
-		IUIAutomationCondition* confTitleHelpTextCondition = nullptr;
-		pAutomation->CreatePropertyCondition(UIA_HelpTextPropertyId, *varConfTitleHelpText, &confTitleHelpTextCondition);
-		AutomationConditionWrapper confTitleHelpTextConditionWrapper(confTitleHelpTextCondition);
+	DWORD processId = 0;
+	GetWindowThreadProcessId(windowHandle, &processId);
+	identity.ProcessId = processId;
 
-		IUIAutomationCondition* helpTextOrCondition = nullptr;
-		pAutomation->CreateOrCondition(
-			confInfoHelpTextConditionWrapper.GetCondition(),
-			confTitleHelpTextConditionWrapper.GetCondition(),
-			&helpTextOrCondition);
-		AutomationConditionWrapper helpTextOrConditionWrapper(helpTextOrCondition);
+	CHandle process(OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId));
+	FILETIME created{};
+	FILETIME exited{};
+	FILETIME kernel{};
+	FILETIME user{};
+	if (process && GetProcessTimes(process, &created, &exited, &kernel, &user))
+	{
+		identity.ProcessStartTime = (static_cast<std::uint64_t>(created.dwHighDateTime) << 32) | created.dwLowDateTime;
+	}
 
-		IUIAutomationElement* infoButton = nullptr;
-		const HRESULT hrFindButton = currentElement->FindFirst(TreeScope_Descendants, helpTextOrConditionWrapper.GetCondition(), &infoButton);
+	wchar_t className[256];
+	const int length = GetClassNameW(windowHandle, className, static_cast<int>(std::size(className)));
+	identity.ClassName.assign(className, length > 0 ? static_cast<size_t>(length) : 0);
+	return identity;
+}
 
-		if (SUCCEEDED(hrFindButton) && infoButton != nullptr)
-		{
-			// This is the main window (has either conference control), so skip it
-			infoButton->Release();
-			currentElement->Release();
-		}
-		else
+/// <summary>
+/// Hashes the current monitors' rectangles and effective DPIs, in enumeration order.
+/// </summary>
+std::uint64_t ZoomService::CurrentTopologyHash()
+{
+	std::vector<MonitorFacts> monitors;
+	EnumDisplayMonitors(nullptr, nullptr, [](const HMONITOR monitor, HDC, LPRECT rect, const LPARAM data) -> BOOL
+	{
+		UINT dpiX = 0;
+		UINT dpiY = 0;
+		if (FAILED(GetDpiForMonitor(monitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY)))
 		{
-			// This is the media window (doesn't have the conference controls)
-			mediaWindow = currentElement;
-			break;
+			dpiX = 0;
 		}
-	}
 
-	return mediaWindow;
+		reinterpret_cast<std::vector<MonitorFacts>*>(data)->push_back(MonitorFacts{ ToScreenRect(*rect), dpiX }); // NOLINT(performance-no-int-to-ptr)
+		return TRUE;
+	}, reinterpret_cast<LPARAM>(&monitors));
+
+	return DiscoveryCache::HashTopology(monitors);
 }
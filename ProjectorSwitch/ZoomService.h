@@ -1,34 +1,116 @@
 #pragma once
 #include "AutomationService.h"
-#include "FindWindowsResult.h"
-#include "ProcessesService.h"
 #include "DisplayWindowResult.h"
+#include "ProviderRegistry.h"
+#include "PlatformBackend.h"
+#include "MediaWindowToggle.h"
+#include "WindowGeometry.h"
+#include "MirrorSession.h"
+#include "DwmThumbnailCompositor.h"
+#include "DiscoveryCache.h"
+#include "MappedFile.h"
+#include "WindowPin.h"
+#include "HoldingSlideWindow.h"
+#include "ShareFollowPolicy.h"
+#include "ShareWindowWatcher.h"
+#include <functional>
+#include <map>
+#include <memory>
 
-class ZoomService  // NOLINT(cppcoreguidelines-special-member-functions)
+// One thing done to follow a screen share, for the log and statistics.
+struct ShareFollowReport
+{
+	ShareFollowSteps Steps;
+	std::int64_t EventToVisibleUs = 0; // share window shown: from its window opening to the first frame with it opaque (0 if unknown)
+	bool MediaToggled = false;         // the media window was moved too (Swap mode), with the outcome in MediaToggle
+	DisplayWindowResult MediaToggle;
+};
+
+class ZoomService : private MediaWindowToggle::Observer  // NOLINT(cppcoreguidelines-special-member-functions)
 {
 public:
-	ZoomService(AutomationService *automationService, ProcessesService *processesService);
-	~ZoomService();
+	// Takes ownership of the automation service; the toggle's calls go through platform.
+	ZoomService(AutomationService *automationService, std::unique_ptr<PlatformBackend> platform);
+	~ZoomService() override;
 
 	DisplayWindowResult Toggle();
 
+	// Whether a process of any configured provider (Zoom by default) exists
+	// (a process snapshot; no UI Automation).
+	static bool IsProviderRunning();
+
+	// Persists the media window found to cacheFilePath and, while it remains valid,
+	// reuses it instead of searching (for one-shot runs, which start empty).
+	void EnableWarmStart(const std::wstring& cacheFilePath);
+
+	// Why the last toggle did (Valid) or did not use the cached window.
+	CacheValidity WarmStartValidity() const { return warmStartValidity_; }
+
+	// Shows the HoldingSlide setting, if any, on the projector while the media window is
+	// home (for long-running instances; the slide is prepared in the background now).
+	void EnableHoldingSlide();
+
+	// The statistics of a pin (PinToProjector) ended by the last toggle; false if none was.
+	bool TakeEndedPinStats(PinStats& stats);
+
+	using ShareFollowCallback = std::function<void(const ShareFollowReport& report)>;
+
+	// Follows screen shares onto the projector as the ShareFollow setting says (for long-
+	// running instances; the events are handled on the reactor's thread), reporting to
+	// callback whatever is done other than in a Toggle.
+	void EnableShareFollow(EventReactor& reactor, ShareFollowCallback callback);
+
 private:
-	RECT mediaWindowOriginalPosition_;
-	bool mediaWindowWasMinimized_;
-	IUIAutomationElement* cachedDesktopWindow_;	
+	std::unique_ptr<MappedFile> journal_; // SessionJournal of the media window's original placement, for other processes
 	AutomationService* automationService_;
-	ProcessesService* processesService_;		
+	std::unique_ptr<PlatformBackend> platform_;
+	ProviderRegistry providers_;
+	MediaWindowToggle toggle_;
+	std::unique_ptr<DwmThumbnailCompositor> mirrorCompositor_;
+	MirrorSession mirror_;
+	bool pinToProjector_;
+	std::unique_ptr<WindowPin> pin_;
+	std::unique_ptr<PinStats> endedPinStats_;
+	std::unique_ptr<HoldingSlideWindow> holdingSlide_;
+	std::wstring warmStartPath_;
+	DiscoveryCacheEntry warmStart_;
+	CacheValidity warmStartValidity_;
+	HWND displayedWindow_;  // the media window as moved onto the projector (null once sent back)
+	RECT displayedRect_;
+	std::unique_ptr<ShareFollowPolicy> shareFollow_;
+	std::unique_ptr<ShareWindowWatcher> shareWatcher_;
+	ShareFollowCallback shareFollowed_;
+	std::map<HWND, WINDOWPLACEMENT> sharePlacements_; // followed share windows' placement beforehand
 		
-	FindWindowsResult FindMediaWindow();
-	IUIAutomationElement* LocateZoomMediaWindow() const;	
-	void InternalHide(HWND windowHandle);
-
-	static RECT GetTargetMonitorRect();
-	static RECT GetPrimaryMonitorRect();
-	static RECT CalculateTargetRect(RECT mediaMonitorRect, HWND mediaWindowHandle);
-	static void InternalDisplay(HWND windowHandle, RECT targetRect);	
-	static void ForceZoomWindowForeground(const HWND windowHandle);
-	static IUIAutomationElement* IdentifyFromMultipleCandidates(
-		IUIAutomationElementArray* foundElements, int elementCount, IUIAutomation* pAutomation);
+	DisplayWindowResult ToggleMediaWindow();
+	void InternalToggle(DisplayWindowResult& result);
+	void SaveWarmStart(HWND windowHandle, std::uint32_t fallbacks);
+	void JournalPlacement(HWND windowHandle, const SendBackPlacement& placement, bool active);
+	void AdoptJournaledPlacement(HWND windowHandle, SendBackPlacement& placement);
+	void RefreshMirror();
+	void StopMirror();
+	void EndPin();
+	bool IsMediaOnProjector() const;
+	void OnShareOpened(HWND window, std::int64_t eventQpc);
+	void OnShareClosed();
+	void OnShareSettle();
+	DisplayWindowResult DismissShare();
+	ShareFollowReport RunShareSteps(const ShareFollowSteps& steps, std::int64_t eventQpc);
+	void ShowShareWindow(HWND window, std::int64_t eventQpc, ShareFollowReport& report);
+	void SendShareWindowHome(HWND window);
+
+	// MediaWindowToggle::Observer
+	PlatformWindow WarmStartWindow() override;
+	void WarmStartUnavailable() override;
+	void Mirror(PlatformWindow window, const ScreenRect& monitorRect, DisplayWindowResult& result) override;
+	void OnSendingBack(PlatformWindow window, const ScreenRect& monitorRect, SendBackPlacement& placement) override;
+	void OnSentBack(PlatformWindow window, const SendBackPlacement& placement) override;
+	void OnDisplaying(PlatformWindow window, const SendBackPlacement& placement) override;
+	void OnDisplayed(PlatformWindow window, const ScreenRect& targetRect) override;
+	void OnToggled(PlatformWindow window, std::uint32_t fallbacks) override;
+
+	static WindowIdentity ObserveWindow(HWND windowHandle);
+	static std::uint64_t CurrentTopologyHash();
+	static std::wstring MonitorKeyForRect(RECT rect);
 };
 
@@ -0,0 +1,90 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "DiscoveryBenchmark.h"
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::cerr << "Usage: DiscoveryBench [--iterations <n>] [--out <file>] [snapshot.tree...]\n"
+			"Runs every discovery strategy against the simulated desktops, or against the\n"
+			"given --capture-tree snapshots, and writes one JSON line per scenario and strategy.\n";
+	}
+}
+
+/// <summary>
+/// Discovery benchmark on any platform: the same report as --bench-discovery.
+/// Exits with 1 if the production strategy chose the wrong window, 2 on bad
+/// arguments or an unreadable snapshot.
+/// </summary>
+int main(const int argc, char* argv[])
+{
+	int iterations = DiscoveryBenchmark::DefaultIterations;
+	std::string outPath;
+	std::vector<std::string> snapshots;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--iterations" && i + 1 < argc)
+		{
+			iterations = std::atoi(argv[++i]);
+		}
+		else if (arg == "--out" && i + 1 < argc)
+		{
+			outPath = argv[++i];
+		}
+		else if (!arg.empty() && arg[0] == '-')
+		{
+			PrintUsage();
+			return 2;
+		}
+		else
+		{
+			snapshots.push_back(arg);
+		}
+	}
+
+	if (iterations <= 0)
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	std::ofstream file;
+	if (!outPath.empty())
+	{
+		file.open(std::filesystem::path(outPath), std::ios::out | std::ios::trunc);
+		if (!file)
+		{
+			std::cerr << "Could not create " << outPath << '\n';
+			return 2;
+		}
+	}
+	std::ostream& out = outPath.empty() ? std::cout : file;
+
+	if (snapshots.empty())
+	{
+		return DiscoveryBenchmark::Run(out, DiscoveryBenchmark::DefaultCases(), iterations) ? 0 : 1;
+	}
+
+	bool allCorrect = true;
+	for (const auto& path : snapshots)
+	{
+		std::ifstream in(std::filesystem::path(path), std::ios::in | std::ios::binary);
+		TreeSnapshotReader reader;
+		if (!in || !reader.Open(in))
+		{
+			std::cerr << "Could not read snapshot " << path << '\n';
+			return 2;
+		}
+
+		allCorrect = DiscoveryBenchmark::RunSnapshot(out, std::filesystem::path(path).filename().string(), reader, iterations) && allCorrect;
+	}
+
+	return allCorrect ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "LogBenchmark.h"
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::cerr << "Usage: LogBench [--batches <n>] [--out <file>] [--log <file>]\n"
+			"Compares the caller's cost of a deferred log call with formatting in place and\n"
+			"with a direct call that formats, writes and flushes a log file (as the\n"
+			"application log does), and writes one JSON line per strategy.\n";
+	}
+}
+
+/// <summary>
+/// Logging benchmark on any platform: the same report as --bench-logging, with the
+/// direct calls writing to a flushed file. Exits with 1 if the deferred log lost a
+/// message, 2 on bad arguments or an unwritable file.
+/// </summary>
+int main(const int argc, char* argv[])
+{
+	int batches = LogBenchmark::DefaultBatches;
+	std::string outPath;
+	std::filesystem::path logPath = std::filesystem::temp_directory_path() / "LogBench.log";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--batches" && i + 1 < argc)
+		{
+			batches = std::atoi(argv[++i]);
+		}
+		else if (arg == "--out" && i + 1 < argc)
+		{
+			outPath = argv[++i];
+		}
+		else if (arg == "--log" && i + 1 < argc)
+		{
+			logPath = argv[++i];
+		}
+		else
+		{
+			PrintUsage();
+			return 2;
+		}
+	}
+
+	if (batches <= 0)
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	std::ofstream file;
+	if (!outPath.empty())
+	{
+		file.open(std::filesystem::path(outPath), std::ios::out | std::ios::trunc);
+		if (!file)
+		{
+			std::cerr << "Could not create " << outPath << '\n';
+			return 2;
+		}
+	}
+	std::ostream& out = outPath.empty() ? std::cout : file;
+
+	std::FILE* log = std::fopen(logPath.string().c_str(), "w");
+	if (log == nullptr)
+	{
+		std::cerr << "Could not create " << logPath.string() << '\n';
+		return 2;
+	}
+
+	const bool delivered = LogBenchmark::Run(out, [log](const long long totalUs, const wchar_t* detail)
+		{
+			std::fwprintf(log, L"INFO Toggle completed in %lld us (%ls)\n", totalUs, detail);
+			std::fflush(log);
+		}, batches);
+
+	std::fclose(log);
+	std::filesystem::remove(logPath);
+	return delivered ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#define PROJECTORSWITCH_TRACE
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TraceRecorder.h"
+
+namespace
+{
+	constexpr int DefaultRounds = 20;
+
+	// Zones per round: one buffer's worth, so each round records every zone.
+	constexpr std::uint32_t ZonesPerRound = ThreadTraceBuffer::Capacity;
+
+	// Stands in for the work a zone wraps, so the loops are not optimized away.
+	volatile std::uint32_t Sink = 0;
+
+	using Clock = std::chrono::steady_clock;
+
+	double NsPerZone(const Clock::duration elapsed)
+	{
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / ZonesPerRound;
+	}
+
+	// What TRACE_ZONE compiles to without PROJECTORSWITCH_TRACE: nothing.
+	double RunUntraced()
+	{
+		const auto start = Clock::now();
+		for (std::uint32_t i = 0; i < ZonesPerRound; ++i)
+		{
+			Sink = Sink + 1;
+		}
+		return NsPerZone(Clock::now() - start);
+	}
+
+	double RunTraced()
+	{
+		const auto start = Clock::now();
+		for (std::uint32_t i = 0; i < ZonesPerRound; ++i)
+		{
+			TRACE_ZONE("TraceBench.Zone");
+			Sink = Sink + 1;
+		}
+		return NsPerZone(Clock::now() - start);
+	}
+
+	double Median(std::vector<double> samples)
+	{
+		std::sort(samples.begin(), samples.end());
+		return samples[samples.size() / 2];
+	}
+
+	void PrintUsage()
+	{
+		std::cerr << "Usage: TraceBench [--rounds <n>] [--out <file>]\n"
+			"Measures the cost of a TRACE_ZONE with tracing compiled out, recording into a\n"
+			"thread's buffer, and once the buffer is full (dropped), and writes one JSON line\n"
+			"per case. Each round records on a new thread, as short-lived workers do.\n";
+	}
+}
+
+/// <summary>
+/// Trace zone overhead benchmark on any platform. Exits with 1 if the recorder kept
+/// a buffer for every exited thread, 2 on bad arguments or an unwritable file.
+/// </summary>
+int main(const int argc, char* argv[])
+{
+	int rounds = DefaultRounds;
+	std::string outPath;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--rounds" && i + 1 < argc)
+		{
+			rounds = std::atoi(argv[++i]);
+		}
+		else if (arg == "--out" && i + 1 < argc)
+		{
+			outPath = argv[++i];
+		}
+		else
+		{
+			PrintUsage();
+			return 2;
+		}
+	}
+
+	if (rounds <= 0)
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	std::ofstream file;
+	if (!outPath.empty())
+	{
+		file.open(std::filesystem::path(outPath), std::ios::out | std::ios::trunc);
+		if (!file)
+		{
+			std::cerr << "Could not create " << outPath << '\n';
+			return 2;
+		}
+	}
+	std::ostream& out = outPath.empty() ? std::cout : file;
+
+	std::vector<double> untraced;
+	std::vector<double> traced;
+	std::vector<double> dropped;
+	for (int round = 0; round < rounds; ++round)
+	{
+		std::thread([&]
+		{
+			untraced.push_back(RunUntraced());
+			traced.push_back(RunTraced());
+			dropped.push_back(RunTraced()); // the buffer is full now
+		}).join();
+	}
+
+	out << "{\"case\":\"off\",\"zones\":" << static_cast<long long>(rounds) * ZonesPerRound
+		<< ",\"p50_ns_per_zone\":" << Median(untraced) << "}\n";
+	out << "{\"case\":\"on\",\"zones\":" << static_cast<long long>(rounds) * ZonesPerRound
+		<< ",\"p50_ns_per_zone\":" << Median(traced) << "}\n";
+	out << "{\"case\":\"on_buffer_full\",\"zones\":" << static_cast<long long>(rounds) * ZonesPerRound
+		<< ",\"p50_ns_per_zone\":" << Median(dropped) << "}\n";
+
+	const std::uint32_t buffers = TraceRecorder::Instance().BufferCount();
+	out << "{\"case\":\"buffers\",\"threads\":" << rounds << ",\"buffers\":" << buffers << "}\n";
+	return buffers <= TraceRecorder::RecycleAfter ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AppState.h"
+
+TEST(AppState, ToggleResultUpdatesPresenceAndPlacementOnlyWhereKnown)
+{
+	AppState state;
+	DisplayWindowResult shown;
+	shown.AllOk = true;
+	shown.Presence = ZoomPresence::Running;
+	shown.Placement = MediaWindowPlacement::OnProjector;
+	shown.Timings.TotalUs = 1234;
+	state.ApplyToggleResult(shown);
+
+	EXPECT_EQ(state.ToggleCount, 1u);
+	EXPECT_TRUE(state.LastToggleOk);
+	EXPECT_EQ(state.LastToggleUs, 1234);
+	EXPECT_EQ(state.Placement, MediaWindowPlacement::OnProjector);
+
+	DisplayWindowResult timedOut;
+	timedOut.AllOk = false;
+	timedOut.Error = DisplayWindowError::DeadlineExceeded;
+	state.ApplyToggleResult(timedOut);
+	EXPECT_EQ(state.Presence, ZoomPresence::Running);
+	EXPECT_EQ(state.Placement, MediaWindowPlacement::OnProjector);
+	EXPECT_EQ(state.LastError, DisplayWindowError::DeadlineExceeded);
+
+	DisplayWindowResult exited;
+	exited.Presence = ZoomPresence::NotRunning;
+	state.ApplyToggleResult(exited);
+	EXPECT_EQ(state.Placement, MediaWindowPlacement::Unknown);
+}
+
+TEST(AppStateStore, PublishesVersionedSnapshots)
+{
+	AppStateStore store;
+	std::vector<std::uint64_t> notified;
+	store.SetChangeListener([&notified](const std::uint64_t version) { notified.push_back(version); });
+
+	const AppStateStore::Snapshot before = store.Current();
+	EXPECT_EQ(store.Update([](AppState& state) { state.MonitorCount = 2; }), 1u);
+	EXPECT_EQ(store.Update([](AppState& state) { state.SelectedMonitorKey = L"\\\\.\\DISPLAY2"; }), 2u);
+
+	// A snapshot never changes once taken.
+	EXPECT_EQ(before->Version, 0u);
+	EXPECT_EQ(before->MonitorCount, 0u);
+
+	const AppStateStore::Snapshot after = store.Current();
+	EXPECT_EQ(after->Version, 2u);
+	EXPECT_EQ(after->MonitorCount, 2u);
+	EXPECT_EQ(after->SelectedMonitorKey, L"\\\\.\\DISPLAY2");
+	EXPECT_EQ(notified, (std::vector<std::uint64_t>{ 1, 2 }));
+}
+
+TEST(AppStateStore, ReleasingTheMonitorListLeavesTheSelectionAndTopology)
+{
+	AppStateStore store;
+	store.Update([](AppState& state)
+	{
+		++state.TopologyGeneration;
+		state.MonitorCount = 2;
+		state.Monitors = { { L"LAPTOP", { 0, 0, 1920, 1080 } }, { L"PROJECTOR", { 1920, 0, 3200, 800 } } };
+		state.SelectedMonitorKey = L"PROJECTOR";
+	});
+	const AppStateStore::Snapshot listed = store.Current();
+
+	// What the UI does when it goes idle: the list goes, everything else stays.
+	store.Update([](AppState& state) { std::vector<MonitorEntry>().swap(state.Monitors); });
+	const AppStateStore::Snapshot released = store.Current();
+	EXPECT_TRUE(released->Monitors.empty());
+	EXPECT_EQ(released->MonitorCount, 2u);
+	EXPECT_EQ(released->TopologyGeneration, 1u);
+	EXPECT_EQ(released->SelectedMonitorKey, L"PROJECTOR");
+
+	// A reader still holding the listed snapshot keeps its list.
+	ASSERT_EQ(listed->Monitors.size(), 2u);
+	EXPECT_EQ(listed->Monitors[1].Key, L"PROJECTOR");
+	EXPECT_EQ(listed->Monitors[1].Rect, (ScreenRect{ 1920, 0, 3200, 800 }));
+}
+
+TEST(AppStateStore, FreesRetiredSnapshotsWithoutReaders)
+{
+	AppStateStore store;
+	const AppStateStore::Snapshot held = store.Current();
+	for (int i = 0; i < 100; ++i)
+	{
+		store.Update([](AppState& state) { ++state.TopologyGeneration; });
+	}
+
+	EXPECT_EQ(store.RetiredCount(), 0u);
+	EXPECT_EQ(held->TopologyGeneration, 0u); // still alive through the reader's reference
+	EXPECT_EQ(store.Current()->TopologyGeneration, 100u);
+}
+
+// Writers and readers hammer the store; readers check that every snapshot is
+// internally consistent and that versions never go backwards. Run under
+// ThreadSanitizer (PROJECTORSWITCH_SANITIZER=thread) to check the reclamation.
+TEST(AppStateStore, StressWithConcurrentWritersAndReaders)
+{
+	constexpr int Writers = 4;
+	constexpr int Readers = 4;
+	constexpr int UpdatesPerWriter = 5000;
+
+	AppStateStore store;
+	std::atomic<std::uint64_t> notified{ 0 };
+	store.SetChangeListener([&notified](std::uint64_t) { notified.fetch_add(1); });
+
+	std::atomic<bool> writing{ true };
+	std::atomic<bool> inconsistent{ false };
+	std::atomic<std::size_t> maxRetired{ 0 };
+	std::atomic<std::uint64_t> reads{ 0 };
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < Readers; ++r)
+	{
+		readers.emplace_back([&]
+		{
+			std::uint64_t lastVersion = 0;
+			while (writing.load())
+			{
+				const AppStateStore::Snapshot state = store.Current();
+				if (state->TopologyGeneration != state->ToggleCount * 2 || state->Version != state->ToggleCount ||
+					state->Version < lastVersion || (state->Version != 0 && state->SelectedMonitorKey.size() != 10 + (state->Version % 5)))
+				{
+					inconsistent = true;
+				}
+				lastVersion = state->Version;
+				reads.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+
+	std::vector<std::thread> writers;
+	for (int w = 0; w < Writers; ++w)
+	{
+		writers.emplace_back([&store, &maxRetired, w]
+		{
+			for (int i = 0; i < UpdatesPerWriter; ++i)
+			{
+				store.Update([w](AppState& state)
+				{
+					++state.ToggleCount;
+					state.TopologyGeneration = state.ToggleCount * 2;
+					state.SelectedMonitorKey.assign(10 + ((state.Version + 1) % 5), static_cast<wchar_t>(L'a' + w));
+				});
+
+				const std::size_t retired = store.RetiredCount();
+				std::size_t seen = maxRetired.load();
+				while (retired > seen && !maxRetired.compare_exchange_weak(seen, retired))
+				{
+				}
+			}
+		});
+	}
+
+	for (std::thread& writer : writers)
+	{
+		writer.join();
+	}
+	writing = false;
+	for (std::thread& reader : readers)
+	{
+		reader.join();
+	}
+
+	EXPECT_FALSE(inconsistent);
+	EXPECT_GT(reads.load(), 0u);
+	EXPECT_EQ(store.Current()->Version, static_cast<std::uint64_t>(Writers * UpdatesPerWriter));
+	EXPECT_EQ(notified.load(), static_cast<std::uint64_t>(Writers * UpdatesPerWriter));
+	EXPECT_LT(maxRetired.load(), AppStateStore::MaxRetired);
+
+	store.Update([](AppState&) {});
+	EXPECT_EQ(store.RetiredCount(), 0u);
+}
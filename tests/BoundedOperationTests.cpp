@@ -0,0 +1,287 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "BoundedOperation.h"
+#include "MediaWindowDiscovery.h"
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	/// <summary>
+	/// A discovery backend over a fixed number of candidates, of which only the last
+	/// has no main-window markers. A call can be made to stall, as a call into a hung
+	/// application would, until the test releases it.
+	/// </summary>
+	class StallingBackend : public DiscoveryBackend
+	{
+	private:
+		std::mutex mutex_;
+		std::condition_variable changed_;
+		bool stalled_ = false;
+		bool released_ = false;
+
+		void StallIf(const bool stall)
+		{
+			if (!stall)
+			{
+				return;
+			}
+
+			std::unique_lock<std::mutex> lock(mutex_);
+			stalled_ = true;
+			changed_.notify_all();
+			// Bounded, so a broken test fails instead of hanging.
+			changed_.wait_for(lock, 30s, [this] { return released_; });
+		}
+
+	public:
+		static constexpr int NoStall = -2;
+		static constexpr int StallInFind = -1;
+
+		int Candidates = 3;
+		int StallAt = NoStall; // StallInFind, or the index of the candidate to stall on
+		std::atomic<int> Probed{ 0 };
+
+		int FindCandidates(const MediaWindowSelectors&) override
+		{
+			StallIf(StallAt == StallInFind);
+			return Candidates;
+		}
+
+		int CandidateHasMainWindowMarker(const int candidateIndex, const MediaWindowSelectors&) override
+		{
+			++Probed;
+			StallIf(StallAt == candidateIndex);
+			return candidateIndex == Candidates - 1 ? 0 : 1;
+		}
+
+		bool WaitUntilStalled()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			return changed_.wait_for(lock, 5s, [this] { return stalled_; });
+		}
+
+		void Release()
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			released_ = true;
+			changed_.notify_all();
+		}
+	};
+
+	// Shared with the worker, which may outlive the test's call to Run (as in ZoomService).
+	struct DiscoveryRun
+	{
+		StallingBackend Backend;
+		DiscoveryOutcome Outcome;
+		std::atomic<bool> Finished{ false };
+		std::atomic<bool> SawCancellation{ false };
+	};
+
+	BoundedOperation::Work Locate(const std::shared_ptr<DiscoveryRun>& run)
+	{
+		return [run](const CancellationToken& cancel)
+		{
+			run->Outcome = MediaWindowDiscovery::Locate(run->Backend, MediaWindowSelectors::Zoom(), cancel);
+			run->SawCancellation = cancel.IsCancelled();
+			run->Finished = true;
+		};
+	}
+
+	bool WaitUntilIdle(const BoundedOperation& operation)
+	{
+		for (int i = 0; i < 500 && operation.IsBusy(); ++i)
+		{
+			std::this_thread::sleep_for(10ms);
+		}
+		return !operation.IsBusy();
+	}
+
+	bool WaitUntilFinished(const DiscoveryRun& run)
+	{
+		for (int i = 0; i < 500 && !run.Finished; ++i)
+		{
+			std::this_thread::sleep_for(10ms);
+		}
+		return run.Finished;
+	}
+}
+
+TEST(BoundedOperation, CompletesWithinTheDeadline)
+{
+	BoundedOperation operation;
+	const auto run = std::make_shared<DiscoveryRun>();
+
+	EXPECT_EQ(operation.Run(Locate(run), Deadline::FromNow(5000)), OperationStatus::Completed);
+	EXPECT_EQ(run->Outcome.SelectedIndex, 2);
+	EXPECT_FALSE(run->Outcome.Cancelled);
+	EXPECT_FALSE(operation.IsBusy());
+}
+
+TEST(BoundedOperation, RunsInlineWithoutADeadlineOrToken)
+{
+	BoundedOperation operation;
+	const std::thread::id caller = std::this_thread::get_id();
+	std::thread::id ranOn;
+
+	EXPECT_EQ(operation.Run([&ranOn](const CancellationToken& cancel)
+	{
+		EXPECT_FALSE(cancel.CanBeCancelled());
+		ranOn = std::this_thread::get_id();
+	}, Deadline::Never()), OperationStatus::Completed);
+	EXPECT_EQ(ranOn, caller);
+}
+
+TEST(BoundedOperation, DeadlineExpiresWhileIdentifying)
+{
+	BoundedOperation operation;
+	const auto run = std::make_shared<DiscoveryRun>();
+	run->Backend.StallAt = 1;
+
+	const auto started = std::chrono::steady_clock::now();
+	EXPECT_EQ(operation.Run(Locate(run), Deadline::FromNow(50)), OperationStatus::TimedOut);
+	const auto waited = std::chrono::steady_clock::now() - started;
+	EXPECT_GE(waited, 50ms);
+	EXPECT_LT(waited, 2s);
+
+	// The call in progress is not interrupted; once it returns, Locate stops at the
+	// next check without probing the remaining candidate.
+	ASSERT_TRUE(run->Backend.WaitUntilStalled());
+	EXPECT_TRUE(operation.IsBusy());
+	run->Backend.Release();
+	ASSERT_TRUE(WaitUntilFinished(*run));
+	EXPECT_TRUE(run->SawCancellation);
+	EXPECT_TRUE(run->Outcome.Cancelled);
+	EXPECT_EQ(run->Outcome.SelectedIndex, -1);
+	EXPECT_EQ(run->Backend.Probed, 2);
+	EXPECT_TRUE(WaitUntilIdle(operation));
+}
+
+TEST(BoundedOperation, DeadlineExpiresWhileFindingCandidates)
+{
+	BoundedOperation operation;
+	const auto run = std::make_shared<DiscoveryRun>();
+	run->Backend.StallAt = StallingBackend::StallInFind;
+
+	EXPECT_EQ(operation.Run(Locate(run), Deadline::FromNow(20)), OperationStatus::TimedOut);
+	ASSERT_TRUE(run->Backend.WaitUntilStalled());
+	run->Backend.Release();
+	ASSERT_TRUE(WaitUntilFinished(*run));
+	EXPECT_TRUE(run->Outcome.Cancelled);
+	EXPECT_EQ(run->Backend.Probed, 0);
+	EXPECT_TRUE(WaitUntilIdle(operation));
+}
+
+TEST(BoundedOperation, RefusesANewRunWhileAnAbandonedOneIsStillGoing)
+{
+	BoundedOperation operation;
+	const auto hung = std::make_shared<DiscoveryRun>();
+	hung->Backend.StallAt = 0;
+	ASSERT_EQ(operation.Run(Locate(hung), Deadline::FromNow(20)), OperationStatus::TimedOut);
+	ASSERT_TRUE(hung->Backend.WaitUntilStalled());
+
+	// Refused at once, without starting the work.
+	const auto next = std::make_shared<DiscoveryRun>();
+	const auto started = std::chrono::steady_clock::now();
+	EXPECT_EQ(operation.Run(Locate(next), Deadline::FromNow(5000)), OperationStatus::Busy);
+	EXPECT_LT(std::chrono::steady_clock::now() - started, 1s);
+	EXPECT_FALSE(next->Finished);
+	EXPECT_EQ(next->Backend.Probed, 0);
+
+	// Once the hung call returns, runs are accepted again.
+	hung->Backend.Release();
+	ASSERT_TRUE(WaitUntilIdle(operation));
+	EXPECT_EQ(operation.Run(Locate(next), Deadline::FromNow(5000)), OperationStatus::Completed);
+	EXPECT_EQ(next->Outcome.SelectedIndex, 2);
+}
+
+TEST(BoundedOperation, CallerCancellationStopsTheWait)
+{
+	BoundedOperation operation;
+	const auto run = std::make_shared<DiscoveryRun>();
+	run->Backend.StallAt = 1;
+	CancellationSource cancel;
+
+	std::thread canceller([&run, &cancel]
+	{
+		run->Backend.WaitUntilStalled();
+		cancel.Cancel();
+	});
+	EXPECT_EQ(operation.Run(Locate(run), Deadline::Never(), cancel.Token()), OperationStatus::Cancelled);
+	canceller.join();
+
+	run->Backend.Release();
+	ASSERT_TRUE(WaitUntilFinished(*run));
+	EXPECT_TRUE(run->SawCancellation); // the worker's own token was cancelled too
+	EXPECT_TRUE(WaitUntilIdle(operation));
+}
+
+TEST(BoundedOperation, AlreadyCancelledTokenRunsNothing)
+{
+	BoundedOperation operation;
+	const auto run = std::make_shared<DiscoveryRun>();
+	CancellationSource cancel;
+	cancel.Cancel();
+
+	EXPECT_EQ(operation.Run(Locate(run), Deadline::FromNow(5000), cancel.Token()), OperationStatus::Cancelled);
+	EXPECT_FALSE(run->Finished);
+}
+
+TEST(BoundedOperation, WorkerOutlivesItsOperation)
+{
+	const auto run = std::make_shared<DiscoveryRun>();
+	run->Backend.StallAt = 0;
+	{
+		BoundedOperation operation;
+		ASSERT_EQ(operation.Run(Locate(run), Deadline::FromNow(20)), OperationStatus::TimedOut);
+		ASSERT_TRUE(run->Backend.WaitUntilStalled());
+	}
+
+	// The detached worker still owns its state and sees its token cancelled.
+	run->Backend.Release();
+	ASSERT_TRUE(WaitUntilFinished(*run));
+	EXPECT_TRUE(run->SawCancellation);
+	EXPECT_TRUE(run->Outcome.Cancelled);
+	EXPECT_EQ(run->Backend.Probed, 1);
+}
+
+TEST(BoundedOperation, RunsShareOneWorkerUntilOneIsAbandoned)
+{
+	BoundedOperation operation;
+	// Thread ids may be reused once a thread exits, so count runs per thread instead.
+	const auto countRun = [](int& runsOnThread)
+	{
+		return [&runsOnThread](const CancellationToken&)
+		{
+			thread_local int runs = 0;
+			runsOnThread = ++runs;
+		};
+	};
+
+	int first = 0;
+	int second = 0;
+	ASSERT_EQ(operation.Run(countRun(first), Deadline::FromNow(5000)), OperationStatus::Completed);
+	ASSERT_EQ(operation.Run(countRun(second), Deadline::FromNow(5000)), OperationStatus::Completed);
+	EXPECT_EQ(first, 1);
+	EXPECT_EQ(second, 2);
+
+	// The hung run keeps its worker; the next run gets a new one.
+	const auto hung = std::make_shared<DiscoveryRun>();
+	hung->Backend.StallAt = 0;
+	ASSERT_EQ(operation.Run(Locate(hung), Deadline::FromNow(20)), OperationStatus::TimedOut);
+	ASSERT_TRUE(hung->Backend.WaitUntilStalled());
+	hung->Backend.Release();
+	ASSERT_TRUE(WaitUntilIdle(operation));
+
+	int third = 0;
+	int fourth = 0;
+	ASSERT_EQ(operation.Run(countRun(third), Deadline::FromNow(5000)), OperationStatus::Completed);
+	ASSERT_EQ(operation.Run(countRun(fourth), Deadline::FromNow(5000)), OperationStatus::Completed);
+	EXPECT_EQ(third, 1);
+	EXPECT_EQ(fourth, 2);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DeferredLog.h"
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	// Collects what the background thread hands to the sink.
+	class Collector
+	{
+	private:
+		mutable std::mutex mutex_;
+		std::vector<std::wstring> messages_;
+
+	public:
+		DeferredLog::Sink Sink()
+		{
+			return [this](DeferredLogLevel, const std::wstring& message)
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				messages_.push_back(message);
+			};
+		}
+
+		std::vector<std::wstring> Messages() const
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			return messages_;
+		}
+
+		bool WaitFor(const size_t count) const
+		{
+			const auto deadline = std::chrono::steady_clock::now() + 5s;
+			while (Messages().size() < count)
+			{
+				if (std::chrono::steady_clock::now() > deadline)
+				{
+					return false;
+				}
+				std::this_thread::sleep_for(1ms);
+			}
+			return true;
+		}
+	};
+
+	template <typename... Args>
+	std::wstring Formatted(const wchar_t* format, const Args&... args)
+	{
+		DeferredLog log;
+		Collector collector;
+		log.Write(DeferredLogLevel::Info, format, args...);
+		log.Start(collector.Sink());
+		log.Stop();
+		const std::vector<std::wstring> messages = collector.Messages();
+		return messages.empty() ? L"<none>" : messages.front();
+	}
+}
+
+TEST(DeferredLog, FormatsCapturedArguments)
+{
+	EXPECT_EQ(Formatted(L"Toggle completed in %lld us (%ls)", 1234LL, L"warm start"), L"Toggle completed in 1234 us (warm start)");
+	EXPECT_EQ(Formatted(L"%d|%5d|%-4d|%u", -7, 42, 3, 9u), L"-7|   42|3   |9");
+	EXPECT_EQ(Formatted(L"%x %08X", -1, 0xBEEFu), L"ffffffff 0000BEEF");
+	EXPECT_EQ(Formatted(L"%.2f %hs", 1.005 + 1, "narrow"), L"2.00 narrow");
+	EXPECT_EQ(Formatted(L"%I64u%%", static_cast<std::uint64_t>(100)), L"100%");
+	EXPECT_EQ(Formatted(L"%d and %d", 1), L"1 and %d"); // missing argument left as written
+}
+
+TEST(DeferredLog, CutsLongStringsToTheRecordBuffer)
+{
+	const std::wstring longText(DeferredLogRecord::TextCapacity + 50, L'x');
+	EXPECT_EQ(Formatted(L"%ls", longText.c_str()), std::wstring(DeferredLogRecord::TextCapacity, L'x'));
+}
+
+TEST(DeferredLog, DeliversInOrderAndDrainsOnStop)
+{
+	DeferredLog log;
+	Collector collector;
+	log.Start(collector.Sink());
+	for (int i = 0; i < 100; ++i)
+	{
+		log.Write(DeferredLogLevel::Info, L"%d", i);
+	}
+	log.Stop();
+
+	const std::vector<std::wstring> messages = collector.Messages();
+	ASSERT_EQ(messages.size(), 100u);
+	for (int i = 0; i < 100; ++i)
+	{
+		EXPECT_EQ(messages[static_cast<size_t>(i)], std::to_wstring(i));
+	}
+	EXPECT_EQ(log.Dropped(), 0u);
+}
+
+TEST(DeferredLog, DropsAndReportsWhenFull)
+{
+	DeferredLog log;
+	Collector collector;
+	for (std::uint64_t i = 0; i < DeferredLog::Capacity + 10; ++i)
+	{
+		log.Write(DeferredLogLevel::Info, L"%llu", i);
+	}
+	EXPECT_EQ(log.Dropped(), 10u);
+
+	log.Start(collector.Sink());
+	log.Stop();
+	const std::vector<std::wstring> messages = collector.Messages();
+	ASSERT_EQ(messages.size(), DeferredLog::Capacity + 1);
+	EXPECT_EQ(messages.back(), L"Log queue full: 10 message(s) dropped");
+}
+
+TEST(DeferredLog, SleepsWhileIdleAndWakesOncePerBurst)
+{
+	DeferredLog log;
+	Collector collector;
+	log.Start(collector.Sink());
+
+	// Idle: the background thread is never woken.
+	std::this_thread::sleep_for(100ms);
+	EXPECT_EQ(log.Wakeups(), 0u);
+
+	for (int burst = 1; burst <= 3; ++burst)
+	{
+		for (int i = 0; i < 20; ++i)
+		{
+			log.Write(DeferredLogLevel::Info, L"%d", i);
+		}
+		ASSERT_TRUE(collector.WaitFor(static_cast<size_t>(burst) * 20));
+		std::this_thread::sleep_for(50ms);
+
+		// Each burst costs at least one wakeup, and nothing happens between bursts.
+		const std::uint64_t wakeups = log.Wakeups();
+		EXPECT_GE(wakeups, static_cast<std::uint64_t>(burst));
+		EXPECT_LE(wakeups, static_cast<std::uint64_t>(burst) * 20);
+		std::this_thread::sleep_for(100ms);
+		EXPECT_EQ(log.Wakeups(), wakeups);
+	}
+
+	log.Stop();
+}
+
+TEST(DeferredLog, ConcurrentWritersLoseNothing)
+{
+	DeferredLog log;
+	Collector collector;
+	log.Start(collector.Sink());
+
+	constexpr int Writers = 4;
+	constexpr int PerWriter = 2000;
+	std::vector<std::thread> writers;
+	for (int w = 0; w < Writers; ++w)
+	{
+		writers.emplace_back([&log, w]
+		{
+			for (int i = 0; i < PerWriter; ++i)
+			{
+				log.Write(DeferredLogLevel::Debug, L"%d:%d", w, i);
+				if (i % 64 == 0)
+				{
+					std::this_thread::sleep_for(100us); // let the queue drain, and the thread park
+				}
+			}
+		});
+	}
+	for (auto& writer : writers)
+	{
+		writer.join();
+	}
+	log.Stop();
+
+	// Whatever was not dropped arrived, each writer's messages in order.
+	const std::uint64_t dropped = log.Dropped();
+	int last[Writers] = { -1, -1, -1, -1 };
+	std::uint64_t received = 0;
+	for (const auto& message : collector.Messages())
+	{
+		if (message.rfind(L"Log queue full", 0) == 0)
+		{
+			continue;
+		}
+		const size_t colon = message.find(L':');
+		ASSERT_NE(colon, std::wstring::npos);
+		const int w = std::stoi(message.substr(0, colon));
+		const int i = std::stoi(message.substr(colon + 1));
+		EXPECT_GT(i, last[w]);
+		last[w] = i;
+		++received;
+	}
+	EXPECT_EQ(received + dropped, static_cast<std::uint64_t>(Writers) * PerWriter);
+}
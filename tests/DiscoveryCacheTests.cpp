@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "DiscoveryCache.h"
+
+namespace
+{
+	const std::vector<MonitorFacts> Monitors{ { { 0, 0, 1920, 1080 }, 96 }, { { 1920, 0, 3840, 1080 }, 144 } };
+
+	DiscoveryCacheEntry Entry()
+	{
+		DiscoveryCacheEntry entry;
+		entry.Window = WindowIdentity{ 0x1234, 42, 999, L"ConfMultiTabContentWndClass" };
+		entry.Path = DiscoveryPath::IdentifiedByMarkers;
+		entry.TopologyHash = DiscoveryCache::HashTopology(Monitors);
+		return entry;
+	}
+
+	std::string Serialized(const DiscoveryCacheEntry& entry)
+	{
+		std::ostringstream out;
+		DiscoveryCache::Write(out, entry);
+		return out.str();
+	}
+}
+
+TEST(DiscoveryCache, WriteReadRoundTrips)
+{
+	std::istringstream in(Serialized(Entry()));
+	DiscoveryCacheEntry read;
+	ASSERT_TRUE(DiscoveryCache::Read(in, read));
+
+	EXPECT_EQ(read.Window.WindowHandle, 0x1234u);
+	EXPECT_EQ(read.Window.ProcessId, 42u);
+	EXPECT_EQ(read.Window.ProcessStartTime, 999u);
+	EXPECT_EQ(read.Window.ClassName, L"ConfMultiTabContentWndClass");
+	EXPECT_EQ(read.Path, DiscoveryPath::IdentifiedByMarkers);
+	EXPECT_EQ(read.TopologyHash, Entry().TopologyHash);
+}
+
+TEST(DiscoveryCache, ReadRejectsEveryTruncationAndClearsTheEntry)
+{
+	const std::string full = Serialized(Entry());
+	for (std::size_t length = 0; length < full.size(); ++length)
+	{
+		std::istringstream in(full.substr(0, length));
+		DiscoveryCacheEntry read = Entry();
+		EXPECT_FALSE(DiscoveryCache::Read(in, read)) << length;
+		EXPECT_EQ(read.Window.ProcessId, 0u) << length;
+		EXPECT_EQ(read.Path, DiscoveryPath::Unknown) << length;
+	}
+}
+
+TEST(DiscoveryCache, ReadRejectsOtherVersionsAndCorruptFields)
+{
+	std::string otherVersion = Serialized(Entry());
+	otherVersion[4] = 1;
+	std::istringstream versionIn(otherVersion);
+	DiscoveryCacheEntry read;
+	EXPECT_FALSE(DiscoveryCache::Read(versionIn, read));
+
+	DiscoveryCacheEntry badPath = Entry();
+	badPath.Path = static_cast<DiscoveryPath>(7);
+	std::istringstream pathIn(Serialized(badPath));
+	EXPECT_FALSE(DiscoveryCache::Read(pathIn, read));
+
+	DiscoveryCacheEntry longClass = Entry();
+	longClass.Window.ClassName.assign(257, L'x');
+	std::istringstream classIn(Serialized(longClass));
+	EXPECT_FALSE(DiscoveryCache::Read(classIn, read));
+}
+
+TEST(DiscoveryCache, ValidWhenEverythingStillMatches)
+{
+	const DiscoveryCacheEntry cached = Entry();
+	EXPECT_EQ(DiscoveryCache::Validate(cached, cached.Window, cached.TopologyHash), CacheValidity::Valid);
+}
+
+TEST(DiscoveryCache, ValidationReportsTheFirstRuleBroken)
+{
+	const DiscoveryCacheEntry cached = Entry();
+	const std::uint64_t topology = cached.TopologyHash;
+
+	EXPECT_EQ(DiscoveryCache::Validate(DiscoveryCacheEntry(), cached.Window, topology), CacheValidity::Empty);
+	DiscoveryCacheEntry unknownPath = cached;
+	unknownPath.Path = DiscoveryPath::Unknown;
+	EXPECT_EQ(DiscoveryCache::Validate(unknownPath, cached.Window, topology), CacheValidity::Empty);
+
+	WindowIdentity observed = cached.Window;
+	observed.ProcessId = 0; // the handle no longer names a window
+	EXPECT_EQ(DiscoveryCache::Validate(cached, observed, topology), CacheValidity::WindowGone);
+
+	observed = cached.Window;
+	observed.WindowHandle = 0x5678;
+	EXPECT_EQ(DiscoveryCache::Validate(cached, observed, topology), CacheValidity::WindowGone);
+
+	observed = cached.Window;
+	observed.ProcessId = 43; // handle reused by another process
+	EXPECT_EQ(DiscoveryCache::Validate(cached, observed, topology), CacheValidity::ProcessChanged);
+
+	observed = cached.Window;
+	observed.ProcessStartTime = 1000; // Zoom restarted and got the same process id
+	EXPECT_EQ(DiscoveryCache::Validate(cached, observed, topology), CacheValidity::ProcessChanged);
+
+	observed = cached.Window;
+	observed.ClassName = L"ZPContentViewWndClass";
+	EXPECT_EQ(DiscoveryCache::Validate(cached, observed, topology), CacheValidity::ClassChanged);
+	observed.ProcessStartTime = 1000; // the process is checked before the class
+	EXPECT_EQ(DiscoveryCache::Validate(cached, observed, topology), CacheValidity::ProcessChanged);
+
+	EXPECT_EQ(DiscoveryCache::Validate(cached, cached.Window, topology + 1), CacheValidity::TopologyChanged);
+}
+
+TEST(DiscoveryCache, TopologyHashSeesEveryMonitorChange)
+{
+	const std::uint64_t original = DiscoveryCache::HashTopology(Monitors);
+	EXPECT_EQ(DiscoveryCache::HashTopology({}), 0u);
+	EXPECT_NE(original, 0u);
+	EXPECT_EQ(DiscoveryCache::HashTopology(Monitors), original);
+
+	std::vector<MonitorFacts> changed = Monitors;
+	changed[1].Dpi = 96;
+	EXPECT_NE(DiscoveryCache::HashTopology(changed), original);
+
+	changed = Monitors;
+	changed[1].Rect.Left += 1;
+	EXPECT_NE(DiscoveryCache::HashTopology(changed), original);
+
+	changed = { Monitors[1], Monitors[0] };
+	EXPECT_NE(DiscoveryCache::HashTopology(changed), original);
+
+	changed = { Monitors[0] };
+	EXPECT_NE(DiscoveryCache::HashTopology(changed), original);
+}
+
+TEST(DiscoveryCache, EveryValidityHasAName)
+{
+	for (int v = 0; v <= static_cast<int>(CacheValidity::TopologyChanged); ++v)
+	{
+		EXPECT_STRNE(DiscoveryCache::ValidityName(static_cast<CacheValidity>(v)), L"?") << v;
+	}
+}
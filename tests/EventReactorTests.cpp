@@ -0,0 +1,323 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "EventReactor.h"
+#if !defined(_WIN32)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "PollEventReactor.h"
+#endif
+
+TEST(ReactorHandlers, SnapshotListsActiveRegistrationsInOrder)
+{
+	ReactorHandlers handlers;
+	const auto a = handlers.Add(10, [] {});
+	const auto b = handlers.Add(11, [] {});
+	const auto c = handlers.Add(12, [] {});
+	EXPECT_NE(a, EventReactor::InvalidRegistration);
+	handlers.Remove(b);
+
+	std::vector<NativeWaitHandle> handles;
+	std::vector<EventReactor::RegistrationId> ids;
+	handlers.Snapshot(handles, ids);
+	EXPECT_EQ(handles, (std::vector<NativeWaitHandle>{ 10, 12 }));
+	EXPECT_EQ(ids, (std::vector<EventReactor::RegistrationId>{ a, c }));
+}
+
+TEST(ReactorHandlers, CallbackMayUnregisterItselfAndOthers)
+{
+	ReactorHandlers handlers;
+	int selfCalls = 0;
+	int otherCalls = 0;
+	EventReactor::RegistrationId self = EventReactor::InvalidRegistration;
+	EventReactor::RegistrationId other = EventReactor::InvalidRegistration;
+	self = handlers.Add(1, [&]
+	{
+		++selfCalls;
+		handlers.Remove(self);
+		handlers.Remove(other);
+	});
+	other = handlers.Add(2, [&] { ++otherCalls; });
+
+	// The running callback completes; the removed ones are not invoked afterwards.
+	EXPECT_TRUE(handlers.Invoke(self));
+	EXPECT_FALSE(handlers.Invoke(other));
+	EXPECT_FALSE(handlers.Invoke(self));
+	EXPECT_EQ(selfCalls, 1);
+	EXPECT_EQ(otherCalls, 0);
+
+	handlers.Compact();
+	std::vector<NativeWaitHandle> handles;
+	std::vector<EventReactor::RegistrationId> ids;
+	handlers.Snapshot(handles, ids);
+	EXPECT_TRUE(ids.empty());
+}
+
+TEST(ReactorHandlers, CallbackMayRegisterWhileRunning)
+{
+	ReactorHandlers handlers;
+	int added = 0;
+	const auto id = handlers.Add(1, [&]
+	{
+		// Enough registrations to reallocate the entries under the running callback.
+		for (int i = 0; i < 64; ++i)
+		{
+			handlers.Add(100 + i, [] {});
+		}
+		++added;
+	});
+
+	EXPECT_TRUE(handlers.Invoke(id));
+	EXPECT_EQ(added, 1);
+
+	std::vector<NativeWaitHandle> handles;
+	std::vector<EventReactor::RegistrationId> ids;
+	handlers.Snapshot(handles, ids);
+	EXPECT_EQ(ids.size(), 65u);
+}
+
+TEST(ReactorTaskQueue, PushReportsWhenTheReactorNeedsWaking)
+{
+	ReactorTaskQueue queue;
+	EXPECT_TRUE(queue.Push([] {}));
+	EXPECT_FALSE(queue.Push([] {}));
+	EXPECT_EQ(queue.RunAll(), 2u);
+	EXPECT_TRUE(queue.Push([] {}));
+}
+
+TEST(ReactorTaskQueue, RunAllLeavesTasksPostedByTasksForNextTime)
+{
+	ReactorTaskQueue queue;
+	int ran = 0;
+	queue.Push([&]
+	{
+		++ran;
+		EXPECT_TRUE(queue.Push([&] { ++ran; })); // the queue was swapped out, so this wakes
+	});
+
+	EXPECT_EQ(queue.RunAll(), 1u);
+	EXPECT_EQ(ran, 1);
+	EXPECT_EQ(queue.RunAll(), 1u);
+	EXPECT_EQ(ran, 2);
+	EXPECT_EQ(queue.RunAll(), 0u);
+}
+
+#if !defined(_WIN32)
+namespace
+{
+	using namespace std::chrono_literals;
+
+	// A readable-on-demand descriptor to register with the reactor.
+	class EventFd  // NOLINT(cppcoreguidelines-special-member-functions)
+	{
+	private:
+		int fd_;
+
+	public:
+		EventFd()
+			: fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+		{
+		}
+
+		~EventFd()
+		{
+			close(fd_);
+		}
+
+		int Fd() const { return fd_; }
+
+		void Signal() const
+		{
+			const std::uint64_t one = 1;
+			[[maybe_unused]] const ssize_t written = write(fd_, &one, sizeof(one));
+		}
+
+		void Consume() const
+		{
+			std::uint64_t count = 0;
+			[[maybe_unused]] const ssize_t bytesRead = read(fd_, &count, sizeof(count));
+		}
+	};
+
+	constexpr int WatchdogExitCode = -99;
+
+	// Ends Run with WatchdogExitCode if the test has not quit it within a few seconds,
+	// so a reactor that fails to wake fails the test instead of hanging it.
+	class Watchdog  // NOLINT(cppcoreguidelines-special-member-functions)
+	{
+	private:
+		EventReactor& reactor_;
+		EventFd fd_;
+		EventReactor::RegistrationId id_;
+		std::mutex mutex_;
+		std::condition_variable stopped_;
+		bool stopping_ = false;
+		std::thread thread_;
+
+	public:
+		explicit Watchdog(EventReactor& reactor)
+			: reactor_(reactor)
+			, id_(reactor.Register(fd_.Fd(), [this] { fd_.Consume(); reactor_.Quit(WatchdogExitCode); }))
+			, thread_([this]
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				if (!stopped_.wait_for(lock, 5s, [this] { return stopping_; }))
+				{
+					fd_.Signal();
+				}
+			})
+		{
+		}
+
+		~Watchdog()
+		{
+			{
+				const std::lock_guard<std::mutex> lock(mutex_);
+				stopping_ = true;
+			}
+			stopped_.notify_all();
+			thread_.join();
+			reactor_.Unregister(id_);
+		}
+	};
+}
+
+TEST(PollEventReactor, PostFromAnotherThreadWakesRun)
+{
+	PollEventReactor reactor;
+	std::thread::id ranOn;
+	std::thread poster([&reactor, &ranOn]
+	{
+		std::this_thread::sleep_for(20ms);
+		reactor.Post([&reactor, &ranOn]
+		{
+			ranOn = std::this_thread::get_id();
+			reactor.Quit(7);
+		});
+	});
+
+	EXPECT_EQ(reactor.Run(), 7);
+	poster.join();
+	EXPECT_EQ(ranOn, std::this_thread::get_id());
+
+	const ReactorStats stats = reactor.Stats();
+	EXPECT_EQ(stats.Wakeups, 1u);
+	EXPECT_EQ(stats.Tasks, 1u);
+	EXPECT_EQ(stats.HandleEvents, 0u);
+	EXPECT_EQ(stats.IdleWakeups, 0u);
+}
+
+TEST(PollEventReactor, CallbackUnregistersItselfAndALaterHandler)
+{
+	PollEventReactor reactor;
+	EventFd first;
+	EventFd second;
+	int firstCalls = 0;
+	int secondCalls = 0;
+	EventReactor::RegistrationId firstId = EventReactor::InvalidRegistration;
+	EventReactor::RegistrationId secondId = EventReactor::InvalidRegistration;
+	firstId = reactor.Register(first.Fd(), [&]
+	{
+		++firstCalls;
+		first.Consume();
+		reactor.Unregister(firstId);
+		reactor.Unregister(secondId);
+		reactor.Post([&reactor] { reactor.Quit(0); });
+	});
+	secondId = reactor.Register(second.Fd(), [&] { ++secondCalls; });
+
+	// Both are readable on the same wakeup; the second is left signaled and must not run.
+	first.Signal();
+	second.Signal();
+	EXPECT_EQ(reactor.Run(), 0);
+	EXPECT_EQ(firstCalls, 1);
+	EXPECT_EQ(secondCalls, 0);
+	EXPECT_EQ(reactor.Stats().HandleEvents, 1u);
+	EXPECT_EQ(reactor.Stats().Tasks, 1u);
+}
+
+TEST(PollEventReactor, QuitFromACallbackStopsTheDispatch)
+{
+	PollEventReactor reactor;
+	EventFd first;
+	EventFd second;
+	int secondCalls = 0;
+	const auto firstId = reactor.Register(first.Fd(), [&] { first.Consume(); reactor.Quit(3); });
+	const auto secondId = reactor.Register(second.Fd(), [&] { second.Consume(); ++secondCalls; });
+	int taskRuns = 0;
+	reactor.Post([&] { ++taskRuns; });
+
+	first.Signal();
+	second.Signal();
+	EXPECT_EQ(reactor.Run(), 3);
+	EXPECT_EQ(secondCalls, 0);
+	EXPECT_EQ(taskRuns, 0);
+	EXPECT_EQ(reactor.Stats().HandleEvents, 1u);
+
+	// What was left is dispatched by the next Run, including the task queued before the
+	// quit and one posted after it.
+	reactor.Unregister(firstId);
+	reactor.Unregister(secondId);
+	const Watchdog watchdog(reactor);
+	reactor.Post([&] { ++taskRuns; reactor.Quit(4); });
+	EXPECT_EQ(reactor.Run(), 4);
+	EXPECT_EQ(taskRuns, 2);
+}
+
+TEST(PollEventReactor, IdleCallbackRunsAfterDispatchingButNotWhenQuitting)
+{
+	PollEventReactor reactor;
+	int idleCalls = 0;
+	reactor.SetIdleCallback([&]
+	{
+		++idleCalls;
+		reactor.Post([&reactor] { reactor.Quit(0); });
+	});
+	reactor.Post([] {});
+
+	EXPECT_EQ(reactor.Run(), 0);
+	EXPECT_EQ(idleCalls, 1);
+
+	const ReactorStats stats = reactor.Stats();
+	EXPECT_EQ(stats.Wakeups, 2u);
+	EXPECT_EQ(stats.Tasks, 2u);
+	EXPECT_EQ(stats.IdleWakeups, 0u);
+}
+
+TEST(PollEventReactor, WakeupsThatDispatchNothingAreCountedIdle)
+{
+	PollEventReactor reactor;
+	// A descriptor that is not open wakes poll (POLLNVAL) on every call without being
+	// dispatched, as a handle closed under its registration would.
+	int closed = eventfd(0, EFD_CLOEXEC);
+	close(closed);
+	const auto id = reactor.Register(closed, [] { ADD_FAILURE() << "dispatched a closed descriptor"; });
+
+	int idleCalls = 0;
+	reactor.SetIdleCallback([&] { ++idleCalls; });
+	std::thread poster([&reactor, id]
+	{
+		std::this_thread::sleep_for(20ms);
+		reactor.Post([&reactor, id]
+		{
+			reactor.Unregister(id);
+			reactor.Quit(0);
+		});
+	});
+
+	EXPECT_EQ(reactor.Run(), 0);
+	poster.join();
+
+	// Every wakeup but the one that ran the task found nothing to do.
+	const ReactorStats stats = reactor.Stats();
+	EXPECT_GE(stats.IdleWakeups, 1u);
+	EXPECT_EQ(stats.Wakeups, stats.IdleWakeups + 1);
+	EXPECT_EQ(stats.Tasks, 1u);
+	EXPECT_EQ(stats.HandleEvents, 0u);
+	EXPECT_EQ(idleCalls, 0);
+}
+#endif
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FlightRecorder.h"
+
+namespace
+{
+	// The recorder is process-wide, so each test marks its own events with a code of its own.
+	constexpr std::int32_t WraparoundCode = 0x5701;
+	constexpr std::int32_t OrderingCode = 0x5702;
+	constexpr std::int32_t ConcurrentCode = 0x5703;
+
+	// Lets a reader tell a torn record (fields from two writes) from a whole one.
+	std::int64_t Check(const std::int64_t writer, const std::int64_t n)
+	{
+		return writer * 1000003 ^ n;
+	}
+
+	std::vector<FlightEventRecord> TakeSnapshot()
+	{
+		std::vector<FlightEventRecord> events(FlightRecorder::Capacity);
+		events.resize(FlightRecorder::Instance().Snapshot(events.data(), events.size()));
+		return events;
+	}
+}
+
+TEST(FlightRecorder, KeepsTheNewestEventsOnceTheRingWraps)
+{
+	FlightRecorder& recorder = FlightRecorder::Instance();
+	const std::uint64_t first = recorder.EventCount();
+	constexpr std::int64_t Written = FlightRecorder::Capacity * 2 + 100;
+	for (std::int64_t n = 0; n < Written; ++n)
+	{
+		recorder.Record(FlightEventKind::SetWindowPos, WraparoundCode, n);
+	}
+
+	const std::vector<FlightEventRecord> events = TakeSnapshot();
+	ASSERT_EQ(events.size(), FlightRecorder::Capacity);
+	EXPECT_EQ(recorder.EventCount(), first + Written);
+
+	// The oldest surviving event is exactly one capacity back; everything older was overwritten.
+	EXPECT_EQ(events.front().Sequence, first + Written - FlightRecorder::Capacity);
+	EXPECT_EQ(events.front().Args[0], Written - static_cast<std::int64_t>(FlightRecorder::Capacity));
+	EXPECT_EQ(events.back().Sequence, first + Written - 1);
+	EXPECT_EQ(events.back().Args[0], Written - 1);
+	for (const FlightEventRecord& e : events)
+	{
+		EXPECT_EQ(e.Kind, FlightEventKind::SetWindowPos);
+		EXPECT_EQ(e.Code, WraparoundCode);
+		EXPECT_EQ(static_cast<std::uint64_t>(e.Args[0]), e.Sequence - first);
+	}
+}
+
+TEST(FlightRecorder, SnapshotIsOldestFirstAndStopsAtTheLimit)
+{
+	FlightRecorder& recorder = FlightRecorder::Instance();
+	// Fill the ring, so the snapshot holds only this test's events.
+	for (std::uint64_t n = 0; n < FlightRecorder::Capacity; ++n)
+	{
+		recorder.Record(FlightEventKind::Fade, OrderingCode, static_cast<std::int64_t>(n));
+	}
+
+	const std::vector<FlightEventRecord> events = TakeSnapshot();
+	ASSERT_EQ(events.size(), FlightRecorder::Capacity);
+	for (size_t i = 1; i < events.size(); ++i)
+	{
+		EXPECT_EQ(events[i].Sequence, events[i - 1].Sequence + 1);
+		EXPECT_GE(events[i].TimeUs, events[i - 1].TimeUs);
+		EXPECT_EQ(events[i].Args[0], events[i - 1].Args[0] + 1);
+	}
+
+	// A smaller buffer gets the oldest events.
+	FlightEventRecord few[3]{};
+	ASSERT_EQ(recorder.Snapshot(few, 3), 3u);
+	EXPECT_EQ(few[0].Sequence, events[0].Sequence);
+	EXPECT_EQ(few[2].Sequence, events[2].Sequence);
+}
+
+TEST(FlightRecorder, DumpWritesOneLinePerEvent)
+{
+	FlightRecorder& recorder = FlightRecorder::Instance();
+	recorder.Record(FlightEventKind::Cloak, static_cast<std::int32_t>(0x80070005), 42);
+
+	std::ostringstream out;
+	recorder.Dump(out);
+	const std::string text = out.str();
+
+	EXPECT_EQ(text.rfind("# seq time_us event code a b c d\n", 0), 0u);
+	EXPECT_NE(text.find(" Cloak 0x80070005 42 0 0 0\n"), std::string::npos);
+	const std::uint64_t held = std::min(recorder.EventCount(), FlightRecorder::Capacity);
+	EXPECT_EQ(static_cast<std::uint64_t>(std::count(text.begin(), text.end(), '\n')), held + 1);
+}
+
+TEST(FlightRecorder, SnapshotsTakenDuringConcurrentWritesHoldOnlyWholeEvents)
+{
+	constexpr int Writers = 4;
+	constexpr std::int64_t PerWriter = 20000;
+	FlightRecorder& recorder = FlightRecorder::Instance();
+	const std::uint64_t first = recorder.EventCount();
+
+	std::atomic<bool> go{ false };
+	std::vector<std::thread> writers;
+	for (int w = 0; w < Writers; ++w)
+	{
+		writers.emplace_back([&recorder, &go, w]
+		{
+			while (!go)
+			{
+				std::this_thread::yield();
+			}
+			for (std::int64_t n = 0; n < PerWriter; ++n)
+			{
+				recorder.Record(FlightEventKind::CandidateProbe, ConcurrentCode, w, n, Check(w, n));
+			}
+		});
+	}
+
+	go = true;
+	// Start reading once the writers are under way (they may not have run yet on one core).
+	while (recorder.EventCount() < first + FlightRecorder::Capacity)
+	{
+		std::this_thread::yield();
+	}
+
+	int snapshots = 0;
+	size_t checked = 0;
+	while (recorder.EventCount() < first + Writers * PerWriter || snapshots == 0)
+	{
+		const std::vector<FlightEventRecord> events = TakeSnapshot();
+		++snapshots;
+
+		std::int64_t lastPerWriter[Writers];
+		std::fill(std::begin(lastPerWriter), std::end(lastPerWriter), -1);
+		for (size_t i = 0; i < events.size(); ++i)
+		{
+			const FlightEventRecord& e = events[i];
+			if (i > 0)
+			{
+				ASSERT_GT(e.Sequence, events[i - 1].Sequence);
+			}
+			if (e.Code != ConcurrentCode)
+			{
+				continue; // an older test's event
+			}
+
+			ASSERT_EQ(e.Kind, FlightEventKind::CandidateProbe);
+			ASSERT_GE(e.Args[0], 0);
+			ASSERT_LT(e.Args[0], Writers);
+			ASSERT_EQ(e.Args[2], Check(e.Args[0], e.Args[1])) << "torn event at sequence " << e.Sequence;
+
+			// Each writer's events appear in the order it recorded them.
+			ASSERT_GT(e.Args[1], lastPerWriter[e.Args[0]]);
+			lastPerWriter[e.Args[0]] = e.Args[1];
+			++checked;
+		}
+	}
+
+	for (std::thread& writer : writers)
+	{
+		writer.join();
+	}
+
+	EXPECT_EQ(recorder.EventCount(), first + Writers * PerWriter);
+	EXPECT_GT(checked, 0u);
+
+	// Once the writers are done, the ring holds the newest events. A writer preempted
+	// mid-record while the others lapped the ring publishes its slot late, and that
+	// slot is then skipped; each writer has at most one record in flight.
+	const std::vector<FlightEventRecord> events = TakeSnapshot();
+	ASSERT_GE(events.size(), FlightRecorder::Capacity - Writers);
+	for (const FlightEventRecord& e : events)
+	{
+		EXPECT_GE(e.Sequence, first + Writers * PerWriter - FlightRecorder::Capacity);
+		EXPECT_EQ(e.Args[2], Check(e.Args[0], e.Args[1]));
+	}
+}
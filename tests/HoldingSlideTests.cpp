@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include "HoldingSlide.h"
+#include "WindowGeometry.h"
+
+namespace
+{
+	constexpr std::uint32_t Background = 0x102030u;
+	constexpr std::uint32_t OpaqueBackground = 0xFF102030u;
+	constexpr std::uint32_t Red = 0xFFFF0000u;
+
+	SlideImage Solid(const int width, const int height, const std::uint32_t pixel)
+	{
+		SlideImage image;
+		image.Width = width;
+		image.Height = height;
+		image.Pixels.assign(static_cast<size_t>(width) * height, pixel);
+		return image;
+	}
+
+	std::uint32_t At(const SlideImage& image, const int x, const int y)
+	{
+		return image.Pixels[static_cast<size_t>(y) * image.Width + x];
+	}
+
+	// The bounds of the pixels that are not the background colour (empty if there are none).
+	ScreenRect ContentBounds(const SlideImage& image)
+	{
+		ScreenRect bounds{ image.Width, image.Height, 0, 0 };
+		for (int y = 0; y < image.Height; ++y)
+		{
+			for (int x = 0; x < image.Width; ++x)
+			{
+				if (At(image, x, y) != OpaqueBackground)
+				{
+					bounds.Left = x < bounds.Left ? x : bounds.Left;
+					bounds.Top = y < bounds.Top ? y : bounds.Top;
+					bounds.Right = x + 1 > bounds.Right ? x + 1 : bounds.Right;
+					bounds.Bottom = y + 1 > bounds.Bottom ? y + 1 : bounds.Bottom;
+				}
+			}
+		}
+		return bounds;
+	}
+}
+
+TEST(HoldingSlide, PillarboxesASourceNarrowerThanTheMonitor)
+{
+	// 4:3 onto 2:1: 133 columns wide (100 * 4 / 3), centred.
+	const SlideImage slide = HoldingSlide::Render(Solid(4, 3, Red), 200, 100, Background);
+	ASSERT_EQ(slide.Width, 200);
+	ASSERT_EQ(slide.Height, 100);
+	EXPECT_EQ(ContentBounds(slide), (ScreenRect{ 33, 0, 166, 100 }));
+	EXPECT_EQ(At(slide, 100, 50), Red);
+	EXPECT_EQ(At(slide, 0, 50), OpaqueBackground);
+	EXPECT_EQ(At(slide, 199, 50), OpaqueBackground);
+}
+
+TEST(HoldingSlide, LetterboxesASourceWiderThanTheMonitor)
+{
+	// 16:9 onto a square: 56 rows high (100 * 9 / 16 = 56.25), centred.
+	const SlideImage slide = HoldingSlide::Render(Solid(16, 9, Red), 100, 100, Background);
+	EXPECT_EQ(ContentBounds(slide), (ScreenRect{ 0, 22, 100, 78 }));
+	EXPECT_EQ(At(slide, 50, 0), OpaqueBackground);
+	EXPECT_EQ(At(slide, 50, 50), Red);
+}
+
+TEST(HoldingSlide, ScalingKeepsTheAspectRatioAcrossSizes)
+{
+	const SlideImage source = Solid(160, 90, Red);
+	const int sizes[][2] = { { 1920, 1080 }, { 1280, 1024 }, { 1024, 768 }, { 800, 1280 }, { 3840, 1600 }, { 7, 5 } };
+	for (const auto& size : sizes)
+	{
+		const SlideImage slide = HoldingSlide::Render(source, size[0], size[1], Background);
+		const ScreenRect content = ContentBounds(slide);
+		SCOPED_TRACE(std::to_string(size[0]) + "x" + std::to_string(size[1]));
+
+		// One dimension is filled; the other is within a pixel of 16:9 and centred.
+		EXPECT_TRUE(content.Width() == size[0] || content.Height() == size[1]);
+		EXPECT_NEAR(content.Width() * 9.0, content.Height() * 16.0, 16.0);
+		EXPECT_LE(std::abs(content.Left - (size[0] - content.Right)), 1);
+		EXPECT_LE(std::abs(content.Top - (size[1] - content.Bottom)), 1);
+	}
+}
+
+TEST(HoldingSlide, UniformSourceStaysUniformWhenScaled)
+{
+	for (const auto& slide : { HoldingSlide::Render(Solid(64, 48, Red), 8, 6, Background),
+		HoldingSlide::Render(Solid(3, 2, Red), 300, 200, Background) })
+	{
+		for (const std::uint32_t pixel : slide.Pixels)
+		{
+			ASSERT_EQ(pixel, Red);
+		}
+	}
+}
+
+TEST(HoldingSlide, TranslucentPixelsAreBlendedOverTheBackground)
+{
+	// Premultiplied: half-transparent red is 0x80 alpha, 0x80 red.
+	const SlideImage slide = HoldingSlide::Render(Solid(1, 1, 0x80800000u), 2, 2, 0x0000FFu);
+	EXPECT_EQ(At(slide, 0, 0), 0xFF80007Fu);
+}
+
+TEST(HoldingSlide, EmptySourceGivesAPlainColourSlide)
+{
+	const SlideImage slide = HoldingSlide::Render(SlideImage{}, 4, 3, Background);
+	ASSERT_EQ(slide.Pixels.size(), 12u);
+	for (const std::uint32_t pixel : slide.Pixels)
+	{
+		EXPECT_EQ(pixel, OpaqueBackground);
+	}
+
+	EXPECT_TRUE(HoldingSlide::Render(Solid(4, 3, Red), 0, 100, Background).IsEmpty());
+}
+
+TEST(HoldingSlide, RendersEachSizeOnceWhileCached)
+{
+	HoldingSlide holding(Solid(4, 3, Red), Background);
+	const SlideImage& first = holding.ForSize(1920, 1080);
+	const SlideImage& again = holding.ForSize(1920, 1080);
+	EXPECT_EQ(&first, &again);
+	EXPECT_EQ(holding.Renders(), 1u);
+
+	holding.ForSize(1280, 720);
+	holding.ForSize(1920, 1080);
+	holding.ForSize(1280, 720);
+	EXPECT_EQ(holding.Renders(), 2u);
+}
+
+TEST(HoldingSlide, EvictsTheLeastRecentlyUsedSize)
+{
+	HoldingSlide holding(Solid(4, 3, Red), Background, 2);
+	holding.ForSize(100, 100); // A
+	holding.ForSize(200, 100); // B
+	holding.ForSize(100, 100); // A is now the most recently used
+	EXPECT_EQ(holding.Renders(), 2u);
+
+	holding.ForSize(300, 100); // C evicts B
+	EXPECT_EQ(holding.Renders(), 3u);
+	holding.ForSize(100, 100);
+	EXPECT_EQ(holding.Renders(), 3u); // A survived
+
+	holding.ForSize(200, 100); // B again, evicting C
+	EXPECT_EQ(holding.Renders(), 4u);
+	holding.ForSize(300, 100);
+	EXPECT_EQ(holding.Renders(), 5u);
+}
+
+TEST(HoldingSlide, PreloadedSlidesAreServedWithoutRendering)
+{
+	HoldingSlide holding(Solid(4, 3, Red), Background, 2);
+	holding.Preload(Solid(640, 480, 0xFF00FF00u));
+	holding.Preload(SlideImage{}); // ignored
+
+	const SlideImage& slide = holding.ForSize(640, 480);
+	EXPECT_EQ(holding.Renders(), 0u);
+	EXPECT_EQ(At(slide, 0, 0), 0xFF00FF00u);
+
+	// A second preload of the same size replaces the first instead of taking another slot.
+	holding.Preload(Solid(640, 480, 0xFF0000FFu));
+	holding.ForSize(320, 240);
+	EXPECT_EQ(At(holding.ForSize(640, 480), 0, 0), 0xFF0000FFu);
+	EXPECT_EQ(holding.Renders(), 1u);
+}
+
+TEST(HoldingSlide, ParsesColours)
+{
+	std::uint32_t color = 0;
+	ASSERT_TRUE(HoldingSlide::ParseColor(L"#1a2B3c", color));
+	EXPECT_EQ(color, 0x1A2B3Cu);
+	EXPECT_FALSE(HoldingSlide::ParseColor(L"1a2b3c", color));
+	EXPECT_FALSE(HoldingSlide::ParseColor(L"#1a2b3", color));
+	EXPECT_FALSE(HoldingSlide::ParseColor(L"#1a2b3g", color));
+}
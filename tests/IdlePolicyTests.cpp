@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "IdlePolicy.h"
+
+namespace
+{
+	using namespace std::chrono_literals;
+	using Clock = IdlePolicy::Clock;
+
+	// A fake clock: an arbitrary fixed origin that the tests advance by hand.
+	const Clock::time_point Start = Clock::time_point{} + 1h;
+}
+
+TEST(IdlePolicy, ReleasesOnceAfterTheReleasePeriod)
+{
+	IdlePolicy policy(600s, Start);
+	EXPECT_EQ(policy.NextRelease(), Start + 600s);
+	EXPECT_EQ(policy.OnTick(Start + 599s), IdleAction::None);
+	EXPECT_FALSE(policy.IsReleased());
+
+	EXPECT_EQ(policy.OnTick(Start + 600s), IdleAction::Release);
+	EXPECT_TRUE(policy.IsReleased());
+
+	EXPECT_EQ(policy.OnTick(Start + 1200s), IdleAction::None); // only once
+	EXPECT_EQ(policy.NextRelease(), Clock::time_point::max());
+}
+
+TEST(IdlePolicy, ZoomStartingAcquiresAgain)
+{
+	IdlePolicy policy(600s, Start);
+	ASSERT_EQ(policy.OnTick(Start + 600s), IdleAction::Release);
+
+	EXPECT_EQ(policy.OnZoomPresence(false, Start + 700s), IdleAction::None);
+	EXPECT_EQ(policy.OnZoomPresence(true, Start + 700s), IdleAction::Acquire);
+	EXPECT_FALSE(policy.IsReleased());
+	EXPECT_EQ(policy.OnZoomPresence(true, Start + 710s), IdleAction::None);
+}
+
+TEST(IdlePolicy, NeverReleasesWhileZoomIsRunning)
+{
+	IdlePolicy policy(600s, Start);
+	EXPECT_EQ(policy.OnZoomPresence(true, Start), IdleAction::None);
+	EXPECT_EQ(policy.OnTick(Start + 5h), IdleAction::None);
+	EXPECT_EQ(policy.NextRelease(), Clock::time_point::max());
+
+	// The period starts when Zoom exits.
+	EXPECT_EQ(policy.OnZoomPresence(false, Start + 5h), IdleAction::None);
+	EXPECT_EQ(policy.OnZoomPresence(false, Start + 5h + 599s), IdleAction::None);
+	EXPECT_EQ(policy.OnZoomPresence(false, Start + 5h + 600s), IdleAction::Release);
+}
+
+TEST(IdlePolicy, UserIntentRestartsThePeriodAndAcquires)
+{
+	IdlePolicy policy(600s, Start);
+	EXPECT_EQ(policy.OnUserIntent(Start + 500s), IdleAction::None); // not released: restarts the period
+	EXPECT_EQ(policy.OnTick(Start + 1000s), IdleAction::None);
+	EXPECT_EQ(policy.OnTick(Start + 1100s), IdleAction::Release);
+
+	EXPECT_EQ(policy.OnUserIntent(Start + 1200s), IdleAction::Acquire);
+	EXPECT_FALSE(policy.IsReleased());
+	EXPECT_EQ(policy.NextRelease(), Start + 1800s);
+	EXPECT_EQ(policy.OnUserIntent(Start + 1210s), IdleAction::None);
+}
+
+TEST(IdlePolicy, ZeroPeriodNeverReleases)
+{
+	IdlePolicy policy(0s, Start);
+	EXPECT_EQ(policy.OnTick(Start + 100h), IdleAction::None);
+	EXPECT_EQ(policy.OnZoomPresence(false, Start + 200h), IdleAction::None);
+	EXPECT_EQ(policy.NextRelease(), Clock::time_point::max());
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "LatencyHistogram.h"
+
+TEST(LatencyHistogram, SmallValuesHaveTheirOwnBuckets)
+{
+	for (std::uint64_t value = 0; value < 2 * LatencyHistogram::SubBucketCount; ++value)
+	{
+		EXPECT_EQ(LatencyHistogram::BucketIndex(value), static_cast<int>(value));
+		EXPECT_EQ(LatencyHistogram::BucketUpperBound(static_cast<int>(value)), value);
+	}
+}
+
+TEST(LatencyHistogram, BucketsAreContiguousAndWithinPrecision)
+{
+	// Every value lies in its bucket, buckets follow each other without gaps, and
+	// each is no wider than 1/32 of its values.
+	int previous = -1;
+	for (std::uint64_t value = 0; value < (1u << 20); ++value)
+	{
+		const int index = LatencyHistogram::BucketIndex(value);
+		ASSERT_TRUE(index == previous || index == previous + 1) << value;
+		ASSERT_GE(LatencyHistogram::BucketUpperBound(index), value);
+		if (index != previous && index > 0)
+		{
+			ASSERT_EQ(LatencyHistogram::BucketUpperBound(index - 1), value - 1);
+		}
+		previous = index;
+	}
+
+	for (int index = 2 * LatencyHistogram::SubBucketCount; index < LatencyHistogram::BucketCount; ++index)
+	{
+		const std::uint64_t lower = LatencyHistogram::BucketUpperBound(index - 1) + 1;
+		const std::uint64_t width = LatencyHistogram::BucketUpperBound(index) - lower + 1;
+		EXPECT_LE(width * LatencyHistogram::SubBucketCount, lower) << index;
+	}
+}
+
+TEST(LatencyHistogram, LastBucketHoldsTheTrackableMaximum)
+{
+	EXPECT_EQ(LatencyHistogram::BucketIndex(LatencyHistogram::MaxTrackableValue), LatencyHistogram::BucketCount - 1);
+	EXPECT_EQ(LatencyHistogram::BucketIndex(~std::uint64_t{ 0 }), LatencyHistogram::BucketCount - 1);
+	EXPECT_EQ(LatencyHistogram::BucketUpperBound(LatencyHistogram::BucketCount - 1), LatencyHistogram::MaxTrackableValue);
+}
+
+TEST(LatencyHistogram, ClampsOutOfRangeValues)
+{
+	LatencyHistogram h;
+	h.Record(-5);
+	h.Record(INT64_MAX);
+
+	EXPECT_EQ(h.TotalCount(), 2u);
+	EXPECT_EQ(h.Min(), 0u);
+	EXPECT_EQ(h.Max(), LatencyHistogram::MaxTrackableValue);
+}
+
+TEST(LatencyHistogram, PercentilesReportBucketUpperBoundsClampedToMax)
+{
+	LatencyHistogram h;
+	for (int value = 1; value <= 100; ++value)
+	{
+		h.Record(value * 1000);
+	}
+
+	EXPECT_EQ(h.Min(), 1000u);
+	EXPECT_EQ(h.Max(), 100000u);
+	EXPECT_DOUBLE_EQ(h.Mean(), 50500.0);
+
+	const std::uint64_t p50 = h.ValueAtPercentile(50.0);
+	EXPECT_GE(p50, 50000u);
+	EXPECT_LE(p50, 50000u + (50000u / LatencyHistogram::SubBucketCount));
+	EXPECT_EQ(h.ValueAtPercentile(100.0), 100000u);
+	EXPECT_EQ(h.ValueAtPercentile(150.0), 100000u);
+	EXPECT_EQ(h.ValueAtPercentile(0.0), LatencyHistogram::BucketUpperBound(LatencyHistogram::BucketIndex(1000)));
+}
+
+TEST(LatencyHistogram, EmptyHistogramReportsZero)
+{
+	const LatencyHistogram h;
+	EXPECT_EQ(h.Min(), 0u);
+	EXPECT_EQ(h.Max(), 0u);
+	EXPECT_EQ(h.Mean(), 0.0);
+	EXPECT_EQ(h.ValueAtPercentile(99.0), 0u);
+}
+
+TEST(LatencyHistogram, MergeMatchesRecordingEverything)
+{
+	LatencyHistogram a;
+	LatencyHistogram b;
+	LatencyHistogram all;
+	for (int i = 0; i < 500; ++i)
+	{
+		const std::int64_t value = (i * 7919) % 250000;
+		(i % 3 == 0 ? a : b).Record(value);
+		all.Record(value);
+	}
+
+	a.Merge(b);
+	EXPECT_EQ(a.TotalCount(), all.TotalCount());
+	EXPECT_EQ(a.Min(), all.Min());
+	EXPECT_EQ(a.Max(), all.Max());
+	EXPECT_DOUBLE_EQ(a.Mean(), all.Mean());
+	for (const double p : { 1.0, 50.0, 90.0, 99.0, 99.9 })
+	{
+		EXPECT_EQ(a.ValueAtPercentile(p), all.ValueAtPercentile(p)) << p;
+	}
+}
+
+TEST(LatencyHistogram, MergingAnEmptyHistogramKeepsTheMinimum)
+{
+	LatencyHistogram h;
+	h.Record(40);
+	h.Merge(LatencyHistogram());
+	EXPECT_EQ(h.Min(), 40u);
+	EXPECT_EQ(h.TotalCount(), 1u);
+}
+
+TEST(LatencyHistogram, WriteReadRoundTrips)
+{
+	LatencyHistogram h;
+	for (int i = 0; i < 1000; ++i)
+	{
+		h.Record(i * 37);
+	}
+
+	std::stringstream data;
+	h.Write(data);
+	LatencyHistogram read;
+	ASSERT_TRUE(read.Read(data));
+
+	EXPECT_EQ(read.TotalCount(), h.TotalCount());
+	EXPECT_EQ(read.Min(), h.Min());
+	EXPECT_EQ(read.Max(), h.Max());
+	EXPECT_EQ(read.ValueAtPercentile(95.0), h.ValueAtPercentile(95.0));
+}
+
+TEST(LatencyHistogram, ReadRejectsTruncatedOrInconsistentData)
+{
+	LatencyHistogram h;
+	h.Record(10);
+	h.Record(5000);
+	std::ostringstream out;
+	h.Write(out);
+	const std::string data = out.str();
+
+	LatencyHistogram read;
+	std::istringstream truncated(data.substr(0, data.size() - 1));
+	EXPECT_FALSE(read.Read(truncated));
+	EXPECT_EQ(read.TotalCount(), 0u);
+
+	std::string inconsistent = data;
+	inconsistent[0] = 3; // total count no longer matches the buckets
+	std::istringstream in(inconsistent);
+	EXPECT_FALSE(read.Read(in));
+	EXPECT_EQ(read.TotalCount(), 0u);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+#include "MediaWindowDiscovery.h"
+
+namespace
+{
+	/// <summary>
+	/// Answers each candidate's marker search from a script (1, 0, -1 or
+	/// CandidateUnavailable), recording the order of the searches.
+	/// </summary>
+	class ScriptedBackend : public DiscoveryBackend
+	{
+	public:
+		std::vector<int> Markers;
+		std::vector<int> Probed;
+
+		explicit ScriptedBackend(std::vector<int> markers)
+			: Markers(std::move(markers))
+		{
+		}
+
+		int FindCandidates(const MediaWindowSelectors&) override
+		{
+			Probed.clear();
+			return static_cast<int>(Markers.size());
+		}
+
+		int CandidateHasMainWindowMarker(const int candidateIndex, const MediaWindowSelectors&) override
+		{
+			Probed.push_back(candidateIndex);
+			return Markers[static_cast<size_t>(candidateIndex)];
+		}
+	};
+
+	DiscoveryOutcome Locate(ScriptedBackend& backend, const DiscoveryStrategy strategy = DiscoveryStrategy::InOrder)
+	{
+		return MediaWindowDiscovery::Locate(backend, MediaWindowSelectors::Zoom(), CancellationToken(), strategy);
+	}
+
+	constexpr int Unavailable = DiscoveryBackend::CandidateUnavailable;
+}
+
+TEST(MediaWindowDiscovery, SingleCandidateIsSelectedWithoutProbing)
+{
+	ScriptedBackend backend({ 1 });
+	const DiscoveryOutcome outcome = Locate(backend);
+	EXPECT_EQ(outcome.SelectedIndex, 0);
+	EXPECT_EQ(outcome.Probes, 0);
+}
+
+TEST(MediaWindowDiscovery, SelectsTheFirstCandidateWithoutAMarker)
+{
+	ScriptedBackend backend({ 1, 1, 0, 0 });
+	const DiscoveryOutcome outcome = Locate(backend);
+	EXPECT_EQ(outcome.SelectedIndex, 2);
+	EXPECT_EQ(backend.Probed, (std::vector<int>{ 0, 1, 2 }));
+}
+
+TEST(MediaWindowDiscovery, SkipsACandidateThatIsNoLongerAvailable)
+{
+	ScriptedBackend backend({ Unavailable, 1, 0 });
+	EXPECT_EQ(Locate(backend).SelectedIndex, 2);
+
+	ScriptedBackend gone({ Unavailable, 1 });
+	EXPECT_EQ(Locate(gone).SelectedIndex, -1);
+}
+
+TEST(MediaWindowDiscovery, FailedSearchCountsAsNoMarker)
+{
+	ScriptedBackend backend({ 1, -1, 0 });
+	EXPECT_EQ(Locate(backend).SelectedIndex, 1);
+}
+
+TEST(MediaWindowDiscovery, ReverseProbesFromTheLastCandidate)
+{
+	ScriptedBackend backend({ 0, 1, 1, 0 });
+	const DiscoveryOutcome outcome = Locate(backend, DiscoveryStrategy::Reverse);
+	EXPECT_EQ(outcome.SelectedIndex, 3);
+	EXPECT_EQ(backend.Probed, (std::vector<int>{ 3 }));
+
+	ScriptedBackend unavailableLast({ 0, 1, Unavailable });
+	EXPECT_EQ(Locate(unavailableLast, DiscoveryStrategy::Reverse).SelectedIndex, 0);
+}
+
+TEST(MediaWindowDiscovery, ProbeAllSelectsOnlyAnUnambiguousWindow)
+{
+	ScriptedBackend backend({ 1, 0, 1, Unavailable });
+	DiscoveryOutcome outcome = Locate(backend, DiscoveryStrategy::ProbeAll);
+	EXPECT_EQ(outcome.SelectedIndex, 1);
+	EXPECT_EQ(outcome.Probes, 4);
+
+	ScriptedBackend ambiguous({ 0, 1, -1 });
+	outcome = Locate(ambiguous, DiscoveryStrategy::ProbeAll);
+	EXPECT_EQ(outcome.SelectedIndex, -1);
+	EXPECT_EQ(outcome.Probes, 3);
+}
+
+TEST(MediaWindowDiscovery, NamesEveryStrategy)
+{
+	EXPECT_STREQ(MediaWindowDiscovery::StrategyName(DiscoveryStrategy::InOrder), "in-order");
+	EXPECT_STREQ(MediaWindowDiscovery::StrategyName(DiscoveryStrategy::Reverse), "reverse");
+	EXPECT_STREQ(MediaWindowDiscovery::StrategyName(DiscoveryStrategy::ProbeAll), "probe-all");
+}
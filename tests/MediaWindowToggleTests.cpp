@@ -0,0 +1,709 @@
+#include <gtest/gtest.h>
+#include <initializer_list>
+#include <map>
+#include <utility>
+#include <vector>
+#include "DesktopModel.h"
+#include "MediaWindowToggle.h"
+
+namespace
+{
+	struct FakeMonitor
+	{
+		ScreenRect Rect;
+		unsigned Dpi;
+	};
+
+	struct FakeWindow
+	{
+		ScreenRect Rect;
+		unsigned Dpi = FrameMetrics::BaseDpi;
+		bool Minimized = false;
+		bool Maximized = false;
+		bool Visible = true;
+		bool Cloaked = false;
+		bool Layered = false;
+		bool Topmost = false;
+		std::uint8_t Alpha = 255;
+		ScreenRect NormalRect;
+	};
+
+	/// <summary>
+	/// A desktop for the toggle: Zoom's windows as a DesktopModel (whose searches
+	/// count themselves, like UI Automation's) with the window manager's view of
+	/// them alongside, on a fake clock. Like Win32PlatformBackend, it counts each
+	/// call it stands in for where it makes it, and reads settings one key at a time.
+	/// A per-monitor aware window moved onto a monitor of another DPI resizes itself
+	/// to the suggested rect, unless IgnoresDpiChange is set.
+	/// </summary>
+	class FakePlatform : public PlatformBackend
+	{
+	private:
+		int current_ = -1; // element of the current window
+		std::uint32_t resizes_ = 0;
+		std::uint64_t nowMs_ = 1000;
+
+		static void Count(const CallCategory category)
+		{
+			CallCountScope::Count(category);
+		}
+
+		int ReadSetting(const std::wstring& key)
+		{
+			Count(CallCategory::IniFileAccess);
+			const auto it = Settings.find(key);
+			return it != Settings.end() ? it->second : 0;
+		}
+
+		// The monitor containing the rect's centre (the window manager takes the one with the most of it).
+		const FakeMonitor& MonitorOf(const ScreenRect& rect) const
+		{
+			const int x = rect.Left + (rect.Width() / 2);
+			const int y = rect.Top + (rect.Height() / 2);
+			for (const auto& monitor : Monitors)
+			{
+				if (x >= monitor.Rect.Left && x < monitor.Rect.Right && y >= monitor.Rect.Top && y < monitor.Rect.Bottom)
+				{
+					return monitor;
+				}
+			}
+			return Monitors.front();
+		}
+
+		void Move(FakeWindow& window, const ScreenRect& rect)
+		{
+			const unsigned dpi = MonitorOf(rect).Dpi;
+			window.Rect = rect;
+			++resizes_;
+			if (dpi != window.Dpi)
+			{
+				if (!IgnoresDpiChange)
+				{
+					window.Rect = WindowGeometry::SuggestedRectAfterDpiChange(rect, window.Dpi, dpi);
+					++resizes_;
+				}
+				window.Dpi = dpi;
+			}
+		}
+
+	public:
+		DesktopModel Desktop;
+		std::map<PlatformWindow, FakeWindow> Windows;
+		std::map<int, PlatformWindow> WindowOfElement;
+		std::vector<FakeMonitor> Monitors{ { { 0, 0, 1920, 1080 }, 96 }, { { 1920, 0, 3840, 1080 }, 96 } };
+		std::vector<std::wstring> Processes{ L"explorer.exe", L"Zoom.exe" };
+		std::map<std::wstring, int> Settings; // settings.ini, with ToggleMode=mirror as 1
+		bool IgnoresDpiChange = false;
+		bool CanCloak = true; // false: cloaking fails, as before Windows 8
+		FrameMetrics Frame{ { 8, 31, 8, 8 }, { 7, 0, 7, 7 }, FrameMetrics::BaseDpi };
+
+		FakePlatform()
+		{
+			SetTargetMonitor({ 1920, 0, 3840, 1080 });
+		}
+
+		void SetTargetMonitor(const ScreenRect& rect)
+		{
+			Settings[L"SelectedMonitorL"] = rect.Left;
+			Settings[L"SelectedMonitorT"] = rect.Top;
+			Settings[L"SelectedMonitorR"] = rect.Right;
+			Settings[L"SelectedMonitorB"] = rect.Bottom;
+		}
+
+		ScreenRect TargetMonitor() const
+		{
+			return ScreenRect{ Settings.at(L"SelectedMonitorL"), Settings.at(L"SelectedMonitorT"),
+				Settings.at(L"SelectedMonitorR"), Settings.at(L"SelectedMonitorB") };
+		}
+
+		// Adds a top-level Zoom window; a main window has the conference controls.
+		PlatformWindow AddZoomWindow(const ScreenRect& rect, const bool mainWindow = false)
+		{
+			const int element = Desktop.AddElement(0, L"Zoom Meeting", L"ConfMultiTabContentWndClass", L"", 42);
+			const int content = Desktop.AddElement(element, L"", L"Pane", L"", 42);
+			if (mainWindow)
+			{
+				Desktop.AddElement(content, L"", L"Button", MediaWindowSelectors::Zoom().MainWindowHelpTexts.front(), 42);
+			}
+
+			const PlatformWindow window = 0x1000 + static_cast<PlatformWindow>(element);
+			WindowOfElement[element] = window;
+			FakeWindow state;
+			state.Rect = rect;
+			state.NormalRect = rect;
+			Windows[window] = state;
+			return window;
+		}
+
+		std::vector<std::wstring> ProcessNames() override
+		{
+			Count(CallCategory::ProcessSnapshot);
+			return Processes;
+		}
+
+		ScreenRect LoadTargetMonitorRect() override
+		{
+			const int left = ReadSetting(L"SelectedMonitorL");
+			const int top = ReadSetting(L"SelectedMonitorT");
+			const int right = ReadSetting(L"SelectedMonitorR");
+			const int bottom = ReadSetting(L"SelectedMonitorB");
+			return ScreenRect{ left, top, right, bottom };
+		}
+
+		bool LoadMirrorMode() override { return ReadSetting(L"ToggleMode") != 0; }
+
+		FrameInsets LoadMirrorCrop() override
+		{
+			const int left = ReadSetting(L"MirrorCropLeft");
+			const int top = ReadSetting(L"MirrorCropTop");
+			const int right = ReadSetting(L"MirrorCropRight");
+			const int bottom = ReadSetting(L"MirrorCropBottom");
+			return FrameInsets{ left, top, right, bottom };
+		}
+
+		bool HasAutomation() const override { return true; }
+		bool ConnectDesktop() override { return true; }
+
+		OperationStatus LocateMediaWindow(const std::vector<std::shared_ptr<const MediaWindowSelectors>>& selectors,
+			DiscoveryOutcome& outcome) override
+		{
+			for (const auto& providerSelectors : selectors)
+			{
+				outcome = MediaWindowDiscovery::Locate(Desktop, *providerSelectors);
+				if (outcome.SelectedIndex >= 0)
+				{
+					current_ = Desktop.CandidateElement(outcome.SelectedIndex);
+					break;
+				}
+			}
+			return OperationStatus::Completed;
+		}
+
+		PlatformResult AdoptWindowElement(const PlatformWindow window) override
+		{
+			Count(CallCategory::UiaFind); // ElementFromHandle
+			for (const auto& [element, elementWindow] : WindowOfElement)
+			{
+				if (elementWindow == window && IsWindow(window))
+				{
+					current_ = element;
+					return PlatformResult::Ok;
+				}
+			}
+			return PlatformResult::Failed;
+		}
+
+		PlatformResult ReadElementWindow(PlatformWindow& window) override
+		{
+			Count(CallCategory::UiaPropertyRead);
+			const auto it = WindowOfElement.find(current_);
+			if (it == WindowOfElement.end())
+			{
+				return PlatformResult::Failed;
+			}
+			window = it->second;
+			return PlatformResult::Ok;
+		}
+
+		PlatformResult ReadElementRect(ScreenRect& rect) override
+		{
+			Count(CallCategory::UiaPropertyRead);
+			const auto it = WindowOfElement.find(current_);
+			if (it == WindowOfElement.end())
+			{
+				return PlatformResult::Failed;
+			}
+			rect = Windows.at(it->second).Rect;
+			return PlatformResult::Ok;
+		}
+
+		bool IsWindow(const PlatformWindow window) override { return Windows.count(window) != 0; }
+		bool IsMinimized(const PlatformWindow window) override { return Windows.at(window).Minimized; }
+
+		bool GetWindowRect(const PlatformWindow window, ScreenRect& rect) override
+		{
+			rect = Windows.at(window).Rect;
+			return true;
+		}
+
+		unsigned WindowDpi(const PlatformWindow window) override { return Windows.at(window).Dpi; }
+		unsigned MonitorDpi(const ScreenRect& monitorRect) override { return MonitorOf(monitorRect).Dpi; }
+		unsigned SystemDpi() override { return Monitors.front().Dpi; }
+		ScreenRect PrimaryWorkArea() override { return ScreenRect{ 0, 0, 1920, 1040 }; }
+		FrameMetrics WindowFrameMetrics(PlatformWindow, const unsigned dpi) override { return Frame.ScaledTo(dpi); }
+
+		bool GetWindowPlacement(const PlatformWindow window, WindowPlacementInfo& placement) override
+		{
+			Count(CallCategory::GetWindowPlacement);
+			const FakeWindow& state = Windows.at(window);
+			placement.ShowState = state.Minimized ? WindowShowState::Minimized
+				: state.Maximized ? WindowShowState::Maximized : WindowShowState::Normal;
+			placement.NormalRect = state.NormalRect;
+			return true;
+		}
+
+		// Read, modified and written back.
+		void SetWindowPlacement(const PlatformWindow window, const WindowPlacementInfo& placement) override
+		{
+			WindowPlacementInfo current;
+			GetWindowPlacement(window, current);
+			Count(CallCategory::SetWindowPlacement);
+			Windows.at(window).NormalRect = placement.NormalRect;
+		}
+
+		bool MoveTopmost(const PlatformWindow window, const ScreenRect& rect) override
+		{
+			Count(CallCategory::SetWindowPos);
+			FakeWindow& state = Windows.at(window);
+			state.Topmost = true;
+			state.Maximized = false;
+			Move(state, rect);
+			return true;
+		}
+
+		// BringWindowToTop (a SetWindowPos), SetForegroundWindow, then SetWindowPos topmost.
+		bool ForceToForeground(const PlatformWindow window) override
+		{
+			Count(CallCategory::SetWindowPos);
+			Count(CallCategory::SetForegroundWindow);
+			Count(CallCategory::SetWindowPos);
+			Windows.at(window).Topmost = true;
+			return true;
+		}
+
+		bool LowerFromTopmost(const PlatformWindow window) override
+		{
+			Count(CallCategory::SetWindowPos);
+			Windows.at(window).Topmost = false;
+			return true;
+		}
+
+		bool RestoreWindow(const PlatformWindow window, const ScreenRect& rect) override
+		{
+			Count(CallCategory::SetWindowPos);
+			FakeWindow& state = Windows.at(window);
+			state.Topmost = false;
+			state.Visible = true;
+			Move(state, rect);
+			return true;
+		}
+
+		void Minimize(const PlatformWindow window) override
+		{
+			Count(CallCategory::ShowWindow);
+			Windows.at(window).Minimized = true;
+		}
+
+		void Maximize(const PlatformWindow window) override
+		{
+			Count(CallCategory::ShowWindow);
+			Windows.at(window).Maximized = true;
+		}
+
+		void Restore(const PlatformWindow window) override
+		{
+			Count(CallCategory::ShowWindow);
+			FakeWindow& state = Windows.at(window);
+			state.Minimized = false;
+			state.Rect = state.NormalRect;
+		}
+
+		void Show(const PlatformWindow window) override
+		{
+			Count(CallCategory::ShowWindow);
+			Windows.at(window).Visible = true;
+		}
+
+		void Hide(const PlatformWindow window) override
+		{
+			Count(CallCategory::ShowWindow);
+			Windows.at(window).Visible = false;
+		}
+
+		void Activate(PlatformWindow) override { Count(CallCategory::SetForegroundWindow); }
+		bool HasLayeredStyle(const PlatformWindow window) override { return Windows.at(window).Layered; }
+
+		void SetLayeredStyle(const PlatformWindow window, const bool layered) override
+		{
+			Count(CallCategory::SetWindowLong);
+			Windows.at(window).Layered = layered;
+		}
+
+		void Redraw(PlatformWindow) override { Count(CallCategory::RedrawWindow); }
+
+		bool SetWindowAlpha(const PlatformWindow window, const std::uint8_t alpha) override
+		{
+			Count(CallCategory::SetLayeredWindowAttributes);
+			FakeWindow& state = Windows.at(window);
+			state.Alpha = alpha;
+			return state.Layered;
+		}
+
+		bool SetCloaked(const PlatformWindow window, const bool cloaked) override
+		{
+			Count(CallCategory::DwmSetWindowAttribute);
+			if (!CanCloak)
+			{
+				return false;
+			}
+			Windows.at(window).Cloaked = cloaked;
+			return true;
+		}
+
+		bool SetTransitionsDisabled(PlatformWindow, bool) override
+		{
+			Count(CallCategory::DwmSetWindowAttribute);
+			return true;
+		}
+
+		void BeginResizeCount(PlatformWindow) override { resizes_ = 0; }
+		void SettleResizes(unsigned, unsigned) override {}
+		std::uint32_t EndResizeCount() override { return resizes_; }
+
+		std::uint64_t TickMs() override { return nowMs_; }
+		void SleepMs(const unsigned ms) override { nowMs_ += ms; }
+		std::int64_t CompositionNow() override { return static_cast<std::int64_t>(nowMs_); }
+
+	};
+
+	/// <summary>
+	/// Records what the toggle reports, and optionally offers a warm start window.
+	/// </summary>
+	class RecordingObserver : public MediaWindowToggle::Observer
+	{
+	public:
+		PlatformWindow WarmStart = 0;
+		int WarmStartsUnavailable = 0;
+		int Mirrors = 0;
+		int Toggles = 0;
+		std::uint32_t LastFallbacks = 0;
+
+		PlatformWindow WarmStartWindow() override { return WarmStart; }
+		void WarmStartUnavailable() override { ++WarmStartsUnavailable; }
+
+		void Mirror(PlatformWindow, const ScreenRect&, DisplayWindowResult& result) override
+		{
+			++Mirrors;
+			result.Placement = MediaWindowPlacement::Mirrored;
+			result.AllOk = true;
+		}
+
+		void OnToggled(PlatformWindow, const std::uint32_t fallbacks) override
+		{
+			++Toggles;
+			LastFallbacks = fallbacks;
+		}
+	};
+
+	DisplayWindowResult Toggle(MediaWindowToggle& toggle)
+	{
+		DisplayWindowResult result;
+		{
+			const CallCountScope callScope(result.Calls);
+			toggle.Run(result);
+		}
+		return result;
+	}
+
+	CallCounts Counts(const std::initializer_list<std::pair<CallCategory, std::uint32_t>> values)
+	{
+		CallCounts counts;
+		for (const auto& [category, count] : values)
+		{
+			counts[category] = count;
+		}
+		return counts;
+	}
+
+	// 31 fade frames over 300 ms on the fake clock, plus alpha 0 before and 255 after.
+	constexpr std::uint32_t FadeAlphaCalls = 33;
+
+	ProviderRegistry ZoomOnly()
+	{
+		ProviderRegistry providers;
+		providers.Add(ProviderRegistry::Zoom());
+		return providers;
+	}
+
+	// Finding the window (the snapshot, FindAll and any probes, the settings and both
+	// properties), then the cloak-move-fade transition: one move (or two, corrected)
+	// and two more to raise it, the layered style on and off, and the fade.
+	CallCounts DisplayCalls(const std::uint32_t finds = 1, const std::uint32_t setWindowPos = 3)
+	{
+		return Counts({
+			{ CallCategory::ProcessSnapshot, 1 },
+			{ CallCategory::UiaFind, finds },
+			{ CallCategory::IniFileAccess, 5 },
+			{ CallCategory::UiaPropertyRead, 2 },
+			{ CallCategory::GetWindowPlacement, 1 },
+			{ CallCategory::DwmSetWindowAttribute, 4 },
+			{ CallCategory::SetWindowPos, setWindowPos },
+			{ CallCategory::SetLayeredWindowAttributes, FadeAlphaCalls },
+			{ CallCategory::SetWindowLong, 2 },
+			{ CallCategory::ShowWindow, 1 },
+			{ CallCategory::SetForegroundWindow, 1 },
+			{ CallCategory::RedrawWindow, 1 } });
+	}
+
+	// Finding the window, then activating it and moving it back.
+	CallCounts SendBackCalls()
+	{
+		return Counts({
+			{ CallCategory::ProcessSnapshot, 1 },
+			{ CallCategory::UiaFind, 1 },
+			{ CallCategory::IniFileAccess, 5 },
+			{ CallCategory::UiaPropertyRead, 2 },
+			{ CallCategory::SetWindowPos, 1 },
+			{ CallCategory::SetForegroundWindow, 1 } });
+	}
+
+	void ExpectWithinBudget(const DisplayWindowResult& result)
+	{
+		EXPECT_FALSE(result.Calls.Exceeds(CallCounts::DefaultToggleBudget())) << result.Calls.Format();
+	}
+}
+
+TEST(MediaWindowToggle, DisplayMakesTheBudgetedCalls)
+{
+	FakePlatform platform;
+	const PlatformWindow window = platform.AddZoomWindow({ 100, 100, 900, 700 });
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	EXPECT_EQ(result.Placement, MediaWindowPlacement::OnProjector);
+	EXPECT_EQ(result.Calls.Format(), DisplayCalls().Format());
+	ExpectWithinBudget(result);
+
+	const FakeWindow& state = platform.Windows.at(window);
+	EXPECT_EQ(state.Rect, (ScreenRect{ 1912, -31, 3848, 1088 }));
+	EXPECT_TRUE(state.Topmost);
+	EXPECT_FALSE(state.Cloaked);
+	EXPECT_FALSE(state.Layered);
+	EXPECT_EQ(state.Alpha, 255);
+	EXPECT_EQ(result.Fallbacks, static_cast<std::uint32_t>(ToggleFallbackSingleCandidate));
+}
+
+TEST(MediaWindowToggle, SendBackMakesOneMove)
+{
+	FakePlatform platform;
+	const PlatformWindow window = platform.AddZoomWindow({ 100, 100, 900, 700 });
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+	ASSERT_TRUE(Toggle(toggle).AllOk);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	EXPECT_EQ(result.Placement, MediaWindowPlacement::Restored);
+	EXPECT_EQ(result.Calls.Format(), SendBackCalls().Format());
+	ExpectWithinBudget(result);
+
+	const FakeWindow& state = platform.Windows.at(window);
+	EXPECT_EQ(state.Rect, (ScreenRect{ 100, 100, 900, 700 }));
+	EXPECT_FALSE(state.Topmost);
+}
+
+TEST(MediaWindowToggle, ProbesCandidatesUntilTheMediaWindow)
+{
+	FakePlatform platform;
+	platform.AddZoomWindow({ 0, 0, 1200, 800 }, true);
+	const PlatformWindow media = platform.AddZoomWindow({ 100, 100, 900, 700 });
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	EXPECT_EQ(result.Calls.Format(), DisplayCalls(3).Format()); // FindAll + a FindFirst per candidate probed
+	ExpectWithinBudget(result);
+	EXPECT_TRUE(platform.Windows.at(media).Topmost);
+	EXPECT_NE(result.Fallbacks & ToggleFallbackMultipleCandidates, 0u);
+}
+
+TEST(MediaWindowToggle, TenCandidatesStayWithinBudget)
+{
+	FakePlatform platform;
+	for (int i = 0; i < 9; ++i)
+	{
+		platform.AddZoomWindow({ 0, 0, 1200, 800 }, true);
+	}
+	platform.AddZoomWindow({ 100, 100, 900, 700 });
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	EXPECT_EQ(result.Calls[CallCategory::UiaFind], 11u);
+	ExpectWithinBudget(result);
+}
+
+TEST(MediaWindowToggle, MinimizedWindowIsRestoredAndMinimizedAgain)
+{
+	FakePlatform platform;
+	const PlatformWindow window = platform.AddZoomWindow({ 100, 100, 900, 700 });
+	platform.Windows.at(window).Minimized = true;
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+
+	const DisplayWindowResult display = Toggle(toggle);
+	ASSERT_TRUE(display.AllOk) << display.ErrorMessage;
+	CallCounts restored = DisplayCalls();
+	restored[CallCategory::ShowWindow] = 2; // restored before the move
+	EXPECT_EQ(display.Calls.Format(), restored.Format());
+	ExpectWithinBudget(display);
+	EXPECT_NE(display.Fallbacks & ToggleFallbackRestoredFromMinimized, 0u);
+	EXPECT_FALSE(platform.Windows.at(window).Minimized);
+
+	const DisplayWindowResult sendBack = Toggle(toggle);
+	ASSERT_TRUE(sendBack.AllOk) << sendBack.ErrorMessage;
+	// Its restore position is moved onto the primary monitor (read and written back),
+	// then it leaves the topmost band and is minimized; it is not activated.
+	EXPECT_EQ(sendBack.Calls.Format(), Counts({
+		{ CallCategory::ProcessSnapshot, 1 },
+		{ CallCategory::UiaFind, 1 },
+		{ CallCategory::IniFileAccess, 5 },
+		{ CallCategory::UiaPropertyRead, 2 },
+		{ CallCategory::GetWindowPlacement, 1 },
+		{ CallCategory::SetWindowPlacement, 1 },
+		{ CallCategory::SetWindowPos, 1 },
+		{ CallCategory::ShowWindow, 1 } }).Format());
+	ExpectWithinBudget(sendBack);
+	EXPECT_NE(sendBack.Fallbacks & ToggleFallbackMinimizedSendBack, 0u);
+
+	const FakeWindow& state = platform.Windows.at(window);
+	EXPECT_TRUE(state.Minimized);
+	EXPECT_FALSE(state.Topmost);
+	EXPECT_EQ(state.NormalRect.Left, 10 - 7); // visible frame RestoreMargin inside the primary work area
+}
+
+TEST(MediaWindowToggle, CrossDpiMoveIsPrecompensated)
+{
+	FakePlatform platform;
+	platform.Monitors[1].Dpi = 144;
+	const PlatformWindow window = platform.AddZoomWindow({ 100, 100, 900, 700 });
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	EXPECT_EQ(result.Calls.Format(), DisplayCalls().Format());
+	EXPECT_NE(result.Fallbacks & ToggleFallbackDpiPrecompensated, 0u);
+	EXPECT_EQ(result.Fallbacks & ToggleFallbackCorrectiveResize, 0u);
+	EXPECT_EQ(platform.Windows.at(window).Rect, toggle.TargetRect(platform.TargetMonitor(), window, 144));
+	EXPECT_EQ(result.ResizeEvents, 2u);
+}
+
+TEST(MediaWindowToggle, WindowIgnoringTheDpiChangeIsCorrectedOnce)
+{
+	FakePlatform platform;
+	platform.Monitors[1].Dpi = 144;
+	platform.IgnoresDpiChange = true;
+	const PlatformWindow window = platform.AddZoomWindow({ 100, 100, 900, 700 });
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	EXPECT_EQ(result.Calls.Format(), DisplayCalls(1, 4).Format());
+	ExpectWithinBudget(result);
+	EXPECT_NE(result.Fallbacks & ToggleFallbackCorrectiveResize, 0u);
+	EXPECT_EQ(platform.Windows.at(window).Rect, toggle.TargetRect(platform.TargetMonitor(), window, 144));
+}
+
+TEST(MediaWindowToggle, NotRunningTakesOnlyTheSnapshot)
+{
+	FakePlatform platform;
+	platform.AddZoomWindow({ 100, 100, 900, 700 });
+	platform.Processes = { L"explorer.exe" };
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	EXPECT_EQ(result.Error, DisplayWindowError::ZoomNotRunning);
+	EXPECT_EQ(result.Presence, ZoomPresence::NotRunning);
+	EXPECT_EQ(result.Calls.Format(), Counts({ { CallCategory::ProcessSnapshot, 1 } }).Format());
+}
+
+TEST(MediaWindowToggle, WarmStartSkipsTheSnapshotAndSearch)
+{
+	FakePlatform platform;
+	const PlatformWindow window = platform.AddZoomWindow({ 100, 100, 900, 700 });
+	ProviderRegistry providers = ZoomOnly();
+	RecordingObserver observer;
+	observer.WarmStart = window;
+	MediaWindowToggle toggle(platform, providers, &observer);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	CallCounts expected = DisplayCalls();
+	expected[CallCategory::ProcessSnapshot] = 0; // and the one find is ElementFromHandle
+	EXPECT_EQ(result.Calls.Format(), expected.Format());
+	EXPECT_EQ(observer.Toggles, 1);
+	EXPECT_NE(observer.LastFallbacks & ToggleFallbackWarmStart, 0u);
+}
+
+TEST(MediaWindowToggle, GoneWarmStartWindowFallsBackToSearching)
+{
+	FakePlatform platform;
+	platform.AddZoomWindow({ 100, 100, 900, 700 });
+	ProviderRegistry providers = ZoomOnly();
+	RecordingObserver observer;
+	observer.WarmStart = 0xDEAD;
+	MediaWindowToggle toggle(platform, providers, &observer);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	EXPECT_EQ(observer.WarmStartsUnavailable, 1);
+	EXPECT_EQ(result.Calls.Format(), DisplayCalls(2).Format());
+	EXPECT_EQ(result.Fallbacks & ToggleFallbackWarmStart, 0u);
+}
+
+TEST(MediaWindowToggle, MirrorModeLeavesTheWindowToTheObserver)
+{
+	FakePlatform platform;
+	const PlatformWindow window = platform.AddZoomWindow({ 100, 100, 900, 700 });
+	platform.Settings[L"ToggleMode"] = 1;
+	ProviderRegistry providers = ZoomOnly();
+	RecordingObserver observer;
+	MediaWindowToggle toggle(platform, providers, &observer);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	EXPECT_EQ(observer.Mirrors, 1);
+	EXPECT_EQ(result.Calls.Format(), Counts({
+		{ CallCategory::ProcessSnapshot, 1 },
+		{ CallCategory::UiaFind, 1 },
+		{ CallCategory::IniFileAccess, 5 },
+		{ CallCategory::UiaPropertyRead, 1 } }).Format());
+	EXPECT_EQ(platform.Windows.at(window).Rect, (ScreenRect{ 100, 100, 900, 700 }));
+}
+
+TEST(MediaWindowToggle, MirrorModeWithoutAnObserverFails)
+{
+	FakePlatform platform;
+	platform.AddZoomWindow({ 100, 100, 900, 700 });
+	platform.Settings[L"ToggleMode"] = 1;
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+
+	EXPECT_EQ(Toggle(toggle).Error, DisplayWindowError::MirrorUnavailable);
+}
+
+TEST(MediaWindowToggle, WindowThatCannotBeCloakedIsHiddenWithinBudget)
+{
+	FakePlatform platform;
+	platform.CanCloak = false;
+	const PlatformWindow window = platform.AddZoomWindow({ 100, 100, 900, 700 });
+	ProviderRegistry providers = ZoomOnly();
+	MediaWindowToggle toggle(platform, providers);
+
+	const DisplayWindowResult result = Toggle(toggle);
+	ASSERT_TRUE(result.AllOk) << result.ErrorMessage;
+	CallCounts expected = DisplayCalls();
+	expected[CallCategory::DwmSetWindowAttribute] = 3; // the cloak fails, so there is no uncloak
+	expected[CallCategory::ShowWindow] = 2;            // hidden, then shown
+	EXPECT_EQ(result.Calls.Format(), expected.Format());
+	ExpectWithinBudget(result);
+	EXPECT_NE(result.Fallbacks & ToggleFallbackHiddenInsteadOfCloaked, 0u);
+	EXPECT_TRUE(platform.Windows.at(window).Visible);
+}
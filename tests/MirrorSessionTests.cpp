@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "MirrorSession.h"
+
+namespace
+{
+	/// <summary>
+	/// Records the calls made to it, and fails whichever step a test asks it to.
+	/// </summary>
+	class FakeCompositor : public ThumbnailCompositor
+	{
+	public:
+		std::vector<std::string> Calls;
+		bool FailCreate = false;
+		bool FailRegister = false;
+		bool FailUpdate = false;
+		bool SourceGone = false;
+		int Width = 1000;
+		int Height = 800;
+		int Hosts = 0;
+		int Thumbnails = 0;
+		ScreenRect LastSource;
+		ScreenRect LastDestination;
+
+		bool CreateHost(const ScreenRect&) override
+		{
+			Calls.emplace_back("CreateHost");
+			if (FailCreate) return false;
+			++Hosts;
+			return true;
+		}
+
+		void DestroyHost() override
+		{
+			Calls.emplace_back("DestroyHost");
+			--Hosts;
+		}
+
+		void ShowHost() override { Calls.emplace_back("ShowHost"); }
+
+		bool Register(std::uint64_t) override
+		{
+			Calls.emplace_back("Register");
+			if (FailRegister) return false;
+			++Thumbnails;
+			return true;
+		}
+
+		void Unregister() override
+		{
+			Calls.emplace_back("Unregister");
+			--Thumbnails;
+		}
+
+		bool QuerySourceSize(int& width, int& height) override
+		{
+			width = Width;
+			height = Height;
+			return !SourceGone;
+		}
+
+		bool Update(const ScreenRect& source, const ScreenRect& destination) override
+		{
+			Calls.emplace_back("Update");
+			LastSource = source;
+			LastDestination = destination;
+			return !FailUpdate;
+		}
+	};
+
+	// 8px borders and a 31px caption at 96 DPI.
+	FrameMetrics Frame()
+	{
+		FrameMetrics metrics;
+		metrics.Client = FrameInsets{ 8, 31, 8, 8 };
+		return metrics;
+	}
+
+	const ScreenRect Projector{ 1920, 0, 3840, 1080 };
+}
+
+TEST(MirrorSession, StartSetsUpAndShowsTheMirror)
+{
+	FakeCompositor compositor;
+	MirrorSession session(&compositor);
+
+	ASSERT_TRUE(session.Start(42, Projector, Frame(), FrameInsets{}));
+	EXPECT_TRUE(session.IsActive());
+	EXPECT_EQ(session.Source(), 42u);
+	EXPECT_EQ(session.Updates(), 1u);
+	EXPECT_EQ(compositor.Calls, (std::vector<std::string>{ "CreateHost", "Register", "Update", "ShowHost" }));
+
+	// The client area, aspect-fitted into the host's client coordinates.
+	EXPECT_EQ(compositor.LastSource, (ScreenRect{ 8, 31, 992, 792 }));
+	EXPECT_EQ(compositor.LastDestination.Height(), 1080);
+	EXPECT_EQ(compositor.LastDestination.Top, 0);
+	EXPECT_EQ(compositor.LastDestination.Left, (1920 - compositor.LastDestination.Width()) / 2);
+}
+
+TEST(MirrorSession, CropsChromeFromTheClientArea)
+{
+	FakeCompositor compositor;
+	MirrorSession session(&compositor);
+
+	ASSERT_TRUE(session.Start(42, Projector, Frame(), FrameInsets{ 0, 40, 0, 60 }));
+	EXPECT_EQ(compositor.LastSource, (ScreenRect{ 8, 71, 992, 732 }));
+}
+
+TEST(MirrorSession, FailedStartsLeaveNothingBehind)
+{
+	for (int failure = 0; failure < 4; ++failure)
+	{
+		FakeCompositor compositor;
+		compositor.FailCreate = failure == 0;
+		compositor.FailRegister = failure == 1;
+		compositor.FailUpdate = failure == 2;
+		compositor.SourceGone = failure == 3;
+		MirrorSession session(&compositor);
+
+		EXPECT_FALSE(session.Start(42, Projector, Frame(), FrameInsets{})) << failure;
+		EXPECT_FALSE(session.IsActive());
+		EXPECT_EQ(compositor.Hosts, 0) << failure;
+		EXPECT_EQ(compositor.Thumbnails, 0) << failure;
+		EXPECT_NE(compositor.Calls.back(), "ShowHost");
+	}
+}
+
+TEST(MirrorSession, RefreshUpdatesOnlyWhenTheSourceChanges)
+{
+	FakeCompositor compositor;
+	MirrorSession session(&compositor);
+	ASSERT_TRUE(session.Start(42, Projector, Frame(), FrameInsets{}));
+
+	EXPECT_TRUE(session.Refresh(Frame()));
+	EXPECT_EQ(session.Updates(), 1u);
+
+	compositor.Width = 1200;
+	EXPECT_TRUE(session.Refresh(Frame()));
+	EXPECT_EQ(session.Updates(), 2u);
+	EXPECT_EQ(compositor.LastSource, (ScreenRect{ 8, 31, 1192, 792 }));
+
+	// A DPI change alone changes the crop.
+	EXPECT_TRUE(session.Refresh(Frame().ScaledTo(144)));
+	EXPECT_EQ(session.Updates(), 3u);
+}
+
+TEST(MirrorSession, StopsWhenTheSourceGoes)
+{
+	FakeCompositor compositor;
+	MirrorSession session(&compositor);
+	ASSERT_TRUE(session.Start(42, Projector, Frame(), FrameInsets{}));
+
+	compositor.SourceGone = true;
+	EXPECT_FALSE(session.Refresh(Frame()));
+	EXPECT_FALSE(session.IsActive());
+	EXPECT_EQ(compositor.Hosts, 0);
+	EXPECT_EQ(compositor.Thumbnails, 0);
+
+	// Refreshing a stopped session does nothing.
+	const std::size_t calls = compositor.Calls.size();
+	EXPECT_FALSE(session.Refresh(Frame()));
+	EXPECT_EQ(compositor.Calls.size(), calls);
+}
+
+TEST(MirrorSession, RestartingReplacesTheMirror)
+{
+	FakeCompositor compositor;
+	MirrorSession session(&compositor);
+	ASSERT_TRUE(session.Start(42, Projector, Frame(), FrameInsets{}));
+	ASSERT_TRUE(session.Start(43, Projector, Frame(), FrameInsets{}));
+
+	EXPECT_EQ(session.Source(), 43u);
+	EXPECT_EQ(session.Updates(), 1u);
+	EXPECT_EQ(compositor.Hosts, 1);
+	EXPECT_EQ(compositor.Thumbnails, 1);
+}
+
+TEST(MirrorSession, DestructorTearsDown)
+{
+	FakeCompositor compositor;
+	{
+		MirrorSession session(&compositor);
+		ASSERT_TRUE(session.Start(42, Projector, Frame(), FrameInsets{}));
+	}
+
+	EXPECT_EQ(compositor.Hosts, 0);
+	EXPECT_EQ(compositor.Thumbnails, 0);
+	EXPECT_EQ(compositor.Calls.back(), "DestroyHost");
+}
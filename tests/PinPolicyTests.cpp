@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "PinPolicy.h"
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	const ScreenRect Target{ 1912, -31, 3848, 1088 };
+
+	ScreenRect Moved(const int dx, const int dy)
+	{
+		return ScreenRect{ Target.Left + dx, Target.Top + dy, Target.Right + dx, Target.Bottom + dy };
+	}
+
+	/// <summary>
+	/// Plays a scripted stream of location changes against the policy, applying each
+	/// correction as the window manager would (the next event then sees the target).
+	/// </summary>
+	class Script
+	{
+	public:
+		PinPolicy Policy;
+		PinPolicy::Clock::time_point Start;
+		std::vector<int> CorrectedAtMs;
+
+		explicit Script(const PinOptions& options = PinOptions())
+			: Policy(Target, options)
+		{
+		}
+
+		PinAction Drift(const int atMs, const ScreenRect& observed, const bool minimized = false)
+		{
+			const PinAction action = Policy.OnLocationChange(observed, minimized, Start + std::chrono::milliseconds(atMs));
+			if (action == PinAction::Correct)
+			{
+				CorrectedAtMs.push_back(atMs);
+				Policy.OnCorrected(std::chrono::microseconds(500 + atMs));
+			}
+			return action;
+		}
+
+		// The application moves the window every intervalMs from fromMs until toMs.
+		void Fight(const int fromMs, const int toMs, const int intervalMs)
+		{
+			for (int at = fromMs; at < toMs; at += intervalMs)
+			{
+				Drift(at, Moved(0, 120));
+			}
+		}
+	};
+}
+
+TEST(PinPolicy, IgnoresDriftWithinTolerance)
+{
+	Script script;
+	EXPECT_EQ(script.Drift(0, Target), PinAction::None);
+	EXPECT_EQ(script.Drift(10, Moved(1, -1)), PinAction::None);
+	EXPECT_EQ(script.Drift(20, ScreenRect{ Target.Left, Target.Top, Target.Right + 1, Target.Bottom }), PinAction::None);
+	EXPECT_EQ(script.Policy.Stats().DriftEvents, 0u);
+
+	EXPECT_EQ(script.Drift(30, Moved(2, 0)), PinAction::Correct);
+	EXPECT_EQ(script.Drift(40, ScreenRect{ Target.Left, Target.Top, Target.Right, Target.Bottom - 300 }), PinAction::Correct);
+	EXPECT_EQ(script.Policy.Stats().DriftEvents, 2u);
+}
+
+TEST(PinPolicy, CorrectsOccasionalDriftIndefinitely)
+{
+	// Zoom re-laying out its window once a second never trips the burst limit.
+	Script script;
+	for (int second = 0; second < 60; ++second)
+	{
+		ASSERT_EQ(script.Drift(second * 1000, Moved(0, 40)), PinAction::Correct) << second;
+	}
+	EXPECT_EQ(script.Policy.Stats().Corrections, 60u);
+	EXPECT_EQ(script.Policy.Stats().Backoffs, 0u);
+}
+
+TEST(PinPolicy, BacksOffFromAnApplicationThatFightsBack)
+{
+	// The application moves the window every 100 ms for 15 s.
+	Script script;
+	script.Fight(0, 15000, 100);
+
+	// A burst of three, a 10 s backoff, then another burst.
+	EXPECT_EQ(script.CorrectedAtMs, (std::vector<int>{ 0, 100, 200, 10300, 10400, 10500 }));
+	const PinStats& stats = script.Policy.Stats();
+	EXPECT_EQ(stats.DriftEvents, 150u);
+	EXPECT_EQ(stats.Corrections, 6u);
+	EXPECT_EQ(stats.Backoffs, 2u);
+	EXPECT_EQ(stats.RateLimited, 144u);
+	EXPECT_TRUE(script.Policy.IsPinned());
+}
+
+TEST(PinPolicy, BurstLimitSlidesWithTime)
+{
+	PinOptions options;
+	options.BurstCorrections = 2;
+	options.BurstWindow = 1000ms;
+	Script script(options);
+
+	EXPECT_EQ(script.Drift(0, Moved(50, 0)), PinAction::Correct);
+	EXPECT_EQ(script.Drift(600, Moved(50, 0)), PinAction::Correct);
+	// The first correction has left the window by 1000 ms.
+	EXPECT_EQ(script.Drift(1000, Moved(50, 0)), PinAction::Correct);
+	// 600 and 1000 are within 1 s of 1100: backoff.
+	EXPECT_EQ(script.Drift(1100, Moved(50, 0)), PinAction::None);
+	EXPECT_EQ(script.Policy.Stats().Backoffs, 1u);
+}
+
+TEST(PinPolicy, LeavesMinimizedWindowsAlone)
+{
+	Script script;
+	EXPECT_EQ(script.Drift(0, ScreenRect{ -32000, -32000, -31840, -31972 }, true), PinAction::None);
+	EXPECT_EQ(script.Policy.Stats().DriftEvents, 0u);
+	// Restored off target: corrected.
+	EXPECT_EQ(script.Drift(500, Moved(-1920, 0)), PinAction::Correct);
+}
+
+TEST(PinPolicy, UserMoveEndsThePin)
+{
+	Script script;
+	EXPECT_EQ(script.Drift(0, Moved(0, 40)), PinAction::Correct);
+
+	EXPECT_EQ(script.Policy.OnUserMoveSize(true), PinAction::None);
+	// Location changes while the user drags are theirs.
+	EXPECT_EQ(script.Drift(100, Moved(-300, 10)), PinAction::None);
+	EXPECT_EQ(script.Drift(150, Moved(-900, 40)), PinAction::None);
+	EXPECT_EQ(script.Policy.OnUserMoveSize(false), PinAction::Unpin);
+	EXPECT_FALSE(script.Policy.IsPinned());
+
+	// Nothing more is corrected, or unpinned again.
+	EXPECT_EQ(script.Drift(1000, Moved(0, 40)), PinAction::None);
+	EXPECT_EQ(script.Policy.OnUserMoveSize(true), PinAction::None);
+	EXPECT_EQ(script.Policy.OnUserMoveSize(false), PinAction::None);
+	EXPECT_EQ(script.Policy.Stats().Corrections, 1u);
+}
+
+TEST(PinPolicy, UserCanTakeOverDuringABackoff)
+{
+	Script script;
+	script.Fight(0, 1000, 100);
+	ASSERT_EQ(script.Policy.Stats().Backoffs, 1u);
+
+	script.Policy.OnUserMoveSize(true);
+	EXPECT_EQ(script.Policy.OnUserMoveSize(false), PinAction::Unpin);
+	EXPECT_EQ(script.Drift(20000, Moved(0, 40)), PinAction::None);
+}
+
+TEST(PinPolicy, RecordsCorrectionLatency)
+{
+	Script script;
+	script.Drift(0, Moved(0, 40));
+	script.Drift(1000, Moved(0, 40));
+	script.Drift(3000, Moved(0, 40));
+
+	EXPECT_EQ(script.Policy.Stats().TotalLatencyUs, 500 + 1500 + 3500);
+	EXPECT_EQ(script.Policy.Stats().MaxLatencyUs, 3500);
+}
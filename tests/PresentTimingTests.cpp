@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include "PresentTiming.h"
+
+namespace
+{
+	constexpr std::int64_t Frequency = 10000000;  // 100 ns ticks
+	constexpr std::int64_t Period = 166667;       // 60 Hz
+	constexpr std::int64_t VBlank = 100000000;
+
+	// Composition 10000 ticks (1 ms) after each vertical blank.
+	const CompositionSample Sample{ VBlank, Period, VBlank + 10000 };
+}
+
+TEST(PresentTiming, ChangeIsPresentedAtTheVBlankAfterTheNextComposition)
+{
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(Sample, VBlank + 9999), VBlank + Period);
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(Sample, VBlank + 10000), VBlank + Period);
+	// Just missed that composition: one frame later.
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(Sample, VBlank + 10001), VBlank + (2 * Period));
+}
+
+TEST(PresentTiming, GridExtendsBothWaysFromTheSample)
+{
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(Sample, VBlank + (10 * Period) + 5000), VBlank + (11 * Period));
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(Sample, VBlank - (3 * Period) + 20000), VBlank - Period);
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(Sample, VBlank - (3 * Period) + 5000), VBlank - (2 * Period));
+}
+
+TEST(PresentTiming, CompositionFromThePreviousFrameGivesTheSamePhase)
+{
+	const CompositionSample earlier{ VBlank, Period, VBlank - Period + 10000 };
+	for (std::int64_t change = VBlank - (2 * Period); change < VBlank + (2 * Period); change += 37)
+	{
+		ASSERT_EQ(PresentTiming::FirstPresentAfter(earlier, change), PresentTiming::FirstPresentAfter(Sample, change)) << change;
+	}
+}
+
+TEST(PresentTiming, UnknownCompositionIsTakenAsAtTheVBlank)
+{
+	const CompositionSample noCompose{ VBlank, Period, 0 };
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(noCompose, VBlank), VBlank + Period);
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(noCompose, VBlank + 1), VBlank + (2 * Period));
+}
+
+TEST(PresentTiming, UnusableSampleGivesZero)
+{
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(CompositionSample{}, VBlank), 0);
+	EXPECT_EQ(PresentTiming::FirstPresentAfter(CompositionSample{ VBlank, 0, 0 }, VBlank), 0);
+}
+
+TEST(PresentTiming, MatchesASimulatedCompositor)
+{
+	std::mt19937_64 random(1);
+	for (int i = 0; i < 100000; ++i)
+	{
+		const std::int64_t period = 1000 + static_cast<std::int64_t>(random() % 50000);
+		const std::int64_t vblank = 1 + static_cast<std::int64_t>(random() % 100000000);
+		const std::int64_t phase = static_cast<std::int64_t>(random() % static_cast<std::uint64_t>(period));
+		const std::int64_t change = vblank + static_cast<std::int64_t>(random() % 2000000) - 1000000;
+		const CompositionSample sample{ vblank, period, vblank + phase + (period * (static_cast<std::int64_t>(random() % 5) - 2)) };
+		if (change <= 0 || sample.ComposeQpc <= 0)
+		{
+			continue;
+		}
+
+		// Step the compositor forwards: the first composition at or after the change,
+		// then the first vertical blank after that.
+		std::int64_t composition = vblank + phase - (period * 2000);
+		while (composition < change)
+		{
+			composition += period;
+		}
+		std::int64_t present = vblank - (period * 3000);
+		while (present <= composition)
+		{
+			present += period;
+		}
+
+		ASSERT_EQ(PresentTiming::FirstPresentAfter(sample, change), present)
+			<< "period " << period << " vblank " << vblank << " compose " << sample.ComposeQpc << " change " << change;
+	}
+}
+
+TEST(PresentTiming, MessageTimeIsMappedBackFromNow)
+{
+	EXPECT_EQ(PresentTiming::MessageTimeToQpc(1000, 1250, 10000000, Frequency), 10000000 - 2500000);
+	// Message time is from before the millisecond counter wrapped.
+	EXPECT_EQ(PresentTiming::MessageTimeToQpc(0xFFFFFF00u, 0x64u, 10000000, Frequency), 10000000 - (356 * 10000));
+	// A message time after now (clocks read in the other order) is taken as now.
+	EXPECT_EQ(PresentTiming::MessageTimeToQpc(2000, 1000, 10000000, Frequency), 10000000);
+}
+
+TEST(PresentTiming, ConvertsTicksToMicroseconds)
+{
+	EXPECT_EQ(PresentTiming::ToMicroseconds(Frequency, Frequency), 1000000);
+	EXPECT_EQ(PresentTiming::ToMicroseconds(3 * 16667, Frequency), 5000);
+	EXPECT_GT(PresentTiming::ToMicroseconds(INT64_MAX / 2, Frequency), 0); // no overflow
+}
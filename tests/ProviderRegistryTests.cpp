@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "ProviderRegistry.h"
+
+namespace
+{
+	// Zoom, Teams (two executables) and WebEx, in that order, counting selector loads.
+	class FakeProviders
+	{
+	public:
+		ProviderRegistry Registry;
+		int Loads = 0;
+
+		FakeProviders()
+		{
+			Registry.Add(Provider(L"Zoom", { L"Zoom.exe" }));
+			Registry.Add(Provider(L"Teams", { L"ms-teams.exe", L"Teams.exe" }));
+			Registry.Add(Provider(L"WebEx", { L"CiscoCollabHost.exe" }));
+		}
+
+		MediaWindowProvider Provider(const std::wstring& name, const std::vector<std::wstring>& processes)
+		{
+			return MediaWindowProvider{ name, processes, [this, name]
+			{
+				++Loads;
+				return MediaWindowSelectors{ name + L" Meeting", name + L"Class", {} };
+			} };
+		}
+
+		std::vector<std::wstring> Names() const
+		{
+			std::vector<std::wstring> names;
+			for (int i = 0; i < Registry.Count(); ++i)
+			{
+				names.push_back(Registry.Provider(i).Name);
+			}
+			return names;
+		}
+
+		std::vector<std::wstring> Resolve(const std::vector<std::wstring>& running) const
+		{
+			std::vector<std::wstring> names;
+			for (const int i : Registry.Resolve(running))
+			{
+				names.push_back(Registry.Provider(i).Name);
+			}
+			return names;
+		}
+	};
+
+	using Names = std::vector<std::wstring>;
+}
+
+TEST(ProviderRegistry, ParseListTrimsAndDropsEmptyItems)
+{
+	EXPECT_EQ(ProviderRegistry::ParseList(L" Teams ,Zoom,\tWebEx\t"), (Names{ L"Teams", L"Zoom", L"WebEx" }));
+	EXPECT_EQ(ProviderRegistry::ParseList(L"Zoom,,  ,Teams,"), (Names{ L"Zoom", L"Teams" }));
+	EXPECT_EQ(ProviderRegistry::ParseList(L"My App, Zoom"), (Names{ L"My App", L"Zoom" }));
+	EXPECT_TRUE(ProviderRegistry::ParseList(L"").empty());
+	EXPECT_TRUE(ProviderRegistry::ParseList(L" , ,").empty());
+
+	// Duplicates and unknown names are kept here; Prioritize deals with them.
+	EXPECT_EQ(ProviderRegistry::ParseList(L"Zoom,zoom,Skype"), (Names{ L"Zoom", L"zoom", L"Skype" }));
+}
+
+TEST(ProviderRegistry, PrioritizeOrdersAndFiltersByName)
+{
+	FakeProviders providers;
+	providers.Registry.Prioritize(ProviderRegistry::ParseList(L"webex, ZOOM"));
+	EXPECT_EQ(providers.Names(), (Names{ L"WebEx", L"Zoom" }));
+}
+
+TEST(ProviderRegistry, PrioritizeIgnoresUnknownAndRepeatedNames)
+{
+	FakeProviders providers;
+	providers.Registry.Prioritize(ProviderRegistry::ParseList(L"Skype, Teams, teams, Zoom, Teams"));
+	EXPECT_EQ(providers.Names(), (Names{ L"Teams", L"Zoom" }));
+}
+
+TEST(ProviderRegistry, PrioritizeKeepsEveryProviderWhenNoNameIsKnown)
+{
+	FakeProviders providers;
+	providers.Registry.Prioritize(ProviderRegistry::ParseList(L"Skype, Zooom"));
+	EXPECT_EQ(providers.Names(), (Names{ L"Zoom", L"Teams", L"WebEx" }));
+
+	providers.Registry.Prioritize(ProviderRegistry::ParseList(L""));
+	EXPECT_EQ(providers.Names(), (Names{ L"Zoom", L"Teams", L"WebEx" }));
+}
+
+TEST(ProviderRegistry, AddReplacesAProviderOfTheSameNameInPlace)
+{
+	FakeProviders providers;
+	providers.Registry.Add(providers.Provider(L"teams", { L"Teams2.exe" }));
+	EXPECT_EQ(providers.Names(), (Names{ L"Zoom", L"teams", L"WebEx" }));
+	EXPECT_EQ(providers.Resolve({ L"Teams2.exe" }), (Names{ L"teams" }));
+	EXPECT_TRUE(providers.Resolve({ L"Teams.exe" }).empty());
+}
+
+TEST(ProviderRegistry, ResolveFollowsPrecedenceNotProcessOrder)
+{
+	FakeProviders providers;
+	EXPECT_EQ(providers.Resolve({ L"CiscoCollabHost.exe", L"explorer.exe", L"ms-teams.exe", L"zoom.EXE" }),
+		(Names{ L"Zoom", L"Teams", L"WebEx" }));
+
+	providers.Registry.Prioritize({ L"WebEx", L"Teams", L"Zoom" });
+	EXPECT_EQ(providers.Resolve({ L"Zoom.exe", L"Teams.exe", L"CiscoCollabHost.exe" }),
+		(Names{ L"WebEx", L"Teams", L"Zoom" }));
+}
+
+TEST(ProviderRegistry, FallsBackWhenThePreferredProviderIsNotRunning)
+{
+	FakeProviders providers;
+	providers.Registry.Prioritize({ L"Teams", L"Zoom", L"WebEx" });
+
+	// Teams is preferred, but only Zoom is running: Zoom is used, and only its selectors are built.
+	const std::vector<int> resolved = providers.Registry.Resolve({ L"svchost.exe", L"Zoom.exe" });
+	ASSERT_EQ(resolved.size(), 1u);
+	EXPECT_EQ(providers.Registry.Provider(resolved[0]).Name, L"Zoom");
+	EXPECT_EQ(providers.Registry.Selectors(resolved[0])->WindowName, L"Zoom Meeting");
+	EXPECT_EQ(providers.Loads, 1);
+	EXPECT_EQ(providers.Registry.LoadedCount(), 1);
+
+	// Either of a provider's executables makes it available.
+	EXPECT_EQ(providers.Resolve({ L"Teams.exe", L"Zoom.exe" }), (Names{ L"Teams", L"Zoom" }));
+	EXPECT_TRUE(providers.Resolve({ L"svchost.exe" }).empty());
+	EXPECT_TRUE(providers.Resolve({}).empty());
+}
+
+TEST(ProviderRegistry, SelectorsAreLoadedOnceAndKeptAcrossPrioritize)
+{
+	FakeProviders providers;
+	const auto first = providers.Registry.Selectors(0);
+	const auto again = providers.Registry.Selectors(0);
+	EXPECT_EQ(first, again);
+	EXPECT_EQ(providers.Loads, 1);
+
+	providers.Registry.Prioritize({ L"Teams", L"Zoom" });
+	EXPECT_EQ(providers.Registry.LoadedCount(), 1);
+	EXPECT_EQ(providers.Registry.Selectors(1), first);
+	EXPECT_EQ(providers.Loads, 1);
+}
+
+TEST(ProviderRegistry, BuiltInZoomProvider)
+{
+	const MediaWindowProvider zoom = ProviderRegistry::Zoom();
+	EXPECT_EQ(zoom.Name, L"Zoom");
+	EXPECT_EQ(zoom.ProcessNames, (Names{ L"Zoom.exe" }));
+	EXPECT_EQ(zoom.LoadSelectors().WindowClassName, MediaWindowSelectors::Zoom().WindowClassName);
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Scene.h"
+
+namespace
+{
+	// A Windows 10 style frame at 96 DPI: 8px borders of which 7 are invisible
+	// resize borders, and a 31px caption.
+	FrameMetrics TypicalFrame(const unsigned dpi = FrameMetrics::BaseDpi)
+	{
+		return FrameMetrics::Measure(ScreenRect{ 0, 0, 1000, 800 }, ScreenRect{ 8, 31, 992, 792 },
+			ScreenRect{ 7, 0, 993, 793 }, FrameMetrics::BaseDpi).ScaledTo(dpi);
+	}
+
+	// A laptop panel at 96 DPI and a projector to its right at 144 DPI.
+	class FakeDesktop
+	{
+	public:
+		std::vector<SceneWindow> Windows;
+		std::vector<SceneMonitor> Monitors
+		{
+			SceneMonitor{ L"laptop", ScreenRect{ 0, 0, 1920, 1080 }, ScreenRect{ 0, 0, 1920, 1040 }, 96 },
+			SceneMonitor{ L"projector", ScreenRect{ 1920, 0, 4480, 1440 }, ScreenRect{ 1920, 0, 4480, 1392 }, 144 },
+		};
+
+		SceneWindow& AddWindow(const std::wstring& process, const std::wstring& windowClass, const std::wstring& title,
+			const ScreenRect& rect, const unsigned dpi = FrameMetrics::BaseDpi)
+		{
+			SceneWindow window;
+			window.Handle = 0x1000 + Windows.size();
+			window.ProcessName = process;
+			window.ClassName = windowClass;
+			window.Title = title;
+			window.Rect = rect;
+			window.Metrics = TypicalFrame(dpi);
+			Windows.push_back(window);
+			return Windows.back();
+		}
+
+		const SceneMonitor& Monitor(const std::wstring& key) const
+		{
+			for (const auto& monitor : Monitors)
+			{
+				if (monitor.Key == key)
+				{
+					return monitor;
+				}
+			}
+			throw std::out_of_range("no such monitor");
+		}
+
+		ScenePlan Plan(const std::vector<std::wstring>& entries) const
+		{
+			Scene scene;
+			scene.Name = L"Test";
+			for (const auto& text : entries)
+			{
+				SceneEntry entry;
+				EXPECT_TRUE(ScenePlanner::ParseEntry(text, entry)) << std::string(text.begin(), text.end());
+				scene.Entries.push_back(entry);
+			}
+			return ScenePlanner::Plan(scene, Windows, Monitors);
+		}
+	};
+
+	// Where the window ends up once it applies the rect suggested for its new DPI. A size
+	// that no whole-pixel size scales to exactly is missed by at most one pixel.
+	void ExpectLandsOn(const SceneMove& move)
+	{
+		const ScreenRect landed = WindowGeometry::SuggestedRectAfterDpiChange(move.Move, move.FromDpi, move.ToDpi);
+		EXPECT_EQ(landed.Left, move.To.Left);
+		EXPECT_EQ(landed.Top, move.To.Top);
+		EXPECT_LE(std::abs(landed.Right - move.To.Right), 1);
+		EXPECT_LE(std::abs(landed.Bottom - move.To.Bottom), 1);
+	}
+
+	ScreenRect ClientRect(const ScreenRect& windowRect, const FrameMetrics& metrics)
+	{
+		return ScreenRect{ windowRect.Left + metrics.Client.Left, windowRect.Top + metrics.Client.Top,
+			windowRect.Right - metrics.Client.Right, windowRect.Bottom - metrics.Client.Bottom };
+	}
+}
+
+TEST(ScenePlanner, ParsesEntries)
+{
+	SceneEntry entry;
+	ASSERT_TRUE(ScenePlanner::ParseEntry(L" process = Zoom.exe ; title=Meeting; monitor=projector; placement=WorkArea ", entry));
+	EXPECT_EQ(entry.Selector.ProcessName, L"Zoom.exe");
+	EXPECT_EQ(entry.Selector.TitleContains, L"Meeting");
+	EXPECT_TRUE(entry.Selector.ClassName.empty());
+	EXPECT_EQ(entry.MonitorKey, L"projector");
+	EXPECT_EQ(entry.Placement, ScenePlacement::FillWorkArea);
+
+	ASSERT_TRUE(ScenePlanner::ParseEntry(L"class=ConfMeetingFrame;monitor=laptop;", entry));
+	EXPECT_EQ(entry.Placement, ScenePlacement::Fill);
+
+	EXPECT_FALSE(ScenePlanner::ParseEntry(L"process=zoom.exe", entry));                           // no monitor
+	EXPECT_FALSE(ScenePlanner::ParseEntry(L"monitor=laptop", entry));                             // no selector
+	EXPECT_FALSE(ScenePlanner::ParseEntry(L"process=zoom.exe;monitor=laptop;size=big", entry));   // unknown key
+	EXPECT_FALSE(ScenePlanner::ParseEntry(L"process=zoom.exe;monitor=laptop;placement=tile", entry));
+	EXPECT_FALSE(ScenePlanner::ParseEntry(L"process zoom.exe;monitor=laptop", entry));
+}
+
+TEST(ScenePlanner, MatchesProcessAndTitleIgnoringCaseButClassExactly)
+{
+	FakeDesktop desktop;
+	const SceneWindow& window = desktop.AddWindow(L"Zoom.exe", L"ConfMeetingFrame", L"Zoom Meeting", ScreenRect{ 0, 0, 800, 600 });
+
+	EXPECT_TRUE(ScenePlanner::Matches(WindowSelector{ L"zoom.EXE", L"", L"" }, window));
+	EXPECT_TRUE(ScenePlanner::Matches(WindowSelector{ L"", L"", L"meeting" }, window));
+	EXPECT_TRUE(ScenePlanner::Matches(WindowSelector{ L"zoom.exe", L"ConfMeetingFrame", L"zoom" }, window));
+	EXPECT_FALSE(ScenePlanner::Matches(WindowSelector{ L"", L"confmeetingframe", L"" }, window));
+	EXPECT_FALSE(ScenePlanner::Matches(WindowSelector{ L"zoom", L"", L"" }, window));
+	EXPECT_FALSE(ScenePlanner::Matches(WindowSelector{ L"zoom.exe", L"", L"webinar" }, window));
+}
+
+TEST(ScenePlanner, EachEntryClaimsTheFirstUnclaimedMatchingWindow)
+{
+	FakeDesktop desktop;
+	desktop.AddWindow(L"notepad.exe", L"Notepad", L"notes.txt", ScreenRect{ 100, 100, 700, 500 });
+	desktop.AddWindow(L"Zoom.exe", L"ConfMeetingFrame", L"Zoom Meeting", ScreenRect{ 0, 0, 800, 600 });
+	desktop.AddWindow(L"Zoom.exe", L"ZPContentViewWndClass", L"Zoom", ScreenRect{ 50, 50, 650, 450 });
+
+	const ScenePlan plan = desktop.Plan({
+		L"process=zoom.exe; monitor=projector",
+		L"process=zoom.exe; monitor=laptop; placement=center",
+		L"process=zoom.exe; monitor=laptop",   // both Zoom windows are taken
+		L"process=notepad.exe; monitor=tv",    // no such monitor
+		L"class=Notepad; monitor=laptop; placement=workarea",
+	});
+
+	ASSERT_EQ(plan.Moves.size(), 3u);
+	EXPECT_EQ(plan.Moves[0].Handle, desktop.Windows[1].Handle);
+	EXPECT_EQ(plan.Moves[1].Handle, desktop.Windows[2].Handle);
+	EXPECT_EQ(plan.Moves[2].Handle, desktop.Windows[0].Handle);
+	EXPECT_EQ(plan.Unresolved, (std::vector<size_t>{ 2, 3 }));
+}
+
+TEST(ScenePlanner, FillCoversTheMonitorWithTheClientAreaAtItsDpi)
+{
+	FakeDesktop desktop;
+	const SceneWindow& window = desktop.AddWindow(L"Zoom.exe", L"ConfMeetingFrame", L"Zoom Meeting", ScreenRect{ 100, 100, 900, 700 });
+
+	const ScenePlan plan = desktop.Plan({ L"process=zoom.exe; monitor=projector" });
+	ASSERT_EQ(plan.Moves.size(), 1u);
+	const SceneMove& move = plan.Moves[0];
+	EXPECT_EQ(move.From, window.Rect);
+	EXPECT_EQ(move.FromDpi, 96u);
+	EXPECT_EQ(move.ToDpi, 144u);
+	EXPECT_EQ(ClientRect(move.To, TypicalFrame(144)), desktop.Monitor(L"projector").MonitorRect);
+	EXPECT_FALSE(move.Restore);
+	EXPECT_FALSE(move.Minimize);
+
+	// The window rescales itself on arrival, so the move is precompensated to land on To
+	// (to the pixel where rounding allows).
+	EXPECT_NE(move.Move, move.To);
+	ExpectLandsOn(move);
+}
+
+TEST(ScenePlanner, MoveWithinOneDpiIsNotPrecompensated)
+{
+	FakeDesktop desktop;
+	desktop.AddWindow(L"Zoom.exe", L"ConfMeetingFrame", L"Zoom Meeting", ScreenRect{ 2000, 100, 2800, 700 }, 144);
+
+	const ScenePlan plan = desktop.Plan({ L"process=zoom.exe; monitor=projector" });
+	ASSERT_EQ(plan.Moves.size(), 1u);
+	EXPECT_EQ(plan.Moves[0].Move, plan.Moves[0].To);
+}
+
+TEST(ScenePlanner, FillWorkAreaCoversTheWorkAreaWithTheVisibleFrame)
+{
+	FakeDesktop desktop;
+	desktop.AddWindow(L"notepad.exe", L"Notepad", L"notes.txt", ScreenRect{ 100, 100, 700, 500 });
+
+	const ScenePlan plan = desktop.Plan({ L"process=notepad.exe; monitor=laptop; placement=workarea" });
+	ASSERT_EQ(plan.Moves.size(), 1u);
+	EXPECT_EQ(WindowGeometry::VisibleRect(plan.Moves[0].To, TypicalFrame()), desktop.Monitor(L"laptop").WorkRect);
+}
+
+TEST(ScenePlanner, CenterScalesForDpiAndCentersInTheWorkArea)
+{
+	FakeDesktop desktop;
+	// Visible frame 586x393 at 96 DPI, so 879x590 at 144 DPI (rounded).
+	desktop.AddWindow(L"notepad.exe", L"Notepad", L"notes.txt", ScreenRect{ 100, 100, 700, 500 });
+
+	const ScenePlan plan = desktop.Plan({ L"process=notepad.exe; monitor=projector; placement=center" });
+	ASSERT_EQ(plan.Moves.size(), 1u);
+	const ScreenRect visible = WindowGeometry::VisibleRect(plan.Moves[0].To, TypicalFrame(144));
+	const ScreenRect& work = desktop.Monitor(L"projector").WorkRect;
+	EXPECT_EQ(visible.Width(), 879);
+	EXPECT_EQ(visible.Height(), 590);
+	EXPECT_EQ(visible.Left - work.Left, (work.Width() - 879) / 2);
+	EXPECT_EQ(visible.Top - work.Top, (work.Height() - 590) / 2);
+}
+
+TEST(ScenePlanner, CenterClipsAWindowLargerThanTheWorkArea)
+{
+	FakeDesktop desktop;
+	desktop.AddWindow(L"notepad.exe", L"Notepad", L"notes.txt", ScreenRect{ -7, 0, 2007, 1207 });
+
+	const ScenePlan plan = desktop.Plan({ L"process=notepad.exe; monitor=laptop; placement=center" });
+	ASSERT_EQ(plan.Moves.size(), 1u);
+	EXPECT_EQ(WindowGeometry::VisibleRect(plan.Moves[0].To, TypicalFrame()), desktop.Monitor(L"laptop").WorkRect);
+}
+
+TEST(ScenePlanner, MinimizedWindowsAreRestoredFirst)
+{
+	FakeDesktop desktop;
+	desktop.AddWindow(L"Zoom.exe", L"ConfMeetingFrame", L"Zoom Meeting", ScreenRect{ 100, 100, 900, 700 }).Minimized = true;
+
+	const ScenePlan plan = desktop.Plan({ L"process=zoom.exe; monitor=laptop" });
+	ASSERT_EQ(plan.Moves.size(), 1u);
+	EXPECT_TRUE(plan.Moves[0].Restore);
+}
+
+TEST(ScenePlanner, RevertMovesSurvivingWindowsBack)
+{
+	FakeDesktop desktop;
+	desktop.AddWindow(L"Zoom.exe", L"ConfMeetingFrame", L"Zoom Meeting", ScreenRect{ 100, 100, 900, 700 }).Minimized = true;
+	desktop.AddWindow(L"notepad.exe", L"Notepad", L"notes.txt", ScreenRect{ 200, 200, 800, 600 });
+
+	const ScenePlan applied = desktop.Plan({
+		L"process=zoom.exe; monitor=projector",
+		L"process=notepad.exe; monitor=projector; placement=center",
+	});
+	const std::vector<SceneRestorePoint> points = ScenePlanner::RestorePoints(applied);
+	ASSERT_EQ(points.size(), 2u);
+	EXPECT_EQ(points[0].Rect, (ScreenRect{ 100, 100, 900, 700 }));
+	EXPECT_TRUE(points[0].Minimized);
+
+	// Both windows now sit on the projector at its DPI; notepad has since been closed.
+	for (auto& window : desktop.Windows)
+	{
+		window.Minimized = false;
+		window.Metrics = TypicalFrame(144);
+	}
+	desktop.Windows[0].Rect = applied.Moves[0].To;
+	desktop.Windows.pop_back();
+
+	const ScenePlan revert = ScenePlanner::PlanRevert(points, desktop.Windows, desktop.Monitors);
+	ASSERT_EQ(revert.Moves.size(), 1u);
+	EXPECT_EQ(revert.Unresolved, (std::vector<size_t>{ 1 }));
+
+	const SceneMove& move = revert.Moves[0];
+	EXPECT_EQ(move.To, points[0].Rect);
+	EXPECT_EQ(move.FromDpi, 144u);
+	EXPECT_EQ(move.ToDpi, 96u); // the DPI of the monitor the restore point is on
+	ExpectLandsOn(move);
+	EXPECT_TRUE(move.Minimize);
+	EXPECT_FALSE(move.Restore);
+}
+
+TEST(ScenePlanner, MonitorForRectPicksTheLargestOverlap)
+{
+	const FakeDesktop desktop;
+	EXPECT_EQ(ScenePlanner::MonitorForRect(ScreenRect{ 1500, 0, 2000, 500 }, desktop.Monitors)->Key, L"laptop");
+	EXPECT_EQ(ScenePlanner::MonitorForRect(ScreenRect{ 1800, 0, 2500, 500 }, desktop.Monitors)->Key, L"projector");
+	EXPECT_EQ(ScenePlanner::MonitorForRect(ScreenRect{ -800, 0, -100, 500 }, desktop.Monitors), nullptr);
+}
+
+TEST(ScenePlanner, RestorePointsRoundTrip)
+{
+	const SceneRestorePoint point{ 0x2A0F12, ScreenRect{ -1280, -8, 100, 1032 }, true };
+	const std::wstring text = ScenePlanner::FormatRestorePoint(point);
+
+	SceneRestorePoint parsed;
+	ASSERT_TRUE(ScenePlanner::ParseRestorePoint(text, parsed));
+	EXPECT_EQ(parsed.Handle, point.Handle);
+	EXPECT_EQ(parsed.Rect, point.Rect);
+	EXPECT_TRUE(parsed.Minimized);
+
+	EXPECT_FALSE(ScenePlanner::ParseRestorePoint(L"1,0,0,10,10", parsed));
+	EXPECT_FALSE(ScenePlanner::ParseRestorePoint(L"1,0,0,10,x,0", parsed));
+	EXPECT_FALSE(ScenePlanner::ParseRestorePoint(L"0,0,0,10,10,0", parsed));  // no handle
+	EXPECT_FALSE(ScenePlanner::ParseRestorePoint(L"1,10,0,10,10,0", parsed)); // empty rect
+}
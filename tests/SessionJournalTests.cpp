@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+#include "SessionJournal.h"
+
+namespace
+{
+	using Journal = std::vector<std::uint8_t>;
+
+	PlacementRecord Record(const int left, const bool active = true)
+	{
+		PlacementRecord record;
+		record.Window = WindowIdentity{ 0xABC, 10, 777, L"ConfMultiTabContentWndClass" };
+		record.Rect = ScreenRect{ left, 0, left + 800, 600 };
+		record.ShowCmd = 1;
+		record.Minimized = left % 2 != 0;
+		record.Active = active;
+		record.MonitorKey = L"\\\\?\\DISPLAY#DEL40F3#5&1a2b3c4d&0&UID4353";
+		return record;
+	}
+
+	std::uint32_t Crc32(const std::uint8_t* data, const std::size_t size)
+	{
+		std::uint32_t crc = 0xFFFFFFFFu;
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; ++bit)
+			{
+				crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+			}
+		}
+		return ~crc;
+	}
+
+	// Renumbers the record in the slot at offset, as if that many writes had been made.
+	void SetSequence(Journal& journal, const std::size_t offset, const std::uint64_t sequence)
+	{
+		std::uint8_t* slot = journal.data() + offset;
+		for (int i = 0; i < 8; ++i)
+		{
+			slot[16 + i] = static_cast<std::uint8_t>((sequence >> (8 * i)) & 0xFF);
+		}
+		const std::uint32_t length = slot[12] | (slot[13] << 8) | (slot[14] << 16) | (static_cast<std::uint32_t>(slot[15]) << 24);
+		const std::uint32_t crc = Crc32(slot + 16, length);
+		for (int i = 0; i < 4; ++i)
+		{
+			slot[8 + i] = static_cast<std::uint8_t>((crc >> (8 * i)) & 0xFF);
+		}
+	}
+}
+
+TEST(SessionJournal, EmptyOrGarbageJournalHasNoRecord)
+{
+	Journal journal(SessionJournal::Size, 0);
+	PlacementRecord record;
+	EXPECT_FALSE(SessionJournal::ReadLatest(journal.data(), record));
+
+	std::mt19937 random(1);
+	for (std::uint8_t& byte : journal)
+	{
+		byte = static_cast<std::uint8_t>(random());
+	}
+	EXPECT_FALSE(SessionJournal::ReadLatest(journal.data(), record));
+}
+
+TEST(SessionJournal, WritesAlternateSlotsAndReadTheNewest)
+{
+	Journal journal(SessionJournal::Size, 0);
+	EXPECT_EQ(SessionJournal::Write(journal.data(), Record(1)), 0u);
+	EXPECT_EQ(SessionJournal::Write(journal.data(), Record(2)), SessionJournal::SlotSize);
+	EXPECT_EQ(SessionJournal::Write(journal.data(), Record(3)), 0u);
+
+	PlacementRecord record;
+	ASSERT_TRUE(SessionJournal::ReadLatest(journal.data(), record));
+	EXPECT_EQ(record.Sequence, 3u);
+	EXPECT_EQ(record.Rect.Left, 3);
+	EXPECT_TRUE(record.Minimized);
+	EXPECT_TRUE(record.Active);
+	EXPECT_EQ(record.Window.ClassName, L"ConfMultiTabContentWndClass");
+	EXPECT_EQ(record.MonitorKey, Record(3).MonitorKey);
+}
+
+TEST(SessionJournal, TruncatesOverlongStrings)
+{
+	Journal journal(SessionJournal::Size, 0);
+	PlacementRecord written = Record(1);
+	written.MonitorKey.assign(1000, L'K');
+	SessionJournal::Write(journal.data(), written);
+
+	PlacementRecord record;
+	ASSERT_TRUE(SessionJournal::ReadLatest(journal.data(), record));
+	EXPECT_EQ(record.MonitorKey.size(), SessionJournal::MaxMonitorKeyLength);
+}
+
+// A crash part-way through a write leaves the slot with any mix of old and new bytes:
+// the reader must get either the previous record or the new one, never neither.
+TEST(SessionJournal, TornSlotLeavesThePreviousRecordReadable)
+{
+	Journal journal(SessionJournal::Size, 0);
+	SessionJournal::Write(journal.data(), Record(1));
+	std::mt19937 random(2);
+
+	for (int write = 0; write < 3; ++write)
+	{
+		const int left = 10 + write;
+		PlacementRecord previous;
+		ASSERT_TRUE(SessionJournal::ReadLatest(journal.data(), previous));
+
+		Journal after = journal;
+		const std::size_t offset = SessionJournal::Write(after.data(), Record(left));
+
+		for (std::size_t written = 0; written <= SessionJournal::SlotSize; ++written)
+		{
+			// The write's bytes reach the file front to back, back to front, or in any order.
+			for (int order = 0; order < 3; ++order)
+			{
+				Journal torn = journal;
+				for (std::size_t i = 0; i < SessionJournal::SlotSize; ++i)
+				{
+					const bool reached = order == 0 ? i < written : order == 1 ? i >= SessionJournal::SlotSize - written : random() % 2 == 0;
+					if (reached)
+					{
+						torn[offset + i] = after[offset + i];
+					}
+				}
+
+				PlacementRecord record;
+				ASSERT_TRUE(SessionJournal::ReadLatest(torn.data(), record)) << "write " << write << ", byte " << written;
+				if (record.Rect.Left == left)
+				{
+					EXPECT_EQ(record.Sequence, previous.Sequence + 1);
+				}
+				else
+				{
+					EXPECT_EQ(record.Sequence, previous.Sequence);
+					EXPECT_EQ(record.Rect.Left, previous.Rect.Left);
+				}
+			}
+		}
+
+		journal = after;
+	}
+}
+
+TEST(SessionJournal, NewestSurvivesSequenceWrap)
+{
+	Journal journal(SessionJournal::Size, 0);
+	SessionJournal::Write(journal.data(), Record(1));
+	SetSequence(journal, 0, std::numeric_limits<std::uint64_t>::max() - 1);
+
+	EXPECT_EQ(SessionJournal::Write(journal.data(), Record(2)), SessionJournal::SlotSize);
+	EXPECT_EQ(SessionJournal::Write(journal.data(), Record(3)), 0u); // sequence 0
+
+	PlacementRecord record;
+	ASSERT_TRUE(SessionJournal::ReadLatest(journal.data(), record));
+	EXPECT_EQ(record.Sequence, 0u);
+	EXPECT_EQ(record.Rect.Left, 3);
+
+	EXPECT_EQ(SessionJournal::Write(journal.data(), Record(4)), SessionJournal::SlotSize);
+	ASSERT_TRUE(SessionJournal::ReadLatest(journal.data(), record));
+	EXPECT_EQ(record.Sequence, 1u);
+	EXPECT_EQ(record.Rect.Left, 4);
+}
+
+TEST(SessionJournal, MatchesOnlyTheSameProcessInstance)
+{
+	const PlacementRecord record = Record(5);
+	const WindowIdentity window = record.Window;
+	EXPECT_EQ(SessionJournal::Match(record, window), JournalMatch::Restorable);
+
+	WindowIdentity observed = window;
+	observed.WindowHandle = 1;
+	EXPECT_EQ(SessionJournal::Match(record, observed), JournalMatch::UnrelatedWindow);
+
+	// Zoom restarted and the handle and process id were reused.
+	observed = window;
+	observed.ProcessStartTime = window.ProcessStartTime + 1;
+	EXPECT_EQ(SessionJournal::Match(record, observed), JournalMatch::StaleSession);
+
+	observed = window;
+	observed.ProcessId = 0; // the window is gone
+	EXPECT_EQ(SessionJournal::Match(record, observed), JournalMatch::StaleSession);
+
+	observed = window;
+	observed.ClassName = L"ZPContentViewWndClass";
+	EXPECT_EQ(SessionJournal::Match(record, observed), JournalMatch::StaleSession);
+}
+
+TEST(SessionJournal, SentBackRecordEndsTheSession)
+{
+	Journal journal(SessionJournal::Size, 0);
+	SessionJournal::Write(journal.data(), Record(5));
+	SessionJournal::Write(journal.data(), Record(5, false));
+
+	PlacementRecord record;
+	ASSERT_TRUE(SessionJournal::ReadLatest(journal.data(), record));
+	EXPECT_EQ(SessionJournal::Match(record, record.Window), JournalMatch::NoSession);
+	EXPECT_EQ(SessionJournal::Match(PlacementRecord(), record.Window), JournalMatch::NoSession);
+}
@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+#include <set>
+#include "ShareFollowPolicy.h"
+
+namespace
+{
+	using namespace std::chrono_literals;
+	using Clock = ShareFollowPolicy::Clock;
+
+	/// <summary>
+	/// Plays a scripted stream of share events against the policy, carrying out its
+	/// steps on a simulated projector and firing its settle timer when due, as
+	/// ZoomService and the share window watcher do.
+	/// </summary>
+	class Script
+	{
+	private:
+		Clock::time_point start_;
+		Clock::time_point settleDue_;
+		bool settlePending_ = false;
+
+		void Apply(const ShareFollowSteps& steps, const Clock::time_point now)
+		{
+			if (steps.ShowShare != 0)
+			{
+				OnProjector.insert(steps.ShowShare);
+			}
+			if (steps.ShowMedia)
+			{
+				MediaOnProjector = true;
+			}
+			if (steps.SendShareHome != 0)
+			{
+				OnProjector.erase(steps.SendShareHome);
+			}
+			if (steps.SendMediaHome)
+			{
+				MediaOnProjector = false;
+			}
+			if (steps.SettleAfter.count() > 0)
+			{
+				settlePending_ = true;
+				settleDue_ = now + steps.SettleAfter;
+			}
+		}
+
+		// Fires the settle timer if it is due by now. The next one fires EarlyMs early.
+		void RunTimers(const Clock::time_point now)
+		{
+			while (settlePending_ && settleDue_ - std::chrono::milliseconds(EarlyMs) <= now)
+			{
+				settlePending_ = false;
+				const Clock::time_point firedAt = settleDue_ - std::chrono::milliseconds(EarlyMs);
+				EarlyMs = 0;
+				++SettleWakeups;
+				Apply(Policy.OnSettle(firedAt), firedAt);
+			}
+		}
+
+		Clock::time_point At(const int ms) const { return start_ + std::chrono::milliseconds(ms); }
+
+	public:
+		ShareFollowPolicy Policy;
+		std::set<std::uint64_t> OnProjector; // share windows
+		bool MediaOnProjector = true;
+		int EarlyMs = 0;
+		int SettleWakeups = 0;
+
+		explicit Script(const ShareFollowMode mode = ShareFollowMode::Move)
+			: start_(Clock::now())
+			, Policy(ShareFollowOptions{ mode, 1500ms })
+		{
+		}
+
+		void Open(const int atMs, const std::uint64_t window)
+		{
+			RunTimers(At(atMs));
+			Apply(Policy.OnShareOpened(window, MediaOnProjector), At(atMs));
+		}
+
+		void Close(const int atMs, const std::uint64_t window)
+		{
+			RunTimers(At(atMs));
+			Apply(Policy.OnShareClosed(window, At(atMs)), At(atMs));
+		}
+
+		// Returns whether the toggle was taken by the policy (else it toggles the media window).
+		bool Toggle(const int atMs)
+		{
+			RunTimers(At(atMs));
+			const ShareFollowSteps steps = Policy.OnOperatorToggle();
+			if (steps.IsEmpty())
+			{
+				MediaOnProjector = !MediaOnProjector;
+				return false;
+			}
+			Apply(steps, At(atMs));
+			return true;
+		}
+
+		void Wait(const int untilMs) { RunTimers(At(untilMs)); }
+	};
+}
+
+TEST(ShareFollowPolicy, FollowsAShareAndUndoesItAfterSettling)
+{
+	Script script;
+	script.Open(0, 7);
+	EXPECT_EQ(script.OnProjector, (std::set<std::uint64_t>{ 7 }));
+	EXPECT_TRUE(script.MediaOnProjector); // Move mode: shown over it
+
+	script.Close(60000, 7);
+	script.Wait(61499);
+	EXPECT_EQ(script.OnProjector.size(), 1u); // still settling
+
+	script.Wait(61500);
+	EXPECT_TRUE(script.OnProjector.empty());
+	EXPECT_TRUE(script.MediaOnProjector);
+	EXPECT_FALSE(script.Policy.IsFollowing());
+	EXPECT_EQ(script.Policy.Stats().Follows, 1u);
+	EXPECT_EQ(script.Policy.Stats().Restores, 1u);
+}
+
+TEST(ShareFollowPolicy, EarlyTimerWaitsOutTheRest)
+{
+	Script script;
+	script.EarlyMs = 400;
+	script.Open(0, 7);
+	script.Close(1000, 7);
+	script.Wait(2100); // fires at 2100, 400 ms early
+	EXPECT_EQ(script.OnProjector.size(), 1u);
+	script.Wait(2500);
+	EXPECT_TRUE(script.OnProjector.empty());
+	EXPECT_EQ(script.SettleWakeups, 2);
+}
+
+TEST(ShareFollowPolicy, SwapSendsTheMediaWindowHomeForTheShare)
+{
+	Script script(ShareFollowMode::Swap);
+	script.Open(0, 7);
+	EXPECT_FALSE(script.MediaOnProjector);
+	EXPECT_EQ(script.OnProjector, (std::set<std::uint64_t>{ 7 }));
+
+	script.Close(30000, 7);
+	script.Wait(32000);
+	EXPECT_TRUE(script.MediaOnProjector);
+	EXPECT_TRUE(script.OnProjector.empty());
+}
+
+TEST(ShareFollowPolicy, SwapLeavesAMediaWindowThatWasHomeAlone)
+{
+	Script script(ShareFollowMode::Swap);
+	script.MediaOnProjector = false;
+	script.Open(0, 7);
+	script.Close(30000, 7);
+	script.Wait(32000);
+	EXPECT_FALSE(script.MediaOnProjector);
+	EXPECT_TRUE(script.OnProjector.empty());
+}
+
+TEST(ShareFollowPolicy, HandoverWithinTheSettleDelaySwapsShareWindows)
+{
+	Script script(ShareFollowMode::Swap);
+	script.Open(0, 7);
+	script.Close(10000, 7);
+	script.Open(10800, 9); // another participant starts sharing
+	EXPECT_EQ(script.OnProjector, (std::set<std::uint64_t>{ 9 }));
+	EXPECT_FALSE(script.MediaOnProjector); // never flashed back
+
+	script.Wait(12000); // the first share's settle timer finds nothing to do
+	EXPECT_EQ(script.OnProjector, (std::set<std::uint64_t>{ 9 }));
+
+	script.Close(20000, 9);
+	script.Wait(21500);
+	EXPECT_TRUE(script.MediaOnProjector);
+	EXPECT_TRUE(script.OnProjector.empty());
+	EXPECT_EQ(script.Policy.Stats().Follows, 2u);
+	EXPECT_EQ(script.Policy.Stats().Restores, 1u);
+}
+
+TEST(ShareFollowPolicy, RecreatedShareWindowIsNotSentHome)
+{
+	Script script;
+	script.Open(0, 7);
+	script.Close(5000, 7); // Zoom hides and reshows the same window
+	script.Open(5200, 7);
+	script.Wait(10000);
+	EXPECT_EQ(script.OnProjector, (std::set<std::uint64_t>{ 7 }));
+	EXPECT_TRUE(script.Policy.IsFollowing());
+}
+
+TEST(ShareFollowPolicy, SecondShareReplacesTheFirst)
+{
+	Script script;
+	script.Open(0, 7);
+	script.Open(100, 9);
+	EXPECT_EQ(script.OnProjector, (std::set<std::uint64_t>{ 9 }));
+
+	script.Close(200, 7); // no longer shown: ignored
+	script.Wait(5000);
+	EXPECT_EQ(script.OnProjector, (std::set<std::uint64_t>{ 9 }));
+}
+
+TEST(ShareFollowPolicy, IgnoresUnrelatedWindows)
+{
+	Script script;
+	script.Close(0, 3);
+	script.Open(10, 0);
+	EXPECT_TRUE(script.OnProjector.empty());
+	EXPECT_FALSE(script.Policy.IsFollowing());
+	EXPECT_EQ(script.SettleWakeups, 0);
+}
+
+TEST(ShareFollowPolicy, OperatorToggleDismissesTheShare)
+{
+	Script script(ShareFollowMode::Swap);
+	EXPECT_FALSE(script.Toggle(0)); // not following: an ordinary toggle
+	EXPECT_FALSE(script.MediaOnProjector);
+	EXPECT_FALSE(script.Toggle(100));
+	EXPECT_TRUE(script.MediaOnProjector);
+
+	script.Open(1000, 7);
+	EXPECT_TRUE(script.Toggle(2000));
+	EXPECT_TRUE(script.MediaOnProjector);
+	EXPECT_TRUE(script.OnProjector.empty());
+	EXPECT_FALSE(script.Policy.IsFollowing());
+
+	// The share window closing afterwards changes nothing.
+	script.Close(3000, 7);
+	script.Wait(10000);
+	EXPECT_TRUE(script.MediaOnProjector);
+	EXPECT_EQ(script.SettleWakeups, 0);
+}
+
+TEST(ShareFollowPolicy, OperatorToggleWhileSettlingRestoresNow)
+{
+	Script script(ShareFollowMode::Swap);
+	script.Open(0, 8);
+	script.Close(1000, 8);
+	EXPECT_TRUE(script.Toggle(1200));
+	EXPECT_TRUE(script.MediaOnProjector);
+	EXPECT_TRUE(script.OnProjector.empty());
+
+	script.Wait(5000); // the pending timer finds nothing to settle
+	EXPECT_EQ(script.Policy.Stats().Restores, 1u);
+	EXPECT_TRUE(script.MediaOnProjector);
+}
+
+TEST(ShareFollowPolicy, RecordsShowLatency)
+{
+	ShareFollowPolicy policy;
+	policy.OnShown(100us);
+	policy.OnShown(50us);
+	EXPECT_EQ(policy.Stats().TotalLatencyUs, 150);
+	EXPECT_EQ(policy.Stats().MaxLatencyUs, 100);
+}
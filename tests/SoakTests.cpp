@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include "SoakBenchmark.h"
+
+namespace
+{
+	// The --selftest-soak run, cut down to keep the test quick; enough toggles that a
+	// leak of one object per toggle (or per report) shows.
+	SoakOptions ReducedOptions()
+	{
+		SoakOptions options;
+		options.Toggles = 5000;
+		options.Warmup = 100;
+		options.ReportEvery = 1000;
+		return options;
+	}
+
+	std::string LastLine(const std::string& report)
+	{
+		const std::size_t end = report.find_last_not_of('\n');
+		const std::size_t start = report.rfind('\n', end);
+		return report.substr(start == std::string::npos ? 0 : start + 1, end - (start == std::string::npos ? 0 : start + 1) + 1);
+	}
+}
+
+TEST(Soak, SimulatedTogglesReleaseEveryObject)
+{
+	std::ostringstream report;
+	EXPECT_TRUE(SoakBenchmark::RunSimulated(report, ReducedOptions())) << report.str();
+
+	const std::string summary = LastLine(report.str());
+	EXPECT_NE(summary.find("\"summary\":true"), std::string::npos) << summary;
+	EXPECT_NE(summary.find("\"failures\":0"), std::string::npos) << summary;
+	EXPECT_NE(summary.find("\"liveObjects\":0.00"), std::string::npos) << summary;
+	EXPECT_NE(summary.find("\"leak\":false"), std::string::npos) << summary;
+}
+
+TEST(Soak, ReportsEveryInterval)
+{
+	std::ostringstream report;
+	SoakBenchmark::RunSimulated(report, ReducedOptions());
+
+	const std::string text = report.str();
+	for (const char* toggles : { "\"toggles\":1000,", "\"toggles\":3000,", "\"toggles\":5000,\"liveObjects\"" })
+	{
+		EXPECT_NE(text.find(toggles), std::string::npos) << toggles;
+	}
+}
+
+TEST(Soak, DetectsAnObjectLeak)
+{
+	std::int64_t live = 0;
+	int toggles = 0;
+	const auto toggle = [&]
+	{
+		// Leaks one object every 100 toggles, once warmed up.
+		if (++toggles > 100 && toggles % 100 == 0)
+		{
+			++live;
+		}
+		return true;
+	};
+	const auto sample = [&]
+	{
+		ResourceSample result;
+		result.LiveObjects = live;
+		return result;
+	};
+
+	std::ostringstream report;
+	EXPECT_FALSE(SoakBenchmark::Run(report, "leaky", toggle, sample, ReducedOptions()));
+	EXPECT_NE(LastLine(report.str()).find("\"liveObjects\":10.00"), std::string::npos) << report.str();
+}
+
+TEST(Soak, AllowsHeapNoiseWithinTolerance)
+{
+	std::int64_t bytes = 1 << 20;
+	const auto toggle = [&] { bytes += 3; return true; };
+	const auto sample = [&]
+	{
+		ResourceSample result;
+		result.PrivateBytes = bytes;
+		return result;
+	};
+
+	std::ostringstream report;
+	EXPECT_TRUE(SoakBenchmark::Run(report, "heap", toggle, sample, ReducedOptions()));
+
+	bytes = 1 << 20;
+	const auto growing = [&] { bytes += 64; return true; };
+	EXPECT_FALSE(SoakBenchmark::Run(report, "heap", growing, sample, ReducedOptions()));
+}
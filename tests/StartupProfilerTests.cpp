@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "StartupProfiler.h"
+
+TEST(StartupProfiler, ScopeRecordsPhaseInOrder)
+{
+	StartupProfiler profiler;
+	{
+		StartupProfiler::Scope outer(profiler, "Outer");
+		StartupProfiler::Scope inner(profiler, "Inner");
+	}
+
+	ASSERT_EQ(profiler.Phases().size(), 2u);
+	EXPECT_EQ(profiler.Phases()[0].Name, "Inner"); // destroyed first
+	EXPECT_EQ(profiler.Phases()[1].Name, "Outer");
+	EXPECT_GE(profiler.Phases()[1].DurationUs, profiler.Phases()[0].DurationUs);
+}
+
+TEST(StartupProfiler, IgnoresPhasesAfterFinish)
+{
+	StartupProfiler profiler;
+	profiler.AddPhase("Before", 0, 10);
+	profiler.Finish();
+	const std::int64_t total = profiler.TotalUs();
+	profiler.AddPhase("After", 20, 10);
+	profiler.Finish();
+
+	EXPECT_TRUE(profiler.IsFinished());
+	EXPECT_EQ(profiler.Phases().size(), 1u);
+	EXPECT_EQ(profiler.TotalUs(), total);
+}
+
+TEST(StartupProfiler, ReportRoundTripsWithTotal)
+{
+	StartupProfiler profiler;
+	profiler.AddPhase("Settings", 5, 120);
+	profiler.AddPhase("Window \"main\"", 130, 40);
+	profiler.Finish();
+
+	std::stringstream report;
+	profiler.WriteReport(report, nullptr);
+	const std::vector<StartupPhase> read = StartupProfiler::ReadReport(report);
+
+	ASSERT_EQ(read.size(), 3u);
+	EXPECT_EQ(read[0].Name, "Settings");
+	EXPECT_EQ(read[0].StartUs, 5);
+	EXPECT_EQ(read[0].DurationUs, 120);
+	EXPECT_EQ(read[1].Name, "Window \"main\"");
+	EXPECT_EQ(read[2].Name, "total");
+	EXPECT_EQ(read[2].DurationUs, profiler.TotalUs());
+}
+
+TEST(StartupProfiler, ReportComparesAgainstBaseline)
+{
+	StartupProfiler profiler;
+	profiler.AddPhase("Settings", 0, 150);
+	profiler.AddPhase("NewPhase", 150, 10);
+	profiler.Finish();
+
+	const std::vector<StartupPhase> baseline{ { "Settings", 0, 100 } };
+	std::ostringstream report;
+	profiler.WriteReport(report, &baseline);
+	const std::string text = report.str();
+
+	EXPECT_NE(text.find("{\"phase\":\"Settings\",\"start_us\":0,\"duration_us\":150,\"baseline_us\":100,\"delta_us\":50}"), std::string::npos);
+	EXPECT_NE(text.find("{\"phase\":\"NewPhase\",\"start_us\":150,\"duration_us\":10}"), std::string::npos);
+}
+
+TEST(StartupProfiler, ReadReportSkipsOtherLines)
+{
+	std::istringstream in(
+		"not json\n"
+		"{\"phase\":\"A\",\"start_us\":1,\"duration_us\":-2}\n"
+		"{\"phase\":\"B\"}\n"
+		"{\"duration_us\":3}\n");
+	const std::vector<StartupPhase> read = StartupProfiler::ReadReport(in);
+
+	ASSERT_EQ(read.size(), 1u);
+	EXPECT_EQ(read[0].Name, "A");
+	EXPECT_EQ(read[0].DurationUs, -2);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "ToggleStats.h"
+
+namespace
+{
+	DisplayWindowResult Toggle(const std::int64_t totalUs, const std::uint32_t fallbacks = ToggleFallbackNone)
+	{
+		DisplayWindowResult result;
+		result.AllOk = true;
+		result.Fallbacks = fallbacks;
+		result.Timings.TotalUs = totalUs;
+		result.Timings.DiscoveryUs = totalUs / 2;
+		return result;
+	}
+
+	DisplayWindowResult Failure(const DisplayWindowError error)
+	{
+		DisplayWindowResult result;
+		result.AllOk = false;
+		result.Error = error;
+		result.Timings.TotalUs = 100;
+		return result;
+	}
+}
+
+TEST(ToggleStats, RecordsOnlyStagesThatRan)
+{
+	ToggleStats stats;
+	stats.Record(Toggle(1000));
+
+	EXPECT_EQ(stats.ToggleCount(), 1u);
+	EXPECT_EQ(stats.Stage(ToggleStage::Total).TotalCount(), 1u);
+	EXPECT_EQ(stats.Stage(ToggleStage::Discovery).TotalCount(), 1u);
+	EXPECT_EQ(stats.Stage(ToggleStage::Move).TotalCount(), 0u);
+	EXPECT_EQ(stats.Stage(ToggleStage::ClickToVisible).TotalCount(), 0u);
+}
+
+TEST(ToggleStats, CountsFailuresAndFallbacks)
+{
+	ToggleStats stats;
+	stats.Record(Toggle(1000, ToggleFallbackWarmStart | ToggleFallbackNoFade));
+	stats.Record(Toggle(1000, ToggleFallbackWarmStart));
+	stats.Record(Failure(DisplayWindowError::DeadlineExceeded));
+
+	EXPECT_EQ(stats.FailureCount(DisplayWindowError::DeadlineExceeded), 1u);
+	EXPECT_EQ(stats.FailureCount(DisplayWindowError::ZoomNotRunning), 0u);
+	EXPECT_EQ(stats.FallbackCount(9), 2u); // WarmStart
+	EXPECT_EQ(stats.FallbackCount(4), 1u); // NoFade
+}
+
+TEST(ToggleStats, MergeAddsEverything)
+{
+	ToggleStats file;
+	file.Record(Toggle(2000));
+	file.Record(Failure(DisplayWindowError::MediaWindowNotFound));
+
+	ToggleStats session;
+	session.Record(Toggle(500, ToggleFallbackCorrectiveResize));
+	session.Record(Failure(DisplayWindowError::MediaWindowNotFound));
+
+	file.Merge(session);
+	EXPECT_EQ(file.ToggleCount(), 4u);
+	EXPECT_EQ(file.Stage(ToggleStage::Total).TotalCount(), 4u);
+	EXPECT_EQ(file.Stage(ToggleStage::Total).Min(), 100u);
+	EXPECT_EQ(file.Stage(ToggleStage::Total).Max(), 2000u);
+	EXPECT_EQ(file.FailureCount(DisplayWindowError::MediaWindowNotFound), 2u);
+	EXPECT_EQ(file.FallbackCount(8), 1u); // CorrectiveResize
+}
+
+TEST(ToggleStats, RepeatedMergesOfResetSessionsMatchOneMerge)
+{
+	// The session is merged after each toggle and reset; the file must end up as
+	// if everything had been merged at exit.
+	ToggleStats incremental;
+	ToggleStats session;
+	ToggleStats all;
+	for (int i = 1; i <= 20; ++i)
+	{
+		const DisplayWindowResult result = i % 5 == 0 ? Failure(DisplayWindowError::ZoomNotRunning) : Toggle(i * 300);
+		session.Record(result);
+		all.Record(result);
+		incremental.Merge(session);
+		session.Reset();
+	}
+
+	EXPECT_EQ(session.ToggleCount(), 0u);
+	EXPECT_EQ(session.Stage(ToggleStage::Total).TotalCount(), 0u);
+	EXPECT_EQ(incremental.ToggleCount(), all.ToggleCount());
+	EXPECT_EQ(incremental.FailureCount(DisplayWindowError::ZoomNotRunning), 4u);
+	EXPECT_EQ(incremental.Stage(ToggleStage::Total).ValueAtPercentile(90.0), all.Stage(ToggleStage::Total).ValueAtPercentile(90.0));
+	EXPECT_EQ(incremental.FormatReport(), all.FormatReport());
+}
+
+TEST(ToggleStats, WriteReadRoundTrips)
+{
+	ToggleStats stats;
+	DisplayWindowResult result = Toggle(1000);
+	result.Timings.ClickToVisibleUs = 180000;
+	stats.Record(result);
+	stats.Record(Failure(DisplayWindowError::NoWindowPosition));
+
+	std::stringstream data;
+	stats.Write(data);
+	ToggleStats read;
+	ASSERT_TRUE(read.Read(data));
+
+	EXPECT_EQ(read.ToggleCount(), 2u);
+	EXPECT_EQ(read.Stage(ToggleStage::ClickToVisible).TotalCount(), 1u);
+	EXPECT_EQ(read.FailureCount(DisplayWindowError::NoWindowPosition), 1u);
+	EXPECT_NE(read.FormatReport().find(L"ClickToVisible: 1"), std::wstring::npos);
+}
+
+TEST(ToggleStats, ReadRejectsOtherFilesAndLeavesStatsEmpty)
+{
+	ToggleStats stats;
+	stats.Record(Toggle(1000));
+
+	std::istringstream notStats("not a stats file at all");
+	EXPECT_FALSE(stats.Read(notStats));
+	EXPECT_EQ(stats.ToggleCount(), 0u);
+	EXPECT_EQ(stats.Stage(ToggleStage::Total).TotalCount(), 0u);
+
+	ToggleStats full;
+	full.Record(Toggle(1000));
+	std::ostringstream out;
+	full.Write(out);
+	std::istringstream truncated(out.str().substr(0, out.str().size() - 3));
+	EXPECT_FALSE(stats.Read(truncated));
+	EXPECT_EQ(stats.ToggleCount(), 0u);
+}
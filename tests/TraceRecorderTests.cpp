@@ -0,0 +1,119 @@
+#define PROJECTORSWITCH_TRACE
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "TraceRecorder.h"
+
+// The recorder is process-wide, so each test records on a thread of its own and
+// looks for that thread's events in the export.
+namespace
+{
+	std::string Export()
+	{
+		std::ostringstream out;
+		TraceRecorder::Instance().ExportChromeTrace(out);
+		return out.str();
+	}
+
+	std::size_t CountOf(const std::string& text, const std::string& needle)
+	{
+		std::size_t count = 0;
+		for (std::size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1))
+		{
+			++count;
+		}
+		return count;
+	}
+}
+
+TEST(TraceRecorder, ExportsCompleteEvents)
+{
+	std::thread([] { TraceRecorder::Instance().Record("Test.Complete", 100, 25); }).join();
+
+	EXPECT_NE(Export().find("{\"name\":\"Test.Complete\",\"cat\":\"toggle\",\"ph\":\"X\",\"pid\":1,\"tid\":"), std::string::npos);
+	EXPECT_NE(Export().find(",\"ts\":100,\"dur\":25}"), std::string::npos);
+}
+
+TEST(TraceRecorder, ZoneRecordsItsLifetime)
+{
+	std::thread([]
+	{
+		TRACE_ZONE("Test.Zone");
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}).join();
+
+	const std::string text = Export();
+	const std::size_t pos = text.find("\"name\":\"Test.Zone\"");
+	ASSERT_NE(pos, std::string::npos);
+	const std::size_t dur = text.find("\"dur\":", pos);
+	ASSERT_NE(dur, std::string::npos);
+	EXPECT_GE(std::stoll(text.substr(dur + 6)), 2000);
+}
+
+TEST(TraceRecorder, ThreadsGetTheirOwnBuffers)
+{
+	std::thread([] { TraceRecorder::Instance().Record("Test.ThreadA", 0, 1); }).join();
+	std::thread([] { TraceRecorder::Instance().Record("Test.ThreadB", 0, 1); }).join();
+
+	const std::string text = Export();
+	const std::size_t a = text.find("\"name\":\"Test.ThreadA\"");
+	const std::size_t b = text.find("\"name\":\"Test.ThreadB\"");
+	ASSERT_NE(a, std::string::npos);
+	ASSERT_NE(b, std::string::npos);
+	const std::string tidA = text.substr(text.find("\"tid\":", a), 10);
+	const std::string tidB = text.substr(text.find("\"tid\":", b), 10);
+	EXPECT_NE(tidA, tidB);
+}
+
+TEST(TraceRecorder, CountsEventsBeyondCapacityAsDropped)
+{
+	std::thread([]
+	{
+		for (std::uint32_t i = 0; i < ThreadTraceBuffer::Capacity + 7; ++i)
+		{
+			TraceRecorder::Instance().Record("Test.Overflow", i, 1);
+		}
+	}).join();
+
+	const std::string text = Export();
+	EXPECT_EQ(CountOf(text, "\"name\":\"Test.Overflow\""), ThreadTraceBuffer::Capacity);
+	EXPECT_NE(text.find("\"name\":\"dropped_events\",\"ph\":\"C\""), std::string::npos);
+	EXPECT_NE(text.find("\"args\":{\"count\":7}"), std::string::npos);
+}
+
+TEST(TraceRecorder, ExitedThreadsHandTheirBuffersOn)
+{
+	for (std::uint32_t i = 0; i < 3 * TraceRecorder::RecycleAfter; ++i)
+	{
+		std::thread([] { TraceRecorder::Instance().Record("Test.ShortLived", 0, 1); }).join();
+	}
+
+	EXPECT_LE(TraceRecorder::Instance().BufferCount(), TraceRecorder::RecycleAfter);
+	EXPECT_GE(CountOf(Export(), "\"name\":\"Test.ShortLived\""), 1u);
+}
+
+TEST(TraceRecorder, RecycledBufferStartsEmpty)
+{
+	// Fill every buffer there may be, so the next thread is certain to recycle one.
+	for (std::uint32_t i = 0; i < TraceRecorder::RecycleAfter; ++i)
+	{
+		std::thread([]
+		{
+			for (std::uint32_t n = 0; n < ThreadTraceBuffer::Capacity; ++n)
+			{
+				TraceRecorder::Instance().Record("Test.Filler", n, 1);
+			}
+		}).join();
+	}
+
+	std::thread([] { TraceRecorder::Instance().Record("Test.AfterRecycling", 0, 1); }).join();
+	EXPECT_EQ(CountOf(Export(), "\"name\":\"Test.AfterRecycling\""), 1u);
+}
+
+TEST(TraceRecorder, ExportIsAJsonObject)
+{
+	const std::string text = Export();
+	EXPECT_EQ(text.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+	EXPECT_EQ(text.substr(text.size() - 4), "\n]}\n");
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "DiscoveryBenchmark.h"
+#include "MediaWindowDiscovery.h"
+#include "ReplayDiscoveryBackend.h"
+#include "TreeSnapshot.h"
+
+namespace
+{
+	constexpr std::uint32_t ZoomProcess = 4242;
+
+	/// <summary>
+	/// Writes a desktop as UiaTreeCapture does: every top-level window of the Zoom
+	/// process, whether or not it matches the selectors, with the selected one recorded.
+	/// </summary>
+	class ZoomDesktop
+	{
+	private:
+		const MediaWindowSelectors zoom_ = MediaWindowSelectors::Zoom();
+
+		void AddControls(TreeSnapshotWriter& writer, const int window, const int controls, const std::wstring& markerHelpText) const
+		{
+			const int pane = writer.AddElement(window, L"", L"Pane", L"", ZoomProcess);
+			for (int i = 0; i < controls; ++i)
+			{
+				writer.AddElement(pane, L"Button " + std::to_wstring(i), L"Button", L"{\"controlID\":\"btn_" + std::to_wstring(i) + L"\"}", ZoomProcess);
+			}
+			if (!markerHelpText.empty())
+			{
+				writer.AddElement(pane, L"Meeting information", L"Button", markerHelpText, ZoomProcess);
+			}
+		}
+
+	public:
+		int MainWindow = -1;
+		int MediaWindow = -1;
+		int Toolbar = -1;
+
+		// className is the media window's class (a Zoom update may rename it).
+		std::string Write(const std::wstring& className, const bool recordSelection = true)
+		{
+			std::ostringstream out(std::ios::binary);
+			TreeSnapshotWriter writer(out);
+			writer.AddElement(-1, L"Desktop 1", L"#32769", L"", 0);
+
+			writer.AddElement(0, L"Untitled - Notepad", L"Notepad", L"", 99);
+			MainWindow = writer.AddElement(0, zoom_.WindowName, zoom_.WindowClassName, L"", ZoomProcess);
+			AddControls(writer, MainWindow, 20, zoom_.MainWindowHelpTexts[0]);
+			Toolbar = writer.AddElement(0, L"", L"ZPFloatToolbarClass", L"", ZoomProcess);
+			AddControls(writer, Toolbar, 3, L"");
+			MediaWindow = writer.AddElement(0, zoom_.WindowName, className, L"", ZoomProcess);
+			AddControls(writer, MediaWindow, 5, L"");
+
+			writer.Finish(recordSelection && className == zoom_.WindowClassName ? MediaWindow : -1);
+			return out.str();
+		}
+	};
+
+	std::vector<TreeSnapshotElement> ReadAll(TreeSnapshotReader& reader)
+	{
+		std::vector<TreeSnapshotElement> elements;
+		EXPECT_TRUE(reader.ReadElements(0, reader.ElementCount(), elements));
+		return elements;
+	}
+}
+
+TEST(TreeSnapshot, RoundTripsElementsAndStrings)
+{
+	std::ostringstream out(std::ios::binary);
+	TreeSnapshotWriter writer(out);
+	EXPECT_EQ(writer.AddElement(-1, L"Desktop", L"#32769", L"", 0), 0);
+	EXPECT_EQ(writer.AddElement(0, L"Zoom Meeting", L"ConfMultiTabContentWndClass", L"", 17), 1);
+	EXPECT_EQ(writer.AddElement(1, L"Café \U0001F3A5", L"Button", L"Zoom Meeting", 17), 2);
+	writer.Finish(1);
+
+	std::istringstream in(out.str(), std::ios::binary);
+	TreeSnapshotReader reader;
+	ASSERT_TRUE(reader.Open(in));
+	EXPECT_EQ(reader.ElementCount(), 3u);
+	EXPECT_EQ(reader.StringCount(), 7u); // "" and "Zoom Meeting" are interned once
+	EXPECT_EQ(reader.SelectedElement(), 1);
+
+	const std::vector<TreeSnapshotElement> elements = ReadAll(reader);
+	ASSERT_EQ(elements.size(), 3u);
+	EXPECT_EQ(elements[0].Parent, TreeSnapshotElement::NoParent);
+	EXPECT_EQ(elements[2].Parent, 1u);
+	EXPECT_EQ(elements[2].ProcessId, 17u);
+	EXPECT_EQ(reader.String(elements[1].ClassNameId), L"ConfMultiTabContentWndClass");
+	EXPECT_EQ(reader.String(elements[2].NameId), L"Café \U0001F3A5");
+	EXPECT_EQ(elements[2].HelpTextId, elements[1].NameId);
+	EXPECT_EQ(reader.String(1000), L"");
+
+	std::vector<TreeSnapshotElement> tail;
+	ASSERT_TRUE(reader.ReadElements(2, 10, tail));
+	ASSERT_EQ(tail.size(), 1u);
+	EXPECT_EQ(tail[0].Parent, 1u);
+}
+
+TEST(TreeSnapshot, RejectsDamagedFiles)
+{
+	ZoomDesktop desktop;
+	const std::string snapshot = desktop.Write(MediaWindowSelectors::Zoom().WindowClassName);
+	TreeSnapshotReader reader;
+
+	std::istringstream truncated(snapshot.substr(0, snapshot.size() - 3), std::ios::binary);
+	EXPECT_FALSE(reader.Open(truncated));
+
+	std::string wrongVersion = snapshot;
+	wrongVersion[4] = 1;
+	std::istringstream oldFile(wrongVersion, std::ios::binary);
+	EXPECT_FALSE(reader.Open(oldFile));
+
+	std::istringstream empty(std::string(), std::ios::binary);
+	EXPECT_FALSE(reader.Open(empty));
+}
+
+TEST(TreeSnapshot, ReplayFindsTheCapturedMediaWindow)
+{
+	ZoomDesktop desktop;
+	std::istringstream in(desktop.Write(MediaWindowSelectors::Zoom().WindowClassName), std::ios::binary);
+	TreeSnapshotReader reader;
+	ASSERT_TRUE(reader.Open(in));
+	EXPECT_EQ(reader.SelectedElement(), desktop.MediaWindow);
+
+	ReplayDiscoveryBackend backend(reader);
+	const DiscoveryOutcome outcome = MediaWindowDiscovery::Locate(backend, MediaWindowSelectors::Zoom());
+	EXPECT_EQ(outcome.CandidateCount, 2);
+	EXPECT_EQ(outcome.Probes, 2); // the main window first, which has the marker
+	EXPECT_EQ(backend.CandidateElement(outcome.SelectedIndex), desktop.MediaWindow);
+	EXPECT_EQ(backend.CandidateElement(0), desktop.MainWindow);
+	EXPECT_EQ(backend.CandidateElement(2), -1);
+	EXPECT_GT(backend.ElementsVisited(), 0u);
+
+	std::ostringstream report;
+	EXPECT_TRUE(DiscoveryBenchmark::RunSnapshot(report, "zoom.tree", reader, 5));
+	EXPECT_NE(report.str().find("\"correct\":5"), std::string::npos) << report.str();
+}
+
+// After an update renames the media window's class, discovery finds only the main
+// window; the capture still holds the renamed window, so new selectors can be tried.
+TEST(TreeSnapshot, CaptureAfterARenameHoldsTheMissedWindow)
+{
+	ZoomDesktop desktop;
+	std::istringstream in(desktop.Write(L"ConfMultiTabContentWndClassV2"), std::ios::binary);
+	TreeSnapshotReader reader;
+	ASSERT_TRUE(reader.Open(in));
+	EXPECT_EQ(reader.SelectedElement(), -1);
+
+	std::vector<TreeSnapshotElement> elements = ReadAll(reader);
+	int zoomWindows = 0;
+	for (const TreeSnapshotElement& element : elements)
+	{
+		zoomWindows += element.Parent == 0 && element.ProcessId == ZoomProcess ? 1 : 0;
+	}
+	EXPECT_EQ(zoomWindows, 3);
+
+	ReplayDiscoveryBackend backend(reader);
+	const DiscoveryOutcome current = MediaWindowDiscovery::Locate(backend, MediaWindowSelectors::Zoom());
+	EXPECT_EQ(current.CandidateCount, 1);
+	EXPECT_EQ(backend.CandidateElement(current.SelectedIndex), desktop.MainWindow); // the wrong window
+
+	MediaWindowSelectors updated = MediaWindowSelectors::Zoom();
+	updated.WindowClassName = L"ConfMultiTabContentWndClassV2";
+	const DiscoveryOutcome fixed = MediaWindowDiscovery::Locate(backend, updated);
+	EXPECT_EQ(fixed.CandidateCount, 1);
+	EXPECT_EQ(backend.CandidateElement(fixed.SelectedIndex), desktop.MediaWindow);
+}
+
+TEST(TreeSnapshot, BenchmarkFlagsASelectionThatChanged)
+{
+	ZoomDesktop desktop;
+	std::string snapshot = desktop.Write(MediaWindowSelectors::Zoom().WindowClassName);
+	std::istringstream in(snapshot, std::ios::binary);
+	TreeSnapshotReader reader;
+	ASSERT_TRUE(reader.Open(in));
+
+	// The selection recorded at capture time was the toolbar, not what discovery picks now.
+	std::ostringstream out(std::ios::binary);
+	{
+		TreeSnapshotWriter writer(out);
+		std::vector<TreeSnapshotElement> elements = ReadAll(reader);
+		for (const TreeSnapshotElement& e : elements)
+		{
+			writer.AddElement(e.Parent == TreeSnapshotElement::NoParent ? -1 : static_cast<int>(e.Parent),
+				reader.String(e.NameId), reader.String(e.ClassNameId), reader.String(e.HelpTextId), e.ProcessId);
+		}
+		writer.Finish(desktop.Toolbar);
+	}
+
+	std::istringstream changedIn(out.str(), std::ios::binary);
+	TreeSnapshotReader changed;
+	ASSERT_TRUE(changed.Open(changedIn));
+	std::ostringstream report;
+	EXPECT_FALSE(DiscoveryBenchmark::RunSnapshot(report, "changed.tree", changed, 3));
+	EXPECT_NE(report.str().find("\"correct\":0"), std::string::npos) << report.str();
+}
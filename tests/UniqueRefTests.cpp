@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <utility>
+#include "UniqueRef.h"
+
+namespace
+{
+	// A refcounted object in the shape of IUnknown, created with one reference held by its creator.
+	class FakeInterface
+	{
+	public:
+		int References = 1;
+		int AddRefs = 0;
+		int Releases = 0;
+
+		unsigned long AddRef()
+		{
+			++AddRefs;
+			return static_cast<unsigned long>(++References);
+		}
+
+		unsigned long Release()
+		{
+			++Releases;
+			EXPECT_GT(References, 0) << "released more often than referenced";
+			return static_cast<unsigned long>(--References);
+		}
+	};
+
+	// Stands in for an API that returns a new reference through an out parameter.
+	void CreateInstance(FakeInterface& object, FakeInterface** out)
+	{
+		object.AddRef();
+		*out = &object;
+	}
+
+	std::uint64_t Transfers()
+	{
+		return UniqueRefStats::Transfers.load();
+	}
+}
+
+TEST(UniqueRef, AdoptsWithoutAddRefAndReleasesOnce)
+{
+	FakeInterface object;
+	{
+		const UniqueRef<FakeInterface> ref(&object);
+		EXPECT_EQ(ref.Get(), &object);
+		EXPECT_TRUE(ref);
+		EXPECT_EQ(object.AddRefs, 0);
+	}
+	EXPECT_EQ(object.Releases, 1);
+	EXPECT_EQ(object.References, 0);
+}
+
+TEST(UniqueRef, ShareTakesItsOwnReference)
+{
+	FakeInterface object;
+	{
+		const auto shared = UniqueRef<FakeInterface>::Share(&object);
+		EXPECT_EQ(object.References, 2);
+	}
+	EXPECT_EQ(object.References, 1); // the creator's reference is untouched
+	EXPECT_FALSE(UniqueRef<FakeInterface>::Share(nullptr));
+}
+
+TEST(UniqueRef, MovesTransferTheReferenceWithoutRefcounting)
+{
+	FakeInterface object;
+	const std::uint64_t before = Transfers();
+	{
+		UniqueRef<FakeInterface> first(&object);
+		UniqueRef<FakeInterface> second(std::move(first));
+		EXPECT_FALSE(first); // NOLINT(bugprone-use-after-move)
+		EXPECT_EQ(second.Get(), &object);
+
+		UniqueRef<FakeInterface> third;
+		third = std::move(second);
+		EXPECT_EQ(third.Get(), &object);
+		EXPECT_EQ(object.AddRefs, 0);
+		EXPECT_EQ(object.Releases, 0);
+	}
+	EXPECT_EQ(object.Releases, 1);
+	EXPECT_EQ(object.References, 0);
+	EXPECT_EQ(Transfers() - before, 2u);
+}
+
+TEST(UniqueRef, MoveAssignmentReleasesTheReferenceItReplaces)
+{
+	FakeInterface kept;
+	FakeInterface replaced;
+	{
+		UniqueRef<FakeInterface> target(&replaced);
+		UniqueRef<FakeInterface> source(&kept);
+		target = std::move(source);
+		EXPECT_EQ(replaced.References, 0);
+		EXPECT_EQ(kept.References, 1);
+
+		// Self-assignment keeps the reference.
+		UniqueRef<FakeInterface>& alias = target;
+		target = std::move(alias);
+		EXPECT_EQ(target.Get(), &kept);
+		EXPECT_EQ(kept.Releases, 0);
+	}
+	EXPECT_EQ(kept.References, 0);
+	EXPECT_EQ(replaced.Releases, 1);
+}
+
+TEST(UniqueRef, ResetReleasesTheOldReferenceAndAdoptsTheNew)
+{
+	FakeInterface first;
+	FakeInterface second;
+	const std::uint64_t before = Transfers();
+	{
+		UniqueRef<FakeInterface> ref(&first);
+		ref.Reset(&second);
+		EXPECT_EQ(first.References, 0);
+		EXPECT_EQ(second.AddRefs, 0);
+
+		ref.Reset();
+		EXPECT_FALSE(ref);
+		EXPECT_EQ(second.References, 0);
+		ref.Reset(); // nothing left to release
+	}
+	EXPECT_EQ(first.Releases, 1);
+	EXPECT_EQ(second.Releases, 1);
+	EXPECT_EQ(Transfers(), before); // Reset adopts and releases; it transfers nothing
+}
+
+TEST(UniqueRef, OutReleasesAHeldReferenceBeforeReceivingANewOne)
+{
+	FakeInterface held;
+	FakeInterface created;
+	created.References = 0; // only what CreateInstance hands out
+	{
+		UniqueRef<FakeInterface> ref(&held);
+		CreateInstance(created, ref.Out());
+		EXPECT_EQ(held.References, 0);
+		EXPECT_EQ(ref.Get(), &created);
+		EXPECT_EQ(created.References, 1);
+
+		// Out on an empty ref releases nothing.
+		UniqueRef<FakeInterface> empty;
+		CreateInstance(created, empty.Out());
+		EXPECT_EQ(created.References, 2);
+	}
+	EXPECT_EQ(held.Releases, 1);
+	EXPECT_EQ(created.AddRefs, 2);
+	EXPECT_EQ(created.Releases, 2);
+	EXPECT_EQ(created.References, 0);
+}
+
+TEST(UniqueRef, DetachHandsTheReferenceToTheCaller)
+{
+	FakeInterface object;
+	const std::uint64_t before = Transfers();
+	FakeInterface* detached = nullptr;
+	{
+		UniqueRef<FakeInterface> ref(&object);
+		detached = ref.Detach();
+		EXPECT_FALSE(ref);
+		EXPECT_EQ(ref.Detach(), nullptr); // counted only when something is handed over
+	}
+	EXPECT_EQ(detached, &object);
+	EXPECT_EQ(object.Releases, 0);
+	EXPECT_EQ(Transfers() - before, 1u);
+
+	// The caller adopts it again.
+	const UniqueRef<FakeInterface> adopted(detached);
+	EXPECT_EQ(object.References, 1);
+}